@@ -3,13 +3,33 @@ $output v_worldpos, v_texcoord, v_worldnorm
 
 #include "common/common.sh"
 
+// Inverse of MeshQuantizer::EncodeOctahedral
+vec3 OctahedralDecode(vec2 encoded)
+{
+	vec3 direction = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	float fold = max(-direction.z, 0.0);
+	direction.x += direction.x >= 0.0 ? -fold : fold;
+	direction.y += direction.y >= 0.0 ? -fold : fold;
+	return normalize(direction);
+}
+
 void main()
 {
+	// Compact meshes store positions with a W of 0 and octahedral normals and tangents;
+	// full ones have no W, which reads as 1. Compact positions are restored by the model matrix.
+	vec3 normal = a_normal;
+	vec3 tangent = a_tangent;
+	if (a_position.w < 0.5)
+	{
+		normal = OctahedralDecode(a_normal.xy);
+		tangent = OctahedralDecode(a_tangent.xy);
+	}
+
 	v_worldpos = mul(u_model[0], vec4(a_position.xyz, 1.0));
 	gl_Position = mul(u_modelViewProj, vec4(a_position.xyz, 1.0));
 
 	v_texcoord = a_texcoord0;
 
-	vec3 binormal = cross(a_tangent, a_normal);
-	v_worldnorm = mat3(a_tangent, binormal, a_normal);
+	vec3 binormal = cross(tangent, normal);
+	v_worldnorm = mat3(tangent, binormal, normal);
 }
\ No newline at end of file
@@ -255,6 +255,8 @@ namespace Noble
 
 			other.m_ArrayCount = 0;
 			other.m_ArrayMax = 0;
+
+			return *this;
 		}
 
 	public:
@@ -484,6 +486,15 @@ namespace Noble
 			m_ArrayMax = 0;
 		}
 
+		/**
+		 * Sets the element count to zero but keeps the allocation,
+		 * so the array can be refilled without reallocating
+		 */
+		void Empty()
+		{
+			m_ArrayCount = 0;
+		}
+
 		/**
 		 * Returns a pointer to the array data
 		 */
@@ -669,9 +680,10 @@ namespace Noble
 		{
 			Size elementsToMove = m_ArrayCount - index;
 
+			// Move from the back so nothing is overwritten before it's moved
 			for (Size i = elementsToMove; i > 0; --i)
 			{
-				Size elementIndex = index + i;
+				Size elementIndex = index + i - 1;
 				MoveElement(elementIndex, elementIndex + amount);
 			}
 		}
@@ -6,6 +6,8 @@
 
 namespace Noble
 {
+	class VfsFile;
+
 	/**
 	 * Asset Types
 	 */
@@ -21,6 +23,42 @@ namespace Noble
 		AT_TEXTURE2D = 3
 	};
 
+	// Number of AssetTypes, for per-type tables
+	constexpr Size AssetTypeCount = 4;
+
+	/**
+	 * Memory an asset holds, in bytes
+	 */
+	struct AssetMemoryUsage
+	{
+		AssetMemoryUsage()
+			: CPUBytes(0), GPUBytes(0)
+		{}
+
+		AssetMemoryUsage(Size cpuBytes, Size gpuBytes)
+			: CPUBytes(cpuBytes), GPUBytes(gpuBytes)
+		{}
+
+		AssetMemoryUsage& operator+=(const AssetMemoryUsage& other)
+		{
+			CPUBytes += other.CPUBytes;
+			GPUBytes += other.GPUBytes;
+			return *this;
+		}
+
+		AssetMemoryUsage& operator-=(const AssetMemoryUsage& other)
+		{
+			CPUBytes -= other.CPUBytes;
+			GPUBytes -= other.GPUBytes;
+			return *this;
+		}
+
+		// System memory
+		Size CPUBytes;
+		// Memory of renderer resources
+		Size GPUBytes;
+	};
+
 	/**
 	 * Abstract base class for Asset subtypes
 	 * Provides facilities for identification and construction of subtypes
@@ -29,8 +67,14 @@ namespace Noble
 	{
 		// Allow the AssetManager to access protected data (create func, etc)
 		friend class AssetManager;
+		// Parses assets on its worker threads
+		friend class AssetLoader;
 	public:
 
+		Asset()
+			: m_RefCount(0), m_LastUsed(0), m_Pinned(false)
+		{}
+
 		/**
 		 * Returns the ID of this Asset
 		 */
@@ -41,22 +85,93 @@ namespace Noble
 		 */
 		virtual const AssetType GetType() const = 0;
 
+		/**
+		 * Returns the memory the asset holds once its resources are created
+		 */
+		virtual AssetMemoryUsage GetMemoryUsage() const { return AssetMemoryUsage(sizeof(Asset), 0); }
+
+		/**
+		 * Returns the number of AssetHandles keeping the asset loaded
+		 */
+		U32 GetRefCount() const { return m_RefCount; }
+
+		/**
+		 * Returns true if the asset can't be evicted, as for assets handed out by pointer
+		 */
+		bool IsPinned() const { return m_Pinned; }
+
 	protected:
 
 		/**
-		 * Overridden in each Asset type to build an instance from a buffer
+		 * Builds the asset from a buffer read from @source: parses it, then creates its resources
+		 * Returns false if the data can't be parsed
+		 */
+		bool CreateFromBuffer(BitStreamView& data, VfsFile& source)
+		{
+			if (!ParseBuffer(data))
+			{
+				return false;
+			}
+
+			RetainSource(source);
+			CreateResources();
+			return true;
+		}
+
+		/**
+		 * Overridden in each Asset type to read an instance from a buffer
+		 * May run on an asset loader thread, so it must not touch the renderer or other assets.
+		 * The buffer stays valid until CreateResources returns. Returns false on malformed data
 		 */
-		virtual void CreateFromBuffer(BitStream& data) = 0;
+		virtual bool ParseBuffer(BitStreamView& data) = 0;
+
+		/**
+		 * Overridden in Asset types that keep pointing into the buffer after ParseBuffer, to move
+		 * the file it came from out of @source so the data outlives the load
+		 * Called after a successful ParseBuffer, on the same thread
+		 */
+		virtual void RetainSource(VfsFile& source) {}
+
+		/**
+		 * Overridden in Asset types that own renderer resources to create them from the parsed data
+		 * Always runs on the main thread
+		 */
+		virtual void CreateResources() {}
 
 		/**
 		 * Overridden in each Asset type to free memory and release any resources
+		 * Must also handle an asset that was parsed but never had its resources created
 		 */
 		virtual void Destroy() = 0;
 
+		/**
+		 * Overridden in Asset types that other assets depend on, to refuse a reload that would break them
+		 * @reloaded is a parsed instance of the same type, without its resources
+		 */
+		virtual bool CanReplaceWith(const Asset& reloaded) const { return true; }
+
+		/**
+		 * Overridden in each Asset type to exchange everything loaded from its file with @other,
+		 * an instance of the same type; reloads use it so existing pointers see the new data
+		 */
+		virtual void SwapContents(Asset& other) = 0;
+
 	protected:
 
 		// Unique identifier for this Asset
 		NIdentifier m_AssetID;
 
+	private:
+
+		// Number of completed requests referencing the asset; residency state is only
+		// touched by the AssetManager, on the main thread
+		U32 m_RefCount;
+		// Residency frame of the last request or release, for LRU eviction
+		U64 m_LastUsed;
+		// Set for assets returned by pointer, which are never evicted
+		bool m_Pinned;
+		// Usage counted toward the manager's totals
+		AssetMemoryUsage m_TrackedMemory;
+
 	};
 }
\ No newline at end of file
@@ -0,0 +1,190 @@
+#include "AssetLoader.h"
+
+#include "Checksum.h"
+#include "Logger.h"
+
+namespace Noble
+{
+	/**
+	 * Queue order: higher priority first, then lower sequence (older) first
+	 */
+	struct AssetLoadRequestOrder
+	{
+		bool operator()(const AssetLoadRequest* a, const AssetLoadRequest* b) const
+		{
+			if (a->Priority != b->Priority)
+			{
+				return a->Priority < b->Priority;
+			}
+			return a->Sequence > b->Sequence;
+		}
+	};
+
+	AssetLoader::AssetLoader()
+		: m_NextSequence(0), m_Running(false)
+	{}
+
+	AssetLoader::~AssetLoader()
+	{
+		Shutdown();
+
+		// Finished requests carry assets only their owner can free, so it takes them all back first
+		CHECK(m_Finished.GetCount() == 0);
+	}
+
+	bool AssetLoader::Initialize(U32 workerCount)
+	{
+		if (m_Running)
+		{
+			return false;
+		}
+
+		m_Running = true;
+
+		workerCount = glm::max(1U, workerCount);
+		for (U32 i = 0; i < workerCount; ++i)
+		{
+			m_Threads.Add(new std::thread(&AssetLoader::WorkerLoop, this));
+		}
+
+		return true;
+	}
+
+	void AssetLoader::Shutdown()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (!m_Running)
+			{
+				return;
+			}
+			m_Running = false;
+
+			// Nothing new gets started
+			for (AssetLoadRequest* request : m_Queue)
+			{
+				request->Status = AssetLoadStatus::Failed;
+				m_Finished.Add(request);
+			}
+			m_Queue.Empty();
+		}
+
+		m_QueueCondition.notify_all();
+
+		for (std::thread* thread : m_Threads)
+		{
+			thread->join();
+			delete thread;
+		}
+		m_Threads.Empty();
+	}
+
+	void AssetLoader::Submit(AssetLoadRequest* request)
+	{
+		CHECK(request && request->LoadedAsset);
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			request->Sequence = m_NextSequence++;
+			request->Status = AssetLoadStatus::Queued;
+
+			if (!m_Running)
+			{
+				request->Status = AssetLoadStatus::Failed;
+				m_Finished.Add(request);
+				return;
+			}
+
+			m_Queue.Push(request);
+		}
+
+		m_QueueCondition.notify_one();
+	}
+
+	void AssetLoader::Reprioritize(AssetLoadRequest* request, AssetLoadPriority priority)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		// Past the queue the priority only orders finalization, which reads it on the main thread
+		if (priority > request->Priority)
+		{
+			request->Priority = priority;
+			if (request->Status == AssetLoadStatus::Queued)
+			{
+				m_Queue.Reorder();
+			}
+		}
+	}
+
+	void AssetLoader::TakeFinished(Array<AssetLoadRequest*>& finished)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		if (m_Finished.GetCount() > 0)
+		{
+			finished.AddMultiple(m_Finished.GetData(), m_Finished.GetCount());
+			m_Finished.Empty();
+		}
+	}
+
+	void AssetLoader::WorkerLoop()
+	{
+		while (true)
+		{
+			AssetLoadRequest* request = nullptr;
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_QueueCondition.wait(lock, [this]() { return !m_Running || m_Queue.GetCount() > 0; });
+
+				if (m_Queue.GetCount() == 0)
+				{
+					// Only reached once shutting down with an empty queue
+					return;
+				}
+
+				request = m_Queue.Pop();
+
+				request->Status = AssetLoadStatus::Loading;
+			}
+
+			const AssetLoadStatus status = Load(request) ? AssetLoadStatus::Finalizing : AssetLoadStatus::Failed;
+
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			request->Status = status;
+			m_Finished.Add(request);
+		}
+	}
+
+	bool AssetLoader::Load(AssetLoadRequest* request)
+	{
+		// Mapping here rather than on request keeps the open and the page faults off the main thread
+		if (!request->NativePath.empty() && !request->File.MapFile(request->NativePath))
+		{
+			NE_LOG_ERROR("Failed to load %s: file not found or inaccessible", request->Path.GetCharArray());
+			return false;
+		}
+
+		if (!request->File.IsValid())
+		{
+			return false;
+		}
+
+		// Other workers are busy with their own assets, so verify on this thread only
+		BitStreamView data = request->File.GetView();
+		if (!ChecksumFrame::Unwrap(data, 1))
+		{
+			NE_LOG_ERROR("Failed to load %s: asset data is corrupt", request->Path.GetCharArray());
+			return false;
+		}
+
+		if (!request->LoadedAsset->ParseBuffer(data))
+		{
+			NE_LOG_ERROR("Failed to load %s: asset data is malformed", request->Path.GetCharArray());
+			return false;
+		}
+		request->LoadedAsset->RetainSource(request->File);
+
+		return true;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,331 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "Array.h"
+#include "Asset.h"
+#include "FileSystem.h"
+#include "Functional.h"
+#include "PriorityQueue.h"
+#include "String.h"
+#include "Types.h"
+#include "VirtualFileSystem.h"
+
+namespace Noble
+{
+	/**
+	 * Queue order of asset loads; higher priorities are parsed and finalized first,
+	 * loads of the same priority run in request order
+	 */
+	enum class AssetLoadPriority : U8
+	{
+		Low,
+		Normal,
+		High,
+		Critical
+	};
+
+	/**
+	 * Lifecycle of an asynchronous asset load
+	 */
+	enum class AssetLoadStatus : U8
+	{
+		// Waiting for a loader thread
+		Queued,
+		// Being read and parsed on a loader thread
+		Loading,
+		// Parsed, waiting for the main thread to create its resources
+		Finalizing,
+		// Loaded and usable
+		Ready,
+		// The file couldn't be read or parsed, or the load was cancelled
+		Failed
+	};
+
+	/**
+	 * Completion callback of an asset load, always called from AssetManager::ProcessAsyncLoads
+	 * Receives the loaded asset, or nullptr if the load failed
+	 */
+	typedef UniqueDelegate<void(Asset*)> AssetLoadCallback;
+
+	/**
+	 * State of one asynchronous asset load, shared between the AssetManager, its loader threads
+	 * and every AssetHandle to it. Reference counted, so handles can outlive the load.
+	 */
+	struct AssetLoadRequest
+	{
+		AssetLoadRequest(const NIdentifier& id, AssetType type, AssetLoadPriority priority)
+			: AssetID(id), Type(type), Priority(priority), Sequence(0), Status(AssetLoadStatus::Queued),
+			LoadedAsset(nullptr), m_RefCount(1)
+		{}
+
+		NO_COPY_NO_MOVE(AssetLoadRequest)
+
+		void AddRef() { m_RefCount.fetch_add(1, std::memory_order_relaxed); }
+
+		/**
+		 * Returns the number of references, handles included
+		 */
+		U32 GetRefCount() const { return m_RefCount.load(std::memory_order_acquire); }
+
+		/**
+		 * Drops a reference, deleting the request with the last one
+		 */
+		void Release()
+		{
+			if (m_RefCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				for (AssetLoadCallback* callback : Callbacks)
+				{
+					delete callback;
+				}
+				for (AssetLoadRequest* dependency : Dependencies)
+				{
+					dependency->Release();
+				}
+				delete this;
+			}
+		}
+
+		// Asset being loaded
+		NIdentifier AssetID;
+		AssetType Type;
+		AssetLoadPriority Priority;
+		// Request order, breaks priority ties
+		U64 Sequence;
+		std::atomic<AssetLoadStatus> Status;
+		// Created on the main thread, parsed on a loader thread
+		Asset* LoadedAsset;
+
+		// File on disk for the loader thread to map, or empty when File was opened up front
+		fs::path NativePath;
+		// Keeps the asset data alive until the asset is finalized
+		VfsFile File;
+		// Registered path, for messages
+		NString Path;
+
+		// Completion callbacks; only touched on the main thread
+		Array<AssetLoadCallback*> Callbacks;
+		// Loads of the assets this one depends on, each holding a reference, until this one is finalized
+		Array<AssetLoadRequest*> Dependencies;
+
+	private:
+
+		std::atomic<U32> m_RefCount;
+	};
+
+	/**
+	 * Handle to an asset requested with AssetManager::RequestAsset
+	 * Cheap to copy; the asset is usable once IsReady returns true.
+	 */
+	template <typename T>
+	class AssetHandle
+	{
+	public:
+
+		AssetHandle()
+			: m_Request(nullptr)
+		{}
+
+		/**
+		 * Takes a new reference to the request
+		 */
+		explicit AssetHandle(AssetLoadRequest* request)
+			: m_Request(request)
+		{
+			if (m_Request)
+			{
+				m_Request->AddRef();
+			}
+		}
+
+		AssetHandle(const AssetHandle& other)
+			: AssetHandle(other.m_Request)
+		{}
+
+		AssetHandle(AssetHandle&& other) noexcept
+			: m_Request(other.m_Request)
+		{
+			other.m_Request = nullptr;
+		}
+
+		AssetHandle& operator=(const AssetHandle& other)
+		{
+			if (other.m_Request)
+			{
+				other.m_Request->AddRef();
+			}
+			Reset();
+			m_Request = other.m_Request;
+			return *this;
+		}
+
+		AssetHandle& operator=(AssetHandle&& other) noexcept
+		{
+			if (&other != this)
+			{
+				Reset();
+				m_Request = other.m_Request;
+				other.m_Request = nullptr;
+			}
+			return *this;
+		}
+
+		~AssetHandle()
+		{
+			Reset();
+		}
+
+		/**
+		 * Returns true if the handle refers to a request
+		 */
+		bool IsValid() const { return m_Request != nullptr; }
+
+		/**
+		 * Returns true once the asset is loaded and usable
+		 */
+		bool IsReady() const { return m_Request && m_Request->Status == AssetLoadStatus::Ready; }
+
+		/**
+		 * Returns true if the asset couldn't be loaded
+		 */
+		bool HasFailed() const { return m_Request && m_Request->Status == AssetLoadStatus::Failed; }
+
+		/**
+		 * Returns the current status of the load
+		 */
+		AssetLoadStatus GetStatus() const { return m_Request ? m_Request->Status.load() : AssetLoadStatus::Failed; }
+
+		/**
+		 * Returns the asset once it's ready, or nullptr
+		 * The asset is owned by the AssetManager, like those returned by its Get functions
+		 */
+		T* Get() const
+		{
+			if (!IsReady())
+			{
+				return nullptr;
+			}
+
+			CHECK(m_Request->LoadedAsset->GetType() == T::StaticType);
+			return static_cast<T*>(m_Request->LoadedAsset);
+		}
+
+		T* operator->() const { return Get(); }
+
+		/**
+		 * Returns the ID of the requested asset
+		 */
+		const NIdentifier& GetAssetID() const
+		{
+			CHECK(m_Request);
+			return m_Request->AssetID;
+		}
+
+		/**
+		 * Drops the handle's reference; the load itself carries on
+		 */
+		void Reset()
+		{
+			if (m_Request)
+			{
+				m_Request->Release();
+				m_Request = nullptr;
+			}
+		}
+
+	private:
+
+		AssetLoadRequest* m_Request;
+	};
+
+	// Defined in AssetLoader.cpp
+	struct AssetLoadRequestOrder;
+
+	/**
+	 * Reads and parses assets on a pool of worker threads
+	 *
+	 * A request's asset is created and its file resolved on the main thread; a worker then maps
+	 * the file, verifies its checksummed frame and runs Asset::ParseBuffer, and hands the request
+	 * back through TakeFinished so the main thread can create the asset's renderer resources.
+	 * Requests are taken highest priority first, then in submission order.
+	 */
+	class AssetLoader
+	{
+	public:
+
+		AssetLoader();
+
+		/**
+		 * Stops the workers. Every finished request must have been taken back with TakeFinished
+		 */
+		~AssetLoader();
+
+		NO_COPY_NO_MOVE(AssetLoader)
+
+		/**
+		 * Starts @workerCount loader threads
+		 */
+		bool Initialize(U32 workerCount);
+
+		/**
+		 * Fails every queued request, waits for the ones being parsed and stops the workers
+		 * Every request is still handed back through TakeFinished
+		 */
+		void Shutdown();
+
+		/**
+		 * Queues a request; the caller keeps its reference until the request is handed back
+		 */
+		void Submit(AssetLoadRequest* request);
+
+		/**
+		 * Moves a queued request up the queue if @priority is higher than its own
+		 */
+		void Reprioritize(AssetLoadRequest* request, AssetLoadPriority priority);
+
+		/**
+		 * Appends every request finished since the last call to @finished
+		 */
+		void TakeFinished(Array<AssetLoadRequest*>& finished);
+
+		/**
+		 * Returns true between Initialize and Shutdown
+		 */
+		bool IsRunning() const { return m_Running; }
+
+	private:
+
+		/**
+		 * Worker thread loop
+		 */
+		void WorkerLoop();
+
+		/**
+		 * Reads and parses the request's asset; returns false if it can't be loaded
+		 */
+		bool Load(AssetLoadRequest* request);
+
+	private:
+
+		// Guards the queue and the finished list
+		std::mutex m_Mutex;
+		// Signalled when requests are queued or the loader stops
+		std::condition_variable m_QueueCondition;
+
+		// Queued requests
+		PriorityQueue<AssetLoadRequest*, AssetLoadRequestOrder> m_Queue;
+		// Requests waiting for TakeFinished
+		Array<AssetLoadRequest*> m_Finished;
+
+		// Source of request sequence numbers
+		U64 m_NextSequence;
+
+		Array<std::thread*> m_Threads;
+		// Set while the workers should keep running
+		std::atomic<bool> m_Running;
+	};
+}
\ No newline at end of file
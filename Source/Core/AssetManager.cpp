@@ -1,289 +1,964 @@
 #include "AssetManager.h"
 
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#include "Checksum.h"
 #include "FileSystem.h"
 #include "Logger.h"
+#include "PackFile.h"
+#include "Time.h"
 
 // 8MB blocks
 #define ASSET_BLOCK_SIZE (1 << 23)
 
+// Root of the game's content, relative to the working directory
+#define CONTENT_DIRECTORY "Content"
+
+// Compiled asset registry, loaded at startup if present (see AssetRegistryFile)
+#define ASSET_REGISTRY_FILE CONTENT_DIRECTORY "/AssetRegistry.nreg"
+
+// Upper bound on asset loader threads; parsing is mostly memory bound, so more rarely helps
+#define MAX_ASSET_LOADER_THREADS 4
+
 namespace Noble
 {
 	AssetManager::AssetManager()
-		: m_AssetAlloc(/*ASSET_BLOCK_SIZE*/)
+		: m_AssetAlloc(/*ASSET_BLOCK_SIZE*/), m_ContentPathsDirty(true), m_ResidencyFrame(0), m_EvictionBlocked(false)
 	{}
 
+	AssetManager::~AssetManager()
+	{
+		// The loader can't free the assets it parsed, they come from m_AssetAlloc
+		CancelAsyncLoads();
+	}
+
 	void AssetManager::LoadAssetRegistry()
 	{
-		// to do
+		// Scan the content tree once up front; discovery and path checks then query the index instead of the disk
+		if (m_ContentIndex.Build(CONTENT_DIRECTORY))
+		{
+			NE_LOG_INFO("Indexed %llu content files", (unsigned long long)m_ContentIndex.GetCount());
+
+			// Keep the index current so changed assets can be reloaded without a rescan
+			if (FileWatcher::IsSupported() && !m_ContentWatcher.Start(m_ContentIndex))
+			{
+				NE_LOG_WARNING("Failed to watch %s, content changes won't be picked up", CONTENT_DIRECTORY);
+			}
+
+			// Loose content is served straight from the index; packs mounted later can override it
+			m_FileSystem.Mount(CONTENT_DIRECTORY, new DirectoryMount(m_ContentIndex));
+
+			// Packs shipped in the content directory sit below the loose files, so any loose copy of a packed file wins
+			for (const DirectoryEntry& entry : m_ContentIndex.FindByExtension(PackFile::Extension))
+			{
+				m_FileSystem.MountPack(CONTENT_DIRECTORY, m_ContentIndex.GetFullPath(entry), -1);
+			}
+		}
+
+		// Leave a core for the main thread
+		const U32 cores = std::thread::hardware_concurrency();
+		m_Loader.Initialize(glm::clamp(cores > 1 ? cores - 1 : 1U, 1U, U32(MAX_ASSET_LOADER_THREADS)));
+
+		// Registrations from the file are used in place from its mapping, so this stays cheap with
+		// any number of assets; RegisterAsset can still add to or override them afterwards
+		std::error_code error;
+		if (fs::is_regular_file(ASSET_REGISTRY_FILE, error))
+		{
+			const Timestamp start = Time::GetNowTimestamp();
+			if (m_Registry.Load(ASSET_REGISTRY_FILE))
+			{
+				m_ContentPathsDirty = true;
+				Timestamp elapsed = Time::GetNowTimestamp();
+				elapsed -= start;
+				NE_LOG_INFO("Asset registry ready in %.2f ms", Time::GetDuration(elapsed) * 1000.0F);
+			}
+		}
 	}
 
 	void AssetManager::RegisterAsset(const NIdentifier& id, const NString& path, AssetType type)
 	{
-		AssetRegistration reg;
-		reg.AssetID = id;
-		reg.Path = path;
-		reg.Type = type;
-		reg.LoadedAsset = nullptr;
+		// Catch typos at registration rather than at first load
+		if (m_FileSystem.HasMounts() && path.StartsWith(CONTENT_DIRECTORY "/") && !m_FileSystem.Exists(path.GetCharArray()))
+		{
+			NE_LOG_WARNING("Asset %s registered to %s, which is not in the content directory", id.GetString(), path.GetCharArray());
+		}
 
-		m_Registry.Add(std::move(reg));
+		m_Registry.Register(id, path.GetCharArray(), type);
+		m_ContentPathsDirty = true;
 	}
 
 	void AssetManager::UnregisterAsset(const NIdentifier& id)
 	{
-		for (auto iter = m_Registry.Start(); iter != m_Registry.End(); ++iter)
+		if (!m_Registry.Unregister(id))
 		{
-			if (iter->AssetID == id)
-			{
-				iter.RemoveCurrent();
-				return;
-			}
+			NE_LOG_WARNING("No asset registered with ID %s", id.GetString());
+			return;
 		}
+		m_ContentPathsDirty = true;
+	}
 
-		NE_LOG_WARNING("No asset registered with ID %s", id.GetString());
+	void AssetManager::SetAssetDependencies(const NIdentifier& id, const Array<NIdentifier>& dependencies)
+	{
+		AssetRegistration* reg = m_Registry.Find(id);
+		if (!reg)
+		{
+			NE_LOG_WARNING("No asset registered with ID %s", id.GetString());
+			return;
+		}
+
+		// Stored as full identifier hashes, like registry files store them
+		Array<IdentifierHash> hashes;
+		for (const NIdentifier& dependency : dependencies)
+		{
+			hashes.Add(dependency.GetIdentifierHash());
+		}
+
+		m_Registry.SetDependencies(*reg, hashes.GetData(), static_cast<U32>(hashes.GetCount()));
+	}
+
+	Asset* AssetManager::GetAsset(const NIdentifier& id, AssetType type)
+	{
+		Asset* result = nullptr;
+
+		if (AssetRegistration* reg = m_Registry.Find(id))
+		{
+			result = LoadFromRegistry(*reg);
+		}
+		else if (m_LoadedAssets.ContainsKey(id))
+		{
+			// Created at runtime rather than registered
+			result = m_LoadedAssets[id];
+		}
+		else
+		{
+			NE_LOG_WARNING("No asset registered with ID %s", id.GetString());
+		}
+
+		if (result)
+		{
+			CHECK(result->GetType() == type);
+		}
+
+		return result;
 	}
 
 	StaticMesh* AssetManager::GetStaticMesh(const NIdentifier& id)
 	{
-		if (m_LoadedAssets.ContainsKey(id))
+		return static_cast<StaticMesh*>(GetAsset(id, AssetType::AT_STATIC_MESH));
+	}
+
+	StaticMesh* AssetManager::GetStaticMesh(const U32 id)
+	{
+		AssetRegistration* reg = m_Registry.FindByHash(id);
+		return reg ? GetStaticMesh(reg->AssetID) : nullptr;
+	}
+
+	Shader* AssetManager::GetShader(const NIdentifier& id)
+	{
+		return static_cast<Shader*>(GetAsset(id, AssetType::AT_SHADER));
+	}
+
+	Shader* AssetManager::GetShader(const U32 id)
+	{
+		AssetRegistration* reg = m_Registry.FindByHash(id);
+		return reg ? GetShader(reg->AssetID) : nullptr;
+	}
+
+	Material* AssetManager::GetMaterial(const NIdentifier& id)
+	{
+		return static_cast<Material*>(GetAsset(id, AssetType::AT_MATERIAL));
+	}
+
+	Material* AssetManager::GetMaterial(const U32 id)
+	{
+		AssetRegistration* reg = m_Registry.FindByHash(id);
+		return reg ? GetMaterial(reg->AssetID) : nullptr;
+	}
+
+	Texture2D* AssetManager::GetTexture2D(const NIdentifier& id)
+	{
+		return static_cast<Texture2D*>(GetAsset(id, AssetType::AT_TEXTURE2D));
+	}
+
+	Texture2D* AssetManager::GetTexture2D(const U32 id)
+	{
+		AssetRegistration* reg = m_Registry.FindByHash(id);
+		return reg ? GetTexture2D(reg->AssetID) : nullptr;
+	}
+
+	Material* AssetManager::CreateMaterial(Material* copy)
+	{
+		Material* newMat;
+		if (copy)
 		{
-			Asset* sm = m_LoadedAssets[id];
-			CHECK(sm->GetType() == AssetType::AT_STATIC_MESH);
-			return static_cast<StaticMesh*>(sm);
+			newMat = NE_NEW(m_AssetAlloc, Material)(*copy);
 		}
 		else
 		{
-			Asset* newLoad = LoadAsset(id);
-			if (newLoad)
-			{
-				CHECK(newLoad->GetType() == AssetType::AT_STATIC_MESH);
-				return static_cast<StaticMesh*>(newLoad);
-			}
+			newMat = NE_NEW(m_AssetAlloc, Material);
 		}
 
+		NString uid = "Material";
+		uid += newMat;
+		const char* out = MakeStringPermanent(uid);
+
+		NIdentifier id(out, uid.GetLength());
+		m_LoadedAssets.Insert(id, newMat);
+
+		return newMat;
+	}
+
+	Asset* AssetManager::LoadAsset(const NIdentifier& id)
+	{
+		if (AssetRegistration* reg = m_Registry.Find(id))
+		{
+			return LoadFromRegistry(*reg);
+		}
+
+		NE_LOG_WARNING("No asset registered with ID %s", id.GetString());
 		return nullptr;
 	}
 
-	StaticMesh* AssetManager::GetStaticMesh(const U32 id)
+	Asset* AssetManager::CreateAsset(AssetType type)
 	{
-		for (auto reg : m_Registry)
+		switch (type)
+		{
+			case AssetType::AT_STATIC_MESH:
+				return NE_NEW(m_AssetAlloc, StaticMesh);
+			case AssetType::AT_SHADER:
+				return NE_NEW(m_AssetAlloc, Shader);
+			case AssetType::AT_MATERIAL:
+				return NE_NEW(m_AssetAlloc, Material);
+			case AssetType::AT_TEXTURE2D:
+				return NE_NEW(m_AssetAlloc, Texture2D);
+			default:
+				NE_LOG_WARNING("Unknown asset type of ID %u", (U8)type);
+				return nullptr;
+		}
+	}
+
+	Asset* AssetManager::LoadFromRegistry(AssetRegistration& reg, bool pin)
+	{
+		// Whoever gets the pointer may keep it indefinitely, so it can't be evicted from under them
+		if (reg.LoadedAsset)
+		{
+			reg.LoadedAsset->m_Pinned |= pin;
+			reg.LoadedAsset->m_LastUsed = m_ResidencyFrame;
+			return reg.LoadedAsset;
+		}
+
+		VfsFile assetFile;
+		BitStreamView data;
+		if (!OpenAssetData(reg, assetFile, data))
+		{
+			return nullptr;
+		}
+
+		// Create the asset instance
+		Asset* result = CreateAsset(reg.Type);
+
+		if (result)
 		{
-			if (reg.AssetID.GetHash() == id)
+			// Load the asset from the buffer
+			if (!result->CreateFromBuffer(data, assetFile))
 			{
-				return GetStaticMesh(reg.AssetID);
+				NE_LOG_ERROR("Failed to load %s: asset data is malformed", reg.Path);
+				result->Destroy();
+				NE_DELETE(m_AssetAlloc, result);
+				return nullptr;
 			}
+			// Set its ID
+			result->m_AssetID = reg.AssetID;
+			result->m_Pinned = pin;
+			result->m_LastUsed = m_ResidencyFrame;
+			TrackMemory(result);
+			// Update the registration
+			reg.LoadedAsset = result;
+			// Store the loaded asset in the map
+			m_LoadedAssets.Insert(reg.AssetID, result);
+
+			return result;
 		}
 
 		return nullptr;
 	}
 
-	Shader* AssetManager::GetShader(const NIdentifier& id)
+	bool AssetManager::OpenAssetData(const AssetRegistration& reg, VfsFile& file, BitStreamView& data)
 	{
-		if (m_LoadedAssets.ContainsKey(id))
+		// Paths outside every mount are still accepted as plain OS paths
+		// Loose files are mapped and read in place, so the data isn't copied into an intermediate buffer
+		if (!m_FileSystem.Open(reg.Path, file) && !file.MapFile(reg.Path))
 		{
-			Asset* sh = m_LoadedAssets[id];
-			CHECK(sh->GetType() == AssetType::AT_SHADER);
-			return static_cast<Shader*>(sh);
+			NE_LOG_ERROR("Failed to load %s: file not found or inaccessible", reg.Path);
+			return false;
 		}
-		else
+
+		data = file.GetView();
+
+		// Cooked assets may be wrapped in a checksummed frame, which is verified before use. This
+		// blocks the caller, so only payloads large enough to be worth the threads are split
+		if (!ChecksumFrame::Unwrap(data, std::thread::hardware_concurrency()))
 		{
-			Asset* newLoad = LoadAsset(id);
-			if (newLoad)
+			NE_LOG_ERROR("Failed to load %s: asset data is corrupt", reg.Path);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool AssetManager::ReloadAsset(const NIdentifier& id)
+	{
+		AssetRegistration* reg = m_Registry.Find(id);
+		if (!reg || !reg->LoadedAsset)
+		{
+			return false;
+		}
+
+		VfsFile assetFile;
+		BitStreamView data;
+		if (!OpenAssetData(*reg, assetFile, data))
+		{
+			// Keep the old version rather than leave callers with a broken asset
+			return false;
+		}
+
+		// The edit is loaded once into a new instance, whose contents are then swapped into the loaded
+		// one so existing pointers see the new data; the old version is kept if the edit can't be used
+		Asset* reloaded = CreateAsset(reg->Type);
+		if (!reloaded)
+		{
+			return false;
+		}
+		reloaded->m_AssetID = reg->AssetID;
+
+		Asset* asset = reg->LoadedAsset;
+		const char* error = nullptr;
+		if (!reloaded->ParseBuffer(data))
+		{
+			error = "asset data is malformed";
+		}
+		else if (!asset->CanReplaceWith(*reloaded))
+		{
+			error = "the new version is incompatible with assets using the loaded one";
+		}
+
+		if (error)
+		{
+			NE_LOG_ERROR("Failed to reload %s: %s, keeping the loaded version", reg->Path, error);
+			reloaded->Destroy();
+			NE_DELETE(m_AssetAlloc, reloaded);
+			return false;
+		}
+
+		reloaded->RetainSource(assetFile);
+		reloaded->CreateResources();
+
+		UntrackMemory(asset);
+		asset->SwapContents(*reloaded);
+		TrackMemory(asset);
+
+		// Holds the old version now
+		reloaded->Destroy();
+		NE_DELETE(m_AssetAlloc, reloaded);
+
+		NE_LOG_INFO("Reloaded %s from %s", id.GetString(), reg->Path);
+		return true;
+	}
+
+	U32 AssetManager::ProcessContentChanges()
+	{
+		m_ContentChanges.Empty();
+		if (m_ContentWatcher.Poll(m_ContentChanges) == 0)
+		{
+			return 0;
+		}
+
+		if (m_ContentPathsDirty)
+		{
+			BuildContentPaths();
+		}
+
+		U32 reloaded = 0;
+		const Size prefixLength = sizeof(CONTENT_DIRECTORY);
+		Array<char> virtualPath;
+		for (const DirectoryChange& change : m_ContentChanges)
+		{
+			const char* path = m_ContentChanges.GetPath(change);
+			const Size pathLength = std::strlen(path);
+
+			// New or deleted files change what their path resolves to; only that path is looked up again
+			if (change.Type != DirectoryChangeType::Modified)
 			{
-				CHECK(newLoad->GetType() == AssetType::AT_SHADER);
-				return static_cast<Shader*>(newLoad);
+				virtualPath.Empty();
+				virtualPath.AddMultiple(CONTENT_DIRECTORY "/", prefixLength);
+				virtualPath.AddMultiple(path, pathLength + 1);
+				m_FileSystem.UpdatePath(virtualPath.GetData());
+			}
+
+			// Only assets whose files changed are touched; unloaded ones pick up the new file when first loaded
+			const U64 hash = HashString64(path, pathLength);
+			const ContentPath* contentPaths = m_ContentPaths.GetData();
+			const ContentPath* end = contentPaths + m_ContentPaths.GetCount();
+			const ContentPath* entry = std::lower_bound(contentPaths, end, hash,
+				[](const ContentPath& contentPath, U64 value) { return contentPath.Hash < value; });
+			for (; entry != end && entry->Hash == hash; ++entry)
+			{
+				const AssetRegistration* reg = m_Registry.Find(entry->AssetID);
+				if (!reg || std::strcmp(reg->Path + prefixLength, path) != 0)
+				{
+					continue;
+				}
+
+				if (change.Type == DirectoryChangeType::Removed)
+				{
+					NE_LOG_WARNING("File of asset %s was removed, keeping the loaded version", reg->AssetID.GetString());
+				}
+				else if (ReloadAsset(entry->AssetID))
+				{
+					++reloaded;
+				}
 			}
 		}
 
-		return nullptr;
+		return reloaded;
 	}
 
-	Shader* AssetManager::GetShader(const U32 id)
+	void AssetManager::BuildContentPaths()
 	{
-		for (auto reg : m_Registry)
+		m_ContentPaths.Empty();
+
+		const Size prefixLength = sizeof(CONTENT_DIRECTORY);
+		for (const AssetRegistration& reg : m_Registry)
 		{
-			if (reg.AssetID.GetHash() == id)
+			if (std::strncmp(reg.Path, CONTENT_DIRECTORY "/", prefixLength) == 0)
 			{
-				return GetShader(reg.AssetID);
+				ContentPath contentPath;
+				contentPath.Hash = HashString64(reg.Path + prefixLength, std::strlen(reg.Path + prefixLength));
+				contentPath.AssetID = reg.AssetID;
+				m_ContentPaths.Add(contentPath);
 			}
 		}
 
-		return nullptr;
+		std::sort(m_ContentPaths.GetData(), m_ContentPaths.GetData() + m_ContentPaths.GetCount(),
+			[](const ContentPath& lhs, const ContentPath& rhs) { return lhs.Hash < rhs.Hash; });
+		m_ContentPathsDirty = false;
 	}
 
-	Material* AssetManager::GetMaterial(const NIdentifier& id)
+	AssetLoadRequest* AssetManager::RequestAssetLoad(const NIdentifier& id, AssetType type,
+		AssetLoadPriority priority, AssetLoadCallback&& callback)
 	{
-		if (m_LoadedAssets.ContainsKey(id))
+		// A load already in progress is shared rather than started twice
+		for (AssetLoadRequest* pending : m_PendingLoads)
 		{
-			Asset* sh = m_LoadedAssets[id];
-			CHECK(sh->GetType() == AssetType::AT_MATERIAL);
-			return static_cast<Material*>(sh);
+			if (pending->AssetID == id)
+			{
+				CHECK(pending->Type == type);
+				ReprioritizeLoad(pending, priority);
+				if (callback)
+				{
+					pending->Callbacks.Add(new AssetLoadCallback(std::move(callback)));
+				}
+				return pending;
+			}
 		}
-		else
+
+		AssetLoadRequest* request = new AssetLoadRequest(id, type, priority);
+		if (callback)
+		{
+			request->Callbacks.Add(new AssetLoadCallback(std::move(callback)));
+		}
+
+		// Loaded and unknown assets complete on the next ProcessAsyncLoads, like every other request,
+		// so callers never see their callback run before RequestAsset returns
+		AssetRegistration* reg = m_Registry.Find(id);
+		if (!reg || reg->LoadedAsset)
 		{
-			Asset* newLoad = LoadAsset(id);
-			if (newLoad)
+			if (reg)
+			{
+				CHECK(reg->Type == type);
+				request->LoadedAsset = reg->LoadedAsset;
+				request->Status = AssetLoadStatus::Ready;
+				// Referenced from now on, so it can't be evicted before the request completes
+				AddAssetRef(reg->LoadedAsset);
+			}
+			else
 			{
-				CHECK(newLoad->GetType() == AssetType::AT_MATERIAL);
-				return static_cast<Material*>(newLoad);
+				NE_LOG_WARNING("No asset registered with ID %s", id.GetString());
+				request->Status = AssetLoadStatus::Failed;
 			}
+
+			m_FinishedLoads.Add(request);
+			return request;
 		}
 
-		return nullptr;
+		CHECK(reg->Type == type);
+		request->Path = reg->Path;
+		request->LoadedAsset = CreateAsset(type);
+		if (!request->LoadedAsset)
+		{
+			request->Status = AssetLoadStatus::Failed;
+			m_FinishedLoads.Add(request);
+			return request;
+		}
+
+		// Paths are resolved here, since mounts only change on this thread. Loose files are mapped by
+		// the loader thread; anything else (pack entries, memory files) is opened now. Paths outside
+		// every mount are still accepted as plain OS paths
+		const char* path = reg->Path;
+		request->NativePath = m_FileSystem.GetNativePath(path);
+		if (request->NativePath.empty() && !m_FileSystem.Open(path, request->File))
+		{
+			request->NativePath = path;
+		}
+
+		// Dependencies are queued first, so at the same priority the leaves of the graph are parsed first
+		if (reg->DependencyCount > 0)
+		{
+			RequestDependencies(request, *reg);
+		}
+
+		m_PendingLoads.Add(request);
+		m_Loader.Submit(request);
+
+		return request;
 	}
 
-	Material* AssetManager::GetMaterial(const U32 id)
+	void AssetManager::RequestDependencies(AssetLoadRequest* request, const AssetRegistration& reg)
 	{
-		for (auto reg : m_Registry)
+		m_ExpandingLoads.Add(reg.AssetID.GetIdentifierHash());
+
+		const IdentifierHash* hashes = m_Registry.GetDependencies(reg);
+		for (U32 i = 0; i < reg.DependencyCount; ++i)
 		{
-			if (reg.AssetID.GetHash() == id)
+			AssetRegistration* dependency = m_Registry.FindByIdentifierHash(hashes[i]);
+			if (!dependency)
+			{
+				NE_LOG_WARNING("Asset %s depends on unregistered asset %llx", reg.AssetID.GetString(), (unsigned long long)hashes[i]);
+				continue;
+			}
+
+			// Waiting on an asset that's waiting on this one would never finish
+			bool cycle = false;
+			for (IdentifierHash expanding : m_ExpandingLoads)
+			{
+				cycle |= (expanding == hashes[i]);
+			}
+			if (cycle)
 			{
-				return GetMaterial(reg.AssetID);
+				NE_LOG_WARNING("Ignoring dependency of asset %s on %s, which depends on it",
+					reg.AssetID.GetString(), dependency->AssetID.GetString());
+				continue;
 			}
+
+			AssetLoadRequest* child = RequestAssetLoad(dependency->AssetID, dependency->Type, request->Priority);
+			child->AddRef();
+			request->Dependencies.Add(child);
 		}
 
-		return nullptr;
+		m_ExpandingLoads.RemoveAt(m_ExpandingLoads.GetCount() - 1);
 	}
 
-	Texture2D* AssetManager::GetTexture2D(const NIdentifier& id)
+	void AssetManager::ReprioritizeLoad(AssetLoadRequest* request, AssetLoadPriority priority)
 	{
-		if (m_LoadedAssets.ContainsKey(id))
+		m_Loader.Reprioritize(request, priority);
+
+		// An urgent asset makes its dependencies just as urgent
+		for (AssetLoadRequest* dependency : request->Dependencies)
 		{
-			Asset* sh = m_LoadedAssets[id];
-			CHECK(sh->GetType() == AssetType::AT_TEXTURE2D);
-			return static_cast<Texture2D*>(sh);
+			ReprioritizeLoad(dependency, priority);
 		}
-		else
+	}
+
+	bool AssetManager::AreDependenciesDone(const AssetLoadRequest* request)
+	{
+		for (const AssetLoadRequest* dependency : request->Dependencies)
 		{
-			Asset* newLoad = LoadAsset(id);
-			if (newLoad)
+			const AssetLoadStatus status = dependency->Status;
+			if (status != AssetLoadStatus::Ready && status != AssetLoadStatus::Failed)
 			{
-				CHECK(newLoad->GetType() == AssetType::AT_TEXTURE2D);
-				return static_cast<Texture2D*>(newLoad);
+				return false;
 			}
 		}
 
-		return nullptr;
+		return true;
 	}
 
-	Texture2D* AssetManager::GetTexture2D(const U32 id)
+	U32 AssetManager::ProcessAsyncLoads(F32 timeBudget)
 	{
-		for (auto reg : m_Registry)
+		m_Loader.TakeFinished(m_FinishedLoads);
+		if (m_FinishedLoads.GetCount() == 0)
+		{
+			return 0;
+		}
+
+		// Highest priority first, then in request order
+		std::stable_sort(m_FinishedLoads.GetData(), m_FinishedLoads.GetData() + m_FinishedLoads.GetCount(),
+			[](const AssetLoadRequest* a, const AssetLoadRequest* b) { return a->Priority > b->Priority; });
+
+		// Creating resources is the expensive part, so bound it to keep frame times steady.
+		// Requests added by callbacks land at the end and are picked up in the same pass
+		const Timestamp start = Time::GetNowTimestamp();
+		Size processed = 0;
+		U32 completed = 0;
+		while (processed < m_FinishedLoads.GetCount())
 		{
-			if (reg.AssetID.GetHash() == id)
+			if (processed > 0)
+			{
+				Timestamp elapsed = Time::GetNowTimestamp();
+				elapsed -= start;
+				if (Time::GetDuration(elapsed) >= timeBudget)
+				{
+					break;
+				}
+			}
+
+			AssetLoadRequest* request = m_FinishedLoads[processed++];
+			if (request->Status == AssetLoadStatus::Finalizing && !AreDependenciesDone(request))
 			{
-				return GetTexture2D(reg.AssetID);
+				// Finalized once its last dependency completes
+				m_WaitingLoads.Add(request);
+				continue;
+			}
+
+			FinishAsyncLoad(request);
+			++completed;
+
+			// Parents this completed the dependencies of join the same pass
+			Size waiting = 0;
+			while (waiting < m_WaitingLoads.GetCount())
+			{
+				if (AreDependenciesDone(m_WaitingLoads[waiting]))
+				{
+					m_FinishedLoads.Add(m_WaitingLoads[waiting]);
+					m_WaitingLoads.RemoveAt(waiting);
+				}
+				else
+				{
+					++waiting;
+				}
 			}
 		}
 
-		return nullptr;
+		// Keep the rest, still in order, for the next frame
+		const Size remaining = m_FinishedLoads.GetCount() - processed;
+		for (Size i = 0; i < remaining; ++i)
+		{
+			m_FinishedLoads[i] = m_FinishedLoads[processed + i];
+		}
+		while (m_FinishedLoads.GetCount() > remaining)
+		{
+			m_FinishedLoads.RemoveAt(m_FinishedLoads.GetCount() - 1);
+		}
+
+		return completed;
 	}
 
-	Material* AssetManager::CreateMaterial(Material* copy)
+	void AssetManager::FinishAsyncLoad(AssetLoadRequest* request)
 	{
-		Material* newMat;
-		if (copy)
+		for (Size i = 0; i < m_PendingLoads.GetCount(); ++i)
 		{
-			newMat = NE_NEW(m_AssetAlloc, Material)(*copy);
+			if (m_PendingLoads[i] == request)
+			{
+				m_PendingLoads.RemoveAt(i);
+				break;
+			}
 		}
-		else
+
+		AssetRegistration* reg = m_Registry.Find(request->AssetID);
+
+		if (request->Status == AssetLoadStatus::Finalizing)
 		{
-			newMat = NE_NEW(m_AssetAlloc, Material);
+			Asset* asset = request->LoadedAsset;
+
+			if (reg && reg->LoadedAsset)
+			{
+				// Loaded synchronously while this one was in flight; keep the instance callers already have
+				asset->Destroy();
+				NE_DELETE(m_AssetAlloc, asset);
+				request->LoadedAsset = reg->LoadedAsset;
+			}
+			else
+			{
+				asset->CreateResources();
+				asset->m_AssetID = request->AssetID;
+				TrackMemory(asset);
+				if (reg)
+				{
+					reg->LoadedAsset = asset;
+				}
+				m_LoadedAssets.Insert(request->AssetID, asset);
+			}
+
+			request->Status = AssetLoadStatus::Ready;
+			AddAssetRef(request->LoadedAsset);
+		}
+		else if (request->Status == AssetLoadStatus::Failed && request->LoadedAsset)
+		{
+			// The instance was never handed out
+			request->LoadedAsset->Destroy();
+			NE_DELETE(m_AssetAlloc, request->LoadedAsset);
+			request->LoadedAsset = nullptr;
 		}
 
-		NString uid = "Material";
-		uid += newMat;
-		const char* out = MakeStringPermanent(uid);
+		// The asset no longer needs its file
+		request->File.Close();
 
-		NIdentifier id(out, uid.GetLength(), HASH(out));
-		m_LoadedAssets.Insert(id, newMat);
+		// Dependencies were only held until this asset could use them
+		for (AssetLoadRequest* dependency : request->Dependencies)
+		{
+			dependency->Release();
+		}
+		request->Dependencies.Empty();
 
-		return newMat;
+		Asset* result = request->Status == AssetLoadStatus::Ready ? request->LoadedAsset : nullptr;
+		for (Size i = 0; i < request->Callbacks.GetCount(); ++i)
+		{
+			// Callbacks may request more assets; those land at the end of m_FinishedLoads or in the loader
+			(*request->Callbacks[i])(result);
+		}
+
+		if (request->Status == AssetLoadStatus::Ready)
+		{
+			// The request keeps the asset loaded until its last handle is gone (see UpdateResidency)
+			m_LiveRequests.Add(request);
+		}
+		else
+		{
+			request->Release();
+		}
 	}
 
-	Asset* AssetManager::LoadAsset(const NIdentifier& id)
+	void AssetManager::CancelAsyncLoads()
 	{
-		for (auto reg : m_Registry)
+		m_Loader.Shutdown();
+
+		// Requests waiting on dependencies are dropped like the rest
+		for (AssetLoadRequest* request : m_WaitingLoads)
+		{
+			m_FinishedLoads.Add(request);
+		}
+		m_WaitingLoads.Empty();
+
+		// Parsed assets are dropped rather than finalized; callbacks still run, with nullptr.
+		// Requests made from those callbacks fail straight away now the loader is stopped
+		m_Loader.TakeFinished(m_FinishedLoads);
+		while (m_FinishedLoads.GetCount() > 0)
 		{
-			if (reg.AssetID == id)
+			for (Size i = 0; i < m_FinishedLoads.GetCount(); ++i)
 			{
-				return LoadFromRegistry(reg);
+				AssetLoadRequest* request = m_FinishedLoads[i];
+				if (request->Status == AssetLoadStatus::Finalizing)
+				{
+					request->Status = AssetLoadStatus::Failed;
+				}
+				FinishAsyncLoad(request);
 			}
-		}
+			m_FinishedLoads.Empty();
 
-		NE_LOG_WARNING("No asset registered with ID %s", id.GetString());
-		return nullptr;
+			m_Loader.TakeFinished(m_FinishedLoads);
+		}
 	}
 
-	Asset* AssetManager::LoadFromRegistry(AssetRegistration& reg)
+	U32 AssetManager::UpdateResidency()
 	{
-		if (reg.LoadedAsset)
+		++m_ResidencyFrame;
+
+		// A request only the manager still references has no handles left
+		for (Size i = m_LiveRequests.GetCount(); i > 0; --i)
 		{
-			return reg.LoadedAsset;
+			AssetLoadRequest* request = m_LiveRequests[i - 1];
+			if (request->GetRefCount() == 1)
+			{
+				ReleaseAssetRef(request->LoadedAsset);
+				request->Release();
+
+				m_LiveRequests[i - 1] = m_LiveRequests[m_LiveRequests.GetCount() - 1];
+				m_LiveRequests.RemoveAt(m_LiveRequests.GetCount() - 1);
+			}
 		}
 
-		// for now, only support single files
-		File assetFile(reg.Path.GetCharArray(), FileMode::FILE_READ, false);
-		if (!assetFile.IsValid())
+		if (m_EvictionBlocked || !IsOverBudget())
 		{
-			NE_LOG_ERROR("Failed to load %s: file not found or inaccessible", reg.Path);
-			return nullptr;
+			return 0;
 		}
 
-		// Read the file data
-		BitStream data;
-		assetFile.Read(data);
-		Asset* result = nullptr;
+		m_EvictionCandidates.Empty();
+		for (AssetRegistration& reg : m_Registry)
+		{
+			const Asset* asset = reg.LoadedAsset;
+			if (asset && asset->m_RefCount == 0 && !asset->m_Pinned)
+			{
+				m_EvictionCandidates.Add(&reg);
+			}
+		}
 
-		// Create the asset instance
-		switch (reg.Type)
+		// Least recently used first
+		std::sort(m_EvictionCandidates.GetData(), m_EvictionCandidates.GetData() + m_EvictionCandidates.GetCount(),
+			[](const AssetRegistration* a, const AssetRegistration* b) { return a->LoadedAsset->m_LastUsed < b->LoadedAsset->m_LastUsed; });
+
+		U32 evicted = 0;
+		for (AssetRegistration* reg : m_EvictionCandidates)
 		{
-			case AssetType::AT_STATIC_MESH:
-				result = NE_NEW(m_AssetAlloc, StaticMesh);
-				break;
-			case AssetType::AT_SHADER:
-				result = NE_NEW(m_AssetAlloc, Shader);
-				break;
-			case AssetType::AT_MATERIAL:
-				result = NE_NEW(m_AssetAlloc, Material);
-				break;
-			case AssetType::AT_TEXTURE2D:
-				result = NE_NEW(m_AssetAlloc, Texture2D);
-				break;
-			default:
-				NE_LOG_WARNING("Unknown asset type of ID %u", (U8)reg.Type);
+			if (!IsOverBudget())
+			{
 				break;
+			}
+
+			UnloadFromRegistry(*reg);
+			++evicted;
+		}
+
+		if (IsOverBudget())
+		{
+			// Don't rescan every frame; wait until a handle is released or the budget changes
+			m_EvictionBlocked = true;
+			NE_LOG_WARNING("Assets use %llu CPU / %llu GPU bytes, over budget, with nothing left to evict",
+				(unsigned long long)m_TotalMemory.CPUBytes, (unsigned long long)m_TotalMemory.GPUBytes);
+		}
+
+		return evicted;
+	}
+
+	void AssetManager::SetMemoryBudget(const AssetMemoryUsage& budget)
+	{
+		m_MemoryBudget = budget;
+		m_EvictionBlocked = false;
+	}
+
+	void AssetManager::SetAssetPinned(const NIdentifier& id, bool pinned)
+	{
+		AssetRegistration* reg = m_Registry.Find(id);
+		if (reg && reg->LoadedAsset)
+		{
+			reg->LoadedAsset->m_Pinned = pinned;
+			m_EvictionBlocked &= pinned;
 		}
+	}
+
+	Asset* AssetManager::GetAssetRef(const U32 id, AssetType type)
+	{
+		AssetRegistration* reg = m_Registry.FindByHash(id);
+		Asset* result = reg ? LoadFromRegistry(*reg, false) : nullptr;
 
 		if (result)
 		{
-			// Load the asset from the buffer
-			result->CreateFromBuffer(data);
-			// Set its ID
-			result->m_AssetID = reg.AssetID;
-			// Update the registration
-			reg.LoadedAsset = result;
-			// Store the loaded asset in the map
-			m_LoadedAssets.Insert(reg.AssetID, result);
+			CHECK(result->GetType() == type);
+			AddAssetRef(result);
+		}
 
-			return result;
+		return result;
+	}
+
+	bool AssetManager::UnloadAsset(const NIdentifier& id)
+	{
+		AssetRegistration* reg = m_Registry.Find(id);
+		if (!reg || !reg->LoadedAsset || reg->LoadedAsset->m_RefCount > 0)
+		{
+			return false;
 		}
 
-		return nullptr;
+		UnloadFromRegistry(*reg);
+		return true;
+	}
+
+	void AssetManager::UnloadFromRegistry(AssetRegistration& reg)
+	{
+		Asset* asset = reg.LoadedAsset;
+		CHECK(asset && asset->m_RefCount == 0);
+
+		UntrackMemory(asset);
+		m_LoadedAssets.RemoveByKey(reg.AssetID);
+		reg.LoadedAsset = nullptr;
+
+		asset->Destroy();
+		NE_DELETE(m_AssetAlloc, asset);
+	}
+
+	void AssetManager::TrackMemory(Asset* asset)
+	{
+		asset->m_TrackedMemory = asset->GetMemoryUsage();
+		m_TotalMemory += asset->m_TrackedMemory;
+		m_TypeMemory[Size(asset->GetType())] += asset->m_TrackedMemory;
+	}
+
+	void AssetManager::UntrackMemory(Asset* asset)
+	{
+		m_TotalMemory -= asset->m_TrackedMemory;
+		m_TypeMemory[Size(asset->GetType())] -= asset->m_TrackedMemory;
+		asset->m_TrackedMemory = AssetMemoryUsage();
+	}
+
+	void AssetManager::AddAssetRef(Asset* asset)
+	{
+		++asset->m_RefCount;
+		asset->m_LastUsed = m_ResidencyFrame;
+	}
+
+	void AssetManager::ReleaseAssetRef(Asset* asset)
+	{
+		CHECK(asset->m_RefCount > 0);
+		if (--asset->m_RefCount == 0)
+		{
+			asset->m_LastUsed = m_ResidencyFrame;
+			m_EvictionBlocked = false;
+		}
+	}
+
+	bool AssetManager::IsOverBudget() const
+	{
+		return (m_MemoryBudget.CPUBytes > 0 && m_TotalMemory.CPUBytes > m_MemoryBudget.CPUBytes) ||
+			(m_MemoryBudget.GPUBytes > 0 && m_TotalMemory.GPUBytes > m_MemoryBudget.GPUBytes);
 	}
 
 	void AssetManager::UnloadAllAssets()
 	{
+		// Nothing may still be parsing into an asset that's about to be deleted
+		CancelAsyncLoads();
+
+		// Handles outliving the manager's assets see their loads as failed
+		for (AssetLoadRequest* request : m_LiveRequests)
+		{
+			request->Status = AssetLoadStatus::Failed;
+			request->LoadedAsset = nullptr;
+			request->Release();
+		}
+		m_LiveRequests.Empty();
+
+		// Assets drop the references they hold on others when destroyed, so destroy all of them
+		// before deleting any
 		for (auto iter = m_LoadedAssets.Start(); iter != m_LoadedAssets.End(); ++iter)
 		{
 			if (iter->Value)
 			{
 				// Have the resource clean itself up
 				iter->Value->Destroy();
+			}
+		}
+
+		for (auto iter = m_LoadedAssets.Start(); iter != m_LoadedAssets.End(); ++iter)
+		{
+			if (iter->Value)
+			{
 				// Delete it from memory
 				NE_DELETE(m_AssetAlloc, iter->Value);
 				// Remove from the map
 				iter.RemoveCurrent();
 			}
 		}
+
+		// Registrations stay, so the assets can be loaded again
+		for (AssetRegistration& reg : m_Registry)
+		{
+			reg.LoadedAsset = nullptr;
+		}
+
+		m_TotalMemory = AssetMemoryUsage();
+		for (AssetMemoryUsage& usage : m_TypeMemory)
+		{
+			usage = AssetMemoryUsage();
+		}
+		m_EvictionBlocked = false;
 	}
 }
\ No newline at end of file
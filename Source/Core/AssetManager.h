@@ -2,8 +2,13 @@
 
 #include "Array.h"
 #include "Asset.h"
+#include "AssetLoader.h"
+#include "AssetRegistry.h"
+#include "DirectoryIndex.h"
+#include "FileWatcher.h"
 #include "Map.h"
 #include "Memory.h"
+#include "VirtualFileSystem.h"
 
 #include "Shader.h"
 #include "StaticMesh.h"
@@ -20,22 +25,6 @@
 namespace Noble
 {
 
-	/**
-	 * AssetRegistration - describes an asset and some surrounding info
-	 */
-	struct AssetRegistration
-	{
-		// Unique identifier for this asset
-		NIdentifier AssetID;
-		// Path to the file where this asset is stored
-		NString Path;
-		// Asset's type
-		AssetType Type;
-		// Pointer to the asset, if it's been loaded
-		Asset* LoadedAsset;
-	};
-
-	typedef Array<AssetRegistration> AssetRegistry;
 	typedef MemoryArena<BasicAllocator, DefaultTracking> AssetAllocator;
 	typedef Map<NIdentifier, Asset*> LoadedAssetMap;
 
@@ -52,7 +41,12 @@ namespace Noble
 		AssetManager();
 
 		/**
-		 * Loads the asset registry file
+		 * Hands every outstanding load back to be dropped, so no parsed asset outlives the manager
+		 */
+		~AssetManager();
+
+		/**
+		 * Indexes the content directory and loads the asset registry file
 		 */
 		void LoadAssetRegistry();
 
@@ -67,6 +61,13 @@ namespace Noble
 		 */
 		void UnregisterAsset(const NIdentifier& id);
 
+		/**
+		 * Sets the assets that must be loaded before the asset, such as a Material's Shader and Textures
+		 * Requesting the asset then requests its dependencies as well; they're read and parsed in
+		 * parallel with it, and it's finalized only once every one of them has completed
+		 */
+		void SetAssetDependencies(const NIdentifier& id, const Array<NIdentifier>& dependencies);
+
 		/**
 		 * Returns a pointer to the StaticMesh of the given ID
 		 * Will load the asset if it's not yet loaded
@@ -129,27 +130,254 @@ namespace Noble
 		 */
 		Asset* LoadAsset(const NIdentifier& id);
 
+		/**
+		 * Returns the loaded asset of the given ID and type, loading it if needed
+		 * Also finds assets made with CreateMaterial. Returns nullptr if the asset doesn't exist
+		 * Like every function returning an asset by pointer, this pins the asset (see SetAssetPinned)
+		 */
+		Asset* GetAsset(const NIdentifier& id, AssetType type);
+
+		/**
+		 * Returns the registered assets
+		 */
+		const AssetRegistry& GetRegistry() const { return m_Registry; }
+
+		/**
+		 * Starts loading the asset on the asset loader threads and returns a handle to it
+		 * The file is read and parsed in the background; renderer resources are created on the
+		 * main thread by ProcessAsyncLoads, which then marks the handle ready and runs @callback.
+		 * Requesting an asset that is loaded or already requested shares the existing load.
+		 */
+		template <typename T>
+		AssetHandle<T> RequestAsset(const NIdentifier& id, AssetLoadPriority priority = AssetLoadPriority::Normal,
+			AssetLoadCallback&& callback = AssetLoadCallback())
+		{
+			return AssetHandle<T>(RequestAssetLoad(id, T::StaticType, priority, std::move(callback)));
+		}
+
+		/**
+		 * Untyped version of RequestAsset
+		 * The returned request stays alive until its completion is processed; take a reference to keep it longer
+		 */
+		AssetLoadRequest* RequestAssetLoad(const NIdentifier& id, AssetType type,
+			AssetLoadPriority priority = AssetLoadPriority::Normal, AssetLoadCallback&& callback = AssetLoadCallback());
+
+		/**
+		 * Finalizes assets the loader threads have parsed: creates their resources, marks their
+		 * handles ready and runs their callbacks, highest priority first. Called once per frame.
+		 * Stops once @timeBudget seconds have passed, but always finalizes at least one asset.
+		 * Returns the number of loads completed
+		 */
+		U32 ProcessAsyncLoads(F32 timeBudget = 0.002F);
+
+		/**
+		 * Returns the number of requested assets that haven't completed yet
+		 */
+		Size GetPendingLoadCount() const { return m_PendingLoads.GetCount(); }
+
+		/**
+		 * Drops references of handles that were released and, while the memory budget is exceeded,
+		 * unloads the least recently used assets that no handle references and that aren't pinned.
+		 * Called once per frame. Returns the number of assets unloaded
+		 */
+		U32 UpdateResidency();
+
+		/**
+		 * Sets the memory the loaded assets may use before unused ones are evicted
+		 * A budget of 0 bytes leaves that kind of memory unbounded (the default)
+		 */
+		void SetMemoryBudget(const AssetMemoryUsage& budget);
+
+		/**
+		 * Returns the memory budget
+		 */
+		const AssetMemoryUsage& GetMemoryBudget() const { return m_MemoryBudget; }
+
+		/**
+		 * Returns the memory used by all loaded assets
+		 */
+		const AssetMemoryUsage& GetMemoryUsage() const { return m_TotalMemory; }
+
+		/**
+		 * Returns the memory used by loaded assets of the type
+		 */
+		const AssetMemoryUsage& GetMemoryUsage(AssetType type) const { return m_TypeMemory[Size(type)]; }
+
+		/**
+		 * Pinned assets are never evicted. Assets handed out by pointer (GetStaticMesh and the like)
+		 * are pinned, since the manager can't tell when the pointer stops being used; unpin them
+		 * once nothing holds on to the pointer to let them be evicted.
+		 */
+		void SetAssetPinned(const NIdentifier& id, bool pinned);
+
+		/**
+		 * Returns the asset registered under the hash of an ID, loading it if needed, with a reference
+		 * added instead of a pin; ReleaseAssetRef drops it. Used by assets that point to others, such
+		 * as a Material to its Shader and Textures, so those are kept only as long as it is
+		 */
+		Asset* GetAssetRef(const U32 id, AssetType type);
+
+		/**
+		 * Adds or drops a reference; referenced assets are never evicted
+		 */
+		void AddAssetRef(Asset* asset);
+		void ReleaseAssetRef(Asset* asset);
+
+		/**
+		 * Unloads the asset if no handle references it
+		 * Pinned assets are unloaded too; pointers to them must no longer be used
+		 * Returns false if the asset isn't loaded or is still referenced
+		 */
+		bool UnloadAsset(const NIdentifier& id);
+
 		/**
 		 * Unloads every loaded asset, regardless of flags
 		 * Used on shutdown
 		 */
 		void UnloadAllAssets();
 
+		/**
+		 * Re-reads a loaded asset from its file and rebuilds it in place
+		 * Returns false if the asset isn't loaded or its file can't be read or parsed, keeping the loaded version
+		 */
+		bool ReloadAsset(const NIdentifier& id);
+
+		/**
+		 * Applies content file changes seen since the last call to the content index and
+		 * reloads the loaded assets whose files changed. Called once per frame.
+		 * Returns the number of assets reloaded
+		 */
+		U32 ProcessContentChanges();
+
+		/**
+		 * Returns the index of every file under the content directory
+		 */
+		const DirectoryIndex& GetContentIndex() const { return m_ContentIndex; }
+
+		/**
+		 * Returns the file system asset paths are resolved through
+		 * The content directory is mounted at "Content"; packs can be mounted over it
+		 */
+		VirtualFileSystem& GetFileSystem() { return m_FileSystem; }
+
 	private:
 
+		/**
+		 * Creates an empty asset of the given type
+		 */
+		Asset* CreateAsset(AssetType type);
+
 		/**
 		 * Loads the requested asset from its registration data
+		 * With @pin set the asset is pinned, as for assets handed out by pointer
+		 */
+		Asset* LoadFromRegistry(AssetRegistration& reg, bool pin = true);
+
+		/**
+		 * Completes a request handed back by the loader or answered without it
+		 */
+		void FinishAsyncLoad(AssetLoadRequest* request);
+
+		/**
+		 * Stops the loader and completes every outstanding request without creating its asset
+		 */
+		void CancelAsyncLoads();
+
+		/**
+		 * Requests every dependency of the registration and adds them to @request
+		 */
+		void RequestDependencies(AssetLoadRequest* request, const AssetRegistration& reg);
+
+		/**
+		 * Raises the priority of a request and of the loads it depends on
+		 */
+		void ReprioritizeLoad(AssetLoadRequest* request, AssetLoadPriority priority);
+
+		/**
+		 * Returns true once every load the request depends on has completed
+		 */
+		static bool AreDependenciesDone(const AssetLoadRequest* request);
+
+		/**
+		 * Destroys a loaded asset and clears its registration
+		 */
+		void UnloadFromRegistry(AssetRegistration& reg);
+
+		/**
+		 * Adds the asset's memory to the totals, or removes it
 		 */
-		Asset* LoadFromRegistry(AssetRegistration& reg);
+		void TrackMemory(Asset* asset);
+		void UntrackMemory(Asset* asset);
+
+		/**
+		 * Returns true if the loaded assets use more memory than the budget allows
+		 */
+		bool IsOverBudget() const;
+
+		/**
+		 * Opens the registration's file through the file system and points @data at the asset
+		 * data in it, verifying the checksummed frame if there is one
+		 */
+		bool OpenAssetData(const AssetRegistration& reg, VfsFile& file, BitStreamView& data);
+
+		/**
+		 * Lists the registrations in the content directory by path, for ProcessContentChanges
+		 */
+		void BuildContentPaths();
 
 	private:
 
-		// Array of all registered assets
+		/**
+		 * A registration whose file is in the content directory
+		 */
+		struct ContentPath
+		{
+			// HashString64 of the path relative to the content directory
+			U64 Hash;
+			NIdentifier AssetID;
+		};
+
+		// All registered assets, indexed by ID
 		AssetRegistry m_Registry;
 		// Allocates each asset
 		AssetAllocator m_AssetAlloc;
 		// Map of all loaded assets
 		LoadedAssetMap m_LoadedAssets;
+		// Every file under the content directory
+		DirectoryIndex m_ContentIndex;
+		// Keeps m_ContentIndex current
+		FileWatcher m_ContentWatcher;
+		// Reused between ProcessContentChanges calls
+		DirectoryChangeList m_ContentChanges;
+		// Registrations in the content directory sorted by path hash, built when first needed
+		Array<ContentPath> m_ContentPaths;
+		// Set when registrations changed since m_ContentPaths was built
+		bool m_ContentPathsDirty;
+		// Resolves asset paths to loose files, packs or memory
+		VirtualFileSystem m_FileSystem;
+		// Reads and parses requested assets in the background
+		AssetLoader m_Loader;
+		// Requests that haven't completed, for sharing repeated requests
+		Array<AssetLoadRequest*> m_PendingLoads;
+		// Requests waiting for ProcessAsyncLoads
+		Array<AssetLoadRequest*> m_FinishedLoads;
+		// Parsed requests waiting for the loads they depend on
+		Array<AssetLoadRequest*> m_WaitingLoads;
+		// Identifier hashes of the assets whose dependencies are being requested, to break cycles
+		Array<IdentifierHash> m_ExpandingLoads;
+		// Completed requests whose assets they keep referenced until their handles are gone
+		Array<AssetLoadRequest*> m_LiveRequests;
+
+		// Memory of the loaded assets, in total and per AssetType
+		AssetMemoryUsage m_TotalMemory;
+		AssetMemoryUsage m_TypeMemory[AssetTypeCount];
+		AssetMemoryUsage m_MemoryBudget;
+		// Advanced by UpdateResidency, orders assets for eviction
+		U64 m_ResidencyFrame;
+		// Set when nothing could be evicted, until an asset becomes evictable again
+		bool m_EvictionBlocked;
+		// Reused between UpdateResidency calls
+		Array<AssetRegistration*> m_EvictionCandidates;
 
 	};
 }
\ No newline at end of file
@@ -0,0 +1,342 @@
+#include "AssetRegistry.h"
+
+#include <cstring>
+
+#include "Logger.h"
+#include "Memory.h"
+
+// Slots in the index table of an empty registry, a power of two
+#define MIN_REGISTRY_SLOTS 64
+
+namespace Noble
+{
+	namespace
+	{
+		/**
+		 * Returns a copy of the null-terminated string, freed with Memory::Free
+		 */
+		const char* CopyPath(const char* path)
+		{
+			const Size size = std::strlen(path) + 1;
+			char* copy = static_cast<char*>(Memory::Malloc(size, alignof(char)));
+			Memory::Memcpy(copy, path, size);
+			return copy;
+		}
+	}
+
+	AssetRegistry::AssetRegistry()
+	{
+		Rehash(MIN_REGISTRY_SLOTS);
+	}
+
+	AssetRegistry::~AssetRegistry()
+	{
+		Clear();
+	}
+
+	bool AssetRegistry::Load(const fs::path& path)
+	{
+		if (m_File.IsOpen())
+		{
+			NE_LOG_WARNING("An asset registry file is already loaded, ignoring %s", path.string().c_str());
+			return false;
+		}
+
+		if (!m_File.Open(path))
+		{
+			return false;
+		}
+
+		// One allocation for each array, sized up front, rather than one per asset
+		const U32 fileCount = m_File.GetEntryCount();
+		const Size totalCount = m_Entries.GetCount() + fileCount;
+		if (totalCount > m_Entries.GetMax())
+		{
+			m_Entries.Resize(totalCount);
+		}
+		ReserveSlots(totalCount);
+
+		// Dependencies are copied in one block, so SetDependencies works the same on every registration
+		const U32 dependencyBase = static_cast<U32>(m_Dependencies.GetCount());
+		if (m_File.GetDependencyCount() > 0)
+		{
+			m_Dependencies.AddMultiple(const_cast<IdentifierHash*>(m_File.GetDependencies()), m_File.GetDependencyCount());
+		}
+
+		const AssetRegistryEntry* entries = m_File.GetEntries();
+		for (U32 i = 0; i < fileCount; ++i)
+		{
+			const AssetRegistryEntry& entry = entries[i];
+			const NIdentifier id = m_File.GetID(entry);
+
+			const Size slot = FindSlot(id);
+			if (m_Slots[slot].Index != EmptySlot)
+			{
+				// Registered at runtime before the file was loaded, which takes precedence
+				continue;
+			}
+
+			AssetRegistration reg;
+			reg.AssetID = id;
+			reg.Path = m_File.GetPath(entry);
+			reg.Type = static_cast<AssetType>(entry.Type);
+			reg.LoadedAsset = nullptr;
+			reg.FileSize = entry.FileSize;
+			reg.FirstDependency = dependencyBase + entry.FirstDependency;
+			reg.DependencyCount = entry.DependencyCount;
+
+			m_Slots[slot].Hash = entry.IdHash;
+			m_Slots[slot].Index = static_cast<U32>(m_Entries.Add(reg));
+		}
+
+		NE_LOG_INFO("Loaded %u assets from %s", fileCount, path.string().c_str());
+		return true;
+	}
+
+	AssetRegistration& AssetRegistry::Register(const NIdentifier& id, const char* path, AssetType type)
+	{
+		const Size slot = FindSlot(id);
+		if (m_Slots[slot].Index != EmptySlot)
+		{
+			AssetRegistration& existing = m_Entries[m_Slots[slot].Index];
+			NE_LOG_WARNING("Asset %s registered twice, now pointing at %s", id.GetString(), path);
+			ReleasePath(existing);
+			existing.Path = CopyPath(path);
+			existing.Type = type;
+			return existing;
+		}
+
+		AssetRegistration reg;
+		reg.AssetID = id;
+		reg.Path = CopyPath(path);
+		reg.Type = type;
+		reg.LoadedAsset = nullptr;
+		reg.FileSize = 0;
+		reg.FirstDependency = 0;
+		reg.DependencyCount = 0;
+
+		const U32 index = static_cast<U32>(m_Entries.Add(reg));
+
+		if ((m_Entries.GetCount() * 2) > m_Slots.GetCount())
+		{
+			// Rehashing re-inserts every registration, including the new one
+			Rehash(m_Slots.GetCount() * 2);
+		}
+		else
+		{
+			m_Slots[slot].Hash = id.GetHash();
+			m_Slots[slot].Index = index;
+		}
+
+		return m_Entries[index];
+	}
+
+	bool AssetRegistry::Unregister(const NIdentifier& id)
+	{
+		Size slot = FindSlot(id);
+		if (m_Slots[slot].Index == EmptySlot)
+		{
+			return false;
+		}
+
+		const U32 index = m_Slots[slot].Index;
+
+		// Backward shift deletion: pull later entries of the probe run into the hole, so lookups
+		// never need tombstones
+		const Size mask = m_Slots.GetCount() - 1;
+		Size next = (slot + 1) & mask;
+		while (m_Slots[next].Index != EmptySlot)
+		{
+			const Size home = m_Slots[next].Hash & mask;
+			// Move the entry back if its home isn't cyclically within (slot, next]
+			const bool inRange = slot <= next ? (home > slot && home <= next) : (home > slot || home <= next);
+			if (!inRange)
+			{
+				m_Slots[slot] = m_Slots[next];
+				slot = next;
+			}
+			next = (next + 1) & mask;
+		}
+		m_Slots[slot].Index = EmptySlot;
+
+		ReleasePath(m_Entries[index]);
+
+		// Keep storage dense by moving the last registration into the hole
+		const U32 last = static_cast<U32>(m_Entries.GetCount() - 1);
+		if (index != last)
+		{
+			const U32 lastHash = m_Entries[last].AssetID.GetHash();
+			m_Slots[FindSlotOfIndex(lastHash, last)].Index = index;
+			m_Entries[index] = std::move(m_Entries[last]);
+		}
+		m_Entries.RemoveAt(last);
+
+		return true;
+	}
+
+	AssetRegistration* AssetRegistry::Find(const NIdentifier& id)
+	{
+		const Size slot = FindSlot(id);
+		return m_Slots[slot].Index != EmptySlot ? &m_Entries[m_Slots[slot].Index] : nullptr;
+	}
+
+	const AssetRegistration* AssetRegistry::Find(const NIdentifier& id) const
+	{
+		const Size slot = FindSlot(id);
+		return m_Slots[slot].Index != EmptySlot ? &m_Entries[m_Slots[slot].Index] : nullptr;
+	}
+
+	AssetRegistration* AssetRegistry::FindByHash(U32 hash)
+	{
+		const Size mask = m_Slots.GetCount() - 1;
+		for (Size slot = hash & mask; m_Slots[slot].Index != EmptySlot; slot = (slot + 1) & mask)
+		{
+			if (m_Slots[slot].Hash == hash)
+			{
+				return &m_Entries[m_Slots[slot].Index];
+			}
+		}
+
+		return nullptr;
+	}
+
+	AssetRegistration* AssetRegistry::FindByIdentifierHash(IdentifierHash hash)
+	{
+		// Slots are keyed by GetHash, the low half of the identifier hash
+		const U32 slotHash = static_cast<U32>(hash);
+		const Size mask = m_Slots.GetCount() - 1;
+		for (Size slot = slotHash & mask; m_Slots[slot].Index != EmptySlot; slot = (slot + 1) & mask)
+		{
+			AssetRegistration& reg = m_Entries[m_Slots[slot].Index];
+			if (m_Slots[slot].Hash == slotHash && reg.AssetID.GetIdentifierHash() == hash)
+			{
+				return &reg;
+			}
+		}
+
+		return nullptr;
+	}
+
+	void AssetRegistry::SetDependencies(AssetRegistration& reg, const IdentifierHash* hashes, U32 count)
+	{
+		// Lists that don't grow are rewritten in place; others move to the end, and the range they
+		// leave stays unused until Clear
+		if (count > reg.DependencyCount)
+		{
+			reg.FirstDependency = static_cast<U32>(m_Dependencies.GetCount());
+			for (U32 i = 0; i < count; ++i)
+			{
+				m_Dependencies.Add(hashes[i]);
+			}
+		}
+		else if (count > 0)
+		{
+			Memory::Memcpy(m_Dependencies.GetData() + reg.FirstDependency, hashes, count * sizeof(IdentifierHash));
+		}
+
+		reg.DependencyCount = count;
+	}
+
+	void AssetRegistry::Clear()
+	{
+		for (AssetRegistration& reg : m_Entries)
+		{
+			ReleasePath(reg);
+		}
+		m_Entries.Empty();
+		m_Dependencies.Empty();
+		m_File.Close();
+
+		for (Slot& slot : m_Slots)
+		{
+			slot.Index = EmptySlot;
+		}
+	}
+
+	Size AssetRegistry::FindSlot(const NIdentifier& id) const
+	{
+		const U32 hash = id.GetHash();
+		const Size mask = m_Slots.GetCount() - 1;
+
+		Size slot = hash & mask;
+		while (m_Slots[slot].Index != EmptySlot)
+		{
+			if (m_Slots[slot].Hash == hash && m_Entries[m_Slots[slot].Index].AssetID == id)
+			{
+				break;
+			}
+			slot = (slot + 1) & mask;
+		}
+
+		return slot;
+	}
+
+	Size AssetRegistry::FindSlotOfIndex(U32 hash, U32 index) const
+	{
+		const Size mask = m_Slots.GetCount() - 1;
+
+		Size slot = hash & mask;
+		while (m_Slots[slot].Index != index)
+		{
+			CHECK(m_Slots[slot].Index != EmptySlot);
+			slot = (slot + 1) & mask;
+		}
+
+		return slot;
+	}
+
+	void AssetRegistry::ReserveSlots(Size count)
+	{
+		Size slotCount = m_Slots.GetCount();
+		while (count * 2 > slotCount)
+		{
+			slotCount *= 2;
+		}
+
+		if (slotCount > m_Slots.GetCount())
+		{
+			Rehash(slotCount);
+		}
+	}
+
+	void AssetRegistry::ReleasePath(AssetRegistration& reg)
+	{
+		if (reg.Path && !m_File.OwnsString(reg.Path))
+		{
+			Memory::Free(const_cast<char*>(reg.Path));
+		}
+		reg.Path = nullptr;
+	}
+
+	void AssetRegistry::Rehash(Size slotCount)
+	{
+		CHECK((slotCount & (slotCount - 1)) == 0);
+
+		m_Slots.Empty();
+		if (slotCount > m_Slots.GetMax())
+		{
+			m_Slots.Resize(slotCount);
+		}
+
+		const Slot empty = { 0, EmptySlot };
+		for (Size i = 0; i < slotCount; ++i)
+		{
+			m_Slots.Add(empty);
+		}
+
+		const Size mask = slotCount - 1;
+		for (U32 i = 0; i < m_Entries.GetCount(); ++i)
+		{
+			const U32 hash = m_Entries[i].AssetID.GetHash();
+
+			Size slot = hash & mask;
+			while (m_Slots[slot].Index != EmptySlot)
+			{
+				slot = (slot + 1) & mask;
+			}
+
+			m_Slots[slot].Hash = hash;
+			m_Slots[slot].Index = i;
+		}
+	}
+}
\ No newline at end of file
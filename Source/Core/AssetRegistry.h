@@ -0,0 +1,165 @@
+#pragma once
+
+#include "Array.h"
+#include "Asset.h"
+#include "AssetRegistryFile.h"
+#include "String.h"
+#include "Types.h"
+
+namespace Noble
+{
+	/**
+	 * AssetRegistration - describes an asset and some surrounding info
+	 */
+	struct AssetRegistration
+	{
+		// Unique identifier for this asset
+		NIdentifier AssetID;
+		// Null-terminated path to the file where this asset is stored, owned by the registry
+		const char* Path;
+		// Asset's type
+		AssetType Type;
+		// Pointer to the asset, if it's been loaded
+		Asset* LoadedAsset;
+		// Size of the asset's file when the registry file was built, 0 if unknown
+		U64 FileSize;
+		// Assets that must be loaded before this one, as a range of identifier hashes in the
+		// registry's dependency list (see AssetRegistry::GetDependencies)
+		U32 FirstDependency;
+		U32 DependencyCount;
+	};
+
+	/**
+	 * Every registered asset, looked up by ID or by 32-bit ID hash in constant time
+	 *
+	 * Registrations are stored densely, so iterating them walks one array, and indexed by an
+	 * open-addressed table of (hash, index) slots probed linearly. Unregistering moves the last
+	 * registration into the freed place, so pointers and references to registrations are only
+	 * valid until the next Register or Unregister.
+	 *
+	 * Registrations loaded from a registry file (see AssetRegistryFile) keep their IDs and paths
+	 * in its mapping, so loading one costs no allocation per asset.
+	 */
+	class AssetRegistry
+	{
+	public:
+
+		AssetRegistry();
+
+		~AssetRegistry();
+
+		NO_COPY_NO_MOVE(AssetRegistry)
+
+		/**
+		 * Maps the registry file and registers every asset in it
+		 * Assets already registered keep their registration. Returns false if the file can't be
+		 * read or a registry file is already loaded; Clear unloads it
+		 */
+		bool Load(const fs::path& path);
+
+		/**
+		 * Adds a registration, or updates the path and type of an existing one with the same ID
+		 */
+		AssetRegistration& Register(const NIdentifier& id, const char* path, AssetType type);
+
+		/**
+		 * Removes the registration; returns false if the ID isn't registered
+		 */
+		bool Unregister(const NIdentifier& id);
+
+		/**
+		 * Returns the registration of the ID, or nullptr
+		 */
+		AssetRegistration* Find(const NIdentifier& id);
+		const AssetRegistration* Find(const NIdentifier& id) const;
+
+		/**
+		 * Returns the registration whose ID has the 32-bit hash (NIdentifier::GetHash), or nullptr
+		 * Used for IDs stored in asset files
+		 */
+		AssetRegistration* FindByHash(U32 hash);
+
+		/**
+		 * Returns the registration whose ID has the identifier hash (NIdentifier::GetIdentifierHash), or nullptr
+		 * Unlike FindByHash, this tells apart IDs whose 32-bit hashes collide under NOBLE_WIDE_IDENTIFIERS
+		 */
+		AssetRegistration* FindByIdentifierHash(IdentifierHash hash);
+
+		/**
+		 * Sets the identifier hashes of the assets the registration depends on, replacing earlier ones
+		 */
+		void SetDependencies(AssetRegistration& reg, const IdentifierHash* hashes, U32 count);
+
+		/**
+		 * Returns the registration's DependencyCount identifier hashes
+		 */
+		const IdentifierHash* GetDependencies(const AssetRegistration& reg) const { return m_Dependencies.GetData() + reg.FirstDependency; }
+
+		/**
+		 * Returns the number of registrations
+		 */
+		Size GetCount() const { return m_Entries.GetCount(); }
+
+		/**
+		 * Removes every registration and unmaps the registry file
+		 */
+		void Clear();
+
+		// Iteration over the registrations, in no particular order
+		AssetRegistration* begin() { return m_Entries.GetData(); }
+		AssetRegistration* end() { return m_Entries.GetData() + m_Entries.GetCount(); }
+		const AssetRegistration* begin() const { return m_Entries.GetData(); }
+		const AssetRegistration* end() const { return m_Entries.GetData() + m_Entries.GetCount(); }
+
+	private:
+
+		// Marks an empty slot
+		static constexpr U32 EmptySlot = std::numeric_limits<U32>::max();
+
+		/**
+		 * An index table entry; the hash is kept so probing rarely touches the registrations
+		 */
+		struct Slot
+		{
+			U32 Hash;
+			// Index into m_Entries, or EmptySlot
+			U32 Index;
+		};
+
+		/**
+		 * Returns the slot holding the ID, or the empty slot that ends its probe sequence
+		 */
+		Size FindSlot(const NIdentifier& id) const;
+
+		/**
+		 * Returns the slot holding the registration at @index
+		 */
+		Size FindSlotOfIndex(U32 hash, U32 index) const;
+
+		/**
+		 * Rebuilds the index with @slotCount slots, a power of two
+		 */
+		void Rehash(Size slotCount);
+
+		/**
+		 * Grows the index so @count registrations keep it at most half full
+		 */
+		void ReserveSlots(Size count);
+
+		/**
+		 * Frees the registration's path unless it's in the registry file
+		 */
+		void ReleasePath(AssetRegistration& reg);
+
+	private:
+
+		// Registrations, densely packed
+		Array<AssetRegistration> m_Entries;
+		// Index table, kept at most half full
+		Array<Slot> m_Slots;
+		// Dependency identifier hashes of every registration, each a contiguous range
+		Array<IdentifierHash> m_Dependencies;
+		// Loaded registry file, holding the IDs and paths of its registrations
+		AssetRegistryFile m_File;
+	};
+}
\ No newline at end of file
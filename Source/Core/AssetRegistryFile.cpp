@@ -0,0 +1,343 @@
+#include "AssetRegistryFile.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "BitStream.h"
+#include "Checksum.h"
+#include "Logger.h"
+
+namespace Noble
+{
+	namespace
+	{
+		/**
+		 * Byte-swaps every field of the entry, to convert between the registry's little-endian
+		 * layout and a big-endian host
+		 */
+		void SwapEntry(AssetRegistryEntry& entry)
+		{
+			ByteOrderHelper::SwapUnits(&entry.IdHash, sizeof(U32), 8);
+			ByteOrderHelper::SwapUnits(&entry.FileSize, sizeof(U64), 1);
+		}
+	}
+
+	AssetRegistryFile::AssetRegistryFile()
+		: m_Entries(nullptr), m_EntryCount(0), m_Dependencies(nullptr), m_DependencyCount(0),
+		m_Strings(nullptr), m_StringsSize(0)
+	{}
+
+	bool AssetRegistryFile::Open(const fs::path& path)
+	{
+		Close();
+
+		// The whole table is validated right away, so have it read ahead
+		if (!m_Mapping.Open(path, 0, MappedFile::SequentialScan))
+		{
+			NE_LOG_WARNING("Failed to open asset registry %s", path.string().c_str());
+			return false;
+		}
+
+		BitStreamView header;
+		if (!MappedTable::OpenHeader(m_Mapping, path, "asset registry", Magic, Version, header))
+		{
+			Close();
+			return false;
+		}
+
+		const Byte* base = reinterpret_cast<const Byte*>(m_Mapping.GetData());
+		const Size fileSize = m_Mapping.GetMappedSize();
+
+		const U32 entryCount = header.Read<U32>();
+		const U32 dependencyCount = header.Read<U32>();
+		const U64 entriesOffset = header.Read<U64>();
+		const U64 dependenciesOffset = header.Read<U64>();
+		const U64 stringsOffset = header.Read<U64>();
+		const U64 stringsSize = header.Read<U64>();
+		const U32 identifierHashBits = header.Read<U32>();
+		const U32 tableChecksum = header.Read<U32>();
+		const bool headerValid = MappedTable::ReadHeaderChecksum(header);
+
+		if (headerValid && identifierHashBits != IdentifierHashBits)
+		{
+			// The table is keyed by NIdentifier::GetHash, which NOBLE_WIDE_IDENTIFIERS changes
+			NE_LOG_WARNING("Asset registry %s was built for %u-bit identifiers, rebuild it", path.string().c_str(), identifierHashBits);
+			Close();
+			return false;
+		}
+
+		// Every range is checked against the file size before anything points into it
+		const U64 entriesSize = U64(entryCount) * sizeof(AssetRegistryEntry);
+		const U64 dependenciesSize = U64(dependencyCount) * sizeof(IdentifierHash);
+		if (!headerValid || !MappedTable::IsRangeValid(entriesOffset, entriesSize, fileSize, alignof(AssetRegistryEntry)) ||
+			!MappedTable::IsRangeValid(dependenciesOffset, dependenciesSize, fileSize, alignof(IdentifierHash)) ||
+			!MappedTable::IsStringBlockValid(base, fileSize, stringsOffset, stringsSize, entryCount))
+		{
+			NE_LOG_WARNING("Asset registry %s has a corrupt header", path.string().c_str());
+			Close();
+			return false;
+		}
+
+		U32 checksum = Checksum::Crc32c(base + entriesOffset, entriesSize);
+		checksum = Checksum::Crc32c(base + dependenciesOffset, dependenciesSize, checksum);
+		checksum = Checksum::Crc32c(base + stringsOffset, stringsSize, checksum);
+		if (checksum != tableChecksum)
+		{
+			NE_LOG_WARNING("Asset registry %s is corrupt", path.string().c_str());
+			Close();
+			return false;
+		}
+
+		const AssetRegistryEntry* entries = MappedTable::ToNativeOrder(reinterpret_cast<const AssetRegistryEntry*>(base + entriesOffset),
+			entryCount, m_SwappedEntries, SwapEntry);
+		const IdentifierHash* dependencies = reinterpret_cast<const IdentifierHash*>(base + dependenciesOffset);
+		if constexpr (ByteOrder::Native == ByteOrder::Big)
+		{
+			if (dependencyCount > 0)
+			{
+				m_SwappedDependencies.Resize(dependencyCount);
+				m_SwappedDependencies.AddMultiple(const_cast<IdentifierHash*>(dependencies), dependencyCount);
+				ByteOrderHelper::SwapUnits(m_SwappedDependencies.GetData(), sizeof(IdentifierHash), dependencyCount);
+			}
+			dependencies = m_SwappedDependencies.GetData();
+		}
+
+		// Catch anything that would make a lookup or a string go out of range
+		const char* strings = reinterpret_cast<const char*>(base + stringsOffset);
+		for (U32 i = 0; i < entryCount; ++i)
+		{
+			const AssetRegistryEntry& entry = entries[i];
+			if (entry.IdLength == 0 || entry.IdOffset >= stringsSize || entry.IdLength >= stringsSize - entry.IdOffset ||
+				strings[entry.IdOffset + entry.IdLength] != '\0' || entry.PathOffset >= stringsSize ||
+				entry.FirstDependency > dependencyCount || entry.DependencyCount > dependencyCount - entry.FirstDependency ||
+				entry.Type >= AssetTypeCount || (i > 0 && entries[i - 1].IdHash > entry.IdHash))
+			{
+				NE_LOG_WARNING("Asset registry %s has a corrupt entry", path.string().c_str());
+				Close();
+				return false;
+			}
+		}
+
+		m_Entries = MappedTable::GetTable(entries, entryCount);
+		m_EntryCount = entryCount;
+		m_Dependencies = dependencies;
+		m_DependencyCount = dependencyCount;
+		m_Strings = strings;
+		m_StringsSize = stringsSize;
+
+		return true;
+	}
+
+	void AssetRegistryFile::Close()
+	{
+		if (m_Mapping.IsValid())
+		{
+			m_Mapping.Close();
+		}
+		m_SwappedEntries.Empty();
+		m_SwappedDependencies.Empty();
+		m_Entries = nullptr;
+		m_EntryCount = 0;
+		m_Dependencies = nullptr;
+		m_DependencyCount = 0;
+		m_Strings = nullptr;
+		m_StringsSize = 0;
+	}
+
+	const AssetRegistryEntry* AssetRegistryFile::Find(U32 idHash) const
+	{
+		if (!IsOpen())
+		{
+			return nullptr;
+		}
+
+		const AssetRegistryEntry* end = m_Entries + m_EntryCount;
+		const AssetRegistryEntry* found = std::lower_bound(m_Entries, end, idHash,
+			[](const AssetRegistryEntry& entry, U32 value) { return entry.IdHash < value; });
+
+		return (found != end && found->IdHash == idHash) ? found : nullptr;
+	}
+
+	AssetRegistryWriter::AssetRegistryWriter()
+	{}
+
+	void AssetRegistryWriter::Add(const char* id, const char* path, AssetType type, U64 fileSize, const Array<NIdentifier>& dependencies)
+	{
+		const Size idLength = std::strlen(id);
+		const Size pathLength = std::strlen(path);
+		CHECK(idLength > 0);
+
+		// GetHash is the low half of the identifier hash in both modes
+		const U64 hash = NIdentifier(id, idLength).GetIdentifierHash();
+
+		PendingEntry entry;
+		entry.IdHash = static_cast<U32>(hash);
+		entry.IdHashHigh = static_cast<U32>(hash >> 32);
+		entry.IdOffset = static_cast<U32>(m_StringPool.GetCount());
+		entry.IdLength = static_cast<U32>(idLength);
+		m_StringPool.AddMultiple(id, idLength + 1);
+		entry.PathOffset = static_cast<U32>(m_StringPool.GetCount());
+		m_StringPool.AddMultiple(path, pathLength + 1);
+		entry.FirstDependency = static_cast<U32>(m_DependencyPool.GetCount());
+		entry.DependencyCount = static_cast<U32>(dependencies.GetCount());
+		for (const NIdentifier& dependency : dependencies)
+		{
+			// The full hash, so assets whose 32-bit hashes collide are still told apart
+			m_DependencyPool.Add(dependency.GetIdentifierHash());
+		}
+		entry.Type = type;
+		entry.FileSize = fileSize;
+
+		m_Entries.Add(entry);
+	}
+
+	bool AssetRegistryWriter::Write(const fs::path& path)
+	{
+		const U32 entryCount = static_cast<U32>(m_Entries.GetCount());
+		const char* strings = m_StringPool.GetData();
+
+		auto getHash = [this](U32 index) { return m_Entries[index].IdHash; };
+		auto getName = [this, strings](U32 index) { return strings + m_Entries[index].IdOffset; };
+		Array<U32> sorted;
+		MappedTable::SortEntries(entryCount, sorted, getHash, getName);
+
+		// Keep the last registration of each ID, and lay out the blocks in table order so the
+		// strings and dependencies of neighbouring entries share pages
+		Array<AssetRegistryEntry> entries;
+		Array<IdentifierHash> dependencyBlock;
+		Array<char> stringBlock;
+		if (entryCount > 0)
+		{
+			entries.Resize(entryCount);
+		}
+		bool collided = false;
+		for (U32 i = 0; i < entryCount; ++i)
+		{
+			const PendingEntry& pending = m_Entries[sorted[i]];
+			const char* id = strings + pending.IdOffset;
+			if (MappedTable::IsReplaced(sorted, i, getHash, getName))
+			{
+				NE_LOG_WARNING("Asset %s was added to the registry more than once, keeping the last", id);
+				continue;
+			}
+			if (i + 1 < entryCount && getHash(sorted[i + 1]) == pending.IdHash)
+			{
+				NE_LOG_ERROR("Asset IDs %s and %s have the same hash; rename one of them", id, getName(sorted[i + 1]));
+				collided = true;
+				continue;
+			}
+
+			AssetRegistryEntry entry;
+			entry.IdHash = pending.IdHash;
+			entry.IdOffset = static_cast<U32>(stringBlock.GetCount());
+			entry.IdLength = pending.IdLength;
+			stringBlock.AddMultiple(id, Size(pending.IdLength) + 1);
+			entry.PathOffset = static_cast<U32>(stringBlock.GetCount());
+			const char* assetPath = strings + pending.PathOffset;
+			stringBlock.AddMultiple(assetPath, std::strlen(assetPath) + 1);
+			entry.FirstDependency = static_cast<U32>(dependencyBlock.GetCount());
+			entry.DependencyCount = pending.DependencyCount;
+			for (U32 d = 0; d < pending.DependencyCount; ++d)
+			{
+				dependencyBlock.Add(m_DependencyPool[pending.FirstDependency + d]);
+			}
+			entry.Type = static_cast<U32>(pending.Type);
+			entry.IdHashHigh = pending.IdHashHigh;
+			entry.FileSize = pending.FileSize;
+			entries.Add(entry);
+		}
+
+		if (collided)
+		{
+			NE_LOG_ERROR("Failed to write asset registry %s", path.string().c_str());
+			return false;
+		}
+
+		// Layout: header, table, dependencies, strings; the table and dependencies stay aligned
+		const U64 entriesOffset = AssetRegistryFile::HeaderSize;
+		const U64 entriesSize = entries.GetCount() * sizeof(AssetRegistryEntry);
+		const U64 dependenciesOffset = entriesOffset + entriesSize;
+		const U64 dependenciesSize = dependencyBlock.GetCount() * sizeof(IdentifierHash);
+		const U64 stringsOffset = MappedTable::AlignUp(dependenciesOffset + dependenciesSize, alignof(AssetRegistryEntry));
+
+		BitStream body;
+		body.SetByteOrder(ByteOrder::Little);
+		for (const AssetRegistryEntry& entry : entries)
+		{
+			AssetRegistryEntry stored = entry;
+			if constexpr (ByteOrder::Native == ByteOrder::Big)
+			{
+				SwapEntry(stored);
+			}
+			body.WriteBytes(reinterpret_cast<const Byte*>(&stored), sizeof(stored));
+		}
+		for (const IdentifierHash hash : dependencyBlock)
+		{
+			body.Write<IdentifierHash>(hash);
+		}
+		while (entriesOffset + body.GetStoredBytes() < stringsOffset)
+		{
+			body.Write<U8>(0);
+		}
+		if (stringBlock.GetCount() > 0)
+		{
+			body.WriteBytes(stringBlock.GetData(), stringBlock.GetCount());
+		}
+
+		U32 tableChecksum = Checksum::Crc32c(body.GetData(), entriesSize + dependenciesSize);
+		tableChecksum = Checksum::Crc32c(body.GetData() + (stringsOffset - entriesOffset), stringBlock.GetCount(), tableChecksum);
+
+		BitStream header(AssetRegistryFile::HeaderSize);
+		header.SetByteOrder(ByteOrder::Little);
+		header.Write<U32>(AssetRegistryFile::Magic);
+		header.Write<U32>(AssetRegistryFile::Version);
+		header.Write<U32>(static_cast<U32>(entries.GetCount()));
+		header.Write<U32>(static_cast<U32>(dependencyBlock.GetCount()));
+		header.Write<U64>(entriesOffset);
+		header.Write<U64>(dependenciesOffset);
+		header.Write<U64>(stringsOffset);
+		header.Write<U64>(stringBlock.GetCount());
+		header.Write<U32>(AssetRegistryFile::IdentifierHashBits);
+		header.Write<U32>(tableChecksum);
+		header.Write<U32>(Checksum::Crc32c(header.GetData(), header.GetStoredBytes()));
+		while (header.GetStoredBytes() < AssetRegistryFile::HeaderSize)
+		{
+			header.Write<U32>(0);
+		}
+
+		// Written under a temporary name, so a failed write never leaves a truncated registry
+		fs::path tempPath = path;
+		tempPath += ".tmp";
+
+		bool succeeded = false;
+		{
+			File file(tempPath, FileMode::FILE_WRITE_REPLACE, true);
+			if (file.IsValid())
+			{
+				BufferedFileWriter writer(file);
+				succeeded = writer.Write(header) && writer.Write(body) && writer.Flush();
+			}
+		}
+
+		std::error_code error;
+		if (succeeded)
+		{
+			fs::rename(tempPath, path, error);
+			succeeded = !error;
+		}
+		if (!succeeded)
+		{
+			fs::remove(tempPath, error);
+			NE_LOG_ERROR("Failed to write asset registry %s", path.string().c_str());
+		}
+
+		return succeeded;
+	}
+
+	void AssetRegistryWriter::Clear()
+	{
+		m_Entries.Empty();
+		m_StringPool.Empty();
+		m_DependencyPool.Empty();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,210 @@
+#pragma once
+
+#include "Array.h"
+#include "Asset.h"
+#include "FileSystem.h"
+#include "MappedTable.h"
+#include "String.h"
+#include "Types.h"
+
+namespace Noble
+{
+	/**
+	 * Registration of one asset in a registry file, read in place from the mapping
+	 * Stored little-endian
+	 */
+	struct AssetRegistryEntry
+	{
+		// NIdentifier::GetHash of the asset's ID, the key the table is sorted by
+		U32 IdHash;
+		// Offset and length of the null-terminated ID in the string block
+		U32 IdOffset;
+		U32 IdLength;
+		// Offset of the null-terminated path in the string block
+		U32 PathOffset;
+		// Range of the asset's dependencies in the dependency block, as full identifier hashes
+		U32 FirstDependency;
+		U32 DependencyCount;
+		// AssetType
+		U32 Type;
+		// High half of the ID's 64-bit hash under NOBLE_WIDE_IDENTIFIERS (IdHash is the low half), 0 otherwise
+		U32 IdHashHigh;
+		// Size of the asset's file when the registry was built, 0 if unknown
+		U64 FileSize;
+	};
+
+	static_assert(sizeof(AssetRegistryEntry) == 40, "AssetRegistryEntry is part of the registry format");
+
+	/**
+	 * Compiled asset registry, the startup replacement for one RegisterAsset call per asset
+	 *
+	 * Layout: a 64-byte little-endian header, the entries sorted by ID hash, the dependency block
+	 * of identifier hashes (IdentifierHashBits wide), then the block of null-terminated IDs and paths. The file is opened as a
+	 * single MappedFile and everything is used in place: IDs and paths are handed out as pointers
+	 * into the mapping, so opening a registry costs one mapping plus a validation pass over the
+	 * table, with no parsing and no allocation per asset.
+	 */
+	class AssetRegistryFile
+	{
+	public:
+
+		// Identifies a registry ("NREG")
+		static constexpr U32 Magic = 0x4745524E;
+		// Current format version
+		static constexpr U32 Version = 4;
+		// Width of the identifier hash this build compares by, recorded since it changes GetHash
+		static constexpr U32 IdentifierHashBits = sizeof(IdentifierHash) * 8;
+		// Size of the header at the start of the file
+		static constexpr Size HeaderSize = MappedTable::HeaderSize;
+		// File extension of registries, without the leading '.'
+		static constexpr const char* Extension = "nreg";
+
+		AssetRegistryFile();
+
+		NO_COPY(AssetRegistryFile)
+
+		/**
+		 * Maps the registry and validates its header and table
+		 * Returns false if the file is missing, not a registry, or corrupt
+		 */
+		bool Open(const fs::path& path);
+
+		/**
+		 * Unmaps the registry; IDs and paths returned from it become invalid
+		 */
+		void Close();
+
+		/**
+		 * Returns true if a registry is open
+		 */
+		bool IsOpen() const { return m_Entries != nullptr; }
+
+		/**
+		 * Returns the first entry whose ID has the hash, or nullptr
+		 */
+		const AssetRegistryEntry* Find(U32 idHash) const;
+
+		/**
+		 * Returns the entries, sorted by ID hash
+		 */
+		const AssetRegistryEntry* GetEntries() const { return m_Entries; }
+
+		/**
+		 * Returns the number of entries
+		 */
+		U32 GetEntryCount() const { return m_EntryCount; }
+
+		/**
+		 * Returns the entry's ID, pointing into the mapping
+		 */
+		NIdentifier GetID(const AssetRegistryEntry& entry) const
+		{
+#ifdef NOBLE_WIDE_IDENTIFIERS
+			// Both halves of the hash are stored, so the ID isn't hashed again
+			return NIdentifier(m_Strings + entry.IdOffset, entry.IdLength, (U64(entry.IdHashHigh) << 32) | entry.IdHash);
+#else
+			return NIdentifier(m_Strings + entry.IdOffset, entry.IdLength, entry.IdHash);
+#endif
+		}
+
+		/**
+		 * Returns the entry's null-terminated path, in the mapping
+		 */
+		const char* GetPath(const AssetRegistryEntry& entry) const { return m_Strings + entry.PathOffset; }
+
+		/**
+		 * Returns the dependency block: every entry's dependencies, as identifier hashes
+		 */
+		const IdentifierHash* GetDependencies() const { return m_Dependencies; }
+
+		/**
+		 * Returns the number of identifier hashes in the dependency block
+		 */
+		U32 GetDependencyCount() const { return m_DependencyCount; }
+
+		/**
+		 * Returns true if @ptr points into the registry's string block
+		 */
+		bool OwnsString(const char* ptr) const { return ptr >= m_Strings && ptr < m_Strings + m_StringsSize; }
+
+	private:
+
+		// Mapping of the whole registry
+		MappedFile m_Mapping;
+		// Table, in the mapping or in m_SwappedEntries
+		const AssetRegistryEntry* m_Entries;
+		U32 m_EntryCount;
+		// Dependency block, in the mapping or in m_SwappedDependencies
+		const IdentifierHash* m_Dependencies;
+		U32 m_DependencyCount;
+		// String block in the mapping
+		const char* m_Strings;
+		Size m_StringsSize;
+		// Byte-swapped copies of the table and the dependency block, only used on big-endian hosts
+		Array<AssetRegistryEntry> m_SwappedEntries;
+		Array<IdentifierHash> m_SwappedDependencies;
+	};
+
+	/**
+	 * Builds registry files
+	 *
+	 * Assets are gathered with Add and written in one pass, sorted by ID hash. IDs whose 32-bit
+	 * hashes collide can't be told apart by the IDs stored in asset files, so Write refuses them.
+	 */
+	class AssetRegistryWriter
+	{
+	public:
+
+		AssetRegistryWriter();
+
+		NO_COPY_NO_MOVE(AssetRegistryWriter)
+
+		/**
+		 * Adds an asset; @dependencies are the IDs of the assets it needs loaded first
+		 * @fileSize is the size of the asset's file, or 0 if unknown. Adding an ID twice keeps the last one.
+		 */
+		void Add(const char* id, const char* path, AssetType type, U64 fileSize, const Array<NIdentifier>& dependencies);
+
+		/**
+		 * Writes the registry to @path, replacing any existing file
+		 * Returns false if IDs collide or the file can't be written
+		 */
+		bool Write(const fs::path& path);
+
+		/**
+		 * Removes every asset
+		 */
+		void Clear();
+
+		/**
+		 * Returns the number of assets added
+		 */
+		Size GetEntryCount() const { return m_Entries.GetCount(); }
+
+	private:
+
+		/**
+		 * An asset waiting to be written; offsets point into m_StringPool and m_DependencyPool
+		 */
+		struct PendingEntry
+		{
+			U32 IdHash;
+			U32 IdHashHigh;
+			U32 IdOffset;
+			U32 IdLength;
+			U32 PathOffset;
+			U32 FirstDependency;
+			U32 DependencyCount;
+			AssetType Type;
+			U64 FileSize;
+		};
+
+	private:
+
+		Array<PendingEntry> m_Entries;
+		// Null-terminated IDs and paths
+		Array<char> m_StringPool;
+		// Dependency identifier hashes
+		Array<IdentifierHash> m_DependencyPool;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,908 @@
+#include "AsyncFileIO.h"
+
+#include "Logger.h"
+
+#if defined(NOBLE_LINUX) && __has_include(<linux/io_uring.h>)
+#define NOBLE_IO_URING 1
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#define NOBLE_IO_URING 0
+#endif
+
+namespace Noble
+{
+	/**
+	 * Internal state of a single request
+	 */
+	struct AsyncIORequest
+	{
+		enum class Operation : U8
+		{
+			// Read into a caller-supplied buffer
+			Read,
+			// Read the whole file into Data
+			ReadFile,
+			// Write from Buffer, or from Data if it owns the bytes
+			Write
+		};
+
+		AsyncIORequest(Operation op, const fs::path& path, AsyncIOCallback&& callback, AsyncIOPriority priority)
+			: Handle(InvalidAsyncIOHandle), Sequence(0), Path(path), Op(op), Mode(FileMode::FILE_READ), Priority(priority),
+			Status(AsyncIOStatus::Queued), Buffer(nullptr), Length(0), Offset(0), Transferred(0),
+			Callback(std::move(callback)), Descriptor(-1)
+		{}
+
+		AsyncIOHandle Handle;
+		// Submission order, breaks priority ties
+		U64 Sequence;
+		fs::path Path;
+		Operation Op;
+		FileMode Mode;
+		AsyncIOPriority Priority;
+		AsyncIOStatus Status;
+
+		// Bytes to read into or write from
+		Byte* Buffer;
+		// Number of bytes requested
+		Size Length;
+		// File offset of the first byte
+		Size Offset;
+		// Bytes read or written so far
+		Size Transferred;
+
+		// Whole-file reads and owned writes
+		BitStream Data;
+		AsyncIOCallback Callback;
+
+		// Open file descriptor while in flight on the ring
+		int Descriptor;
+	};
+
+	/**
+	 * Queue order: higher priority first, then older first
+	 */
+	struct AsyncIORequestOrder
+	{
+		bool operator()(const AsyncIORequest* a, const AsyncIORequest* b) const
+		{
+			if (a->Priority != b->Priority)
+			{
+				return a->Priority < b->Priority;
+			}
+			return a->Sequence > b->Sequence;
+		}
+	};
+
+	namespace
+	{
+		// Bits of a handle that index its slot
+		constexpr U64 HandleSlotMask = 0xFFFFFFFFULL;
+
+		/**
+		 * Performs the request synchronously using File; used by the worker threads
+		 */
+		AsyncIOStatus ExecuteBlocking(AsyncIORequest* request)
+		{
+			switch (request->Op)
+			{
+				case AsyncIORequest::Operation::Read:
+				{
+					File file(request->Path, FileMode::FILE_READ);
+					if (!file.IsValid())
+					{
+						return AsyncIOStatus::Failed;
+					}
+					file.Seek(request->Offset);
+					request->Transferred = file.Read(request->Buffer, request->Length);
+					return AsyncIOStatus::Completed;
+				}
+				case AsyncIORequest::Operation::ReadFile:
+				{
+					File file(request->Path, FileMode::FILE_READ);
+					if (!file.IsValid())
+					{
+						return AsyncIOStatus::Failed;
+					}
+					request->Transferred = file.Read(request->Data);
+					return AsyncIOStatus::Completed;
+				}
+				case AsyncIORequest::Operation::Write:
+				{
+					File file(request->Path, request->Mode, true);
+					if (!file.IsValid())
+					{
+						return AsyncIOStatus::Failed;
+					}
+					request->Transferred = file.Write(request->Buffer, request->Length);
+					return request->Transferred == request->Length ? AsyncIOStatus::Completed : AsyncIOStatus::Failed;
+				}
+			}
+
+			return AsyncIOStatus::Failed;
+		}
+	}
+
+#if NOBLE_IO_URING
+	/**
+	 * A minimal io_uring wrapper over the raw syscalls, so there's no dependency on liburing
+	 */
+	struct IoUringContext
+	{
+		// Largest single read or write; the length field is 32 bits
+		static constexpr Size MaxTransfer = 1 << 30;
+		// user_data of the poll on the wake eventfd
+		static constexpr U64 WakeTag = 0;
+
+		IoUringContext()
+			: RingFd(-1), WakeFd(-1), SqRing(nullptr), SqRingSize(0), CqRing(nullptr), CqRingSize(0),
+			Sqes(nullptr), SqesSize(0), SqHead(nullptr), SqTail(nullptr), SqMask(nullptr), SqArray(nullptr),
+			CqHead(nullptr), CqTail(nullptr), CqMask(nullptr), Cqes(nullptr), Entries(0), LocalTail(0),
+			Unsubmitted(0), InFlight(0)
+		{}
+
+		~IoUringContext()
+		{
+			Destroy();
+		}
+
+		/**
+		 * Sets up the ring and checks that the kernel supports the operations we use
+		 */
+		bool Create(U32 entries)
+		{
+			io_uring_params params = {};
+			RingFd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+			if (RingFd < 0)
+			{
+				return false;
+			}
+
+			Entries = params.sq_entries;
+
+			SqRingSize = params.sq_off.array + params.sq_entries * sizeof(U32);
+			SqRing = ::mmap(nullptr, SqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, RingFd, IORING_OFF_SQ_RING);
+			CqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+			CqRing = ::mmap(nullptr, CqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, RingFd, IORING_OFF_CQ_RING);
+			SqesSize = params.sq_entries * sizeof(io_uring_sqe);
+			Sqes = static_cast<io_uring_sqe*>(::mmap(nullptr, SqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, RingFd, IORING_OFF_SQES));
+
+			if (SqRing == MAP_FAILED || CqRing == MAP_FAILED || Sqes == MAP_FAILED)
+			{
+				return false;
+			}
+
+			Byte* sq = static_cast<Byte*>(SqRing);
+			SqHead = reinterpret_cast<U32*>(sq + params.sq_off.head);
+			SqTail = reinterpret_cast<U32*>(sq + params.sq_off.tail);
+			SqMask = reinterpret_cast<U32*>(sq + params.sq_off.ring_mask);
+			SqArray = reinterpret_cast<U32*>(sq + params.sq_off.array);
+			LocalTail = *SqTail;
+
+			Byte* cq = static_cast<Byte*>(CqRing);
+			CqHead = reinterpret_cast<U32*>(cq + params.cq_off.head);
+			CqTail = reinterpret_cast<U32*>(cq + params.cq_off.tail);
+			CqMask = reinterpret_cast<U32*>(cq + params.cq_off.ring_mask);
+			Cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+			// READ and WRITE need 5.6, which is also when probing was added
+			alignas(io_uring_probe) Byte probeStorage[sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op)] = {};
+			io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(probeStorage);
+			if (::syscall(__NR_io_uring_register, RingFd, IORING_REGISTER_PROBE, probe, 256) < 0)
+			{
+				return false;
+			}
+			const U8 required[] = { IORING_OP_READ, IORING_OP_WRITE, IORING_OP_POLL_ADD };
+			for (U8 op : required)
+			{
+				if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED))
+				{
+					return false;
+				}
+			}
+
+			WakeFd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+			return WakeFd >= 0;
+		}
+
+		void Destroy()
+		{
+			if (Sqes && Sqes != MAP_FAILED)
+			{
+				::munmap(Sqes, SqesSize);
+			}
+			if (CqRing && CqRing != MAP_FAILED)
+			{
+				::munmap(CqRing, CqRingSize);
+			}
+			if (SqRing && SqRing != MAP_FAILED)
+			{
+				::munmap(SqRing, SqRingSize);
+			}
+			if (WakeFd >= 0)
+			{
+				::close(WakeFd);
+			}
+			if (RingFd >= 0)
+			{
+				::close(RingFd);
+			}
+
+			Sqes = nullptr;
+			CqRing = nullptr;
+			SqRing = nullptr;
+			WakeFd = -1;
+			RingFd = -1;
+		}
+
+		/**
+		 * Returns true if another request can be put in flight without overflowing the completion queue
+		 */
+		bool HasRoom() const
+		{
+			return InFlight < Entries;
+		}
+
+		/**
+		 * Claims the next submission slot; the caller must have checked HasRoom
+		 */
+		io_uring_sqe* NextSqe(U64 userData)
+		{
+			const U32 index = LocalTail & *SqMask;
+			io_uring_sqe* sqe = Sqes + index;
+			*sqe = {};
+			sqe->user_data = userData;
+
+			SqArray[index] = index;
+			++LocalTail;
+			++Unsubmitted;
+			++InFlight;
+
+			return sqe;
+		}
+
+		/**
+		 * Queues a poll on the wake eventfd, so Submit can be woken from other threads
+		 */
+		void ArmWake()
+		{
+			io_uring_sqe* sqe = NextSqe(WakeTag);
+			sqe->opcode = IORING_OP_POLL_ADD;
+			sqe->fd = WakeFd;
+			sqe->poll32_events = POLLIN;
+		}
+
+		/**
+		 * Queues the next chunk of a request's transfer
+		 */
+		void QueueTransfer(AsyncIORequest* request)
+		{
+			const bool append = request->Op == AsyncIORequest::Operation::Write && request->Mode == FileMode::FILE_WRITE_APPEND;
+
+			io_uring_sqe* sqe = NextSqe(reinterpret_cast<U64>(request));
+			sqe->opcode = request->Op == AsyncIORequest::Operation::Write ? IORING_OP_WRITE : IORING_OP_READ;
+			sqe->fd = request->Descriptor;
+			sqe->addr = reinterpret_cast<U64>(request->Buffer + request->Transferred);
+			sqe->len = static_cast<U32>(glm::min(request->Length - request->Transferred, MaxTransfer));
+			// An offset of -1 uses the file position, which O_APPEND keeps at the end
+			sqe->off = append ? ~0ULL : request->Offset + request->Transferred;
+		}
+
+		/**
+		 * Submits everything queued and blocks until at least one completion arrives
+		 */
+		bool SubmitAndWait()
+		{
+			__atomic_store_n(SqTail, LocalTail, __ATOMIC_RELEASE);
+
+			while (true)
+			{
+				const long result = ::syscall(__NR_io_uring_enter, RingFd, Unsubmitted, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+				if (result >= 0)
+				{
+					Unsubmitted -= static_cast<U32>(result);
+					return true;
+				}
+				if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+				{
+					return false;
+				}
+			}
+		}
+
+		/**
+		 * Calls @handler for each available completion, then releases them to the kernel
+		 */
+		template <typename Handler>
+		void Reap(Handler&& handler)
+		{
+			U32 head = *CqHead;
+			const U32 tail = __atomic_load_n(CqTail, __ATOMIC_ACQUIRE);
+
+			while (head != tail)
+			{
+				const io_uring_cqe& cqe = Cqes[head & *CqMask];
+				--InFlight;
+				handler(cqe.user_data, cqe.res);
+				++head;
+			}
+
+			__atomic_store_n(CqHead, head, __ATOMIC_RELEASE);
+		}
+
+		int RingFd;
+		int WakeFd;
+
+		void* SqRing;
+		Size SqRingSize;
+		void* CqRing;
+		Size CqRingSize;
+		io_uring_sqe* Sqes;
+		Size SqesSize;
+
+		U32* SqHead;
+		U32* SqTail;
+		U32* SqMask;
+		U32* SqArray;
+		U32* CqHead;
+		U32* CqTail;
+		U32* CqMask;
+		io_uring_cqe* Cqes;
+
+		// Number of submission entries
+		U32 Entries;
+		// Our copy of the submission tail, published in SubmitAndWait
+		U32 LocalTail;
+		// Entries queued but not yet taken by the kernel
+		U32 Unsubmitted;
+		// Entries submitted or queued whose completion hasn't been reaped
+		U32 InFlight;
+		// Requests with a partial transfer waiting for their next chunk
+		Array<AsyncIORequest*> Resubmit;
+	};
+#endif
+
+	AsyncFileIO::AsyncFileIO()
+		: m_NextSequence(1), m_Ring(nullptr), m_Running(false)
+	{}
+
+	AsyncFileIO::~AsyncFileIO()
+	{
+		Shutdown();
+
+		// Requests the backend never finished, which only happens if the ring failed, count as failed
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			for (AsyncIORequest* request : m_Slots)
+			{
+				if (request && (request->Status == AsyncIOStatus::Queued || request->Status == AsyncIOStatus::InFlight))
+				{
+#if NOBLE_IO_URING
+					if (request->Descriptor >= 0)
+					{
+						::close(request->Descriptor);
+						request->Descriptor = -1;
+					}
+#endif
+					request->Status = AsyncIOStatus::Failed;
+					m_Completed.Add(request);
+				}
+			}
+		}
+
+		// Callbacks can't submit anything new now, so this ends once everything has run
+		while (ProcessCompletions() > 0)
+		{
+		}
+	}
+
+	bool AsyncFileIO::Initialize(U32 workerCount, bool allowIoUring)
+	{
+		if (m_Running)
+		{
+			return false;
+		}
+
+		m_Running = true;
+
+#if NOBLE_IO_URING
+		if (allowIoUring)
+		{
+			IoUringContext* ring = new IoUringContext;
+			if (ring->Create(64))
+			{
+				m_Ring = ring;
+				m_Threads.Add(new std::thread(&AsyncFileIO::RingLoop, this));
+				NE_LOG_INFO("Async file I/O using io_uring");
+				return true;
+			}
+
+			NE_LOG_INFO("io_uring is unavailable, async file I/O falling back to worker threads");
+			delete ring;
+		}
+#endif
+
+		workerCount = glm::max(1U, workerCount);
+		for (U32 i = 0; i < workerCount; ++i)
+		{
+			m_Threads.Add(new std::thread(&AsyncFileIO::WorkerLoop, this));
+		}
+
+		return true;
+	}
+
+	void AsyncFileIO::Shutdown()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (!m_Running)
+			{
+				return;
+			}
+			m_Running = false;
+
+			// Nothing new gets started
+			for (AsyncIORequest* request : m_Queue)
+			{
+				request->Status = AsyncIOStatus::Cancelled;
+				m_Completed.Add(request);
+			}
+			m_Queue.Empty();
+		}
+
+		WakeBackend();
+		m_FinishedCondition.notify_all();
+
+		for (std::thread* thread : m_Threads)
+		{
+			thread->join();
+			delete thread;
+		}
+		m_Threads.Empty();
+
+#if NOBLE_IO_URING
+		delete m_Ring;
+		m_Ring = nullptr;
+#endif
+	}
+
+	AsyncIOHandle AsyncFileIO::Read(const fs::path& path, void* buffer, Size size, Size offset,
+		AsyncIOCallback&& callback, AsyncIOPriority priority)
+	{
+		CHECK(buffer || size == 0);
+
+		AsyncIORequest* request = new AsyncIORequest(AsyncIORequest::Operation::Read, path, std::move(callback), priority);
+		request->Buffer = static_cast<Byte*>(buffer);
+		request->Length = size;
+		request->Offset = offset;
+
+		return Submit(request);
+	}
+
+	AsyncIOHandle AsyncFileIO::ReadFile(const fs::path& path, AsyncIOCallback&& callback, AsyncIOPriority priority)
+	{
+		return Submit(new AsyncIORequest(AsyncIORequest::Operation::ReadFile, path, std::move(callback), priority));
+	}
+
+	AsyncIOHandle AsyncFileIO::Write(const fs::path& path, const void* data, Size size, FileMode mode,
+		AsyncIOCallback&& callback, AsyncIOPriority priority)
+	{
+		CHECK(data || size == 0);
+		CHECK(mode != FileMode::FILE_READ);
+
+		AsyncIORequest* request = new AsyncIORequest(AsyncIORequest::Operation::Write, path, std::move(callback), priority);
+		request->Mode = mode;
+		request->Buffer = const_cast<Byte*>(static_cast<const Byte*>(data));
+		request->Length = size;
+
+		return Submit(request);
+	}
+
+	AsyncIOHandle AsyncFileIO::Write(const fs::path& path, BitStream&& data, FileMode mode,
+		AsyncIOCallback&& callback, AsyncIOPriority priority)
+	{
+		CHECK(mode != FileMode::FILE_READ);
+
+		AsyncIORequest* request = new AsyncIORequest(AsyncIORequest::Operation::Write, path, std::move(callback), priority);
+		request->Mode = mode;
+		request->Data = std::move(data);
+		request->Buffer = request->Data.GetData();
+		request->Length = request->Data.GetStoredBytes();
+
+		return Submit(request);
+	}
+
+	AsyncIOHandle AsyncFileIO::Submit(AsyncIORequest* request)
+	{
+		AsyncIOHandle handle = InvalidAsyncIOHandle;
+		bool queued = false;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			AddLive(request);
+			handle = request->Handle;
+
+			queued = m_Running;
+			if (queued)
+			{
+				m_Queue.Push(request);
+			}
+			else
+			{
+				request->Status = AsyncIOStatus::Cancelled;
+				m_Completed.Add(request);
+			}
+		}
+
+		// Logging happens outside the lock since the logger may submit its own writes
+		if (queued)
+		{
+			WakeBackend();
+		}
+		else
+		{
+			NE_LOG_WARNING("Async file request for %s made while async I/O is not running", request->Path.string().c_str());
+		}
+
+		return handle;
+	}
+
+	bool AsyncFileIO::Cancel(AsyncIOHandle handle)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		AsyncIORequest* request = FindRequest(handle);
+		if (!request || request->Status != AsyncIOStatus::Queued)
+		{
+			return false;
+		}
+
+		m_Queue.Remove(request);
+
+		request->Status = AsyncIOStatus::Cancelled;
+		m_Completed.Add(request);
+		m_FinishedCondition.notify_all();
+
+		return true;
+	}
+
+	AsyncIOStatus AsyncFileIO::GetStatus(AsyncIOHandle handle) const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		const AsyncIORequest* request = FindRequest(handle);
+		return request ? request->Status : AsyncIOStatus::Unknown;
+	}
+
+	AsyncIOStatus AsyncFileIO::Wait(AsyncIOHandle handle)
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+
+		// Only this thread releases requests, so the pointer stays valid while waiting
+		AsyncIORequest* request = FindRequest(handle);
+		if (!request)
+		{
+			return AsyncIOStatus::Unknown;
+		}
+
+		m_FinishedCondition.wait(lock, [request]()
+		{
+			return request->Status != AsyncIOStatus::Queued && request->Status != AsyncIOStatus::InFlight;
+		});
+
+		return request->Status;
+	}
+
+	U32 AsyncFileIO::ProcessCompletions()
+	{
+		Array<AsyncIORequest*> completed;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (m_Completed.GetCount() == 0)
+			{
+				return 0;
+			}
+
+			for (AsyncIORequest* request : m_Completed)
+			{
+				completed.Add(request);
+				RemoveLive(request);
+			}
+			m_Completed.Empty();
+		}
+
+		// Callbacks run without the lock, so they're free to submit more requests
+		for (AsyncIORequest* request : completed)
+		{
+			if (request->Callback)
+			{
+				AsyncIOResult result;
+				result.Handle = request->Handle;
+				result.Status = request->Status;
+				result.BytesTransferred = request->Transferred;
+				result.Data = std::move(request->Data);
+
+				request->Callback(result);
+			}
+
+			delete request;
+		}
+
+		return static_cast<U32>(completed.GetCount());
+	}
+
+	AsyncIORequest* AsyncFileIO::FindRequest(AsyncIOHandle handle) const
+	{
+		const Size slot = handle & HandleSlotMask;
+		if (slot >= m_Slots.GetCount())
+		{
+			return nullptr;
+		}
+
+		AsyncIORequest* request = m_Slots[slot];
+		return (request && request->Handle == handle) ? request : nullptr;
+	}
+
+	void AsyncFileIO::AddLive(AsyncIORequest* request)
+	{
+		U32 slot = 0;
+		if (m_FreeSlots.GetCount() > 0)
+		{
+			slot = m_FreeSlots[m_FreeSlots.GetCount() - 1];
+			m_FreeSlots.RemoveAt(m_FreeSlots.GetCount() - 1);
+			m_Slots[slot] = request;
+		}
+		else
+		{
+			slot = static_cast<U32>(m_Slots.GetCount());
+			m_Slots.Add(request);
+		}
+
+		// The serial is the low half of the sequence and never zero, so no handle is InvalidAsyncIOHandle
+		if ((m_NextSequence & HandleSlotMask) == 0)
+		{
+			++m_NextSequence;
+		}
+		request->Sequence = m_NextSequence++;
+		request->Handle = (request->Sequence << 32) | slot;
+	}
+
+	void AsyncFileIO::RemoveLive(AsyncIORequest* request)
+	{
+		const U32 slot = static_cast<U32>(request->Handle & HandleSlotMask);
+		CHECK(m_Slots[slot] == request);
+
+		m_Slots[slot] = nullptr;
+		m_FreeSlots.Add(slot);
+	}
+
+	AsyncIORequest* AsyncFileIO::PopQueued()
+	{
+		if (m_Queue.GetCount() == 0)
+		{
+			return nullptr;
+		}
+
+		AsyncIORequest* request = m_Queue.Pop();
+
+		request->Status = AsyncIOStatus::InFlight;
+		return request;
+	}
+
+	void AsyncFileIO::Finish(AsyncIORequest* request, AsyncIOStatus status)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			request->Status = status;
+			m_Completed.Add(request);
+		}
+
+		m_FinishedCondition.notify_all();
+	}
+
+	void AsyncFileIO::WakeBackend()
+	{
+#if NOBLE_IO_URING
+		if (m_Ring)
+		{
+			// A full counter already has a wake pending, so only other errors matter
+			const U64 one = 1;
+			if (::write(m_Ring->WakeFd, &one, sizeof(one)) != sizeof(one) && errno != EAGAIN)
+			{
+				NE_LOG_ERROR("Failed to wake the io_uring thread - Error Msg: %s", strerror(errno));
+			}
+			return;
+		}
+#endif
+		m_QueueCondition.notify_all();
+	}
+
+	void AsyncFileIO::WorkerLoop()
+	{
+		while (true)
+		{
+			AsyncIORequest* request = nullptr;
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_QueueCondition.wait(lock, [this]() { return !m_Running || m_Queue.GetCount() > 0; });
+
+				request = PopQueued();
+				if (!request)
+				{
+					// Only reached once shutting down with an empty queue
+					return;
+				}
+			}
+
+			Finish(request, ExecuteBlocking(request));
+		}
+	}
+
+#if NOBLE_IO_URING
+	void AsyncFileIO::RingLoop()
+	{
+		IoUringContext& ring = *m_Ring;
+		Array<AsyncIORequest*> starting;
+		bool wakeArmed = false;
+
+		while (true)
+		{
+			if (!wakeArmed && m_Running)
+			{
+				ring.ArmWake();
+				wakeArmed = true;
+			}
+
+			// Continue partial transfers first, oldest first, then start queued requests in priority order
+			Size resumed = 0;
+			while (resumed < ring.Resubmit.GetCount() && ring.HasRoom())
+			{
+				ring.QueueTransfer(ring.Resubmit[resumed++]);
+			}
+			if (resumed > 0)
+			{
+				ring.Resubmit.RemoveMultiple(0, resumed);
+			}
+
+			starting.Empty();
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				for (U32 room = ring.Entries - ring.InFlight; room > 0; --room)
+				{
+					AsyncIORequest* request = PopQueued();
+					if (!request)
+					{
+						break;
+					}
+					starting.Add(request);
+				}
+			}
+
+			for (AsyncIORequest* request : starting)
+			{
+				int flags = O_CLOEXEC;
+				switch (request->Op)
+				{
+					case AsyncIORequest::Operation::Read:
+					case AsyncIORequest::Operation::ReadFile:
+						flags |= O_RDONLY;
+						break;
+					case AsyncIORequest::Operation::Write:
+						flags |= O_WRONLY | O_CREAT | (request->Mode == FileMode::FILE_WRITE_APPEND ? O_APPEND : O_TRUNC);
+						break;
+				}
+
+				request->Descriptor = ::open(request->Path.c_str(), flags, 0644);
+				if (request->Descriptor < 0)
+				{
+					Finish(request, AsyncIOStatus::Failed);
+					continue;
+				}
+
+				if (request->Op == AsyncIORequest::Operation::ReadFile)
+				{
+					struct stat info;
+					if (::fstat(request->Descriptor, &info) != 0)
+					{
+						::close(request->Descriptor);
+						Finish(request, AsyncIOStatus::Failed);
+						continue;
+					}
+
+					request->Length = static_cast<Size>(info.st_size);
+					if (request->Length > 0)
+					{
+						request->Data.Resize(request->Length);
+						request->Buffer = request->Data.GetData();
+					}
+				}
+
+				if (request->Length == 0)
+				{
+					::close(request->Descriptor);
+					Finish(request, AsyncIOStatus::Completed);
+					continue;
+				}
+
+				ring.QueueTransfer(request);
+			}
+
+			// Shutting down with nothing left in flight; a pending wake poll dies with the ring
+			if (!m_Running && ring.InFlight == (wakeArmed ? 1U : 0U) && ring.Resubmit.GetCount() == 0)
+			{
+				return;
+			}
+
+			if (!ring.SubmitAndWait())
+			{
+				NE_LOG_ERROR("io_uring_enter failed - Error Msg: %s", strerror(errno));
+				return;
+			}
+
+			ring.Reap([&](U64 userData, I32 result)
+			{
+				if (userData == IoUringContext::WakeTag)
+				{
+					// Clears the counter so the next poll waits again; it may already have been read
+					U64 value;
+					if (::read(ring.WakeFd, &value, sizeof(value)) != sizeof(value) && errno != EAGAIN)
+					{
+						NE_LOG_WARNING("Failed to clear the io_uring wake counter - Error Msg: %s", strerror(errno));
+					}
+					wakeArmed = false;
+					return;
+				}
+
+				AsyncIORequest* request = reinterpret_cast<AsyncIORequest*>(userData);
+				if (result == -EINTR || result == -EAGAIN)
+				{
+					ring.Resubmit.Add(request);
+					return;
+				}
+
+				AsyncIOStatus status = AsyncIOStatus::InFlight;
+				if (result < 0)
+				{
+					status = AsyncIOStatus::Failed;
+				}
+				else
+				{
+					request->Transferred += static_cast<Size>(result);
+					if (request->Transferred == request->Length)
+					{
+						status = AsyncIOStatus::Completed;
+					}
+					else if (result == 0)
+					{
+						// End of file for reads; a write that makes no progress has failed
+						status = request->Op == AsyncIORequest::Operation::Write ? AsyncIOStatus::Failed : AsyncIOStatus::Completed;
+					}
+				}
+
+				if (status == AsyncIOStatus::InFlight)
+				{
+					ring.Resubmit.Add(request);
+					return;
+				}
+
+				if (request->Op == AsyncIORequest::Operation::ReadFile)
+				{
+					request->Data.UpdateStoredBytes(request->Transferred);
+				}
+
+				::close(request->Descriptor);
+				request->Descriptor = -1;
+				Finish(request, status);
+			});
+		}
+	}
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,260 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "Array.h"
+#include "BitStream.h"
+#include "FileSystem.h"
+#include "Functional.h"
+#include "PriorityQueue.h"
+#include "Types.h"
+
+namespace Noble
+{
+	/**
+	 * Identifies a request made to AsyncFileIO
+	 * The low 32 bits index the request's slot and the high 32 bits are a serial number, so a
+	 * stale handle is simply not found even once its slot is reused
+	 */
+	typedef U64 AsyncIOHandle;
+
+	// Handle value that never refers to a request
+	constexpr AsyncIOHandle InvalidAsyncIOHandle = 0;
+
+	/**
+	 * Lifecycle of an asynchronous request
+	 */
+	enum class AsyncIOStatus : U8
+	{
+		// Waiting in the queue, can still be cancelled
+		Queued,
+		// Handed to the OS or a worker thread
+		InFlight,
+		// Finished; the result may have transferred fewer bytes than requested
+		Completed,
+		// The file could not be opened or the transfer failed
+		Failed,
+		// Cancelled before it was started
+		Cancelled,
+		// The handle does not refer to a live request
+		Unknown
+	};
+
+	/**
+	 * Queue order of requests; higher priorities are started first,
+	 * requests of the same priority start in submission order
+	 */
+	enum class AsyncIOPriority : U8
+	{
+		Low,
+		Normal,
+		High,
+		Critical
+	};
+
+	/**
+	 * Passed to a request's completion callback
+	 */
+	struct AsyncIOResult
+	{
+		// Handle of the finished request
+		AsyncIOHandle Handle;
+		// Final status
+		AsyncIOStatus Status;
+		// Number of bytes read or written
+		Size BytesTransferred;
+		// File contents for reads that didn't supply a buffer, or the data of owned writes
+		// The callback may move it out
+		BitStream Data;
+	};
+
+	// Completion callback, always called from AsyncFileIO::ProcessCompletions
+	typedef UniqueDelegate<void(AsyncIOResult&)> AsyncIOCallback;
+
+	// Defined in AsyncFileIO.cpp
+	struct AsyncIORequest;
+	struct AsyncIORequestOrder;
+	struct IoUringContext;
+
+	/**
+	 * Performs file reads and writes away from the calling thread
+	 *
+	 * Requests go into a priority queue and are serviced by io_uring on Linux, falling back to a
+	 * small pool of worker threads (always used on Windows) when the ring can't be created.
+	 * The io_uring path batches everything that's queued into a single submission.
+	 *
+	 * Completion callbacks are deferred until the owning thread calls ProcessCompletions, so they
+	 * never race with game code; the engine does this once per frame. Submitting is thread-safe,
+	 * but Wait, Cancel and ProcessCompletions belong to the owning thread.
+	 *
+	 * This serves copying reads and writes, such as log dumps. Assets don't go through it: the
+	 * AssetLoader maps their files on its own threads so they can be used in place.
+	 */
+	class AsyncFileIO
+	{
+	public:
+
+		AsyncFileIO();
+
+		/**
+		 * Stops the backend, cancelling anything still queued, then runs the callbacks of every
+		 * request left so none is dropped silently
+		 */
+		~AsyncFileIO();
+
+		NO_COPY_NO_MOVE(AsyncFileIO)
+
+		/**
+		 * Starts the backend
+		 * @workerCount is the number of threads used when io_uring is not available, or when
+		 * @allowIoUring is false, which tests use to cover both backends on Linux
+		 */
+		bool Initialize(U32 workerCount = 2, bool allowIoUring = true);
+
+		/**
+		 * Cancels queued requests, waits for in-flight ones and stops the backend
+		 * Callbacks of finished requests still run on the next ProcessCompletions
+		 */
+		void Shutdown();
+
+		/**
+		 * Reads @size bytes at @offset into @buffer, which must stay valid until completion
+		 */
+		AsyncIOHandle Read(const fs::path& path, void* buffer, Size size, Size offset = 0,
+			AsyncIOCallback&& callback = AsyncIOCallback(), AsyncIOPriority priority = AsyncIOPriority::Normal);
+
+		/**
+		 * Reads the whole file into AsyncIOResult::Data
+		 */
+		AsyncIOHandle ReadFile(const fs::path& path,
+			AsyncIOCallback&& callback = AsyncIOCallback(), AsyncIOPriority priority = AsyncIOPriority::Normal);
+
+		/**
+		 * Writes @size bytes from @data, which must stay valid until completion
+		 * Replace mode truncates the file first; both write modes create the file if needed
+		 */
+		AsyncIOHandle Write(const fs::path& path, const void* data, Size size, FileMode mode = FileMode::FILE_WRITE_REPLACE,
+			AsyncIOCallback&& callback = AsyncIOCallback(), AsyncIOPriority priority = AsyncIOPriority::Normal);
+
+		/**
+		 * Writes the stored bytes of @data, taking ownership of the stream
+		 */
+		AsyncIOHandle Write(const fs::path& path, BitStream&& data, FileMode mode = FileMode::FILE_WRITE_REPLACE,
+			AsyncIOCallback&& callback = AsyncIOCallback(), AsyncIOPriority priority = AsyncIOPriority::Normal);
+
+		/**
+		 * Cancels a request that hasn't started yet
+		 * Returns false if it is already in flight or finished; its callback still runs either way
+		 */
+		bool Cancel(AsyncIOHandle handle);
+
+		/**
+		 * Returns the current status of the request, or Unknown once its completion was processed
+		 */
+		AsyncIOStatus GetStatus(AsyncIOHandle handle) const;
+
+		/**
+		 * Blocks until the request finishes and returns its final status
+		 * The callback still runs in the next ProcessCompletions
+		 */
+		AsyncIOStatus Wait(AsyncIOHandle handle);
+
+		/**
+		 * Runs the callbacks of every finished request and releases them
+		 * Returns the number of requests processed
+		 */
+		U32 ProcessCompletions();
+
+		/**
+		 * Returns true if requests are serviced by io_uring rather than worker threads
+		 */
+		bool IsUsingIoUring() const { return m_Ring != nullptr; }
+
+		/**
+		 * Returns true between Initialize and Shutdown
+		 */
+		bool IsRunning() const { return m_Running; }
+
+	private:
+
+		/**
+		 * Creates a request and queues it
+		 */
+		AsyncIOHandle Submit(AsyncIORequest* request);
+
+		/**
+		 * Returns the live request for the handle, or nullptr
+		 * Caller must hold m_Mutex
+		 */
+		AsyncIORequest* FindRequest(AsyncIOHandle handle) const;
+
+		/**
+		 * Gives the request a slot and a handle
+		 * Caller must hold m_Mutex
+		 */
+		void AddLive(AsyncIORequest* request);
+
+		/**
+		 * Frees the request's slot, after which its handle is no longer found
+		 * Caller must hold m_Mutex
+		 */
+		void RemoveLive(AsyncIORequest* request);
+
+		/**
+		 * Removes the highest priority request from the queue and marks it in flight
+		 * Caller must hold m_Mutex. Returns nullptr if the queue is empty
+		 */
+		AsyncIORequest* PopQueued();
+
+		/**
+		 * Records the final status and moves the request to the completed list
+		 */
+		void Finish(AsyncIORequest* request, AsyncIOStatus status);
+
+		/**
+		 * Worker thread loop for the thread-pool backend
+		 */
+		void WorkerLoop();
+
+		/**
+		 * I/O thread loop for the io_uring backend
+		 */
+		void RingLoop();
+
+		/**
+		 * Wakes whichever backend is waiting for new requests
+		 */
+		void WakeBackend();
+
+	private:
+
+		// Guards the queue, the live request list and the completed list
+		mutable std::mutex m_Mutex;
+		// Signalled when requests are queued (worker backend)
+		std::condition_variable m_QueueCondition;
+		// Signalled when a request finishes
+		std::condition_variable m_FinishedCondition;
+
+		// Queued requests, by priority then submission order
+		PriorityQueue<AsyncIORequest*, AsyncIORequestOrder> m_Queue;
+		// Every request that hasn't had its completion processed yet, indexed by the low half
+		// of its handle; null slots are listed in m_FreeSlots
+		Array<AsyncIORequest*> m_Slots;
+		Array<U32> m_FreeSlots;
+		// Requests waiting for ProcessCompletions
+		Array<AsyncIORequest*> m_Completed;
+
+		// Source of FIFO order within a priority and of handle serial numbers
+		U64 m_NextSequence;
+
+		// Worker threads, or the single ring thread
+		Array<std::thread*> m_Threads;
+		// io_uring state, null when using worker threads
+		IoUringContext* m_Ring;
+		// Set while the backend should keep running
+		std::atomic<bool> m_Running;
+	};
+}
\ No newline at end of file
@@ -1,17 +1,544 @@
 #pragma once
 
+#include <bit>
+#include <cstring>
+#include <type_traits>
+
 #include "HelperMacros.h"
 #include "Memory.h"
 #include "Types.h"
 
+#ifdef NOBLE_WINDOWS
+#include <stdlib.h>
+#endif
+
 namespace Noble
 {
+	/**
+	 * Byte order of the values stored in a BitStream
+	 */
+	enum class ByteOrder : U8
+	{
+		Little,
+		Big,
+		Native = (std::endian::native == std::endian::little) ? Little : Big
+	};
+
+	/**
+	 * Describes the scalar unit a type is made of, which is what gets byte-swapped when a
+	 * BitStream is not in native byte order. Arithmetic types are their own unit and glm
+	 * types use their value_type; specialize this for plain structs of a single scalar type
+	 * that are stored in a stream with a fixed byte order.
+	 */
+	template <typename T, typename = void>
+	struct ByteSwapUnit
+	{
+		typedef void Type;
+	};
+
+	template <typename T>
+	struct ByteSwapUnit<T, std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>>>
+	{
+		typedef T Type;
+	};
+
+	template <typename T>
+	struct ByteSwapUnit<T, std::enable_if_t<std::is_arithmetic_v<typename T::value_type>>>
+	{
+		typedef typename T::value_type Type;
+	};
+
+	namespace BitStreamHelper
+	{
+		/**
+		 * Returns a mask covering the lowest @count bits
+		 */
+		constexpr U64 BitMask(const U32 count)
+		{
+			return count >= 64 ? ~0ULL : (1ULL << count) - 1;
+		}
+
+		// Largest magnitude of the three smallest components of a unit quaternion (1 / sqrt(2))
+		constexpr F32 QuatComponentLimit = 0.70710678F;
+	}
+
+	namespace ByteOrderHelper
+	{
+		/**
+		 * Reverses the bytes of @count consecutive scalars of @unitSize bytes each
+		 */
+		inline void SwapUnits(void* data, const Size unitSize, const Size count)
+		{
+			UByte* bytes = static_cast<UByte*>(data);
+			switch (unitSize)
+			{
+				case 1:
+				{
+					break;
+				}
+				case 2:
+				{
+					for (Size i = 0; i < count; ++i, bytes += 2)
+					{
+						U16 v;
+						std::memcpy(&v, bytes, 2);
+#ifdef NOBLE_WINDOWS
+						v = _byteswap_ushort(v);
+#else
+						v = __builtin_bswap16(v);
+#endif
+						std::memcpy(bytes, &v, 2);
+					}
+					break;
+				}
+				case 4:
+				{
+					for (Size i = 0; i < count; ++i, bytes += 4)
+					{
+						U32 v;
+						std::memcpy(&v, bytes, 4);
+#ifdef NOBLE_WINDOWS
+						v = _byteswap_ulong(v);
+#else
+						v = __builtin_bswap32(v);
+#endif
+						std::memcpy(bytes, &v, 4);
+					}
+					break;
+				}
+				case 8:
+				{
+					for (Size i = 0; i < count; ++i, bytes += 8)
+					{
+						U64 v;
+						std::memcpy(&v, bytes, 8);
+#ifdef NOBLE_WINDOWS
+						v = _byteswap_uint64(v);
+#else
+						v = __builtin_bswap64(v);
+#endif
+						std::memcpy(bytes, &v, 8);
+					}
+					break;
+				}
+				default:
+				{
+					for (Size i = 0; i < count; ++i, bytes += unitSize)
+					{
+						for (Size lo = 0, hi = unitSize - 1; lo < hi; ++lo, --hi)
+						{
+							UByte tmp = bytes[lo];
+							bytes[lo] = bytes[hi];
+							bytes[hi] = tmp;
+						}
+					}
+					break;
+				}
+			}
+		}
+
+		/**
+		 * Byte-swaps every scalar in an array of T
+		 * Native-order streams never get here, so only types stored with a fixed byte order
+		 * need a ByteSwapUnit specialization
+		 */
+		template <typename T>
+		void SwapElements(T* elements, const Size count)
+		{
+			typedef typename ByteSwapUnit<T>::Type Unit;
+			if constexpr (std::is_void_v<Unit>)
+			{
+				// Type needs a ByteSwapUnit specialization to be stored in a byte-swapped stream
+				CHECK(false);
+			}
+			else
+			{
+				static_assert(sizeof(T) % sizeof(Unit) == 0, "ByteSwapUnit must evenly divide the type");
+
+				SwapUnits(elements, sizeof(Unit), count * (sizeof(T) / sizeof(Unit)));
+			}
+		}
+	}
+
+	/**
+	 * Reading side shared by BitStreamBase and BitStreamView, so the two decode a stream the
+	 * same way. Derived provides GetData() and GetReadLimit(), the number of readable bytes.
+	 *
+	 * Whole values (Read, ReadArray, ReadBytes) start on the next byte boundary; bit packed
+	 * values (ReadBits and the helpers built on it) are pulled a byte at a time, in the
+	 * little-endian bit order BitStreamBase writes them in.
+	 */
+	template <typename Derived>
+	class BitStreamReader
+	{
+	public:
+
+		/**
+		 * Returns the current position of the reader
+		 */
+		Size GetReaderPos() const
+		{
+			return m_ReaderPos;
+		}
+
+		/**
+		 * Returns the number of bytes left to read
+		 */
+		Size GetRemainingBytes() const
+		{
+			return GetReadSize() - m_ReaderPos;
+		}
+
+		/**
+		 * Returns true if there are still bytes to read
+		 * False if the stream has been fully read
+		 */
+		const bool IsReadable() const
+		{
+			return m_ReaderPos < GetReadSize();
+		}
+
+		/**
+		 * Moves the reader to the given byte offset
+		 */
+		void Seek(const Size pos)
+		{
+			CHECK(pos <= GetReadSize());
+
+			AlignRead();
+			m_ReaderPos = pos;
+		}
+
+		/**
+		 * Advances the reader by the given number of bytes
+		 */
+		void Skip(const Size bytes)
+		{
+			Seek(m_ReaderPos + bytes);
+		}
+
+		/**
+		 * Sets the byte order typed values are stored in
+		 * Orders other than ByteOrder::Native cost a byte swap per scalar
+		 */
+		void SetByteOrder(const ByteOrder order)
+		{
+			m_SwapBytes = (order != ByteOrder::Native);
+		}
+
+		/**
+		 * Returns the byte order typed values are stored in
+		 */
+		ByteOrder GetByteOrder() const
+		{
+			if (m_SwapBytes)
+			{
+				return ByteOrder::Native == ByteOrder::Little ? ByteOrder::Big : ByteOrder::Little;
+			}
+			return ByteOrder::Native;
+		}
+
+		/**
+		 * Reads an arbitrary value from the Stream
+		 */
+		template <typename T>
+		T Read()
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "BitStream can only store trivially copyable types");
+
+			AlignRead();
+
+			CHECK(m_ReaderPos + sizeof(T) <= GetReadSize());
+
+			// Copy out rather than casting, the read position has no alignment guarantees
+			T value;
+			std::memcpy(&value, GetReadData() + m_ReaderPos, sizeof(T));
+			m_ReaderPos += sizeof(T);
+
+			if (m_SwapBytes)
+			{
+				ByteOrderHelper::SwapElements(&value, 1);
+			}
+			return value;
+		}
+
+		/**
+		 * Reads @count values into the given array in one copy
+		 * Returns the number of values actually read
+		 */
+		template <typename T>
+		Size ReadArray(T* values, const Size count)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "BitStream can only store trivially copyable types");
+
+			AlignRead();
+
+			// Don't read beyond the end of the buffer
+			const Size toRead = glm::min(count, GetRemainingBytes() / sizeof(T));
+			if (toRead == 0)
+			{
+				return 0;
+			}
+			CHECK(values);
+
+			std::memcpy(values, GetReadData() + m_ReaderPos, sizeof(T) * toRead);
+			m_ReaderPos += sizeof(T) * toRead;
+
+			if (m_SwapBytes)
+			{
+				ByteOrderHelper::SwapElements(values, toRead);
+			}
+			return toRead;
+		}
+
+		/**
+		 * Reads the requested number of bytes into the given buffer
+		 * Returns the number of bytes actually read
+		 */
+		Size ReadBytes(UByte* data, const Size count)
+		{
+			AlignRead();
+
+			// Don't read beyond the end of the buffer
+			Size bytesToRead = glm::min(count, GetRemainingBytes());
+			if (bytesToRead > 0)
+			{
+				std::memcpy(data, GetReadData() + m_ReaderPos, bytesToRead);
+				m_ReaderPos += bytesToRead;
+			}
+
+			return bytesToRead;
+		}
+
+		/**
+		 * Returns a pointer to the next @count bytes and advances past them, without copying
+		 * Returns nullptr if fewer than @count bytes remain
+		 */
+		const Byte* ReadSpan(const Size count)
+		{
+			AlignRead();
+
+			if (count > GetRemainingBytes())
+			{
+				return nullptr;
+			}
+
+			const Byte* span = GetReadData() + m_ReaderPos;
+			m_ReaderPos += count;
+			return span;
+		}
+
+		// BIT PACKING
+
+		/**
+		 * Reads @count bits (1 to 64) written with BitStreamBase::WriteBits
+		 */
+		U64 ReadBits(const U32 count)
+		{
+			CHECK(count > 0 && count <= 64);
+
+			if (count > 32)
+			{
+				U64 low = ReadBits(32);
+				return low | (ReadBits(count - 32) << 32);
+			}
+
+			while (m_ReadBits < count)
+			{
+				CHECK(m_ReaderPos < GetReadSize());
+
+				m_ReadScratch |= static_cast<U64>(static_cast<UByte>(GetReadData()[m_ReaderPos++])) << m_ReadBits;
+				m_ReadBits += 8;
+			}
+
+			U64 result = m_ReadScratch & BitStreamHelper::BitMask(count);
+			m_ReadScratch >>= count;
+			m_ReadBits -= count;
+
+			return result;
+		}
+
+		/**
+		 * Reads a single bit
+		 */
+		bool ReadBool()
+		{
+			return ReadBits(1) != 0;
+		}
+
+		/**
+		 * Discards the padding bits left in the current byte so the next read starts on a byte boundary
+		 */
+		void AlignRead()
+		{
+			m_ReadScratch = 0;
+			m_ReadBits = 0;
+		}
+
+		// VARIABLE LENGTH INTEGERS
+
+		/**
+		 * Reads an unsigned integer written with BitStreamBase::WriteVarUInt
+		 */
+		U64 ReadVarUInt()
+		{
+			U64 result = 0;
+			for (U32 shift = 0; shift < 64; shift += 7)
+			{
+				U64 group = ReadBits(8);
+				result |= (group & 0x7F) << shift;
+				if ((group & 0x80) == 0)
+				{
+					break;
+				}
+			}
+			return result;
+		}
+
+		/**
+		 * Reads a signed integer written with BitStreamBase::WriteVarInt
+		 */
+		I64 ReadVarInt()
+		{
+			return ZigZagDecode(ReadVarUInt());
+		}
+
+		/**
+		 * Reverses BitStreamBase::ZigZagEncode
+		 */
+		static constexpr I64 ZigZagDecode(const U64 value)
+		{
+			return static_cast<I64>(value >> 1) ^ -static_cast<I64>(value & 1);
+		}
+
+		// QUANTIZATION
+
+		/**
+		 * Reads a float written with BitStreamBase::WriteQuantizedFloat using the same range and bits
+		 */
+		F32 ReadQuantizedFloat(const F32 min, const F32 max, const U32 bits)
+		{
+			CHECK(max > min && bits > 0 && bits <= 32);
+
+			const F64 normalized = static_cast<F64>(ReadBits(bits)) / BitStreamHelper::BitMask(bits);
+			return static_cast<F32>(min + normalized * (static_cast<F64>(max) - min));
+		}
+
+		/**
+		 * Reads a vector written with BitStreamBase::WriteQuantizedVector
+		 */
+		template <glm::length_t L>
+		glm::vec<L, F32> ReadQuantizedVector(const F32 min, const F32 max, const U32 bits)
+		{
+			glm::vec<L, F32> result;
+			for (glm::length_t i = 0; i < L; ++i)
+			{
+				result[i] = ReadQuantizedFloat(min, max, bits);
+			}
+			return result;
+		}
+
+		/**
+		 * Reads a rotation written with BitStreamBase::WriteQuantizedQuaternion
+		 */
+		Quaternion ReadQuantizedQuaternion(const U32 bitsPerComponent = 10)
+		{
+			const U32 largest = static_cast<U32>(ReadBits(2));
+
+			F32 comps[4];
+			F32 sumSquares = 0.0F;
+			for (U32 i = 0; i < 4; ++i)
+			{
+				if (i != largest)
+				{
+					comps[i] = ReadQuantizedFloat(-BitStreamHelper::QuatComponentLimit, BitStreamHelper::QuatComponentLimit, bitsPerComponent);
+					sumSquares += comps[i] * comps[i];
+				}
+			}
+			comps[largest] = glm::sqrt(glm::max(0.0F, 1.0F - sumSquares));
+
+			return glm::normalize(Quaternion(comps[3], comps[0], comps[1], comps[2]));
+		}
+
+	protected:
+
+		BitStreamReader()
+		{
+			m_SwapBytes = false;
+			ClearReadState();
+		}
+
+		/**
+		 * Resets the reader to the start, dropping any partially read bits
+		 */
+		void ClearReadState()
+		{
+			m_ReaderPos = 0;
+			m_ReadScratch = 0;
+			m_ReadBits = 0;
+		}
+
+		/**
+		 * Copies the reader position, bit state and byte order from another reader
+		 */
+		void CopyReadState(const BitStreamReader& other)
+		{
+			m_ReaderPos = other.m_ReaderPos;
+			m_ReadScratch = other.m_ReadScratch;
+			m_ReadBits = other.m_ReadBits;
+			m_SwapBytes = other.m_SwapBytes;
+		}
+
+	private:
+
+		/**
+		 * Returns the start of the readable bytes
+		 */
+		const Byte* GetReadData() const
+		{
+			return static_cast<const Derived*>(this)->GetData();
+		}
+
+		/**
+		 * Returns the number of readable bytes
+		 */
+		Size GetReadSize() const
+		{
+			return static_cast<const Derived*>(this)->GetReadLimit();
+		}
+
+	protected:
+
+		// Current position of the reader
+		Size m_ReaderPos;
+		// Bits pulled from the buffer but not yet read
+		U64 m_ReadScratch;
+		// Number of valid bits in m_ReadScratch
+		U32 m_ReadBits;
+		// Whether typed values are byte-swapped on the way in and out
+		bool m_SwapBytes;
+	};
+
 	/**
 	 * This container allows writing and reading arbitrary values to a buffer
+	 *
+	 * Values can be written whole (Write, WriteBytes) or packed at bit granularity
+	 * (WriteBits and the varint/quantized helpers built on it). Packed bits are gathered
+	 * in a 64-bit scratch word and flushed to the buffer 32 bits at a time, in little-endian
+	 * bit order. Whole-value writes and reads first align to the next byte boundary, so the
+	 * two styles can be mixed freely as long as reads mirror the writes.
+	 *
+	 * Values are stored in native byte order by default. SetByteOrder() makes the stream
+	 * swap typed values (Write/Read/WriteArray/ReadArray) to and from a fixed order, which
+	 * keeps files portable at the cost of a swap pass on hosts of the other endianness.
 	 */
 	template <typename Allocator>
-	class BitStreamBase
+	class BitStreamBase : public BitStreamReader<BitStreamBase<Allocator>>
 	{
+		typedef BitStreamReader<BitStreamBase<Allocator>> Reader;
+		friend Reader;
+		using Reader::m_SwapBytes;
+
 	public:
 
 		/**
@@ -20,9 +547,9 @@ namespace Noble
 		BitStreamBase()
 			: m_Allocator()
 		{
-			m_ReaderPos = 0;
 			m_StoredBytes = 0;
 			m_MaxBytes = 0;
+			ClearBitState();
 		}
 
 		/**
@@ -53,9 +580,9 @@ namespace Noble
 		BitStreamBase(const BitStreamBase& other)
 			: m_Allocator(other.m_Allocator)
 		{
-			m_ReaderPos = other.m_ReaderPos;
 			m_StoredBytes = other.m_StoredBytes;
 			m_MaxBytes = other.m_MaxBytes;
+			CopyBitState(other);
 		}
 
 		/**
@@ -65,13 +592,13 @@ namespace Noble
 		BitStreamBase(BitStreamBase&& other)
 			: m_Allocator(std::move(other.m_Allocator))
 		{
-			m_ReaderPos = other.m_ReaderPos;
 			m_StoredBytes = other.m_StoredBytes;
 			m_MaxBytes = other.m_MaxBytes;
+			CopyBitState(other);
 
-			other.m_ReaderPos = 0;
 			other.m_StoredBytes = 0;
 			other.m_MaxBytes = 0;
+			other.ClearBitState();
 		}
 
 		/**
@@ -80,9 +607,11 @@ namespace Noble
 		BitStreamBase& operator=(const BitStreamBase& other)
 		{
 			m_Allocator = other.m_Allocator;
-			m_ReaderPos = other.m_ReaderPos;
 			m_StoredBytes = other.m_StoredBytes;
 			m_MaxBytes = other.m_MaxBytes;
+			CopyBitState(other);
+
+			return *this;
 		}
 
 		/**
@@ -93,13 +622,15 @@ namespace Noble
 		{
 			m_Allocator = std::move(other.m_Allocator);
 
-			m_ReaderPos = other.m_ReaderPos;
 			m_StoredBytes = other.m_StoredBytes;
 			m_MaxBytes = other.m_MaxBytes;
+			CopyBitState(other);
 
-			other.m_ReaderPos = 0;
 			other.m_StoredBytes = 0;
 			other.m_MaxBytes = 0;
+			other.ClearBitState();
+
+			return *this;
 		}
 
 		/**
@@ -145,6 +676,7 @@ namespace Noble
 
 		/**
 		 * Returns the number of bytes stored in the BitStream
+		 * Bits written with WriteBits are not counted until they are flushed
 		 */
 		const Size GetStoredBytes() const
 		{
@@ -161,36 +693,49 @@ namespace Noble
 		}
 
 		/**
-		 * Returns true if there are still bytes to read in the BitStream
-		 * False if the stream has been fully read
+		 * Writes an arbitrary type to the BitStream
 		 */
-		const bool IsReadable() const
+		template <typename T>
+		void Write(T value)
 		{
-			return m_ReaderPos < m_StoredBytes;
+			static_assert(std::is_trivially_copyable_v<T>, "BitStream can only store trivially copyable types");
+
+			if (m_SwapBytes)
+			{
+				ByteOrderHelper::SwapElements(&value, 1);
+			}
+
+			AlignWrite();
+			MakeRoom(sizeof(T));
+
+			std::memcpy(GetData() + m_StoredBytes, &value, sizeof(T));
+			m_StoredBytes += sizeof(T);
 		}
 
 		/**
-		 * Writes an arbitrary type to the BitStream
+		 * Writes an array of @count values in one copy
 		 */
 		template <typename T>
-		void Write(T value)
+		void WriteArray(const T* values, const Size count)
 		{
-			// Make room to store a value of size T
-			MakeRoom(sizeof(T));
-			
-			// Use a union to make a Byte[] alias of the type
-			union
+			static_assert(std::is_trivially_copyable_v<T>, "BitStream can only store trivially copyable types");
+
+			if (count == 0)
 			{
-				T* as_T;
-				Byte* as_byte_array;
-			};
-			as_T = &value;
+				return;
+			}
+			CHECK(values);
+
+			AlignWrite();
+			MakeRoom(sizeof(T) * count);
 
-			// Write the data
-			for (I32 i = 0; i < sizeof(T); ++i)
+			T* dest = reinterpret_cast<T*>(GetData() + m_StoredBytes);
+			std::memcpy(dest, values, sizeof(T) * count);
+			if (m_SwapBytes)
 			{
-				GetData()[m_StoredBytes++] = as_byte_array[i];
+				ByteOrderHelper::SwapElements(dest, count);
 			}
+			m_StoredBytes += sizeof(T) * count;
 		}
 
 		/**
@@ -200,69 +745,241 @@ namespace Noble
 		{
 			CHECK(data && count > 0);
 
+			AlignWrite();
+
 			// Make room for the new bytes
 			MakeRoom(count);
 
-			// Write the data
-			for (I32 i = 0; i < count; ++i)
+			std::memcpy(GetData() + m_StoredBytes, data, count);
+			m_StoredBytes += count;
+		}
+
+		
+		/**
+		 * Resets the BitStream to an empty state
+		 */
+		void Reset()
+		{
+			m_Allocator.Reset();
+			m_StoredBytes = 0;
+			m_MaxBytes = 0;
+			ClearBitState();
+		}
+
+		/**
+		 * Called from various external read functions to notify the BitStream
+		 * that bytes were manually placed in its buffer. This probably is not
+		 * the function you're looking for.
+		 */
+		void UpdateStoredBytes(const Size bytes)
+		{
+			m_StoredBytes = bytes;
+		}
+
+
+	public:
+
+		// BIT PACKING
+
+		/**
+		 * Writes the lowest @count bits of the value (1 to 64 bits)
+		 */
+		void WriteBits(U64 value, const U32 count)
+		{
+			CHECK(count > 0 && count <= 64);
+
+			if (count > 32)
+			{
+				WriteBits(value, 32);
+				WriteBits(value >> 32, count - 32);
+				return;
+			}
+
+			// Pending bits are always < 32, so this can't overflow the scratch word
+			m_WriteScratch |= (value & BitStreamHelper::BitMask(count)) << m_WriteBits;
+			m_WriteBits += count;
+
+			if (m_WriteBits >= 32)
 			{
-				GetData()[m_StoredBytes++] = data[i];
+				FlushScratchBytes(4);
+				m_WriteScratch >>= 32;
+				m_WriteBits -= 32;
 			}
 		}
 
 		/**
-		 * Reads an arbitrary value from the Stream
+		 * Writes a single bit
 		 */
-		template <typename T>
-		T Read()
+		void WriteBool(const bool value)
 		{
-			CHECK(m_ReaderPos + sizeof(T) <= m_StoredBytes);
+			WriteBits(value ? 1 : 0, 1);
+		}
 
-			Size readPos = m_ReaderPos;
-			m_ReaderPos += sizeof(T);
-			return *((T*)(GetData() + readPos));
+		/**
+		 * Writes any pending bits to the buffer, padding with zeroes up to the next byte
+		 * Must be called before using GetData()/GetStoredBytes() after WriteBits
+		 */
+		void AlignWrite()
+		{
+			if (m_WriteBits > 0)
+			{
+				FlushScratchBytes((m_WriteBits + 7) / 8);
+				m_WriteScratch = 0;
+				m_WriteBits = 0;
+			}
 		}
-		
+
+		// VARIABLE LENGTH INTEGERS
+
 		/**
-		 * Reads the requested number of bytes into the given buffer
-		 * Returns the number of bytes actually read
+		 * Writes an unsigned integer in 7-bit groups; small values take a single byte
 		 */
-		Size ReadBytes(UByte* data, const Size count)
+		void WriteVarUInt(U64 value)
 		{
-			// Don't read beyond the end of the buffer
-			Size bytesToRead = glm::min(count, m_StoredBytes - m_ReaderPos);
+			while (value >= 0x80)
+			{
+				WriteBits((value & 0x7F) | 0x80, 8);
+				value >>= 7;
+			}
+			WriteBits(value, 8);
+		}
+
+		/**
+		 * Writes a signed integer zigzag-encoded, so small negative values stay small
+		 */
+		void WriteVarInt(const I64 value)
+		{
+			WriteVarUInt(ZigZagEncode(value));
+		}
+
+		/**
+		 * Maps signed values to unsigned ones by magnitude: 0, -1, 1, -2, 2... -> 0, 1, 2, 3, 4...
+		 */
+		static constexpr U64 ZigZagEncode(const I64 value)
+		{
+			return (static_cast<U64>(value) << 1) ^ static_cast<U64>(value >> 63);
+		}
+
+		// QUANTIZATION
 
-			for (U32 i = 0; i < bytesToRead; ++i)
+		/**
+		 * Returns the number of bits needed to store values in [min, max] with
+		 * at least the given precision (the largest acceptable error between steps)
+		 */
+		static U32 GetQuantizationBits(const F32 min, const F32 max, const F32 precision)
+		{
+			CHECK(max > min && precision > 0.0F);
+
+			const F64 steps = glm::ceil(static_cast<F64>(max - min) / precision);
+			U32 bits = 1;
+			while (bits < 32 && static_cast<F64>(BitStreamHelper::BitMask(bits)) < steps)
 			{
-				data[i] = GetData()[m_ReaderPos++];
+				++bits;
 			}
+			return bits;
+		}
 
-			return bytesToRead;
+		/**
+		 * Writes a float clamped to [min, max] using the given number of bits (1 to 32)
+		 */
+		void WriteQuantizedFloat(const F32 value, const F32 min, const F32 max, const U32 bits)
+		{
+			CHECK(max > min && bits > 0 && bits <= 32);
+
+			const F64 normalized = (static_cast<F64>(glm::clamp(value, min, max)) - min) / (static_cast<F64>(max) - min);
+			WriteBits(static_cast<U64>(normalized * BitStreamHelper::BitMask(bits) + 0.5), bits);
 		}
 
 		/**
-		 * Resets the BitStream to an empty state
+		 * Writes each component of the vector with WriteQuantizedFloat
 		 */
-		void Reset()
+		template <glm::length_t L>
+		void WriteQuantizedVector(const glm::vec<L, F32>& value, const F32 min, const F32 max, const U32 bits)
 		{
-			m_Allocator.Reset();
-			m_StoredBytes = 0;
-			m_MaxBytes = 0;
-			m_ReaderPos = 0;
+			for (glm::length_t i = 0; i < L; ++i)
+			{
+				WriteQuantizedFloat(value[i], min, max, bits);
+			}
 		}
 
 		/**
-		 * Called from various external read functions to notify the BitStream
-		 * that bytes were manually placed in its buffer. This probably is not
-		 * the function you're looking for.
+		 * Writes a rotation using the "smallest three" encoding: the index of the largest
+		 * component in 2 bits, then the other three components with the given bits each.
+		 * The default of 10 bits gives 32 bits per rotation, off by at most 2 * sqrt(6) / (2^bits - 1)
+		 * radians: about a quarter of a degree at 10 bits, or 0.07 degrees at 12.
 		 */
-		void UpdateStoredBytes(const Size bytes)
+		void WriteQuantizedQuaternion(const Quaternion& value, const U32 bitsPerComponent = 10)
 		{
-			m_StoredBytes = bytes;
+			const Quaternion norm = glm::normalize(value);
+			const F32 comps[4] = { norm.x, norm.y, norm.z, norm.w };
+
+			U32 largest = 0;
+			for (U32 i = 1; i < 4; ++i)
+			{
+				if (glm::abs(comps[i]) > glm::abs(comps[largest]))
+				{
+					largest = i;
+				}
+			}
+
+			// q and -q are the same rotation, so flip the sign to keep the dropped component positive
+			const F32 sign = comps[largest] < 0.0F ? -1.0F : 1.0F;
+
+			WriteBits(largest, 2);
+			for (U32 i = 0; i < 4; ++i)
+			{
+				if (i != largest)
+				{
+					WriteQuantizedFloat(comps[i] * sign, -BitStreamHelper::QuatComponentLimit, BitStreamHelper::QuatComponentLimit, bitsPerComponent);
+				}
+			}
 		}
 
 	private:
 
+		/**
+		 * Appends the lowest @bytes bytes of the write scratch word to the buffer
+		 */
+		void FlushScratchBytes(const U32 bytes)
+		{
+			MakeRoom(bytes);
+
+			Byte* dest = GetData() + m_StoredBytes;
+			for (U32 i = 0; i < bytes; ++i)
+			{
+				dest[i] = static_cast<Byte>((m_WriteScratch >> (i * 8)) & 0xFF);
+			}
+			m_StoredBytes += bytes;
+		}
+
+		/**
+		 * Resets the bit packing state and moves the reader back to the start
+		 */
+		void ClearBitState()
+		{
+			m_WriteScratch = 0;
+			m_WriteBits = 0;
+			this->ClearReadState();
+		}
+
+		/**
+		 * Copies the bit packing state, reader position and byte order from another stream
+		 */
+		void CopyBitState(const BitStreamBase& other)
+		{
+			m_WriteScratch = other.m_WriteScratch;
+			m_WriteBits = other.m_WriteBits;
+			this->CopyReadState(other);
+		}
+
+		/**
+		 * Returns the number of bytes the reader can read
+		 */
+		Size GetReadLimit() const
+		{
+			return m_StoredBytes;
+		}
+
 		/**
 		 * Allocates space to store the requested number of bytes
 		 */
@@ -284,11 +1001,112 @@ namespace Noble
 		Size m_StoredBytes;
 		// Max number of bytes that can be stored
 		Size m_MaxBytes;
-		// Current position of the reader
-		Size m_ReaderPos;
+		// Bits written but not yet flushed to the buffer
+		U64 m_WriteScratch;
+		// Number of valid bits in m_WriteScratch
+		U32 m_WriteBits;
 		// Allocator instance
 		Allocator m_Allocator;
 	};
 
 	typedef BitStreamBase<DefaultContainerAllocator<Byte>> BitStream;
+
+	/**
+	 * Read-only view over memory the view does not own, such as a MappedFile region or
+	 * another BitStream. Nothing is copied on construction, and ReadSpan/ReadSubView hand
+	 * out pointers into the underlying memory, so data can go straight to its consumer.
+	 *
+	 * Reads come from BitStreamReader, shared with BitStreamBase. The viewed memory must outlive the view.
+	 */
+	class BitStreamView : public BitStreamReader<BitStreamView>
+	{
+		friend BitStreamReader<BitStreamView>;
+
+	public:
+
+		/**
+		 * Empty view
+		 */
+		BitStreamView()
+			: BitStreamView(static_cast<const Byte*>(nullptr), 0)
+		{}
+
+		/**
+		 * Views @size bytes starting at @data
+		 */
+		BitStreamView(const Byte* data, const Size size)
+			: m_Data(data), m_Size(size)
+		{
+			CHECK(data || size == 0);
+		}
+
+		/**
+		 * Views @size bytes starting at @data
+		 */
+		BitStreamView(const UByte* data, const Size size)
+			: BitStreamView(reinterpret_cast<const Byte*>(data), size)
+		{}
+
+		/**
+		 * Views the bytes stored in a BitStream, using the same byte order
+		 */
+		template <typename Allocator>
+		explicit BitStreamView(const BitStreamBase<Allocator>& stream)
+			: BitStreamView(stream.GetData(), stream.GetStoredBytes())
+		{
+			SetByteOrder(stream.GetByteOrder());
+		}
+
+	public:
+
+		/**
+		 * Returns the start of the viewed memory
+		 */
+		const Byte* GetData() const
+		{
+			return m_Data;
+		}
+
+		/**
+		 * Returns the number of bytes in the view
+		 */
+		Size GetSize() const
+		{
+			return m_Size;
+		}
+
+		/**
+		 * Returns a view of the next @count bytes and advances past them
+		 * Returns an empty view if fewer than @count bytes remain
+		 */
+		BitStreamView ReadSubView(const Size count)
+		{
+			const Byte* span = ReadSpan(count);
+			if (!span)
+			{
+				return BitStreamView();
+			}
+
+			BitStreamView sub(span, count);
+			sub.m_SwapBytes = m_SwapBytes;
+			return sub;
+		}
+
+	private:
+
+		/**
+		 * Returns the number of bytes the reader can read
+		 */
+		Size GetReadLimit() const
+		{
+			return m_Size;
+		}
+
+	private:
+
+		// Start of the viewed memory
+		const Byte* m_Data;
+		// Number of bytes in the view
+		Size m_Size;
+	};
 }
\ No newline at end of file
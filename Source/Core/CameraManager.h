@@ -46,6 +46,11 @@ namespace Noble
 		 */
 		Matrix4x4f GetProjectionMatrix() const;
 
+		/**
+		 * Returns the height of the view being rendered, in pixels
+		 */
+		F32 GetViewportHeight() const { return m_RenderData.Height; }
+
 	private:
 
 		/**
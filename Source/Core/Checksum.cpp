@@ -0,0 +1,377 @@
+#include "Checksum.h"
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+#include "Logger.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define NOBLE_CRC32C_HARDWARE 1
+#include <nmmintrin.h>
+#ifdef NOBLE_WINDOWS
+#include <intrin.h>
+#define NOBLE_TARGET_SSE42
+#else
+#include <cpuid.h>
+#define NOBLE_TARGET_SSE42 __attribute__((target("sse4.2")))
+#endif
+#else
+#define NOBLE_CRC32C_HARDWARE 0
+#endif
+
+namespace Noble
+{
+	namespace
+	{
+		// Reflected CRC32C polynomial
+		constexpr U32 Crc32cPolynomial = 0x82F63B78;
+
+		/**
+		 * Slicing-by-8 tables, built at compile time
+		 */
+		struct Crc32cTables
+		{
+			U32 Data[8][256];
+
+			constexpr Crc32cTables()
+				: Data()
+			{
+				for (U32 i = 0; i < 256; ++i)
+				{
+					U32 crc = i;
+					for (U32 bit = 0; bit < 8; ++bit)
+					{
+						crc = (crc >> 1) ^ ((crc & 1) ? Crc32cPolynomial : 0);
+					}
+					Data[0][i] = crc;
+				}
+
+				for (U32 i = 0; i < 256; ++i)
+				{
+					for (U32 slice = 1; slice < 8; ++slice)
+					{
+						Data[slice][i] = (Data[slice - 1][i] >> 8) ^ Data[0][Data[slice - 1][i] & 0xFF];
+					}
+				}
+			}
+		};
+
+		constexpr Crc32cTables CrcTables;
+
+#if NOBLE_CRC32C_HARDWARE
+		bool DetectHardwareCrc32c()
+		{
+			// SSE4.2 is bit 20 of ECX for cpuid leaf 1
+#ifdef NOBLE_WINDOWS
+			int info[4];
+			__cpuid(info, 1);
+			return (info[2] & (1 << 20)) != 0;
+#else
+			unsigned int eax, ebx, ecx, edx;
+			if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+			{
+				return false;
+			}
+			return (ecx & (1 << 20)) != 0;
+#endif
+		}
+
+		NOBLE_TARGET_SSE42 U32 Crc32cHardware(const UByte* data, Size size, U32 crc)
+		{
+			// Byte steps until the pointer is 8-byte aligned
+			while (size > 0 && (reinterpret_cast<uintptr_t>(data) & 7) != 0)
+			{
+				crc = _mm_crc32_u8(crc, *data++);
+				--size;
+			}
+
+			U64 crc64 = crc;
+			while (size >= 8)
+			{
+				U64 value;
+				std::memcpy(&value, data, 8);
+				crc64 = _mm_crc32_u64(crc64, value);
+				data += 8;
+				size -= 8;
+			}
+			crc = static_cast<U32>(crc64);
+
+			while (size > 0)
+			{
+				crc = _mm_crc32_u8(crc, *data++);
+				--size;
+			}
+
+			return crc;
+		}
+#endif
+	}
+
+	U32 Checksum::Crc32c(const void* data, Size size, U32 previous)
+	{
+#if NOBLE_CRC32C_HARDWARE
+		if (HasHardwareCrc32c())
+		{
+			return ~Crc32cHardware(static_cast<const UByte*>(data), size, ~previous);
+		}
+#endif
+		return Crc32cSoftware(data, size, previous);
+	}
+
+	U32 Checksum::Crc32cSoftware(const void* data, Size size, U32 previous)
+	{
+		const UByte* bytes = static_cast<const UByte*>(data);
+		U32 crc = ~previous;
+
+		while (size >= 8)
+		{
+			U32 low = U32(bytes[0]) | (U32(bytes[1]) << 8) | (U32(bytes[2]) << 16) | (U32(bytes[3]) << 24);
+			low ^= crc;
+
+			crc = CrcTables.Data[7][low & 0xFF] ^
+				CrcTables.Data[6][(low >> 8) & 0xFF] ^
+				CrcTables.Data[5][(low >> 16) & 0xFF] ^
+				CrcTables.Data[4][low >> 24] ^
+				CrcTables.Data[3][bytes[4]] ^
+				CrcTables.Data[2][bytes[5]] ^
+				CrcTables.Data[1][bytes[6]] ^
+				CrcTables.Data[0][bytes[7]];
+
+			bytes += 8;
+			size -= 8;
+		}
+
+		while (size > 0)
+		{
+			crc = (crc >> 8) ^ CrcTables.Data[0][(crc ^ *bytes++) & 0xFF];
+			--size;
+		}
+
+		return ~crc;
+	}
+
+	bool Checksum::HasHardwareCrc32c()
+	{
+#if NOBLE_CRC32C_HARDWARE
+		static const bool hasHardware = DetectHardwareCrc32c();
+		return hasHardware;
+#else
+		return false;
+#endif
+	}
+
+	void ChecksumFrame::Write(const void* data, Size size, BitStream& output, U32 blockSize)
+	{
+		WriteHeader(data, size, output, blockSize);
+		if (size > 0)
+		{
+			output.WriteBytes(static_cast<const Byte*>(data), size);
+		}
+	}
+
+	void ChecksumFrame::WriteHeader(const void* data, Size size, BitStream& output, U32 blockSize)
+	{
+		CHECK(data || size == 0);
+		CHECK(blockSize > 0);
+
+		const UByte* bytes = static_cast<const UByte*>(data);
+		const U32 blockCount = static_cast<U32>((size + blockSize - 1) / blockSize);
+
+		// Header and table are built separately so they're always little-endian
+		BitStream header(HeaderSize + (Size(blockCount) + 1) * sizeof(U32));
+		header.SetByteOrder(ByteOrder::Little);
+		header.Write<U32>(Magic);
+		header.Write<U32>(blockSize);
+		header.Write<U64>(size);
+		header.Write<U32>(blockCount);
+
+		for (U32 i = 0; i < blockCount; ++i)
+		{
+			const Size blockStart = Size(i) * blockSize;
+			header.Write<U32>(Checksum::Crc32c(bytes + blockStart, glm::min<Size>(blockSize, size - blockStart)));
+		}
+
+		header.Write<U32>(Checksum::Crc32c(header.GetData(), header.GetStoredBytes()));
+
+		output.WriteBytes(header.GetData(), header.GetStoredBytes());
+	}
+
+	bool ChecksumFrame::IsFrame(const BitStreamView& data)
+	{
+		BitStreamView header(data.GetData() + data.GetReaderPos(), data.GetRemainingBytes());
+		header.SetByteOrder(ByteOrder::Little);
+
+		return header.GetRemainingBytes() >= HeaderSize && header.Read<U32>() == Magic;
+	}
+
+	Size ChecksumFrame::GetHeaderAndTableSize(const BitStreamView& data)
+	{
+		if (!IsFrame(data))
+		{
+			return 0;
+		}
+
+		// The block count ends the fixed header, after the magic, block size and payload size
+		BitStreamView blockCount(data.GetData() + data.GetReaderPos() + HeaderSize - sizeof(U32), sizeof(U32));
+		blockCount.SetByteOrder(ByteOrder::Little);
+		return HeaderSize + (Size(blockCount.Read<U32>()) + 1) * sizeof(U32);
+	}
+
+	bool ChecksumFrame::Unwrap(BitStreamView& data, U32 workerCount)
+	{
+		if (!IsFrame(data))
+		{
+			return true;
+		}
+
+		ChecksumFrameReader frame;
+		if (!frame.Open(data) || !frame.VerifyAll(workerCount))
+		{
+			return false;
+		}
+
+		data = frame.GetPayload();
+		return true;
+	}
+
+	ChecksumFrameReader::ChecksumFrameReader()
+		: m_Payload(nullptr), m_PayloadSize(0), m_BlockSize(0), m_BlockCount(0)
+	{}
+
+	bool ChecksumFrameReader::Open(BitStreamView& frame)
+	{
+		if (!OpenHeader(frame))
+		{
+			return false;
+		}
+
+		m_Payload = frame.ReadSpan(m_PayloadSize);
+		if (!m_Payload)
+		{
+			NE_LOG_WARNING("Checksum frame is truncated");
+			return false;
+		}
+
+		return true;
+	}
+
+	bool ChecksumFrameReader::OpenHeader(BitStreamView& frame)
+	{
+		m_BlockChecksums.Empty();
+		m_Payload = nullptr;
+
+		const Byte* headerStart = frame.GetData() + frame.GetReaderPos();
+
+		BitStreamView header = frame.ReadSubView(ChecksumFrame::HeaderSize);
+		if (header.GetSize() != ChecksumFrame::HeaderSize)
+		{
+			return false;
+		}
+		header.SetByteOrder(ByteOrder::Little);
+
+		const U32 magic = header.Read<U32>();
+		const U32 blockSize = header.Read<U32>();
+		const U64 payloadSize = header.Read<U64>();
+		const U32 blockCount = header.Read<U32>();
+
+		if (magic != ChecksumFrame::Magic || blockSize == 0 || U64(blockCount) != (payloadSize + blockSize - 1) / blockSize)
+		{
+			NE_LOG_WARNING("Invalid checksum frame header");
+			return false;
+		}
+
+		BitStreamView table = frame.ReadSubView((Size(blockCount) + 1) * sizeof(U32));
+		if (table.GetSize() == 0)
+		{
+			return false;
+		}
+		table.SetByteOrder(ByteOrder::Little);
+
+		// The header checksum covers everything before it
+		const Size checkedBytes = ChecksumFrame::HeaderSize + Size(blockCount) * sizeof(U32);
+		if (blockCount > 0)
+		{
+			m_BlockChecksums.Resize(blockCount);
+		}
+		for (U32 i = 0; i < blockCount; ++i)
+		{
+			m_BlockChecksums.Add(table.Read<U32>());
+		}
+		if (table.Read<U32>() != Checksum::Crc32c(headerStart, checkedBytes))
+		{
+			NE_LOG_WARNING("Checksum frame header is corrupt");
+			return false;
+		}
+
+		m_PayloadSize = payloadSize;
+		m_BlockSize = blockSize;
+		m_BlockCount = blockCount;
+
+		return true;
+	}
+
+	bool ChecksumFrameReader::VerifyBlock(U32 blockIndex) const
+	{
+		CHECK(blockIndex < m_BlockCount);
+
+		const Size blockStart = Size(blockIndex) * m_BlockSize;
+		const Size blockSize = glm::min<Size>(m_BlockSize, m_PayloadSize - blockStart);
+
+		return Checksum::Crc32c(m_Payload + blockStart, blockSize) == m_BlockChecksums[blockIndex];
+	}
+
+	bool ChecksumFrameReader::VerifyAll(U32 workerCount) const
+	{
+		// Small payloads are checked on this thread; larger ones get a thread per MinBytesPerWorker
+		const Size sizeLimit = glm::min<Size>(m_PayloadSize / MinBytesPerWorker, m_BlockCount);
+		workerCount = glm::max(1U, glm::min(workerCount, static_cast<U32>(sizeLimit)));
+
+		if (workerCount == 1)
+		{
+			for (U32 i = 0; i < m_BlockCount; ++i)
+			{
+				if (!VerifyBlock(i))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// Each worker checks a contiguous run of blocks; any failure stops the rest early
+		std::atomic<bool> valid(true);
+		auto verifyRange = [this, &valid, workerCount](U32 worker)
+		{
+			const U32 first = static_cast<U32>(U64(m_BlockCount) * worker / workerCount);
+			const U32 last = static_cast<U32>(U64(m_BlockCount) * (worker + 1) / workerCount);
+			for (U32 i = first; i < last && valid.load(std::memory_order_relaxed); ++i)
+			{
+				if (!VerifyBlock(i))
+				{
+					valid.store(false, std::memory_order_relaxed);
+				}
+			}
+		};
+
+		Array<std::thread*> workers;
+		for (U32 w = 1; w < workerCount; ++w)
+		{
+			workers.Add(new std::thread(verifyRange, w));
+		}
+		verifyRange(0);
+
+		for (std::thread* worker : workers)
+		{
+			worker->join();
+			delete worker;
+		}
+
+		return valid.load();
+	}
+
+	BitStreamView ChecksumFrameReader::GetPayload() const
+	{
+		return BitStreamView(m_Payload, m_PayloadSize);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "Array.h"
+#include "BitStream.h"
+#include "Types.h"
+
+namespace Noble
+{
+	/**
+	 * CRC32C (Castagnoli) checksums
+	 * Uses the SSE4.2 crc32 instruction when the CPU has it, slicing-by-8 tables otherwise
+	 */
+	struct Checksum
+	{
+		/**
+		 * Returns the CRC32C of the data
+		 * Pass the result of a previous call as @previous to checksum data in pieces
+		 */
+		static U32 Crc32c(const void* data, Size size, U32 previous = 0);
+
+		/**
+		 * Table-driven CRC32C, used when SSE4.2 is unavailable
+		 */
+		static U32 Crc32cSoftware(const void* data, Size size, U32 previous = 0);
+
+		/**
+		 * Returns true if Crc32c uses the hardware instruction on this CPU
+		 */
+		static bool HasHardwareCrc32c();
+	};
+
+	/**
+	 * Container that splits a payload into blocks and stores a CRC32C for each one,
+	 * so corruption in cooked assets or saves is caught at load time.
+	 *
+	 * Layout: a little-endian header (magic, block size, payload size, block count),
+	 * the table of block checksums, a checksum of the header and table, then the payload
+	 * itself, unchanged and contiguous so it can be used in place once verified.
+	 */
+	struct ChecksumFrame
+	{
+		// Identifies a checksummed frame ("NCRF")
+		static constexpr U32 Magic = 0x4652434E;
+		// Default number of payload bytes covered by each checksum
+		static constexpr U32 DefaultBlockSize = 64 * 1024;
+		// Size of the fixed part of the header, before the checksum table
+		static constexpr Size HeaderSize = 20;
+
+		/**
+		 * Appends the data to @output as a checksummed frame
+		 */
+		static void Write(const void* data, Size size, BitStream& output, U32 blockSize = DefaultBlockSize);
+
+		/**
+		 * Appends only the header and checksum table for the data to @output
+		 * Writing the data itself right after it produces the same frame as Write
+		 */
+		static void WriteHeader(const void* data, Size size, BitStream& output, U32 blockSize = DefaultBlockSize);
+
+		/**
+		 * Returns true if the data starts with a checksummed frame header
+		 */
+		static bool IsFrame(const BitStreamView& data);
+
+		/**
+		 * Returns the size of the header and checksum table of the frame the data starts with,
+		 * which needs only the HeaderSize bytes of the fixed header, or 0 if it isn't a frame
+		 */
+		static Size GetHeaderAndTableSize(const BitStreamView& data);
+
+		/**
+		 * If @data starts with a checksummed frame, verifies it and narrows @data to the payload
+		 * Data without a frame is left as is. Returns false if the frame is corrupt
+		 */
+		static bool Unwrap(BitStreamView& data, U32 workerCount = 1);
+	};
+
+	/**
+	 * Parses a checksummed frame and verifies its blocks. Verification only reads shared
+	 * state, so blocks can be checked from several threads at once.
+	 */
+	class ChecksumFrameReader
+	{
+	public:
+
+		// Payload bytes each verification thread needs before VerifyAll starts another; below
+		// this, starting a thread costs more than checking the blocks it would take
+		static constexpr Size MinBytesPerWorker = 8 * 1024 * 1024;
+
+		ChecksumFrameReader();
+
+		/**
+		 * Reads the frame header and checksum table, leaving the view positioned after the
+		 * frame. Returns false if the header is malformed or its own checksum doesn't match.
+		 * The frame data must outlive the reader.
+		 */
+		bool Open(BitStreamView& frame);
+
+		/**
+		 * Reads only the frame header and checksum table, for payloads read into place separately;
+		 * SetPayload must be called before verifying. Returns false if the header is malformed or corrupt
+		 */
+		bool OpenHeader(BitStreamView& frame);
+
+		/**
+		 * Points the reader at the GetPayloadSize() bytes of payload to verify, which must outlive it
+		 */
+		void SetPayload(const Byte* payload) { m_Payload = payload; }
+
+		/**
+		 * Returns the payload size in bytes
+		 */
+		Size GetPayloadSize() const { return m_PayloadSize; }
+
+		/**
+		 * Returns the number of checksummed blocks
+		 */
+		U32 GetBlockCount() const { return m_BlockCount; }
+
+		/**
+		 * Returns true if the block's checksum matches
+		 */
+		bool VerifyBlock(U32 blockIndex) const;
+
+		/**
+		 * Verifies every block, splitting the work across up to @workerCount threads (the
+		 * calling thread included) with at least MinBytesPerWorker each, so small payloads are
+		 * checked on the calling thread. Returns false if any block fails.
+		 */
+		bool VerifyAll(U32 workerCount = 1) const;
+
+		/**
+		 * Returns a view of the payload, without copying
+		 */
+		BitStreamView GetPayload() const;
+
+	private:
+
+		// Start of the payload
+		const Byte* m_Payload;
+		// Payload size
+		Size m_PayloadSize;
+		// Payload bytes per block
+		U32 m_BlockSize;
+		// Number of blocks
+		U32 m_BlockCount;
+		// Expected checksum of each block
+		Array<U32> m_BlockChecksums;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,627 @@
+#include "Compression.h"
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+#include "Logger.h"
+
+namespace Noble
+{
+	namespace
+	{
+		// Minimum match length encoded by a sequence
+		constexpr Size MinMatch = 4;
+		// The last bytes of a block are always literals
+		constexpr Size LastLiterals = 5;
+		// Matches can't start within this many bytes of the end of the block
+		constexpr Size MatchFindLimit = 12;
+		// Matches can reach back at most this far
+		constexpr Size MaxOffset = 65535;
+		// Number of bits in the match finder's hash
+		constexpr U32 HashBits = 12;
+
+		// Identifies a frame written by CompressFrame ("NBLZ")
+		constexpr U32 FrameMagic = 0x5A4C424E;
+		// Set in a block table entry when the block is stored uncompressed
+		constexpr U32 StoredBlockFlag = 0x80000000;
+
+		FORCEINLINE U32 Load32(const Byte* ptr)
+		{
+			U32 value;
+			std::memcpy(&value, ptr, sizeof(U32));
+			return value;
+		}
+
+		FORCEINLINE U32 HashSequence(const U32 sequence)
+		{
+			return (sequence * 2654435761U) >> (32 - HashBits);
+		}
+
+		/**
+		 * Writes a length continuation: runs of 255 followed by the remainder
+		 */
+		FORCEINLINE bool WriteLength(Size length, Byte*& op, const Byte* opEnd)
+		{
+			while (length >= 255)
+			{
+				if (op >= opEnd)
+				{
+					return false;
+				}
+				*op++ = static_cast<Byte>(255);
+				length -= 255;
+			}
+			if (op >= opEnd)
+			{
+				return false;
+			}
+			*op++ = static_cast<Byte>(length);
+			return true;
+		}
+
+		/**
+		 * Reads a length continuation, adding it to @length
+		 */
+		FORCEINLINE bool ReadLength(Size& length, const UByte*& ip, const UByte* ipEnd)
+		{
+			UByte next;
+			do
+			{
+				if (ip >= ipEnd)
+				{
+					return false;
+				}
+				next = *ip++;
+				length += next;
+			} while (next == 255);
+			return true;
+		}
+
+		/**
+		 * Emits one sequence: literals, then optionally a match
+		 */
+		bool WriteSequence(const Byte* literals, const Size literalLength, const Size offset, const Size matchLength, Byte*& op, const Byte* opEnd)
+		{
+			if (op >= opEnd)
+			{
+				return false;
+			}
+
+			Byte* token = op++;
+			UByte tokenValue = 0;
+
+			if (literalLength >= 15)
+			{
+				tokenValue = 15 << 4;
+				if (!WriteLength(literalLength - 15, op, opEnd))
+				{
+					return false;
+				}
+			}
+			else
+			{
+				tokenValue = static_cast<UByte>(literalLength << 4);
+			}
+
+			if (literalLength > static_cast<Size>(opEnd - op))
+			{
+				return false;
+			}
+			std::memcpy(op, literals, literalLength);
+			op += literalLength;
+
+			if (matchLength > 0)
+			{
+				if (opEnd - op < 2)
+				{
+					return false;
+				}
+				*op++ = static_cast<Byte>(offset & 0xFF);
+				*op++ = static_cast<Byte>(offset >> 8);
+
+				const Size encodedLength = matchLength - MinMatch;
+				if (encodedLength >= 15)
+				{
+					tokenValue |= 15;
+					if (!WriteLength(encodedLength - 15, op, opEnd))
+					{
+						return false;
+					}
+				}
+				else
+				{
+					tokenValue |= static_cast<UByte>(encodedLength);
+				}
+			}
+
+			*token = static_cast<Byte>(tokenValue);
+			return true;
+		}
+
+		void WriteLE32(BitStream& output, const U32 value)
+		{
+			const Byte bytes[4] =
+			{
+				static_cast<Byte>(value), static_cast<Byte>(value >> 8),
+				static_cast<Byte>(value >> 16), static_cast<Byte>(value >> 24)
+			};
+			output.WriteBytes(bytes, 4);
+		}
+
+		void WriteLE64(BitStream& output, const U64 value)
+		{
+			WriteLE32(output, static_cast<U32>(value));
+			WriteLE32(output, static_cast<U32>(value >> 32));
+		}
+
+		bool ReadLE32(BitStreamView& input, U32& value)
+		{
+			const UByte* bytes = reinterpret_cast<const UByte*>(input.ReadSpan(4));
+			if (!bytes)
+			{
+				return false;
+			}
+			value = U32(bytes[0]) | (U32(bytes[1]) << 8) | (U32(bytes[2]) << 16) | (U32(bytes[3]) << 24);
+			return true;
+		}
+
+		bool ReadLE64(BitStreamView& input, U64& value)
+		{
+			U32 low, high;
+			if (!ReadLE32(input, low) || !ReadLE32(input, high))
+			{
+				return false;
+			}
+			value = U64(low) | (U64(high) << 32);
+			return true;
+		}
+
+		/**
+		 * Makes sure @output can take @bytes more bytes without reallocating, and returns
+		 * the position they start at
+		 */
+		Byte* ReserveOutput(BitStream& output, const Size bytes)
+		{
+			output.AlignWrite();
+
+			// Grow geometrically, frames reserve room once per block
+			const Size required = output.GetStoredBytes() + bytes;
+			if (required > output.GetMaxBytes())
+			{
+				output.Resize(glm::max(required, output.GetMaxBytes() * 2));
+			}
+			return output.GetData() + output.GetStoredBytes();
+		}
+	}
+
+	Size Compression::CompressBlock(const Byte* src, Size srcSize, Byte* dest, Size destCapacity)
+	{
+		CHECK(src || srcSize == 0);
+		CHECK(dest);
+
+		Byte* op = dest;
+		const Byte* opEnd = dest + destCapacity;
+		Size anchor = 0;
+
+		if (srcSize > MatchFindLimit)
+		{
+			// Positions of recently seen 4-byte sequences, by hash
+			U32 hashTable[1 << HashBits];
+			std::memset(hashTable, 0, sizeof(hashTable));
+
+			const Size matchFindEnd = srcSize - MatchFindLimit;
+			const Size matchExtendEnd = srcSize - LastLiterals;
+
+			Size ip = 1;
+			while (ip < matchFindEnd)
+			{
+				const U32 sequence = Load32(src + ip);
+				const U32 hash = HashSequence(sequence);
+				Size ref = hashTable[hash];
+				hashTable[hash] = static_cast<U32>(ip);
+
+				if (ip - ref > MaxOffset || Load32(src + ref) != sequence)
+				{
+					// Skip ahead faster the longer we go without a match
+					ip += 1 + ((ip - anchor) >> 6);
+					continue;
+				}
+
+				// Extend the match backwards over pending literals
+				while (ip > anchor && ref > 0 && src[ip - 1] == src[ref - 1])
+				{
+					--ip;
+					--ref;
+				}
+
+				// Extend the match forwards
+				Size matchLength = MinMatch;
+				while (ip + matchLength < matchExtendEnd && src[ref + matchLength] == src[ip + matchLength])
+				{
+					++matchLength;
+				}
+
+				if (!WriteSequence(src + anchor, ip - anchor, ip - ref, matchLength, op, opEnd))
+				{
+					return 0;
+				}
+
+				ip += matchLength;
+				anchor = ip;
+
+				// Index a position inside the match so the next search has a nearby candidate
+				if (ip < matchFindEnd)
+				{
+					hashTable[HashSequence(Load32(src + ip - 2))] = static_cast<U32>(ip - 2);
+				}
+			}
+		}
+
+		// Trailing literals
+		if (!WriteSequence(src + anchor, srcSize - anchor, 0, 0, op, opEnd))
+		{
+			return 0;
+		}
+
+		return static_cast<Size>(op - dest);
+	}
+
+	bool Compression::DecompressBlock(const Byte* src, Size srcSize, Byte* dest, Size destCapacity, Size& outSize)
+	{
+		CHECK(src || srcSize == 0);
+
+		const UByte* ip = reinterpret_cast<const UByte*>(src);
+		const UByte* ipEnd = ip + srcSize;
+		UByte* op = reinterpret_cast<UByte*>(dest);
+		UByte* opStart = op;
+		const UByte* opEnd = op + destCapacity;
+
+		outSize = 0;
+
+		while (ip < ipEnd)
+		{
+			const UByte token = *ip++;
+
+			// Literals
+			Size literalLength = token >> 4;
+			if (literalLength == 15 && !ReadLength(literalLength, ip, ipEnd))
+			{
+				return false;
+			}
+			if (literalLength > static_cast<Size>(ipEnd - ip) || literalLength > static_cast<Size>(opEnd - op))
+			{
+				return false;
+			}
+			if (literalLength <= 16 && ipEnd - ip >= 16 && opEnd - op >= 16)
+			{
+				// Short runs are the common case, a fixed-size copy is much cheaper
+				std::memcpy(op, ip, 16);
+			}
+			else
+			{
+				std::memcpy(op, ip, literalLength);
+			}
+			ip += literalLength;
+			op += literalLength;
+
+			// The last sequence has no match
+			if (ip == ipEnd)
+			{
+				break;
+			}
+
+			// Match
+			if (ipEnd - ip < 2)
+			{
+				return false;
+			}
+			const Size offset = Size(ip[0]) | (Size(ip[1]) << 8);
+			ip += 2;
+			if (offset == 0 || offset > static_cast<Size>(op - opStart))
+			{
+				return false;
+			}
+
+			Size matchLength = token & 15;
+			if (matchLength == 15 && !ReadLength(matchLength, ip, ipEnd))
+			{
+				return false;
+			}
+			matchLength += MinMatch;
+			if (matchLength > static_cast<Size>(opEnd - op))
+			{
+				return false;
+			}
+
+			const UByte* match = op - offset;
+			Size remaining = matchLength;
+
+			if (offset < 8)
+			{
+				// Short offsets repeat a small pattern. Copy just enough bytes by hand that a
+				// whole number of repeats lies at least 8 bytes back, then copy from there
+				const Size period = offset * ((8 + offset - 1) / offset);
+				const Size head = glm::min(remaining, period - offset);
+				for (Size i = 0; i < head; ++i)
+				{
+					*op++ = *match++;
+				}
+				remaining -= head;
+				if (remaining > 0)
+				{
+					match = op - period;
+				}
+			}
+
+			// Each 8-byte chunk reads at least 8 bytes behind where it writes, so chunked
+			// copies are safe even when the match overlaps the output
+			UByte* matchEnd = op + remaining;
+			if (static_cast<Size>(opEnd - op) >= remaining + 8)
+			{
+				// Enough room to overshoot the end of the match; later writes replace the excess
+				while (op < matchEnd)
+				{
+					std::memcpy(op, match, 8);
+					op += 8;
+					match += 8;
+				}
+				op = matchEnd;
+			}
+			else
+			{
+				while (op < matchEnd)
+				{
+					*op++ = *match++;
+				}
+			}
+		}
+
+		outSize = static_cast<Size>(op - opStart);
+		return true;
+	}
+
+	void Compression::Compress(const Byte* src, Size srcSize, BitStream& output)
+	{
+		WriteLE64(output, srcSize);
+
+		// Compressed size is patched in once it's known
+		const Size sizePos = output.GetStoredBytes();
+		WriteLE64(output, 0);
+
+		const Size maxSize = GetMaxCompressedSize(srcSize);
+		Byte* dest = ReserveOutput(output, maxSize);
+		const Size compressedSize = CompressBlock(src, srcSize, dest, maxSize);
+		CHECK(compressedSize > 0);
+
+		output.UpdateStoredBytes(output.GetStoredBytes() + compressedSize);
+
+		Byte* sizeBytes = output.GetData() + sizePos;
+		for (U32 i = 0; i < 8; ++i)
+		{
+			sizeBytes[i] = static_cast<Byte>(U64(compressedSize) >> (i * 8));
+		}
+	}
+
+	bool Compression::Decompress(BitStreamView& input, BitStream& output)
+	{
+		U64 rawSize, compressedSize;
+		if (!ReadLE64(input, rawSize) || !ReadLE64(input, compressedSize))
+		{
+			return false;
+		}
+
+		// Reject sizes the block can't possibly decompress to before allocating for them
+		const Byte* block = input.ReadSpan(compressedSize);
+		if (!block || rawSize > compressedSize * MaxExpansion)
+		{
+			return false;
+		}
+
+		Byte* dest = ReserveOutput(output, rawSize);
+		Size decompressedSize = 0;
+		if (!DecompressBlock(block, compressedSize, dest, rawSize, decompressedSize) || decompressedSize != rawSize)
+		{
+			return false;
+		}
+
+		output.UpdateStoredBytes(output.GetStoredBytes() + decompressedSize);
+		return true;
+	}
+
+	void Compression::CompressFrame(const Byte* src, Size srcSize, BitStream& output, U32 blockSize)
+	{
+		CHECK(blockSize > 0 && blockSize < StoredBlockFlag);
+
+		const U32 blockCount = static_cast<U32>((srcSize + blockSize - 1) / blockSize);
+		const Size maxBlockSize = GetMaxCompressedSize(blockSize);
+
+		// Room for the header, block table and worst case block data up front
+		ReserveOutput(output, 24 + Size(blockCount) * (4 + maxBlockSize));
+
+		WriteLE32(output, FrameMagic);
+		WriteLE32(output, blockSize);
+		WriteLE64(output, srcSize);
+		WriteLE32(output, blockCount);
+
+		// Block table is filled in as blocks are compressed
+		const Size tablePos = output.GetStoredBytes();
+		for (U32 i = 0; i < blockCount; ++i)
+		{
+			WriteLE32(output, 0);
+		}
+
+		for (U32 i = 0; i < blockCount; ++i)
+		{
+			const Size blockStart = Size(i) * blockSize;
+			const Size rawSize = glm::min<Size>(blockSize, srcSize - blockStart);
+
+			Byte* dest = ReserveOutput(output, maxBlockSize);
+			Size storedSize = CompressBlock(src + blockStart, rawSize, dest, maxBlockSize);
+			U32 entry = static_cast<U32>(storedSize);
+
+			// Incompressible data is cheaper to keep as-is
+			if (storedSize == 0 || storedSize >= rawSize)
+			{
+				std::memcpy(dest, src + blockStart, rawSize);
+				storedSize = rawSize;
+				entry = static_cast<U32>(rawSize) | StoredBlockFlag;
+			}
+
+			output.UpdateStoredBytes(output.GetStoredBytes() + storedSize);
+
+			Byte* entryBytes = output.GetData() + tablePos + Size(i) * 4;
+			for (U32 b = 0; b < 4; ++b)
+			{
+				entryBytes[b] = static_cast<Byte>(entry >> (b * 8));
+			}
+		}
+	}
+
+	bool Compression::DecompressFrame(BitStreamView& input, BitStream& output, U32 workerCount)
+	{
+		CompressedFrameReader reader;
+		if (!reader.Open(input))
+		{
+			return false;
+		}
+
+		Byte* dest = ReserveOutput(output, reader.GetRawSize());
+		if (!reader.DecompressAll(dest, workerCount))
+		{
+			return false;
+		}
+
+		output.UpdateStoredBytes(output.GetStoredBytes() + reader.GetRawSize());
+		return true;
+	}
+
+	CompressedFrameReader::CompressedFrameReader()
+		: m_BlockData(nullptr), m_RawSize(0), m_BlockSize(0), m_BlockCount(0)
+	{}
+
+	bool CompressedFrameReader::Open(BitStreamView& frame)
+	{
+		m_BlockOffsets.Empty();
+		m_BlockStored.Empty();
+
+		U32 magic, blockSize, blockCount;
+		U64 rawSize;
+		if (!ReadLE32(frame, magic) || !ReadLE32(frame, blockSize) || !ReadLE64(frame, rawSize) || !ReadLE32(frame, blockCount))
+		{
+			return false;
+		}
+
+		if (magic != FrameMagic || blockSize == 0 || blockSize >= StoredBlockFlag
+			|| U64(blockCount) != (rawSize + blockSize - 1) / blockSize)
+		{
+			NE_LOG_WARNING("Invalid compressed frame header");
+			return false;
+		}
+
+		if (frame.GetRemainingBytes() / 4 < blockCount)
+		{
+			return false;
+		}
+
+		m_BlockOffsets.Resize(blockCount + 1);
+		m_BlockStored.Resize(blockCount);
+
+		Size offset = 0;
+		for (U32 i = 0; i < blockCount; ++i)
+		{
+			U32 entry;
+			ReadLE32(frame, entry);
+
+			m_BlockOffsets.Add(offset);
+			m_BlockStored.Add((entry & StoredBlockFlag) != 0);
+			offset += entry & ~StoredBlockFlag;
+		}
+		m_BlockOffsets.Add(offset);
+
+		m_BlockData = frame.ReadSpan(offset);
+		if ((!m_BlockData && offset > 0) || rawSize > offset * Compression::MaxExpansion)
+		{
+			return false;
+		}
+
+		m_RawSize = rawSize;
+		m_BlockSize = blockSize;
+		m_BlockCount = blockCount;
+
+		return true;
+	}
+
+	bool CompressedFrameReader::DecompressBlock(U32 blockIndex, Byte* dest) const
+	{
+		CHECK(blockIndex < m_BlockCount);
+
+		const Size rawStart = Size(blockIndex) * m_BlockSize;
+		const Size rawSize = glm::min<Size>(m_BlockSize, m_RawSize - rawStart);
+
+		const Byte* block = m_BlockData + m_BlockOffsets[blockIndex];
+		const Size blockSize = m_BlockOffsets[blockIndex + 1] - m_BlockOffsets[blockIndex];
+
+		if (m_BlockStored[blockIndex])
+		{
+			if (blockSize != rawSize)
+			{
+				return false;
+			}
+			std::memcpy(dest + rawStart, block, rawSize);
+			return true;
+		}
+
+		Size decompressedSize = 0;
+		return Compression::DecompressBlock(block, blockSize, dest + rawStart, rawSize, decompressedSize)
+			&& decompressedSize == rawSize;
+	}
+
+	bool CompressedFrameReader::DecompressAll(Byte* dest, U32 workerCount) const
+	{
+		const Size sizeLimit = glm::min<Size>(m_RawSize / MinBytesPerWorker, m_BlockCount);
+		workerCount = glm::max(1U, glm::min(workerCount, static_cast<U32>(sizeLimit)));
+
+		if (workerCount == 1)
+		{
+			for (U32 i = 0; i < m_BlockCount; ++i)
+			{
+				if (!DecompressBlock(i, dest))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// Blocks land in disjoint parts of @dest, so each worker decodes a contiguous run of them
+		std::atomic<bool> valid(true);
+		auto decompressRange = [this, dest, &valid, workerCount](U32 worker)
+		{
+			const U32 first = static_cast<U32>(U64(m_BlockCount) * worker / workerCount);
+			const U32 last = static_cast<U32>(U64(m_BlockCount) * (worker + 1) / workerCount);
+			for (U32 i = first; i < last && valid.load(std::memory_order_relaxed); ++i)
+			{
+				if (!DecompressBlock(i, dest))
+				{
+					valid.store(false, std::memory_order_relaxed);
+				}
+			}
+		};
+
+		Array<std::thread*> workers;
+		for (U32 w = 1; w < workerCount; ++w)
+		{
+			workers.Add(new std::thread(decompressRange, w));
+		}
+		decompressRange(0);
+
+		for (std::thread* worker : workers)
+		{
+			worker->join();
+			delete worker;
+		}
+
+		return valid.load();
+	}
+}
\ No newline at end of file
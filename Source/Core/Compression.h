@@ -0,0 +1,138 @@
+#pragma once
+
+#include "Array.h"
+#include "BitStream.h"
+#include "Types.h"
+
+namespace Noble
+{
+	/**
+	 * LZ4-style block compression for BitStream payloads
+	 *
+	 * Blocks use the LZ4 block format (token, literals, 16-bit offset, match length), so
+	 * compression is a single greedy pass with a small hash table and decompression is
+	 * little more than a series of memcpys. Every decoder path is bounds-checked, so
+	 * malformed input fails cleanly instead of reading or writing out of range.
+	 *
+	 * Frames split a payload into independently compressed blocks with a size table up
+	 * front; see CompressedFrameReader for decoding them, including from several threads.
+	 */
+	struct Compression
+	{
+		// Default uncompressed size of each block in a frame
+		static constexpr U32 DefaultBlockSize = 64 * 1024;
+		// A single compressed byte can expand to at most this many bytes
+		static constexpr Size MaxExpansion = 255;
+
+		/**
+		 * Returns the largest compressed size a block of @inputSize bytes can produce
+		 */
+		static constexpr Size GetMaxCompressedSize(const Size inputSize)
+		{
+			return inputSize + (inputSize / 255) + 16;
+		}
+
+		/**
+		 * Compresses @srcSize bytes into @dest
+		 * Returns the compressed size, or 0 if @destCapacity was too small
+		 */
+		static Size CompressBlock(const Byte* src, Size srcSize, Byte* dest, Size destCapacity);
+
+		/**
+		 * Decompresses a block produced by CompressBlock into @dest
+		 * Returns false if the block is malformed or does not fit in @destCapacity
+		 */
+		static bool DecompressBlock(const Byte* src, Size srcSize, Byte* dest, Size destCapacity, Size& outSize);
+
+		/**
+		 * Compresses the whole input as one block, appended to @output
+		 * The block is prefixed with the uncompressed and compressed sizes
+		 */
+		static void Compress(const Byte* src, Size srcSize, BitStream& output);
+
+		/**
+		 * Decompresses a buffer written by Compress, appending the result to @output
+		 * Returns false if the input is malformed
+		 */
+		static bool Decompress(BitStreamView& input, BitStream& output);
+
+		/**
+		 * Compresses the input as a frame of independent blocks of @blockSize bytes,
+		 * appended to @output. Blocks that don't shrink are stored uncompressed.
+		 */
+		static void CompressFrame(const Byte* src, Size srcSize, BitStream& output, U32 blockSize = DefaultBlockSize);
+
+		/**
+		 * Decompresses a whole frame written by CompressFrame, appending the result to @output
+		 * Large frames are split across up to @workerCount threads, see CompressedFrameReader::DecompressAll
+		 * Returns false if the frame is malformed
+		 */
+		static bool DecompressFrame(BitStreamView& input, BitStream& output, U32 workerCount = 1);
+	};
+
+	/**
+	 * Parses the header of a compressed frame so its blocks can be decompressed
+	 * individually. DecompressBlock only reads shared state, so different blocks can
+	 * be decoded on different threads into the same destination buffer.
+	 */
+	class CompressedFrameReader
+	{
+	public:
+
+		// Uncompressed bytes each thread needs before DecompressAll starts another; below this,
+		// starting a thread costs more than decoding the blocks it would take
+		static constexpr Size MinBytesPerWorker = 4 * 1024 * 1024;
+
+		CompressedFrameReader();
+
+		/**
+		 * Reads the frame header and block table from the view, leaving the view
+		 * positioned after the frame. The frame data must outlive the reader.
+		 * Returns false if the header is malformed
+		 */
+		bool Open(BitStreamView& frame);
+
+		/**
+		 * Returns the total uncompressed size of the frame
+		 */
+		Size GetRawSize() const { return m_RawSize; }
+
+		/**
+		 * Returns the uncompressed size of every block except possibly the last
+		 */
+		U32 GetBlockSize() const { return m_BlockSize; }
+
+		/**
+		 * Returns the number of blocks in the frame
+		 */
+		U32 GetBlockCount() const { return m_BlockCount; }
+
+		/**
+		 * Decompresses one block to its place in @dest, which must hold GetRawSize() bytes
+		 * Returns false if the block is malformed
+		 */
+		bool DecompressBlock(U32 blockIndex, Byte* dest) const;
+
+		/**
+		 * Decompresses every block into @dest, which must hold GetRawSize() bytes, splitting the
+		 * work across up to @workerCount threads (the calling thread included) with at least
+		 * MinBytesPerWorker each. Returns false if any block is malformed
+		 */
+		bool DecompressAll(Byte* dest, U32 workerCount = 1) const;
+
+	private:
+
+		// Start of the first block's data
+		const Byte* m_BlockData;
+		// Total uncompressed size
+		Size m_RawSize;
+		// Uncompressed size of each full block
+		U32 m_BlockSize;
+		// Number of blocks
+		U32 m_BlockCount;
+		// Byte offset of each block from m_BlockData, plus the end offset
+		Array<Size> m_BlockOffsets;
+		// Whether each block was stored without compression
+		Array<bool> m_BlockStored;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,836 @@
+#include "DirectoryIndex.h"
+
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#include "Logger.h"
+
+#ifndef NOBLE_WINDOWS
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+namespace Noble
+{
+	namespace
+	{
+		// Longest relative path an entry can hold
+		constexpr Size MaxIndexedPathLength = 0xFFFF;
+
+		/**
+		 * Makes room for @count elements; Array::Resize only accepts growth
+		 */
+		template <typename T>
+		void Reserve(Array<T>& arr, Size count)
+		{
+			if (count > arr.GetMax())
+			{
+				arr.Resize(count);
+			}
+		}
+
+		/**
+		 * Files found by one scan thread, with paths in its own pool
+		 */
+		struct ScanOutput
+		{
+			Array<DirectoryEntry> Entries;
+			Array<char> Pool;
+		};
+
+		/**
+		 * Directories waiting to be scanned, shared by the scan threads
+		 */
+		struct ScanQueue
+		{
+			std::mutex Mutex;
+			std::condition_variable Condition;
+			// Relative paths of the pending directories
+			Array<char> Pool;
+			Array<U32> Pending;
+			// Threads currently scanning a directory
+			U32 Busy = 0;
+		};
+
+		/**
+		 * Appends "dir/name" (or just "name" at the root) with a null terminator to the pool
+		 * Returns the offset of the new path
+		 */
+		U32 AppendPath(Array<char>& pool, const char* dir, Size dirLength, const char* name, Size nameLength)
+		{
+			const U32 offset = static_cast<U32>(pool.GetCount());
+			if (dirLength > 0)
+			{
+				pool.AddMultiple(dir, dirLength);
+				pool.Add('/');
+			}
+			pool.AddMultiple(name, nameLength);
+			pool.Add('\0');
+			return offset;
+		}
+
+		/**
+		 * Records a regular file found while scanning
+		 */
+		void AddScannedFile(ScanOutput& output, const char* dir, Size dirLength, const char* name, U64 size, I64 modifiedTime)
+		{
+			const Size nameLength = std::strlen(name);
+			const Size pathLength = dirLength > 0 ? dirLength + 1 + nameLength : nameLength;
+			if (pathLength > MaxIndexedPathLength)
+			{
+				NE_LOG_WARNING("Path too long to index: %s/%s", dir, name);
+				return;
+			}
+
+			DirectoryEntry entry;
+			entry.PathOffset = AppendPath(output.Pool, dir, dirLength, name, nameLength);
+			entry.PathLength = static_cast<U16>(pathLength);
+			entry.ExtensionId = 0;
+			entry.FileSize = size;
+			entry.ModifiedTime = modifiedTime;
+			output.Entries.Add(entry);
+		}
+
+		/**
+		 * Reads a single directory, recording its files in @output and appending the relative
+		 * paths of its subdirectories to @subdirs, each null-terminated
+		 * Symlinked directories aren't followed, matching recursive_directory_iterator
+		 */
+		void ScanDirectory(const fs::path& root, const char* dir, Size dirLength, ScanOutput& output, Array<char>& subdirs)
+		{
+			const fs::path fullPath = dirLength > 0 ? root / dir : root;
+
+#ifdef NOBLE_WINDOWS
+			// Directory entries cache the attributes from the directory read, so nothing here stats the file again
+			std::error_code error;
+			fs::directory_iterator iter(fullPath, error);
+			for (; !error && iter != fs::directory_iterator(); iter.increment(error))
+			{
+				const fs::directory_entry& child = *iter;
+				const std::string name = child.path().filename().generic_string();
+
+				if (child.is_directory(error) && !child.is_symlink(error))
+				{
+					AppendPath(subdirs, dir, dirLength, name.c_str(), name.size());
+				}
+				else if (child.is_regular_file(error))
+				{
+					const U64 size = child.file_size(error);
+					const I64 modifiedTime = child.last_write_time(error).time_since_epoch().count();
+					AddScannedFile(output, dir, dirLength, name.c_str(), size, modifiedTime);
+				}
+			}
+#else
+			DIR* handle = opendir(fullPath.c_str());
+			if (!handle)
+			{
+				return;
+			}
+			const int dirFd = dirfd(handle);
+
+			while (dirent* child = readdir(handle))
+			{
+				const char* name = child->d_name;
+				if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+				{
+					continue;
+				}
+
+				// d_type saves a stat for subdirectories; files still need one for the size and time
+				if (child->d_type == DT_DIR)
+				{
+					AppendPath(subdirs, dir, dirLength, name, std::strlen(name));
+					continue;
+				}
+				if (child->d_type != DT_REG && child->d_type != DT_LNK && child->d_type != DT_UNKNOWN)
+				{
+					continue;
+				}
+
+				struct stat info;
+				if (fstatat(dirFd, name, &info, 0) != 0)
+				{
+					continue;
+				}
+
+				if (S_ISDIR(info.st_mode))
+				{
+					if (child->d_type == DT_UNKNOWN)
+					{
+						AppendPath(subdirs, dir, dirLength, name, std::strlen(name));
+					}
+				}
+				else if (S_ISREG(info.st_mode))
+				{
+					const I64 modifiedTime = I64(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+					AddScannedFile(output, dir, dirLength, name, info.st_size, modifiedTime);
+				}
+			}
+
+			closedir(handle);
+#endif
+		}
+
+		/**
+		 * Scan thread loop: takes directories from the queue until it's empty and every thread is idle
+		 */
+		void ScanWorker(const fs::path& root, ScanQueue& queue, ScanOutput& output)
+		{
+			Array<char> dir;
+			Array<char> subdirs;
+
+			std::unique_lock<std::mutex> lock(queue.Mutex);
+			while (true)
+			{
+				queue.Condition.wait(lock, [&queue] { return queue.Pending.GetCount() > 0 || queue.Busy == 0; });
+				if (queue.Pending.GetCount() == 0)
+				{
+					// Nothing queued and nobody left to queue more
+					return;
+				}
+
+				const U32 offset = queue.Pending[queue.Pending.GetCount() - 1];
+				queue.Pending.RemoveAt(queue.Pending.GetCount() - 1);
+				++queue.Busy;
+
+				// Copy the path out, the queue's pool can grow while we scan
+				const char* path = queue.Pool.GetData() + offset;
+				const Size pathLength = std::strlen(path);
+				dir.Empty();
+				dir.AddMultiple(path, pathLength + 1);
+				lock.unlock();
+
+				subdirs.Empty();
+				ScanDirectory(root, dir.GetData(), pathLength, output, subdirs);
+
+				lock.lock();
+				for (Size i = 0; i < subdirs.GetCount(); i += std::strlen(subdirs.GetData() + i) + 1)
+				{
+					queue.Pending.Add(static_cast<U32>(queue.Pool.GetCount()));
+					queue.Pool.AddMultiple(subdirs.GetData() + i, std::strlen(subdirs.GetData() + i) + 1);
+				}
+				--queue.Busy;
+
+				if (subdirs.GetCount() > 0 || queue.Busy == 0)
+				{
+					queue.Condition.notify_all();
+				}
+			}
+		}
+
+		/**
+		 * Scans the subtree at @dir (relative to @root, empty for the root itself) with
+		 * @workerCount threads, producing entries sorted by path with their paths in @pool
+		 */
+		void ScanTree(const fs::path& root, const char* dir, U32 workerCount, Array<DirectoryEntry>& entries, Array<char>& pool)
+		{
+			if (workerCount == 0)
+			{
+				workerCount = glm::max(1U, std::thread::hardware_concurrency());
+			}
+
+			ScanQueue queue;
+			queue.Pending.Add(0);
+			queue.Pool.AddMultiple(dir, std::strlen(dir) + 1);
+
+			Array<ScanOutput*> outputs;
+			for (U32 i = 0; i < workerCount; ++i)
+			{
+				outputs.Add(new ScanOutput());
+			}
+
+			// The calling thread scans too
+			Array<std::thread*> workers;
+			for (U32 i = 1; i < workerCount; ++i)
+			{
+				workers.Add(new std::thread(ScanWorker, std::cref(root), std::ref(queue), std::ref(*outputs[i])));
+			}
+			ScanWorker(root, queue, *outputs[0]);
+
+			for (std::thread* worker : workers)
+			{
+				worker->join();
+				delete worker;
+			}
+
+			// Gather everything into one pool so the entries can be sorted together
+			Array<DirectoryEntry> unsorted;
+			Array<char> unsortedPool;
+			for (ScanOutput* output : outputs)
+			{
+				const U32 base = static_cast<U32>(unsortedPool.GetCount());
+				if (output->Pool.GetCount() > 0)
+				{
+					unsortedPool.AddMultiple(output->Pool.GetData(), output->Pool.GetCount());
+				}
+				for (DirectoryEntry entry : output->Entries)
+				{
+					entry.PathOffset += base;
+					unsorted.Add(entry);
+				}
+				delete output;
+			}
+
+			const char* paths = unsortedPool.GetData();
+			std::sort(unsorted.GetData(), unsorted.GetData() + unsorted.GetCount(),
+				[paths](const DirectoryEntry& lhs, const DirectoryEntry& rhs)
+				{
+					return std::strcmp(paths + lhs.PathOffset, paths + rhs.PathOffset) < 0;
+				});
+
+			// Repack the pool in sorted order, so walking the entries walks the pool front to back
+			entries.Empty();
+			pool.Empty();
+			Reserve(entries, unsorted.GetCount());
+			Reserve(pool, unsortedPool.GetCount());
+			for (DirectoryEntry entry : unsorted)
+			{
+				const U32 offset = static_cast<U32>(pool.GetCount());
+				pool.AddMultiple(paths + entry.PathOffset, Size(entry.PathLength) + 1);
+				entry.PathOffset = offset;
+				entries.Add(entry);
+			}
+		}
+
+		/**
+		 * Stats a single path, following symlinks
+		 * Returns false if it doesn't exist
+		 */
+		bool StatPath(const fs::path& path, bool& isDirectory, bool& isFile, U64& size, I64& modifiedTime)
+		{
+#ifdef NOBLE_WINDOWS
+			std::error_code error;
+			const fs::file_status status = fs::status(path, error);
+			if (error || !fs::exists(status))
+			{
+				return false;
+			}
+
+			isDirectory = fs::is_directory(status);
+			isFile = fs::is_regular_file(status);
+			size = isFile ? fs::file_size(path, error) : 0;
+			modifiedTime = fs::last_write_time(path, error).time_since_epoch().count();
+#else
+			struct stat info;
+			if (stat(path.c_str(), &info) != 0)
+			{
+				return false;
+			}
+
+			isDirectory = S_ISDIR(info.st_mode);
+			isFile = S_ISREG(info.st_mode);
+			size = isFile ? info.st_size : 0;
+			modifiedTime = I64(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+#endif
+			return true;
+		}
+
+		/**
+		 * Orders a stored path against a query of known length, like strcmp
+		 */
+		int ComparePath(const char* stored, Size storedLength, const char* query, Size queryLength)
+		{
+			const int result = std::memcmp(stored, query, glm::min(storedLength, queryLength));
+			if (result != 0)
+			{
+				return result;
+			}
+			return storedLength < queryLength ? -1 : (storedLength > queryLength ? 1 : 0);
+		}
+
+		void ReportChange(DirectoryChangeList* changes, DirectoryChangeType type, const char* path)
+		{
+			if (changes)
+			{
+				changes->Add(type, path);
+			}
+		}
+	}
+
+	void DirectoryChangeList::Add(DirectoryChangeType type, const char* path)
+	{
+		DirectoryChange change;
+		change.Type = type;
+		change.PathOffset = static_cast<U32>(m_Paths.GetCount());
+		m_Changes.Add(change);
+		m_Paths.AddMultiple(path, std::strlen(path) + 1);
+	}
+
+	void DirectoryChangeList::Empty()
+	{
+		m_Changes.Empty();
+		m_Paths.Empty();
+	}
+
+	DirectoryIndex::DirectoryIndex()
+		: m_UnusedPoolBytes(0), m_Built(false)
+	{
+		Clear();
+	}
+
+	bool DirectoryIndex::Build(const fs::path& root, U32 workerCount)
+	{
+		Clear();
+
+		std::error_code error;
+		if (!fs::is_directory(root, error))
+		{
+			NE_LOG_WARNING("Can't index %s: not a directory", root.string().c_str());
+			return false;
+		}
+
+		m_Root = root;
+		ScanTree(m_Root, "", workerCount, m_Entries, m_PathPool);
+
+		for (DirectoryEntry& entry : m_Entries)
+		{
+			entry.ExtensionId = InternExtension(GetPath(entry), entry.PathLength);
+		}
+		RebuildExtensionLists();
+
+		m_Built = true;
+		return true;
+	}
+
+	bool DirectoryIndex::Refresh(DirectoryChangeList* changes, U32 workerCount)
+	{
+		if (!m_Built)
+		{
+			return false;
+		}
+
+		Array<DirectoryEntry> scanned;
+		Array<char> scannedPool;
+		ScanTree(m_Root, "", workerCount, scanned, scannedPool);
+
+		return MergeScanned("", scanned, scannedPool, changes);
+	}
+
+	bool DirectoryIndex::UpdatePath(const char* relativePath, DirectoryChangeList* changes)
+	{
+		if (!m_Built)
+		{
+			return false;
+		}
+
+		// Normalize to the stored form: '/' separators, no leading "./" or '/', no trailing '/'
+		Array<char> path;
+		const char* start = relativePath;
+		while (start[0] == '/' || start[0] == '\\' || (start[0] == '.' && (start[1] == '/' || start[1] == '\\')))
+		{
+			start += start[0] == '.' ? 2 : 1;
+		}
+		for (const char* c = start; *c; ++c)
+		{
+			path.Add(*c == '\\' ? '/' : *c);
+		}
+		while (path.GetCount() > 0 && path[path.GetCount() - 1] == '/')
+		{
+			path.RemoveAt(path.GetCount() - 1);
+		}
+
+		if (path.GetCount() == 0)
+		{
+			return Refresh(changes);
+		}
+		if (path.GetCount() > MaxIndexedPathLength)
+		{
+			return false;
+		}
+
+		const Size pathLength = path.GetCount();
+		path.Add('\0');
+
+		bool isDirectory = false;
+		bool isFile = false;
+		U64 size = 0;
+		I64 modifiedTime = 0;
+		const bool exists = StatPath(m_Root / path.GetData(), isDirectory, isFile, size, modifiedTime);
+
+		// Anything indexed under the path as a directory
+		Array<char> subtree;
+		subtree.AddMultiple(path.GetData(), pathLength);
+		subtree.Add('/');
+		subtree.Add('\0');
+
+		bool changed = false;
+		if (exists && isDirectory)
+		{
+			Array<DirectoryEntry> scanned;
+			Array<char> scannedPool;
+			ScanTree(m_Root, path.GetData(), 1, scanned, scannedPool);
+			changed = MergeScanned(subtree.GetData(), scanned, scannedPool, changes);
+		}
+		else
+		{
+			changed = MergeScanned(subtree.GetData(), Array<DirectoryEntry>(), Array<char>(), changes);
+		}
+
+		// The path itself as a file
+		const Size index = LowerBound(path.GetData(), pathLength);
+		const bool indexed = index < m_Entries.GetCount() && m_Entries[index].PathLength == pathLength &&
+			std::memcmp(GetPath(m_Entries[index]), path.GetData(), pathLength) == 0;
+
+		if (exists && isFile)
+		{
+			if (indexed)
+			{
+				DirectoryEntry& entry = m_Entries[index];
+				if (entry.FileSize != size || entry.ModifiedTime != modifiedTime)
+				{
+					entry.FileSize = size;
+					entry.ModifiedTime = modifiedTime;
+					ReportChange(changes, DirectoryChangeType::Modified, path.GetData());
+					changed = true;
+				}
+			}
+			else
+			{
+				DirectoryEntry entry;
+				entry.PathOffset = AddPath(path.GetData(), pathLength);
+				entry.PathLength = static_cast<U16>(pathLength);
+				entry.ExtensionId = InternExtension(path.GetData(), pathLength);
+				entry.FileSize = size;
+				entry.ModifiedTime = modifiedTime;
+
+				if (index < m_Entries.GetCount())
+				{
+					m_Entries.Insert(entry, index);
+				}
+				else
+				{
+					m_Entries.Add(entry);
+				}
+
+				RebuildExtensionLists();
+				ReportChange(changes, DirectoryChangeType::Added, path.GetData());
+				changed = true;
+			}
+		}
+		else if (indexed)
+		{
+			m_UnusedPoolBytes += Size(m_Entries[index].PathLength) + 1;
+			m_Entries.RemoveAt(index);
+
+			RebuildExtensionLists();
+			CompactPool();
+			ReportChange(changes, DirectoryChangeType::Removed, path.GetData());
+			changed = true;
+		}
+
+		return changed;
+	}
+
+	void DirectoryIndex::Clear()
+	{
+		m_Root.clear();
+		m_Entries.Empty();
+		m_PathPool.Empty();
+		m_UnusedPoolBytes = 0;
+		m_Built = false;
+
+		// Extension 0 is always the empty one
+		m_Extensions.Empty();
+		m_ExtensionPool.Empty();
+		m_Extensions.Add(0);
+		m_ExtensionPool.Add('\0');
+
+		RebuildExtensionLists();
+	}
+
+	const DirectoryEntry* DirectoryIndex::Find(const char* relativePath) const
+	{
+		const Size length = std::strlen(relativePath);
+		const Size index = LowerBound(relativePath, length);
+		if (index < m_Entries.GetCount())
+		{
+			const DirectoryEntry& entry = m_Entries[index];
+			if (entry.PathLength == length && std::memcmp(GetPath(entry), relativePath, length) == 0)
+			{
+				return &entry;
+			}
+		}
+		return nullptr;
+	}
+
+	DirectoryEntryRange DirectoryIndex::FindByPrefix(const char* prefix) const
+	{
+		const Size length = std::strlen(prefix);
+		const DirectoryEntry* entries = m_Entries.GetData();
+		const DirectoryEntry* first = entries + LowerBound(prefix, length);
+
+		// Paths sharing a prefix are contiguous in sorted order
+		const DirectoryEntry* last = std::partition_point(first, entries + m_Entries.GetCount(),
+			[this, prefix, length](const DirectoryEntry& entry)
+			{
+				return entry.PathLength >= length && std::memcmp(GetPath(entry), prefix, length) == 0;
+			});
+
+		return DirectoryEntryRange{ first, last };
+	}
+
+	DirectoryEntryList DirectoryIndex::FindByExtension(const char* extension) const
+	{
+		if (extension[0] == '.')
+		{
+			++extension;
+		}
+
+		const U32* indices = m_ExtensionEntries.GetData();
+		for (Size id = 0; id < m_Extensions.GetCount(); ++id)
+		{
+			const char* interned = m_ExtensionPool.GetData() + m_Extensions[id];
+			Size i = 0;
+			while (interned[i] != '\0' && std::tolower(static_cast<unsigned char>(extension[i])) == interned[i])
+			{
+				++i;
+			}
+
+			if (interned[i] == '\0' && extension[i] == '\0')
+			{
+				return DirectoryEntryList{ m_Entries.GetData(), indices + m_ExtensionStart[id], indices + m_ExtensionStart[id + 1] };
+			}
+		}
+
+		return DirectoryEntryList{ m_Entries.GetData(), indices, indices };
+	}
+
+	DirectoryEntryRange DirectoryIndex::GetEntries() const
+	{
+		return DirectoryEntryRange{ m_Entries.GetData(), m_Entries.GetData() + m_Entries.GetCount() };
+	}
+
+	fs::path DirectoryIndex::GetFullPath(const DirectoryEntry& entry) const
+	{
+		return m_Root / GetPath(entry);
+	}
+
+	const char* DirectoryIndex::GetExtension(const DirectoryEntry& entry) const
+	{
+		return m_ExtensionPool.GetData() + m_Extensions[entry.ExtensionId];
+	}
+
+	Size DirectoryIndex::LowerBound(const char* path, Size length) const
+	{
+		const DirectoryEntry* entries = m_Entries.GetData();
+		const DirectoryEntry* found = std::partition_point(entries, entries + m_Entries.GetCount(),
+			[this, path, length](const DirectoryEntry& entry)
+			{
+				return ComparePath(GetPath(entry), entry.PathLength, path, length) < 0;
+			});
+
+		return found - entries;
+	}
+
+	U32 DirectoryIndex::AddPath(const char* path, Size length)
+	{
+		const U32 offset = static_cast<U32>(m_PathPool.GetCount());
+		m_PathPool.AddMultiple(path, length);
+		m_PathPool.Add('\0');
+		return offset;
+	}
+
+	U16 DirectoryIndex::InternExtension(const char* path, Size length)
+	{
+		// Same rule as fs::path::extension: the last '.' of the file name, unless the name starts with it
+		Size dot = length;
+		for (Size i = length; i > 0 && path[i - 1] != '/'; --i)
+		{
+			if (path[i - 1] == '.')
+			{
+				dot = i - 1;
+				break;
+			}
+		}
+		if (dot == length || dot == 0 || path[dot - 1] == '/')
+		{
+			return 0;
+		}
+
+		char extension[64];
+		const Size extensionLength = length - dot - 1;
+		if (extensionLength == 0 || extensionLength >= sizeof(extension))
+		{
+			return 0;
+		}
+		for (Size i = 0; i < extensionLength; ++i)
+		{
+			extension[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(path[dot + 1 + i])));
+		}
+		extension[extensionLength] = '\0';
+
+		for (Size id = 1; id < m_Extensions.GetCount(); ++id)
+		{
+			if (std::strcmp(m_ExtensionPool.GetData() + m_Extensions[id], extension) == 0)
+			{
+				return static_cast<U16>(id);
+			}
+		}
+
+		if (m_Extensions.GetCount() > 0xFFFF)
+		{
+			return 0;
+		}
+
+		m_Extensions.Add(static_cast<U32>(m_ExtensionPool.GetCount()));
+		m_ExtensionPool.AddMultiple(extension, extensionLength + 1);
+		return static_cast<U16>(m_Extensions.GetCount() - 1);
+	}
+
+	bool DirectoryIndex::MergeScanned(const char* prefix, const Array<DirectoryEntry>& scanned, const Array<char>& scannedPool,
+		DirectoryChangeList* changes)
+	{
+		const DirectoryEntryRange existing = FindByPrefix(prefix);
+		const Size first = existing.First - m_Entries.GetData();
+		const Size last = existing.Last - m_Entries.GetData();
+		const Size total = m_Entries.GetCount() - existing.GetCount() + scanned.GetCount();
+
+		Array<DirectoryEntry> merged;
+		Reserve(merged, total);
+		if (first > 0)
+		{
+			merged.AddMultiple(m_Entries.GetData(), first);
+		}
+
+		// Walk both sorted lists together; anything only in one of them was added or removed
+		bool changed = false;
+		Size oldIndex = first;
+		Size newIndex = 0;
+		while (oldIndex < last || newIndex < scanned.GetCount())
+		{
+			const DirectoryEntry* oldEntry = oldIndex < last ? &m_Entries[oldIndex] : nullptr;
+			const DirectoryEntry* newEntry = newIndex < scanned.GetCount() ? &scanned[newIndex] : nullptr;
+			const char* newPath = newEntry ? scannedPool.GetData() + newEntry->PathOffset : nullptr;
+
+			int order = 0;
+			if (!oldEntry)
+			{
+				order = 1;
+			}
+			else if (!newEntry)
+			{
+				order = -1;
+			}
+			else
+			{
+				order = ComparePath(GetPath(*oldEntry), oldEntry->PathLength, newPath, newEntry->PathLength);
+			}
+
+			if (order < 0)
+			{
+				ReportChange(changes, DirectoryChangeType::Removed, GetPath(*oldEntry));
+				m_UnusedPoolBytes += Size(oldEntry->PathLength) + 1;
+				++oldIndex;
+			}
+			else if (order > 0)
+			{
+				DirectoryEntry entry = *newEntry;
+				entry.PathOffset = AddPath(newPath, newEntry->PathLength);
+				entry.ExtensionId = InternExtension(newPath, newEntry->PathLength);
+				merged.Add(entry);
+
+				ReportChange(changes, DirectoryChangeType::Added, newPath);
+				++newIndex;
+			}
+			else
+			{
+				DirectoryEntry entry = *oldEntry;
+				if (entry.FileSize != newEntry->FileSize || entry.ModifiedTime != newEntry->ModifiedTime)
+				{
+					entry.FileSize = newEntry->FileSize;
+					entry.ModifiedTime = newEntry->ModifiedTime;
+					ReportChange(changes, DirectoryChangeType::Modified, GetPath(entry));
+					changed = true;
+				}
+				merged.Add(entry);
+
+				++oldIndex;
+				++newIndex;
+			}
+
+			changed |= order != 0;
+		}
+
+		if (!changed)
+		{
+			return false;
+		}
+
+		if (last < m_Entries.GetCount())
+		{
+			merged.AddMultiple(m_Entries.GetData() + last, m_Entries.GetCount() - last);
+		}
+		m_Entries = std::move(merged);
+
+		RebuildExtensionLists();
+		CompactPool();
+
+		return true;
+	}
+
+	void DirectoryIndex::CompactPool()
+	{
+		// Only worth it once at least half of the pool is dead
+		if (m_UnusedPoolBytes == 0 || m_UnusedPoolBytes * 2 < m_PathPool.GetCount())
+		{
+			return;
+		}
+
+		Array<char> pool;
+		Reserve(pool, m_PathPool.GetCount() - m_UnusedPoolBytes);
+		for (DirectoryEntry& entry : m_Entries)
+		{
+			const U32 offset = static_cast<U32>(pool.GetCount());
+			pool.AddMultiple(GetPath(entry), Size(entry.PathLength) + 1);
+			entry.PathOffset = offset;
+		}
+
+		m_PathPool = std::move(pool);
+		m_UnusedPoolBytes = 0;
+	}
+
+	void DirectoryIndex::RebuildExtensionLists()
+	{
+		// Counting sort by extension; entries are visited in path order, so each group stays sorted
+		const Size extensionCount = m_Extensions.GetCount();
+
+		m_ExtensionStart.Empty();
+		Reserve(m_ExtensionStart, extensionCount + 1);
+		for (Size i = 0; i <= extensionCount; ++i)
+		{
+			m_ExtensionStart.Add(0);
+		}
+		for (const DirectoryEntry& entry : m_Entries)
+		{
+			++m_ExtensionStart[entry.ExtensionId + 1];
+		}
+		for (Size i = 1; i <= extensionCount; ++i)
+		{
+			m_ExtensionStart[i] += m_ExtensionStart[i - 1];
+		}
+
+		m_ExtensionEntries.Empty();
+		if (m_Entries.GetCount() == 0)
+		{
+			return;
+		}
+
+		Reserve(m_ExtensionEntries, m_Entries.GetCount());
+		for (Size i = 0; i < m_Entries.GetCount(); ++i)
+		{
+			m_ExtensionEntries.Add(0);
+		}
+
+		Array<U32> cursor;
+		cursor.AddMultiple(m_ExtensionStart.GetData(), extensionCount);
+		for (Size i = 0; i < m_Entries.GetCount(); ++i)
+		{
+			m_ExtensionEntries[cursor[m_Entries[i].ExtensionId]++] = static_cast<U32>(i);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,273 @@
+#pragma once
+
+#include "Array.h"
+#include "FileSystem.h"
+#include "Types.h"
+
+namespace Noble
+{
+	/**
+	 * A file recorded by a DirectoryIndex
+	 */
+	struct DirectoryEntry
+	{
+		// Offset of the path in the index's string pool
+		U32 PathOffset;
+		// Length of the path, excluding the null terminator
+		U16 PathLength;
+		// Interned lowercase extension, 0 if the file has none
+		U16 ExtensionId;
+		// File size in bytes
+		U64 FileSize;
+		// Last write time in platform ticks, only meaningful for comparison
+		I64 ModifiedTime;
+	};
+
+	/**
+	 * Contiguous run of entries, as returned by prefix queries
+	 */
+	struct DirectoryEntryRange
+	{
+		const DirectoryEntry* First;
+		const DirectoryEntry* Last;
+
+		const DirectoryEntry* begin() const { return First; }
+		const DirectoryEntry* end() const { return Last; }
+
+		Size GetCount() const { return Last - First; }
+		bool IsEmpty() const { return First == Last; }
+	};
+
+	/**
+	 * Entries that share an extension, in path order
+	 */
+	struct DirectoryEntryList
+	{
+		struct Iterator
+		{
+			const DirectoryEntry* Entries;
+			const U32* Index;
+
+			const DirectoryEntry& operator*() const { return Entries[*Index]; }
+			const DirectoryEntry* operator->() const { return Entries + *Index; }
+			Iterator& operator++() { ++Index; return *this; }
+			bool operator!=(const Iterator& other) const { return Index != other.Index; }
+		};
+
+		const DirectoryEntry* Entries;
+		const U32* First;
+		const U32* Last;
+
+		Iterator begin() const { return Iterator{ Entries, First }; }
+		Iterator end() const { return Iterator{ Entries, Last }; }
+
+		Size GetCount() const { return Last - First; }
+		bool IsEmpty() const { return First == Last; }
+	};
+
+	/**
+	 * Kinds of change reported when the index is updated
+	 */
+	enum class DirectoryChangeType : U8
+	{
+		Added,
+		Modified,
+		Removed
+	};
+
+	/**
+	 * A file that changed since the index last saw it
+	 */
+	struct DirectoryChange
+	{
+		DirectoryChangeType Type;
+		// Offset of the path, relative to the index root, in the owning list's pool
+		U32 PathOffset;
+	};
+
+	/**
+	 * Changes reported by a DirectoryIndex update
+	 * Paths are packed into one pool, so filling the list doesn't allocate per change
+	 */
+	class DirectoryChangeList
+	{
+	public:
+
+		/**
+		 * Records a change to the path
+		 */
+		void Add(DirectoryChangeType type, const char* path);
+
+		/**
+		 * Removes every change, keeping the storage
+		 */
+		void Empty();
+
+		/**
+		 * Returns the path of the change, relative to the index root
+		 */
+		const char* GetPath(const DirectoryChange& change) const { return m_Paths.GetData() + change.PathOffset; }
+
+		Size GetCount() const { return m_Changes.GetCount(); }
+		const DirectoryChange& operator[](Size index) const { return m_Changes[index]; }
+
+		const DirectoryChange* begin() const { return m_Changes.GetData(); }
+		const DirectoryChange* end() const { return m_Changes.GetData() + m_Changes.GetCount(); }
+
+	private:
+
+		// Changes in the order they were found
+		Array<DirectoryChange> m_Changes;
+		// Null-terminated paths of the changes
+		Array<char> m_Paths;
+	};
+
+	/**
+	 * Cached table of every regular file below a content root
+	 *
+	 * The tree is scanned once, in parallel, and stored as a compact array of entries sorted by
+	 * relative path ('/'-separated), with the paths packed into a single string pool and extensions
+	 * interned. Lookups, subtree (prefix) queries and extension queries never touch the disk.
+	 *
+	 * The index can be kept current without a full rescan: UpdatePath re-stats a single file or
+	 * subtree, and Refresh rescans everything and reports the differences. Queries and updates
+	 * must not run concurrently; any update invalidates previously returned ranges.
+	 */
+	class DirectoryIndex
+	{
+	public:
+
+		DirectoryIndex();
+
+		NO_COPY(DirectoryIndex)
+
+		/**
+		 * Scans @root and replaces the contents of the index
+		 * @workerCount threads are used, 0 picks one per hardware thread
+		 */
+		bool Build(const fs::path& root, U32 workerCount = 0);
+
+		/**
+		 * Rescans the root and records every added, modified or removed file in @changes
+		 * Returns true if anything changed
+		 */
+		bool Refresh(DirectoryChangeList* changes = nullptr, U32 workerCount = 0);
+
+		/**
+		 * Re-stats a single path relative to the root, which may be a file, a directory
+		 * (rescanned as a subtree) or something that no longer exists
+		 * Any differences are applied and recorded in @changes. Returns true if anything changed.
+		 */
+		bool UpdatePath(const char* relativePath, DirectoryChangeList* changes = nullptr);
+
+		/**
+		 * Removes every entry and forgets the root
+		 */
+		void Clear();
+
+		/**
+		 * Returns the entry for the relative path, or nullptr if it isn't indexed
+		 */
+		const DirectoryEntry* Find(const char* relativePath) const;
+
+		/**
+		 * Returns every entry whose path starts with @prefix
+		 * A prefix ending in '/' selects a directory's whole subtree
+		 */
+		DirectoryEntryRange FindByPrefix(const char* prefix) const;
+
+		/**
+		 * Returns every entry with the given extension, with or without the leading '.'
+		 * Matching is case-insensitive
+		 */
+		DirectoryEntryList FindByExtension(const char* extension) const;
+
+		/**
+		 * Returns every entry
+		 */
+		DirectoryEntryRange GetEntries() const;
+
+		/**
+		 * Returns the null-terminated path of the entry, relative to the root
+		 */
+		const char* GetPath(const DirectoryEntry& entry) const { return m_PathPool.GetData() + entry.PathOffset; }
+
+		/**
+		 * Returns the root joined with the entry's path
+		 */
+		fs::path GetFullPath(const DirectoryEntry& entry) const;
+
+		/**
+		 * Returns the interned extension of the entry, without the leading '.'
+		 */
+		const char* GetExtension(const DirectoryEntry& entry) const;
+
+		/**
+		 * Returns the scanned root
+		 */
+		const fs::path& GetRoot() const { return m_Root; }
+
+		/**
+		 * Returns the number of indexed files
+		 */
+		Size GetCount() const { return m_Entries.GetCount(); }
+
+		/**
+		 * Returns true if the index has been built
+		 */
+		bool IsBuilt() const { return m_Built; }
+
+	private:
+
+		/**
+		 * Returns the index of the first entry whose path isn't less than @path
+		 */
+		Size LowerBound(const char* path, Size length) const;
+
+		/**
+		 * Copies the path into the pool and returns its offset
+		 */
+		U32 AddPath(const char* path, Size length);
+
+		/**
+		 * Returns the id of the lowercase extension of @path, adding it if it's new
+		 */
+		U16 InternExtension(const char* path, Size length);
+
+		/**
+		 * Replaces every entry with a path starting with @prefix by the sorted @scanned entries,
+		 * whose paths live in @scannedPool, and reports the differences
+		 */
+		bool MergeScanned(const char* prefix, const Array<DirectoryEntry>& scanned, const Array<char>& scannedPool,
+			DirectoryChangeList* changes);
+
+		/**
+		 * Rebuilds the pool without the paths of removed entries once enough of it is unused
+		 */
+		void CompactPool();
+
+		/**
+		 * Rebuilds the per-extension lists after the entries change
+		 */
+		void RebuildExtensionLists();
+
+	private:
+
+		// Scanned directory
+		fs::path m_Root;
+		// Every file, sorted by path
+		Array<DirectoryEntry> m_Entries;
+		// Null-terminated relative paths of the entries
+		Array<char> m_PathPool;
+		// Bytes of the pool no longer referenced by an entry
+		Size m_UnusedPoolBytes;
+		// Interned extensions as offsets into m_ExtensionPool; id 0 is the empty extension
+		Array<U32> m_Extensions;
+		Array<char> m_ExtensionPool;
+		// Entry indices grouped by extension; group i spans m_ExtensionStart[i] to m_ExtensionStart[i + 1]
+		Array<U32> m_ExtensionEntries;
+		Array<U32> m_ExtensionStart;
+		// Set once Build succeeds
+		bool m_Built;
+	};
+}
\ No newline at end of file
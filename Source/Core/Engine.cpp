@@ -88,9 +88,21 @@ namespace Noble
 		// Initialize the logger
 		NE_LOG_INFO("Noble Engine %s - %s", NOBLE_VERSION, __DATE__);
 
+		// Start async file I/O early so everything after can use it
+		result = m_FileIO.Initialize();
+		if (!result)
+		{
+			NE_LOG_FATAL("Async file I/O failed to initialize");
+			return false;
+		}
+		g_FileIO = &m_FileIO;
+
 		// Load the config file for other subsystems to use
 		Config::LoadConfig();
 
+		// Index the content directory before anything registers or loads assets
+		m_AssetManager.LoadAssetRegistry();
+
 		// Create the game window and start the renderer
 		result = m_Renderer.Initialize(inst->GetGameName());
 		if (!result)
@@ -162,6 +174,18 @@ namespace Noble
 			finish = HandleWindowsMessages(msg);
 			if (!finish)
 			{
+				// Run callbacks for file requests that finished since last frame
+				m_FileIO.ProcessCompletions();
+
+				// Reload assets whose files changed on disk
+				m_AssetManager.ProcessContentChanges();
+
+				// Finish assets parsed in the background, within a small slice of the frame
+				m_AssetManager.ProcessAsyncLoads();
+
+				// Evict unreferenced assets if over the memory budget
+				m_AssetManager.UpdateResidency();
+
 				Input::PreFrame();
 
 				// Count fixed steps to circumvent spiraling from hard freezes
@@ -205,6 +229,11 @@ namespace Noble
 		// Close the window down
 		m_Renderer.Shutdown();
 
+		// Finish outstanding file I/O and run the remaining callbacks
+		m_FileIO.Shutdown();
+		m_FileIO.ProcessCompletions();
+		g_FileIO = nullptr;
+
 		// Print the current log
 		Logger::PrintLog("LogFile.txt");
 
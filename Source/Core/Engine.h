@@ -3,6 +3,7 @@
 #define NOBLE_VERSION "Early Dev"
 
 #include "AssetManager.h"
+#include "AsyncFileIO.h"
 #include "Time.h"
 #include "Renderer.h"
 #include "World.h"
@@ -72,6 +73,8 @@ namespace Noble
 		World m_World;
 		// Handles asset loading and unloading
 		AssetManager m_AssetManager;
+		// Services file reads and writes off the main thread
+		AsyncFileIO m_FileIO;
 		// Camera manager instance
 		CameraManager m_CamManager;
 		// Physics handler
@@ -0,0 +1,32 @@
+#include "EventBus.h"
+
+namespace Noble
+{
+	EventBus::EventBus()
+	{}
+
+	EventBus::~EventBus()
+	{
+		for (EventQueueBase* queue : m_DispatchOrder)
+		{
+			NE_DELETE(m_QueueMemory, queue);
+		}
+	}
+
+	void EventBus::Dispatch()
+	{
+		// Indexed loop: a handler may use a new event type, which appends a queue
+		for (Size i = 0; i < m_DispatchOrder.GetCount(); ++i)
+		{
+			m_DispatchOrder[i]->Dispatch();
+		}
+	}
+
+	void EventBus::Discard()
+	{
+		for (EventQueueBase* queue : m_DispatchOrder)
+		{
+			queue->Discard();
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,279 @@
+#pragma once
+
+#include "Array.h"
+#include "Functional.h"
+#include "Memory.h"
+#include "Types.h"
+
+#include <atomic>
+
+namespace Noble
+{
+	/**
+	 * A batch of queued events of a single type, handed to subscribers on dispatch
+	 * Only valid for the duration of the subscriber call
+	 */
+	template <typename EventType>
+	struct EventBatch
+	{
+		// Contiguous array of events
+		const EventType* Events;
+		// Number of events in the batch
+		Size Count;
+
+		const EventType& operator[](Size index) const
+		{
+			CHECK(index < Count);
+			return Events[index];
+		}
+
+		// RANGED FOR LOOP SUPPORT
+
+		const EventType* begin() const { return Events; }
+		const EventType* end() const { return Events + Count; }
+	};
+
+	/**
+	 * Type-erased interface for the per-type queues held by the EventBus
+	 */
+	class EventQueueBase
+	{
+	public:
+
+		virtual ~EventQueueBase() {}
+
+		/**
+		 * Hands all queued events to the subscribers, then empties the queue
+		 */
+		virtual void Dispatch() = 0;
+
+		/**
+		 * Drops all queued events without dispatching them
+		 */
+		virtual void Discard() = 0;
+	};
+
+	/**
+	 * Holds the pending events and subscribers for a single event type
+	 *
+	 * Events are written into one of two arrays; dispatch flips to the other one before
+	 * calling subscribers, so events sent from inside a handler land in the next batch
+	 * instead of invalidating the one being read.
+	 */
+	template <typename EventType>
+	class EventQueue : public EventQueueBase
+	{
+	public:
+
+		typedef Delegate<void(const EventBatch<EventType>&)> HandlerType;
+
+		EventQueue()
+			: m_WriteIndex(0)
+		{}
+
+		/**
+		 * Appends an event to the pending batch
+		 */
+		void Push(const EventType& ev)
+		{
+			m_Events[m_WriteIndex].Add(ev);
+		}
+
+		/**
+		 * Appends an event to the pending batch
+		 */
+		void Push(EventType&& ev)
+		{
+			m_Events[m_WriteIndex].Add(std::move(ev));
+		}
+
+		/**
+		 * Returns the number of pending events
+		 */
+		Size GetPendingCount() const
+		{
+			return m_Events[m_WriteIndex].GetCount();
+		}
+
+		/**
+		 * Returns the subscriber list for this type
+		 */
+		MulticastDelegate<void(const EventBatch<EventType>&)>& GetHandlers()
+		{
+			return m_Handlers;
+		}
+
+		virtual void Dispatch() override
+		{
+			Array<EventType>& batch = m_Events[m_WriteIndex];
+			if (batch.GetCount() == 0)
+			{
+				return;
+			}
+
+			// Further sends go to the other buffer
+			m_WriteIndex ^= 1;
+
+			EventBatch<EventType> view;
+			view.Events = batch.GetData();
+			view.Count = batch.GetCount();
+			m_Handlers.Broadcast(view);
+
+			// Keep the storage around for the next frame
+			batch.Empty();
+		}
+
+		virtual void Discard() override
+		{
+			m_Events[0].Empty();
+			m_Events[1].Empty();
+		}
+
+	private:
+
+		// Double-buffered event storage
+		Array<EventType> m_Events[2];
+		// Index of the buffer currently receiving events
+		U8 m_WriteIndex;
+		// Subscribers for this type
+		MulticastDelegate<void(const EventBatch<EventType>&)> m_Handlers;
+	};
+
+	/**
+	 * Typed event bus. Events are appended to a contiguous queue per event type as they
+	 * are sent, and subscribers receive them as whole batches when Dispatch() is called
+	 * instead of through one virtual call per event.
+	 *
+	 * Event types need to be default-constructible and copy-assignable (they are stored
+	 * in an Array).
+	 */
+	class EventBus
+	{
+	public:
+
+		EventBus();
+
+		NO_COPY_NO_MOVE(EventBus)
+
+		/**
+		 * Frees every queue
+		 */
+		~EventBus();
+
+	public:
+
+		/**
+		 * Queues an event to be delivered on the next dispatch
+		 */
+		template <typename EventType>
+		void Send(const EventType& ev)
+		{
+			GetQueue<EventType>()->Push(ev);
+		}
+
+		/**
+		 * Queues an event to be delivered on the next dispatch
+		 */
+		template <typename EventType>
+		void Send(EventType&& ev)
+		{
+			GetQueue<std::decay_t<EventType>>()->Push(std::forward<EventType>(ev));
+		}
+
+		/**
+		 * Registers a handler that receives each batch of the given event type
+		 * Returns a handle that can be passed to Unsubscribe
+		 */
+		template <typename EventType, typename F>
+		DelegateHandle Subscribe(F&& handler)
+		{
+			return GetQueue<EventType>()->GetHandlers().Add(std::forward<F>(handler));
+		}
+
+		/**
+		 * Registers a member function that receives each batch of the given event type
+		 */
+		template <typename EventType, typename Obj, typename Pointer>
+		DelegateHandle Subscribe(Obj* obj, Pointer func)
+		{
+			return GetQueue<EventType>()->GetHandlers().AddMember(obj, func);
+		}
+
+		/**
+		 * Removes a handler added with Subscribe
+		 */
+		template <typename EventType>
+		bool Unsubscribe(DelegateHandle handle)
+		{
+			return GetQueue<EventType>()->GetHandlers().Remove(handle);
+		}
+
+		/**
+		 * Returns the number of events of the given type waiting for dispatch
+		 */
+		template <typename EventType>
+		Size GetPendingCount()
+		{
+			return GetQueue<EventType>()->GetPendingCount();
+		}
+
+		/**
+		 * Delivers every pending batch to its subscribers, one event type at a time
+		 * in the order the types were first used
+		 */
+		void Dispatch();
+
+		/**
+		 * Drops all pending events without delivering them
+		 */
+		void Discard();
+
+	private:
+
+		/**
+		 * Returns a process-wide unique index for the event type
+		 * Buses on different threads may ask for a new type at once, so the counter is atomic
+		 */
+		template <typename EventType>
+		static U32 GetTypeIndex()
+		{
+			static const U32 index = s_NextTypeIndex.fetch_add(1, std::memory_order_relaxed);
+			return index;
+		}
+
+		/**
+		 * Returns the queue for the event type, creating it on first use
+		 */
+		template <typename EventType>
+		EventQueue<EventType>* GetQueue()
+		{
+			const U32 index = GetTypeIndex<EventType>();
+
+			while (m_QueuesByType.GetCount() <= index)
+			{
+				m_QueuesByType.Add(nullptr);
+			}
+
+			EventQueueBase*& queue = m_QueuesByType[index];
+			if (!queue)
+			{
+				queue = NE_NEW(m_QueueMemory, EventQueue<EventType>);
+				m_DispatchOrder.Add(queue);
+			}
+
+			return static_cast<EventQueue<EventType>*>(queue);
+		}
+
+	private:
+
+		// Counter for handing out event type indices
+		inline static std::atomic<U32> s_NextTypeIndex = 0;
+
+		// Memory for the queue objects
+		MemoryArena<BasicAllocator, DefaultTracking> m_QueueMemory;
+		// Queues indexed by event type index (null for types this bus hasn't seen)
+		Array<EventQueueBase*> m_QueuesByType;
+		// Queues in the order they were created, which is the dispatch order
+		Array<EventQueueBase*> m_DispatchOrder;
+	};
+}
\ No newline at end of file
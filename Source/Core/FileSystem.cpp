@@ -1,7 +1,19 @@
 #include "FileSystem.h"
 
+#include "Checksum.h"
 #include "Logger.h"
+
+#ifdef NOBLE_WINDOWS
 #include "WindowsMinimal.h"
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
 
 namespace Noble
 {
@@ -58,28 +70,16 @@ namespace Noble
 
 	Array<fs::path> Directory::Iterate()
 	{
-		// First count the number of relevant children
-		Size count = 0;
-		for (const auto& entry : fs::directory_iterator(m_Path))
-		{
-			if (fs::is_directory(entry) || fs::is_regular_file(entry))
-			{
-				count++;
-			}
-		}
-
-		// Now fill the array
 		Array<fs::path> arr;
-		if (count > 0)
+		std::error_code error;
+		for (fs::directory_iterator iter(m_Path, error); !error && iter != fs::directory_iterator(); iter.increment(error))
 		{
-			arr.Resize(count);
-			for (const auto& entry : fs::directory_iterator(m_Path))
+			// Entries cache their type from the directory read where the platform provides it,
+			// so this doesn't stat every child
+			std::error_code typeError;
+			if (iter->is_directory(typeError) || iter->is_regular_file(typeError))
 			{
-				if (fs::is_directory(entry) || fs::is_regular_file(entry))
-				{
-					fs::path path = entry.path();
-					arr.Add(path);
-				}
+				arr.Add(iter->path());
 			}
 		}
 
@@ -88,28 +88,14 @@ namespace Noble
 
 	Array<fs::path> Directory::IterateRecursive()
 	{
-		// First count the number of relevant children
-		Size count = 0;
-		for (const auto& entry : fs::recursive_directory_iterator(m_Path))
-		{
-			if (fs::is_directory(entry) || fs::is_regular_file(entry))
-			{
-				count++;
-			}
-		}
-
-		// Now fill the array
 		Array<fs::path> arr;
-		if (count > 0)
+		std::error_code error;
+		for (fs::recursive_directory_iterator iter(m_Path, error); !error && iter != fs::recursive_directory_iterator(); iter.increment(error))
 		{
-			arr.Resize(count);
-			for (const auto& entry : fs::recursive_directory_iterator(m_Path))
+			std::error_code typeError;
+			if (iter->is_directory(typeError) || iter->is_regular_file(typeError))
 			{
-				if (fs::is_directory(entry) || fs::is_regular_file(entry))
-				{
-					fs::path path = entry.path();
-					arr.Add(path);
-				}
+				arr.Add(iter->path());
 			}
 		}
 
@@ -133,8 +119,9 @@ namespace Noble
 
 	File::File()
 	{
-		m_Handle = NULL;
+		m_Handle = InvalidFileHandle;
 		m_FileSize = 0;
+		m_Position = 0;
 		m_Mode = FileMode::FILE_READ;
 	}
 
@@ -148,21 +135,28 @@ namespace Noble
 	{
 		m_Handle = other.m_Handle;
 		m_FileSize = other.m_FileSize;
+		m_Position = other.m_Position;
 		m_Mode = other.m_Mode;
 
-		other.m_Handle = NULL;
+		other.m_Handle = InvalidFileHandle;
 		other.m_FileSize = 0;
+		other.m_Position = 0;
 		other.m_Mode = FileMode::FILE_READ;
 	}
 
 	File& File::operator=(File&& other) noexcept
 	{
+		// Close any existing opened file
+		Close();
+
 		m_Handle = other.m_Handle;
 		m_FileSize = other.m_FileSize;
+		m_Position = other.m_Position;
 		m_Mode = other.m_Mode;
 
-		other.m_Handle = NULL;
+		other.m_Handle = InvalidFileHandle;
 		other.m_FileSize = 0;
+		other.m_Position = 0;
 		other.m_Mode = FileMode::FILE_READ;
 
 		return *this;
@@ -173,6 +167,7 @@ namespace Noble
 		Close();
 	}
 
+#ifdef NOBLE_WINDOWS
 	void File::Open(const fs::path& path, FileMode mode, bool create)
 	{
 		// Skip if a file is already open
@@ -184,6 +179,7 @@ namespace Noble
 
 		// Set up access params
 		m_Mode = mode;
+		m_Position = 0;
 		DWORD dwAccess = 0;
 		DWORD dwShare = 0;
 		DWORD dwCreation = 0;
@@ -223,7 +219,7 @@ namespace Noble
 		if (m_Handle == INVALID_HANDLE_VALUE)
 		{
 			NE_LOG_WARNING("Failed to open file %s - Error Msg: %u", path.string().c_str(), GetLastError());
-			m_Handle = NULL;
+			m_Handle = InvalidFileHandle;
 			return;
 		}
 
@@ -240,10 +236,14 @@ namespace Noble
 
 	void File::Close()
 	{
-		if (m_Handle)
+		if (IsValid())
 		{
 			CloseHandle(m_Handle);
+			m_Handle = InvalidFileHandle;
 		}
+
+		m_FileSize = 0;
+		m_Position = 0;
 	}
 
 	Size File::Read(void* buffer, Size maxRead)
@@ -271,26 +271,189 @@ namespace Noble
 			NE_LOG_INFO("Read %u bytes from file, which is different from requested %u bytes", bytesRead, maxRead);
 		}
 
+		m_Position += bytesRead;
 		return bytesRead;
 	}
 
-	Size File::Read(BitStream& buffer, Size maxRead)
+	Size File::Write(const void* data, Size maxWrite)
 	{
-		// Update max read value
-		maxRead = maxRead == 0 ? GetFileSize() : maxRead;
+		// Check for file validity
+		if (!IsValid())
+		{
+			NE_LOG_WARNING("Attempted to write to invalid File object");
+			return 0;
+		}
 
-		// Check if buffer needs resizing
-		if ((buffer.GetMaxBytes() - buffer.GetStoredBytes()) < maxRead)
+		// Write to file and store bytes written
+		DWORD bytesWritten = 0;
+		BOOL result = WriteFile(m_Handle, data, maxWrite, &bytesWritten, NULL);
+
+		// Check for error and unexpected state
+		if (result == FALSE)
 		{
-			buffer.Resize(maxRead);
+			NE_LOG_WARNING("File write failed - Error Msg: %u", GetLastError());
+			return 0;
 		}
 
-		// Perform the read directly into the buffer
-		Size bytesRead = Read(buffer.GetData(), maxRead);
-		
-		// Update the buffer's "stored bytes" value
-		buffer.UpdateStoredBytes(bytesRead);
+		if (bytesWritten != maxWrite)
+		{
+			NE_LOG_INFO("Wrote %u bytes to file, which is different from requested %u bytes", bytesWritten, maxWrite);
+		}
+
+		m_Position += bytesWritten;
+		return bytesWritten;
+	}
+
+	void File::Seek(Size position)
+	{
+		if (!IsValid())
+		{
+			return;
+		}
+
+		LARGE_INTEGER distance;
+		distance.QuadPart = static_cast<LONGLONG>(position);
+		if (SetFilePointerEx(m_Handle, distance, NULL, FILE_BEGIN))
+		{
+			m_Position = position;
+		}
+	}
+
+	Size File::ReadV(const FileSpan* spans, Size count)
+	{
+		// ReadFileScatter needs unbuffered, page-aligned I/O, so just go span by span
+		Size total = 0;
+		for (Size i = 0; i < count; ++i)
+		{
+			const Size bytesRead = Read(spans[i].Data, spans[i].Length);
+			total += bytesRead;
+			if (bytesRead != spans[i].Length)
+			{
+				break;
+			}
+		}
+
+		return total;
+	}
+
+	Size File::WriteV(const ConstFileSpan* spans, Size count)
+	{
+		// Same restriction applies to WriteFileGather
+		Size total = 0;
+		for (Size i = 0; i < count; ++i)
+		{
+			const Size bytesWritten = Write(spans[i].Data, spans[i].Length);
+			total += bytesWritten;
+			if (bytesWritten != spans[i].Length)
+			{
+				break;
+			}
+		}
+
+		return total;
+	}
+#else
+	void File::Open(const fs::path& path, FileMode mode, bool create)
+	{
+		// Skip if a file is already open
+		if (IsValid())
+		{
+			NE_LOG_WARNING("Attempted to open a file without closing the original - file %s will not be opened.", path.string().c_str());
+			return;
+		}
+
+		// Set up access flags to match the Windows behaviour
+		m_Mode = mode;
+		m_Position = 0;
+		int flags = O_CLOEXEC;
+
+		switch (mode)
+		{
+			case FileMode::FILE_READ:
+				// Only read, existing only
+				flags |= O_RDONLY;
+				break;
+			case FileMode::FILE_WRITE_REPLACE:
+				// Only write, truncating existing or creating if requested
+				flags |= O_WRONLY | O_TRUNC | (create ? O_CREAT : 0);
+				break;
+			case FileMode::FILE_WRITE_APPEND:
+				// Only write, always at the end, creating if requested
+				flags |= O_WRONLY | O_APPEND | (create ? O_CREAT : 0);
+				break;
+		}
+
+		// Open the file and check for error
+		m_Handle = ::open(path.c_str(), flags, 0644);
+		if (m_Handle == InvalidFileHandle)
+		{
+			NE_LOG_WARNING("Failed to open file %s - Error Msg: %s", path.string().c_str(), strerror(errno));
+			return;
+		}
+
+		// Grab file size
+		struct stat info;
+		if (::fstat(m_Handle, &info) != 0)
+		{
+			NE_LOG_WARNING("Failed to find file size for file %s", path.string().c_str());
+			m_FileSize = 0;
+			return;
+		}
+		m_FileSize = static_cast<Size>(info.st_size);
+	}
+
+	void File::Close()
+	{
+		if (IsValid())
+		{
+			::close(m_Handle);
+			m_Handle = InvalidFileHandle;
+		}
+
+		m_FileSize = 0;
+		m_Position = 0;
+	}
 
+	Size File::Read(void* buffer, Size maxRead)
+	{
+		// Check for file validity
+		if (!IsValid())
+		{
+			NE_LOG_WARNING("Attempted to read from invalid File object");
+			return 0;
+		}
+
+		// pread may return less than requested, so keep going until EOF or error
+		Byte* dest = static_cast<Byte*>(buffer);
+		Size bytesRead = 0;
+		while (bytesRead < maxRead)
+		{
+			ssize_t result = ::pread(m_Handle, dest + bytesRead, maxRead - bytesRead, static_cast<off_t>(m_Position + bytesRead));
+			if (result < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+
+				NE_LOG_WARNING("File read failed - Error Msg: %s", strerror(errno));
+				break;
+			}
+
+			if (result == 0)
+			{
+				break;
+			}
+
+			bytesRead += static_cast<Size>(result);
+		}
+
+		if (bytesRead != maxRead)
+		{
+			NE_LOG_INFO("Read %u bytes from file, which is different from requested %u bytes", bytesRead, maxRead);
+		}
+
+		m_Position += bytesRead;
 		return bytesRead;
 	}
 
@@ -303,15 +466,31 @@ namespace Noble
 			return 0;
 		}
 
-		// Write to file and store bytes written
-		DWORD bytesWritten = 0;
-		BOOL result = WriteFile(m_Handle, data, maxWrite, &bytesWritten, NULL);
-
-		// Check for error and unexpected state
-		if (result == FALSE)
+		// In append mode the kernel places every write at the end, whatever the offset
+		const Byte* source = static_cast<const Byte*>(data);
+		Size bytesWritten = 0;
+		while (bytesWritten < maxWrite)
 		{
-			NE_LOG_WARNING("File write failed - Error Msg: %u", GetLastError());
-			return 0;
+			ssize_t result = ::pwrite(m_Handle, source + bytesWritten, maxWrite - bytesWritten, static_cast<off_t>(m_Position + bytesWritten));
+			if (result < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+
+				NE_LOG_WARNING("File write failed - Error Msg: %s", strerror(errno));
+				break;
+			}
+
+			// Nothing written and no error would otherwise retry forever
+			if (result == 0)
+			{
+				NE_LOG_WARNING("File write made no progress");
+				break;
+			}
+
+			bytesWritten += static_cast<Size>(result);
 		}
 
 		if (bytesWritten != maxWrite)
@@ -319,16 +498,306 @@ namespace Noble
 			NE_LOG_INFO("Wrote %u bytes to file, which is different from requested %u bytes", bytesWritten, maxWrite);
 		}
 
+		m_Position += bytesWritten;
 		return bytesWritten;
 	}
 
+	void File::Seek(Size position)
+	{
+		// Reads and writes go through pread/pwrite, so the position is all there is
+		m_Position = position;
+	}
+
+	namespace
+	{
+		// Spans handed to the kernel per preadv/pwritev call, well under IOV_MAX
+		constexpr Size MaxSpansPerCall = 64;
+
+		/**
+		 * Runs preadv/pwritev until every vector is done, EOF or an error
+		 * Returns the number of bytes transferred
+		 */
+		Size TransferVectored(int handle, iovec* vectors, int count, Size position, bool write)
+		{
+			Size transferred = 0;
+			while (count > 0)
+			{
+				const off_t offset = static_cast<off_t>(position + transferred);
+				ssize_t result = write ? ::pwritev(handle, vectors, count, offset) : ::preadv(handle, vectors, count, offset);
+				if (result < 0)
+				{
+					if (errno == EINTR)
+					{
+						continue;
+					}
+
+					NE_LOG_WARNING("Vectored file %s failed - Error Msg: %s", write ? "write" : "read", strerror(errno));
+					break;
+				}
+
+				if (result == 0)
+				{
+					break;
+				}
+
+				transferred += static_cast<Size>(result);
+
+				// Skip the vectors that were completed, then trim a partial one
+				Size remaining = static_cast<Size>(result);
+				while (count > 0 && remaining >= vectors->iov_len)
+				{
+					remaining -= vectors->iov_len;
+					++vectors;
+					--count;
+				}
+				if (count > 0)
+				{
+					vectors->iov_base = static_cast<Byte*>(vectors->iov_base) + remaining;
+					vectors->iov_len -= remaining;
+				}
+			}
+
+			return transferred;
+		}
+	}
+
+	Size File::ReadV(const FileSpan* spans, Size count)
+	{
+		if (!IsValid())
+		{
+			NE_LOG_WARNING("Attempted to read from invalid File object");
+			return 0;
+		}
+
+		Size total = 0;
+		for (Size first = 0; first < count; first += MaxSpansPerCall)
+		{
+			iovec vectors[MaxSpansPerCall];
+			const Size batch = glm::min(count - first, MaxSpansPerCall);
+			Size batchBytes = 0;
+			for (Size i = 0; i < batch; ++i)
+			{
+				vectors[i].iov_base = spans[first + i].Data;
+				vectors[i].iov_len = spans[first + i].Length;
+				batchBytes += spans[first + i].Length;
+			}
+
+			const Size bytesRead = TransferVectored(m_Handle, vectors, static_cast<int>(batch), m_Position, false);
+			m_Position += bytesRead;
+			total += bytesRead;
+			if (bytesRead != batchBytes)
+			{
+				break;
+			}
+		}
+
+		return total;
+	}
+
+	Size File::WriteV(const ConstFileSpan* spans, Size count)
+	{
+		if (!IsValid())
+		{
+			NE_LOG_WARNING("Attempted to write to invalid File object");
+			return 0;
+		}
+
+		Size total = 0;
+		for (Size first = 0; first < count; first += MaxSpansPerCall)
+		{
+			iovec vectors[MaxSpansPerCall];
+			const Size batch = glm::min(count - first, MaxSpansPerCall);
+			Size batchBytes = 0;
+			for (Size i = 0; i < batch; ++i)
+			{
+				vectors[i].iov_base = const_cast<void*>(spans[first + i].Data);
+				vectors[i].iov_len = spans[first + i].Length;
+				batchBytes += spans[first + i].Length;
+			}
+
+			const Size bytesWritten = TransferVectored(m_Handle, vectors, static_cast<int>(batch), m_Position, true);
+			m_Position += bytesWritten;
+			total += bytesWritten;
+			if (bytesWritten != batchBytes)
+			{
+				NE_LOG_INFO("Wrote %u bytes to file, which is different from requested %u bytes", bytesWritten, batchBytes);
+				break;
+			}
+		}
+
+		return total;
+	}
+#endif
+
+	Size File::Read(BitStream& buffer, Size maxRead)
+	{
+		// Update max read value
+		maxRead = maxRead == 0 ? GetFileSize() - glm::min(m_Position, GetFileSize()) : maxRead;
+
+		// Check if buffer needs resizing
+		const Size storedBytes = buffer.GetStoredBytes();
+		if ((buffer.GetMaxBytes() - storedBytes) < maxRead)
+		{
+			buffer.Resize(storedBytes + maxRead);
+		}
+
+		// Perform the read directly into the buffer, after anything already stored
+		Size bytesRead = Read(buffer.GetData() + storedBytes, maxRead);
+		
+		// Update the buffer's "stored bytes" value
+		buffer.UpdateStoredBytes(storedBytes + bytesRead);
+
+		return bytesRead;
+	}
+
+	bool File::WriteChecksummed(const void* data, Size size, U32 blockSize)
+	{
+		// The payload goes straight from the caller's memory, after the header
+		BitStream header;
+		ChecksumFrame::WriteHeader(data, size, header, blockSize);
+
+		const ConstFileSpan spans[] = { { header.GetData(), header.GetStoredBytes() }, { data, size } };
+		return WriteV(spans, 2) == header.GetStoredBytes() + size;
+	}
+
+	bool File::ReadChecksummed(BitStream& buffer, U32 workerCount)
+	{
+		// Only the header and checksum table are read on their own; the payload is read straight
+		// into @buffer and verified where it lands
+		BitStream header;
+		Read(header, ChecksumFrame::HeaderSize);
+		const Size headerSize = ChecksumFrame::GetHeaderAndTableSize(BitStreamView(header));
+		if (headerSize > 0)
+		{
+			Read(header, headerSize - header.GetStoredBytes());
+		}
+
+		BitStreamView headerView(header);
+		ChecksumFrameReader reader;
+		if (headerSize == 0 || !reader.OpenHeader(headerView))
+		{
+			NE_LOG_WARNING("File does not contain a valid checksum frame");
+			return false;
+		}
+
+		const Size storedBytes = buffer.GetStoredBytes();
+		if (reader.GetPayloadSize() > 0 && Read(buffer, reader.GetPayloadSize()) != reader.GetPayloadSize())
+		{
+			NE_LOG_WARNING("Checksum frame is truncated");
+			buffer.UpdateStoredBytes(storedBytes);
+			return false;
+		}
+
+		reader.SetPayload(buffer.GetData() + storedBytes);
+		if (!reader.VerifyAll(workerCount))
+		{
+			NE_LOG_WARNING("File failed checksum verification");
+			buffer.UpdateStoredBytes(storedBytes);
+			return false;
+		}
+
+		return true;
+	}
+
+	// ----- Buffered File Writer -----
+
+	BufferedFileWriter::BufferedFileWriter(File& file, Size bufferSize)
+		: m_File(file), m_Buffer(nullptr), m_BufferSize(bufferSize), m_BufferedBytes(0), m_BytesWritten(0), m_Failed(false)
+	{
+		CHECK(bufferSize > 0);
+		m_Buffer = static_cast<Byte*>(Memory::Malloc(m_BufferSize, NOBLE_DEFAULT_ALIGN));
+	}
+
+	BufferedFileWriter::~BufferedFileWriter()
+	{
+		Flush();
+		Memory::Free(m_Buffer);
+	}
+
+	bool BufferedFileWriter::Write(const void* data, Size size)
+	{
+		if (m_Failed)
+		{
+			return false;
+		}
+
+		// Small writes just accumulate
+		if (m_BufferedBytes + size <= m_BufferSize)
+		{
+			Memory::Memcpy(m_Buffer + m_BufferedBytes, data, size);
+			m_BufferedBytes += size;
+			return true;
+		}
+
+		// Smaller than the buffer: start a new batch with it
+		if (size < m_BufferSize)
+		{
+			if (!Flush())
+			{
+				return false;
+			}
+
+			Memory::Memcpy(m_Buffer, data, size);
+			m_BufferedBytes = size;
+			return true;
+		}
+
+		// Large: send it together with whatever is buffered, without copying
+		const ConstFileSpan spans[] = { { m_Buffer, m_BufferedBytes }, { data, size } };
+		const Size expected = m_BufferedBytes + size;
+		const Size written = m_File.WriteV(spans, 2);
+
+		m_BytesWritten += written;
+		m_BufferedBytes = 0;
+		m_Failed = written != expected;
+
+		return !m_Failed;
+	}
+
+	bool BufferedFileWriter::Write(const BitStream& stream)
+	{
+		return Write(stream.GetData(), stream.GetStoredBytes());
+	}
+
+	bool BufferedFileWriter::WriteV(const ConstFileSpan* spans, Size count)
+	{
+		for (Size i = 0; i < count; ++i)
+		{
+			if (!Write(spans[i].Data, spans[i].Length))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool BufferedFileWriter::Flush()
+	{
+		if (m_Failed)
+		{
+			return false;
+		}
+
+		if (m_BufferedBytes > 0)
+		{
+			const Size written = m_File.Write(m_Buffer, m_BufferedBytes);
+
+			m_BytesWritten += written;
+			m_Failed = written != m_BufferedBytes;
+			m_BufferedBytes = 0;
+		}
+
+		return !m_Failed;
+	}
+
 	// ----- Mapped File -----
 
 	MappedFile::MappedFile()
-		: m_FilePath(), m_FileSize(0), m_MappedSize(0)
+		: m_FilePath(), m_FileSize(0), m_MappedSize(0), m_MappedOffset(0), m_CacheHint(Normal)
 	{
 		m_MappedFile = nullptr;
-		m_File = nullptr;
+		m_File = InvalidFileHandle;
 		m_MappedView = nullptr;
 	}
 
@@ -343,49 +812,51 @@ namespace Noble
 		m_FilePath = std::move(other.m_FilePath);
 		m_FileSize = other.m_FileSize;
 		m_MappedSize = other.m_MappedSize;
+		m_MappedOffset = other.m_MappedOffset;
+		m_CacheHint = other.m_CacheHint;
 		m_MappedFile = other.m_MappedFile;
 		m_MappedView = other.m_MappedView;
 		m_File = other.m_File;
 
 		other.m_FileSize = 0;
 		other.m_MappedSize = 0;
+		other.m_MappedOffset = 0;
 		other.m_MappedFile = nullptr;
 		other.m_MappedView = nullptr;
-		other.m_File = nullptr;
+		other.m_File = InvalidFileHandle;
 	}
 
 	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
 	{
-		// Close any existing opened file
-		if (IsValid())
-		{
-			Close();
-		}
+		// Close any existing opened file, including one left without a view
+		Close();
 
 		m_FilePath = std::move(other.m_FilePath);
 		m_FileSize = other.m_FileSize;
 		m_MappedSize = other.m_MappedSize;
+		m_MappedOffset = other.m_MappedOffset;
+		m_CacheHint = other.m_CacheHint;
 		m_MappedFile = other.m_MappedFile;
 		m_MappedView = other.m_MappedView;
 		m_File = other.m_File;
 
 		other.m_FileSize = 0;
 		other.m_MappedSize = 0;
+		other.m_MappedOffset = 0;
 		other.m_MappedFile = nullptr;
 		other.m_MappedView = nullptr;
-		other.m_File = nullptr;
+		other.m_File = InvalidFileHandle;
 
 		return *this;
 	}
 
 	MappedFile::~MappedFile()
 	{
-		if (IsValid())
-		{
-			Close();
-		}
+		// The file may be open without a view, after a failed Remap
+		Close();
 	}
 
+#ifdef NOBLE_WINDOWS
 	bool MappedFile::Open(const fs::path& path, Size mappedSize, CacheHint hint)
 	{
 		// Don't map another file if this is already mapped
@@ -395,25 +866,27 @@ namespace Noble
 		}
 
 		// Prepare member fields
-		m_File = nullptr;
+		m_File = InvalidFileHandle;
 		m_FileSize = 0;
 		m_MappedFile = nullptr;
 		m_MappedView = nullptr;
+		m_CacheHint = hint;
 
 		// Grab the proper cache hint constant
 		DWORD whint = 0;
 		switch (hint)
 		{
-			case Normal: whint = FILE_ATTRIBUTE_NORMAL;
-			case SequentialScan: whint = FILE_FLAG_SEQUENTIAL_SCAN;
-			case RandomAccess: whint = FILE_FLAG_RANDOM_ACCESS;
+			case Normal: whint = FILE_ATTRIBUTE_NORMAL; break;
+			case SequentialScan: whint = FILE_FLAG_SEQUENTIAL_SCAN; break;
+			case RandomAccess: whint = FILE_FLAG_RANDOM_ACCESS; break;
 			default: break;
 		}
 
 		m_File = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, whint, NULL);
 
-		if (!m_File)
+		if (m_File == INVALID_HANDLE_VALUE)
 		{
+			m_File = InvalidFileHandle;
 			return false;
 		}
 
@@ -421,6 +894,7 @@ namespace Noble
 		LARGE_INTEGER result;
 		if (!GetFileSizeEx(m_File, &result))
 		{
+			Close();
 			return false;
 		}
 		m_FileSize = static_cast<Size>(result.QuadPart);
@@ -429,14 +903,16 @@ namespace Noble
 		m_MappedFile = ::CreateFileMapping(m_File, NULL, PAGE_READONLY, 0, 0, NULL);
 		if (!m_MappedFile)
 		{
+			Close();
 			return false;
 		}
 
-		// Map the initial part
+		// Map the initial part; an empty file or a failed mapping leaves nothing open
 		Remap(0, mappedSize);
 
 		if (!m_MappedView)
 		{
+			Close();
 			return false;
 		}
 
@@ -457,18 +933,20 @@ namespace Noble
 			m_MappedFile = NULL;
 		}
 
-		if (m_File)
+		if (m_File != InvalidFileHandle)
 		{
 			::CloseHandle(m_File);
-			m_File = 0;
+			m_File = InvalidFileHandle;
 		}
 
 		m_FileSize = 0;
+		m_MappedSize = 0;
+		m_MappedOffset = 0;
 	}
 
 	bool MappedFile::Remap(Size offset, Size mappedSize)
 	{
-		if (!m_File)
+		if (m_File == InvalidFileHandle)
 		{
 			return false;
 		}
@@ -502,6 +980,7 @@ namespace Noble
 		DWORD offsetLow = DWORD(offset & 0xFFFFFFFF);
 		DWORD offsetHigh = DWORD(offset >> 32);
 		m_MappedSize = mappedSize;
+		m_MappedOffset = offset;
 
 		m_MappedView = ::MapViewOfFile(m_MappedFile, FILE_MAP_READ, offsetHigh, offsetLow, mappedSize);
 		if (m_MappedView == NULL)
@@ -514,6 +993,179 @@ namespace Noble
 		return true;
 	}
 
+	U32 MappedFile::GetPageSize()
+	{
+		SYSTEM_INFO sys;
+		GetSystemInfo(&sys);
+		return sys.dwAllocationGranularity;
+	}
+#else
+	namespace
+	{
+		/**
+		 * Passes the cache hint on to the kernel for a mapped range
+		 */
+		void AdviseMappedRange(void* view, Size size, MappedFile::CacheHint hint)
+		{
+			int advice = MADV_NORMAL;
+			switch (hint)
+			{
+				case MappedFile::SequentialScan: advice = MADV_SEQUENTIAL; break;
+				case MappedFile::RandomAccess: advice = MADV_RANDOM; break;
+				default: break;
+			}
+
+			if (advice != MADV_NORMAL)
+			{
+				::madvise(view, size, advice);
+			}
+		}
+	}
+
+	bool MappedFile::Open(const fs::path& path, Size mappedSize, CacheHint hint)
+	{
+		// Don't map another file if this is already mapped
+		if (IsValid())
+		{
+			return false;
+		}
+
+		// Prepare member fields
+		m_File = InvalidFileHandle;
+		m_FileSize = 0;
+		m_MappedFile = nullptr;
+		m_MappedView = nullptr;
+		m_CacheHint = hint;
+
+		m_File = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (m_File == InvalidFileHandle)
+		{
+			return false;
+		}
+
+		// Grab file size
+		struct stat info;
+		if (::fstat(m_File, &info) != 0)
+		{
+			Close();
+			return false;
+		}
+		m_FileSize = static_cast<Size>(info.st_size);
+
+		// Readahead applies to the file itself, so set it once here and per mapping in Remap
+		int advice = POSIX_FADV_NORMAL;
+		switch (hint)
+		{
+			case SequentialScan: advice = POSIX_FADV_SEQUENTIAL; break;
+			case RandomAccess: advice = POSIX_FADV_RANDOM; break;
+			default: break;
+		}
+		::posix_fadvise(m_File, 0, 0, advice);
+
+		// Map the initial part; an empty file or a failed mapping leaves nothing open
+		Remap(0, mappedSize);
+
+		if (!m_MappedView)
+		{
+			Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (m_MappedView)
+		{
+			::munmap(m_MappedView, m_MappedSize);
+			m_MappedView = nullptr;
+		}
+
+		if (m_File != InvalidFileHandle)
+		{
+			::close(m_File);
+			m_File = InvalidFileHandle;
+		}
+
+		m_FileSize = 0;
+		m_MappedSize = 0;
+		m_MappedOffset = 0;
+	}
+
+	bool MappedFile::Remap(Size offset, Size mappedSize)
+	{
+		if (m_File == InvalidFileHandle)
+		{
+			return false;
+		}
+
+		// mappedSize of 0 means map the whole file
+		if (mappedSize == 0)
+		{
+			mappedSize = m_FileSize;
+		}
+
+		// Check the passed-in constants for validity, adjust accordingly
+		if (offset > m_FileSize)
+		{
+			NE_LOG_ERROR("Cannot map file with offset greater than file size!");
+			return false;
+		}
+		if (offset + mappedSize > m_FileSize)
+		{
+			NE_LOG_WARNING("Requested map size [%u] and offset [%u] exceeds file size [%u]\
+				. Actual mapped size will be less than requested.", mappedSize, offset, m_FileSize);
+			mappedSize = (m_FileSize - offset);
+		}
+
+		void* view = MAP_FAILED;
+#ifdef MREMAP_MAYMOVE
+		// Same start offset, so the existing mapping can be grown or shrunk in place
+		if (m_MappedView && offset == m_MappedOffset && mappedSize > 0)
+		{
+			view = ::mremap(m_MappedView, m_MappedSize, mappedSize, MREMAP_MAYMOVE);
+			if (view == MAP_FAILED)
+			{
+				::munmap(m_MappedView, m_MappedSize);
+			}
+			m_MappedView = nullptr;
+		}
+#endif
+
+		// Clear the existing mapped view
+		if (m_MappedView)
+		{
+			::munmap(m_MappedView, m_MappedSize);
+			m_MappedView = nullptr;
+		}
+
+		if (view == MAP_FAILED && mappedSize > 0)
+		{
+			view = ::mmap(nullptr, mappedSize, PROT_READ, MAP_SHARED, m_File, static_cast<off_t>(offset));
+		}
+
+		if (view == MAP_FAILED)
+		{
+			m_MappedSize = 0;
+			m_MappedView = nullptr;
+			return false;
+		}
+
+		m_MappedView = view;
+		m_MappedSize = mappedSize;
+		m_MappedOffset = offset;
+		AdviseMappedRange(m_MappedView, m_MappedSize, m_CacheHint);
+
+		return true;
+	}
+
+	U32 MappedFile::GetPageSize()
+	{
+		return static_cast<U32>(::sysconf(_SC_PAGESIZE));
+	}
+#endif
+
 	Size MappedFile::GetFileSize() const
 	{
 		return m_FileSize;
@@ -524,16 +1176,22 @@ namespace Noble
 		return m_MappedSize;
 	}
 
-	U32 MappedFile::GetPageSize()
+	const UByte* MappedFile::GetData() const
 	{
-		SYSTEM_INFO sys;
-		GetSystemInfo(&sys);
-		return sys.dwAllocationGranularity;
+		return static_cast<const UByte*>(m_MappedView);
 	}
 
-	const UByte* MappedFile::GetData() const
+	BitStreamView MappedFile::GetView(Size offset, Size size) const
 	{
-		return static_cast<UByte*>(m_MappedFile);
+		CHECK(offset <= GetMappedSize());
+
+		if (size == 0)
+		{
+			size = GetMappedSize() - offset;
+		}
+		CHECK(offset + size <= GetMappedSize());
+
+		return BitStreamView(GetData() + offset, size);
 	}
 
 	UByte MappedFile::At(Size offset) const
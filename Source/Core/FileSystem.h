@@ -14,6 +14,16 @@ namespace Noble
 	// Predefine for use in Directory
 	class MappedFile;
 
+#ifdef NOBLE_WINDOWS
+	// Native file handle (HANDLE)
+	using NativeFileHandle = void*;
+	constexpr NativeFileHandle InvalidFileHandle = nullptr;
+#else
+	// Native file descriptor
+	using NativeFileHandle = int;
+	constexpr NativeFileHandle InvalidFileHandle = -1;
+#endif
+
 	/**
 	 * Represents a directory and allows traversal to parent and child directories
 	 * Can also return an open File contained in the directory
@@ -63,6 +73,7 @@ namespace Noble
 
 		/**
 		 * Returns an Array of paths to files or folders in the directory and its subdirectories
+		 * Walks the disk on every call; use a DirectoryIndex for repeated queries
 		 */
 		Array<fs::path> IterateRecursive();
 
@@ -96,6 +107,24 @@ namespace Noble
 		FILE_WRITE_APPEND
 	};
 
+	/**
+	 * A region of memory to read into, for File::ReadV
+	 */
+	struct FileSpan
+	{
+		void* Data;
+		Size Length;
+	};
+
+	/**
+	 * A region of memory to write from, for File::WriteV
+	 */
+	struct ConstFileSpan
+	{
+		const void* Data;
+		Size Length;
+	};
+
 	/**
 	 * A wrapper providing buffered file I/O
 	 */
@@ -165,10 +194,46 @@ namespace Noble
 		 */
 		Size Write(const void* data, Size maxWrite);
 
+		/**
+		 * Fills each span in order from the file, using a single scatter read where the platform has one
+		 * Returns the total number of bytes read
+		 */
+		Size ReadV(const FileSpan* spans, Size count);
+
+		/**
+		 * Writes each span in order, using a single gather write where the platform has one
+		 * Returns the total number of bytes written
+		 */
+		Size WriteV(const ConstFileSpan* spans, Size count);
+
+		/**
+		 * Writes the data as a checksummed frame (see ChecksumFrame)
+		 * Returns true if the whole frame was written
+		 */
+		bool WriteChecksummed(const void* data, Size size, U32 blockSize = 64 * 1024);
+
+		/**
+		 * Reads a checksummed frame from the rest of the file, verifies every block
+		 * using @workerCount threads, and appends the payload to @buffer
+		 * Returns false if the frame is malformed or any block fails verification
+		 */
+		bool ReadChecksummed(BitStream& buffer, U32 workerCount = 1);
+
+		/**
+		 * Moves the position of the next read or write
+		 * Writes in append mode always go to the end of the file
+		 */
+		void Seek(Size position);
+
+		/**
+		 * Returns the position of the next read or write
+		 */
+		Size GetPosition() const { return m_Position; }
+
 		/**
 		 * Returns true if a file is open
 		 */
-		bool IsValid() const { return m_Handle != nullptr; }
+		bool IsValid() const { return m_Handle != InvalidFileHandle; }
 
 		/**
 		 * Returns the size of the open file, or 0 if no file is open
@@ -180,9 +245,98 @@ namespace Noble
 		// Current file mode
 		FileMode m_Mode;
 		// Handle to the currently open file
-		void* m_Handle;
+		NativeFileHandle m_Handle;
 		// Size of the currently open file
 		Size m_FileSize;
+		// Offset of the next read or write
+		Size m_Position;
+	};
+
+	/**
+	 * Coalesces small writes to a File into buffer-sized ones
+	 * A write that doesn't fit is sent along with the buffered bytes in one gather write,
+	 * so large payloads are never copied. Flushes on destruction.
+	 */
+	class BufferedFileWriter
+	{
+	public:
+
+		// Default buffer size
+		static constexpr Size DefaultBufferSize = 64 * 1024;
+
+		/**
+		 * Buffers writes to @file, which must outlive the writer
+		 */
+		explicit BufferedFileWriter(File& file, Size bufferSize = DefaultBufferSize);
+
+		/**
+		 * Flushes anything left in the buffer
+		 */
+		~BufferedFileWriter();
+
+		NO_COPY_NO_MOVE(BufferedFileWriter)
+
+		/**
+		 * Queues the bytes for writing
+		 * Returns false if this or an earlier write failed
+		 */
+		bool Write(const void* data, Size size);
+
+		/**
+		 * Queues the stored bytes of the BitStream for writing
+		 */
+		bool Write(const BitStream& stream);
+
+		/**
+		 * Queues the raw bytes of a value for writing
+		 */
+		template <typename T>
+		bool Write(const T& value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "BufferedFileWriter::Write requires a trivially copyable type");
+			return Write(&value, sizeof(T));
+		}
+
+		/**
+		 * Queues each span in order
+		 */
+		bool WriteV(const ConstFileSpan* spans, Size count);
+
+		/**
+		 * Writes out the buffered bytes
+		 * Returns false if this or an earlier write failed
+		 */
+		bool Flush();
+
+		/**
+		 * Returns the number of bytes waiting in the buffer
+		 */
+		Size GetBufferedBytes() const { return m_BufferedBytes; }
+
+		/**
+		 * Returns the number of bytes passed to the file so far
+		 */
+		Size GetBytesWritten() const { return m_BytesWritten; }
+
+		/**
+		 * Returns true if any write to the file came up short
+		 */
+		bool HasFailed() const { return m_Failed; }
+
+	private:
+
+		// Destination file
+		File& m_File;
+		// Pending bytes
+		Byte* m_Buffer;
+		// Capacity of m_Buffer
+		Size m_BufferSize;
+		// Bytes currently in m_Buffer
+		Size m_BufferedBytes;
+		// Bytes handed to the file
+		Size m_BytesWritten;
+		// Set once a write comes up short; later writes are dropped
+		bool m_Failed;
 	};
 
 	/**
@@ -197,6 +351,7 @@ namespace Noble
 		/**
 		 * Used to hint at the OS how we plan to use the file
 		 * Can optimize certain reads. Default is Normal
+		 * Maps to file flags on Windows and madvise/posix_fadvise elsewhere
 		 */
 		enum CacheHint
 		{
@@ -250,6 +405,7 @@ namespace Noble
 		/**
 		 * Remaps to a new offset in the same file
 		 * Offset must be a multiple of the OS page size
+		 * On Linux, changing only the size of the mapping is done in place with mremap
 		 */
 		bool Remap(Size offset, Size mappedSize);
 
@@ -275,6 +431,13 @@ namespace Noble
 		 */
 		const UByte* GetData() const;
 
+		/**
+		 * Returns a read-only view over the mapped data, without copying
+		 * Optionally views only @size bytes starting at @offset into the mapped region
+		 * The view is only valid while the file stays mapped
+		 */
+		BitStreamView GetView(Size offset = 0, Size size = 0) const;
+
 		/**
 		 * Returns the byte at the requested offset
 		 */
@@ -298,10 +461,14 @@ namespace Noble
 		Size m_FileSize;
 		// Mapped size
 		Size m_MappedSize;
+		// File offset of the mapped region
+		Size m_MappedOffset;
+		// How the file is expected to be accessed
+		CacheHint m_CacheHint;
 
 		// Platform specifics
 
-		void* m_File;
+		NativeFileHandle m_File;
 		void* m_MappedFile;
 		void* m_MappedView;
 	};
@@ -0,0 +1,405 @@
+#include "FileWatcher.h"
+
+#include <cstring>
+
+#include "Logger.h"
+#include "String.h"
+
+#ifdef NOBLE_LINUX
+#include <errno.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+// Events that can change what the index holds; IN_CLOSE_WRITE rather than IN_MODIFY so a
+// file being written reports once, when the writer is done
+#define NOBLE_WATCH_MASK (IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | \
+	IN_ATTRIB | IN_ONLYDIR | IN_DONT_FOLLOW)
+#endif
+
+// Past this many unsettled paths, one full refresh is cheaper than tracking them all
+#define MAX_PENDING_PATHS 4096
+
+namespace Noble
+{
+	FileWatcher::FileWatcher()
+		: m_Index(nullptr), m_Handle(-1), m_WatchPoolGarbage(0), m_SettleTime(0.1F), m_NeedsRefresh(false)
+	{}
+
+	FileWatcher::~FileWatcher()
+	{
+		Stop();
+	}
+
+	bool FileWatcher::IsSupported()
+	{
+#ifdef NOBLE_LINUX
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	bool FileWatcher::Start(DirectoryIndex& index)
+	{
+		Stop();
+
+		if (!index.IsBuilt())
+		{
+			return false;
+		}
+
+#ifdef NOBLE_LINUX
+		m_Handle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (m_Handle < 0)
+		{
+			NE_LOG_WARNING("Failed to create inotify instance (errno %d)", errno);
+			return false;
+		}
+
+		m_Index = &index;
+		WatchTree("");
+
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	void FileWatcher::Stop()
+	{
+#ifdef NOBLE_LINUX
+		if (m_Handle >= 0)
+		{
+			// Closing the instance drops every watch with it
+			close(m_Handle);
+		}
+#endif
+		m_Handle = -1;
+		m_Index = nullptr;
+		m_Watches.Empty();
+		m_WatchPool.Empty();
+		m_WatchPoolGarbage = 0;
+		m_Pending.Empty();
+		m_PendingPool.Empty();
+		m_NeedsRefresh = false;
+	}
+
+	U32 FileWatcher::Poll(DirectoryChangeList& changes)
+	{
+		if (!m_Index)
+		{
+			return 0;
+		}
+
+		ReadEvents();
+
+		const Size startCount = changes.GetCount();
+
+		if (m_NeedsRefresh)
+		{
+			NE_LOG_INFO("File watcher lost track of changes, rescanning %s", m_Index->GetRoot().string().c_str());
+
+			m_Index->Refresh(&changes);
+			m_Pending.Empty();
+			m_PendingPool.Empty();
+			m_NeedsRefresh = false;
+
+			return static_cast<U32>(changes.GetCount() - startCount);
+		}
+
+		if (m_Pending.GetCount() == 0)
+		{
+			return 0;
+		}
+
+		// Apply everything that has been quiet long enough, keep the rest for the next poll
+		const Timestamp now = Time::GetNowTimestamp();
+		Size kept = 0;
+		for (Size i = 0; i < m_Pending.GetCount(); ++i)
+		{
+			const PendingPath pending = m_Pending[i];
+			Timestamp age = now;
+			age -= pending.LastEvent;
+
+			if (Time::GetDuration(age) >= m_SettleTime)
+			{
+				m_Index->UpdatePath(m_PendingPool.GetData() + pending.PathOffset, &changes);
+			}
+			else
+			{
+				m_Pending[kept++] = pending;
+			}
+		}
+
+		if (kept == m_Pending.GetCount())
+		{
+			return 0;
+		}
+
+		// Drop the applied paths and pack the kept ones to the front of the pool, so paths that keep
+		// changing don't hold on to the space of every path applied meanwhile. Kept paths stay in
+		// pool order, so each one moves down, never onto one not yet moved
+		m_Pending.RemoveMultiple(kept, m_Pending.GetCount() - kept);
+		Size poolCount = 0;
+		for (PendingPath& pending : m_Pending)
+		{
+			const char* path = m_PendingPool.GetData() + pending.PathOffset;
+			const Size length = std::strlen(path) + 1;
+			std::memmove(m_PendingPool.GetData() + poolCount, path, length);
+			pending.PathOffset = static_cast<U32>(poolCount);
+			poolCount += length;
+		}
+		if (poolCount < m_PendingPool.GetCount())
+		{
+			m_PendingPool.RemoveMultiple(poolCount, m_PendingPool.GetCount() - poolCount);
+		}
+
+		return static_cast<U32>(changes.GetCount() - startCount);
+	}
+
+	void FileWatcher::WatchTree(const char* relativeDir)
+	{
+#ifdef NOBLE_LINUX
+		// Directories created before the watch was added are caught by the rescan the caller queues
+		Array<char> pending;
+		pending.AddMultiple(relativeDir, std::strlen(relativeDir) + 1);
+
+		Size next = 0;
+		while (next < pending.GetCount())
+		{
+			const Size dirOffset = next;
+			const Size dirLength = std::strlen(pending.GetData() + dirOffset);
+			next += dirLength + 1;
+
+			const fs::path fullPath = dirLength > 0 ? m_Index->GetRoot() / (pending.GetData() + dirOffset) : m_Index->GetRoot();
+			const I32 descriptor = inotify_add_watch(m_Handle, fullPath.c_str(), NOBLE_WATCH_MASK);
+			if (descriptor < 0)
+			{
+				if (errno == ENOSPC)
+				{
+					NE_LOG_WARNING("Out of inotify watches, raise fs.inotify.max_user_watches to watch all of %s",
+						m_Index->GetRoot().string().c_str());
+				}
+				continue;
+			}
+
+			// Watching a directory twice returns its existing descriptor; just update the path
+			const U32 pathOffset = static_cast<U32>(m_WatchPool.GetCount());
+			m_WatchPool.AddMultiple(pending.GetData() + dirOffset, dirLength + 1);
+
+			Size insertAt = m_Watches.GetCount();
+			while (insertAt > 0 && m_Watches[insertAt - 1].Descriptor > descriptor)
+			{
+				--insertAt;
+			}
+			if (insertAt > 0 && m_Watches[insertAt - 1].Descriptor == descriptor)
+			{
+				m_WatchPoolGarbage += std::strlen(m_WatchPool.GetData() + m_Watches[insertAt - 1].PathOffset) + 1;
+				m_Watches[insertAt - 1].PathOffset = pathOffset;
+			}
+			else
+			{
+				const WatchedDirectory watch = { descriptor, pathOffset };
+				if (insertAt < m_Watches.GetCount())
+				{
+					m_Watches.Insert(watch, insertAt);
+				}
+				else
+				{
+					m_Watches.Add(watch);
+				}
+			}
+
+			std::error_code error;
+			for (fs::directory_iterator iter(fullPath, error); !error && iter != fs::directory_iterator(); iter.increment(error))
+			{
+				if (iter->is_directory(error) && !iter->is_symlink(error))
+				{
+					const std::string name = iter->path().filename().string();
+
+					// The pool may move while appending, so copy the parent first
+					Array<char> child;
+					if (dirLength > 0)
+					{
+						child.AddMultiple(pending.GetData() + dirOffset, dirLength);
+						child.Add('/');
+					}
+					child.AddMultiple(name.c_str(), name.size() + 1);
+					pending.AddMultiple(child.GetData(), child.GetCount());
+				}
+			}
+		}
+#endif
+	}
+
+	void FileWatcher::UnwatchTree(const char* relativeDir)
+	{
+#ifdef NOBLE_LINUX
+		const Size length = std::strlen(relativeDir);
+
+		for (Size i = m_Watches.GetCount(); i > 0; --i)
+		{
+			const char* path = m_WatchPool.GetData() + m_Watches[i - 1].PathOffset;
+			if (std::strncmp(path, relativeDir, length) == 0 && (path[length] == '\0' || path[length] == '/'))
+			{
+				m_WatchPoolGarbage += std::strlen(path) + 1;
+				inotify_rm_watch(m_Handle, m_Watches[i - 1].Descriptor);
+				m_Watches.RemoveAt(i - 1);
+			}
+		}
+
+		// Done with relativeDir, which may point into the pool
+		CompactWatchPool();
+#endif
+	}
+
+	void FileWatcher::CompactWatchPool()
+	{
+		if (m_WatchPoolGarbage * 2 <= m_WatchPool.GetCount())
+		{
+			return;
+		}
+
+		Array<char> pool;
+		for (WatchedDirectory& watch : m_Watches)
+		{
+			const char* path = m_WatchPool.GetData() + watch.PathOffset;
+			watch.PathOffset = static_cast<U32>(pool.GetCount());
+			pool.AddMultiple(path, std::strlen(path) + 1);
+		}
+
+		m_WatchPool = std::move(pool);
+		m_WatchPoolGarbage = 0;
+	}
+
+	const char* FileWatcher::FindWatchPath(I32 descriptor) const
+	{
+		Size low = 0;
+		Size high = m_Watches.GetCount();
+		while (low < high)
+		{
+			const Size mid = (low + high) / 2;
+			if (m_Watches[mid].Descriptor < descriptor)
+			{
+				low = mid + 1;
+			}
+			else
+			{
+				high = mid;
+			}
+		}
+
+		if (low < m_Watches.GetCount() && m_Watches[low].Descriptor == descriptor)
+		{
+			return m_WatchPool.GetData() + m_Watches[low].PathOffset;
+		}
+		return nullptr;
+	}
+
+	void FileWatcher::QueuePath(const char* relativePath, const Timestamp& now)
+	{
+		const Size length = std::strlen(relativePath);
+		const U32 hash = HashStringN(relativePath, length);
+
+		for (PendingPath& pending : m_Pending)
+		{
+			if (pending.Hash == hash && std::strcmp(m_PendingPool.GetData() + pending.PathOffset, relativePath) == 0)
+			{
+				pending.LastEvent = now;
+				return;
+			}
+		}
+
+		if (m_Pending.GetCount() >= MAX_PENDING_PATHS)
+		{
+			m_NeedsRefresh = true;
+			return;
+		}
+
+		PendingPath pending;
+		pending.PathOffset = static_cast<U32>(m_PendingPool.GetCount());
+		pending.Hash = hash;
+		pending.LastEvent = now;
+		m_PendingPool.AddMultiple(relativePath, length + 1);
+		m_Pending.Add(pending);
+	}
+
+	void FileWatcher::ReadEvents()
+	{
+#ifdef NOBLE_LINUX
+		alignas(inotify_event) char buffer[16 * 1024];
+		Array<char> path;
+
+		while (true)
+		{
+			const ssize_t bytesRead = read(m_Handle, buffer, sizeof(buffer));
+			if (bytesRead <= 0)
+			{
+				if (bytesRead < 0 && errno == EINTR)
+				{
+					continue;
+				}
+				// EAGAIN: nothing left to read
+				return;
+			}
+
+			const Timestamp now = Time::GetNowTimestamp();
+
+			for (ssize_t offset = 0; offset < bytesRead; )
+			{
+				const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+				offset += sizeof(inotify_event) + event->len;
+
+				if (event->mask & IN_Q_OVERFLOW)
+				{
+					m_NeedsRefresh = true;
+					continue;
+				}
+
+				const char* dir = FindWatchPath(event->wd);
+				if (!dir)
+				{
+					continue;
+				}
+
+				if (event->mask & IN_IGNORED)
+				{
+					// The directory is gone; its parent's event queues the removal
+					UnwatchTree(dir);
+					continue;
+				}
+
+				if (event->len == 0 || event->name[0] == '\0')
+				{
+					continue;
+				}
+
+				path.Empty();
+				const Size dirLength = std::strlen(dir);
+				if (dirLength > 0)
+				{
+					path.AddMultiple(dir, dirLength);
+					path.Add('/');
+				}
+				path.AddMultiple(event->name, std::strlen(event->name) + 1);
+
+				if (event->mask & IN_ISDIR)
+				{
+					// Watch descriptors follow the directory, not its name, so a moved directory's
+					// watches are replaced rather than renamed
+					if (event->mask & (IN_MOVED_FROM | IN_DELETE))
+					{
+						UnwatchTree(path.GetData());
+					}
+					else if (event->mask & (IN_CREATE | IN_MOVED_TO))
+					{
+						WatchTree(path.GetData());
+					}
+				}
+
+				QueuePath(path.GetData(), now);
+			}
+		}
+#endif
+	}
+}
\ No newline at end of file
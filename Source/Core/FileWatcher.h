@@ -0,0 +1,145 @@
+#pragma once
+
+#include "Array.h"
+#include "DirectoryIndex.h"
+#include "Time.h"
+#include "Types.h"
+
+namespace Noble
+{
+	/**
+	 * Watches the tree behind a DirectoryIndex and keeps the index current
+	 *
+	 * Uses inotify on Linux, with a watch on every directory since inotify isn't recursive.
+	 * Events are coalesced per path: a path is only re-stated once it has been quiet for the
+	 * settle time, so an editor's truncate/write/rename sequence or a large copy produces one
+	 * index update per file rather than one per event. If the kernel queue overflows, or too
+	 * many paths pile up, the watcher falls back to a single full Refresh of the index.
+	 *
+	 * Not supported on other platforms; Start returns false and Poll never reports changes.
+	 * Everything runs on the thread that calls Poll, there is no background thread.
+	 */
+	class FileWatcher
+	{
+	public:
+
+		FileWatcher();
+
+		/**
+		 * Stops watching
+		 */
+		~FileWatcher();
+
+		NO_COPY_NO_MOVE(FileWatcher)
+
+		/**
+		 * Starts watching the root of @index, which must already be built
+		 * The index must outlive the watcher, or Stop must be called first
+		 */
+		bool Start(DirectoryIndex& index);
+
+		/**
+		 * Stops watching and drops pending events
+		 */
+		void Stop();
+
+		/**
+		 * Reads new events, then applies every path that has settled to the index
+		 * Changes found are appended to @changes. Returns the number of changes appended.
+		 */
+		U32 Poll(DirectoryChangeList& changes);
+
+		/**
+		 * Sets how long, in seconds, a path must go without events before it's applied
+		 */
+		void SetSettleTime(F32 seconds) { m_SettleTime = seconds; }
+
+		/**
+		 * Returns true between a successful Start and Stop
+		 */
+		bool IsWatching() const { return m_Index != nullptr; }
+
+		/**
+		 * Returns true if file watching is available on this platform
+		 */
+		static bool IsSupported();
+
+	private:
+
+		/**
+		 * Adds watches for the directory (relative to the root) and every directory below it
+		 */
+		void WatchTree(const char* relativeDir);
+
+		/**
+		 * Removes the watches of the directory and every directory below it
+		 */
+		void UnwatchTree(const char* relativeDir);
+
+		/**
+		 * Rebuilds m_WatchPool from the live watches once most of it belongs to removed ones
+		 * Invalidates pointers into the pool
+		 */
+		void CompactWatchPool();
+
+		/**
+		 * Returns the relative directory of a watch descriptor, or nullptr if it's not known
+		 */
+		const char* FindWatchPath(I32 descriptor) const;
+
+		/**
+		 * Records an event for the path, merging it with one already pending
+		 */
+		void QueuePath(const char* relativePath, const Timestamp& now);
+
+		/**
+		 * Reads every queued event without blocking
+		 */
+		void ReadEvents();
+
+	private:
+
+		/**
+		 * A watched directory
+		 */
+		struct WatchedDirectory
+		{
+			I32 Descriptor;
+			// Offset of the relative path in m_WatchPool
+			U32 PathOffset;
+		};
+
+		/**
+		 * A path with events that haven't been applied yet
+		 */
+		struct PendingPath
+		{
+			// Offset of the relative path in m_PendingPool
+			U32 PathOffset;
+			// Hash of the path, to skip most string compares when merging events
+			U32 Hash;
+			// Time of the most recent event
+			Timestamp LastEvent;
+		};
+
+		// Index kept up to date, null when not watching
+		DirectoryIndex* m_Index;
+		// inotify instance
+		I32 m_Handle;
+
+		// Watched directories, sorted by descriptor
+		Array<WatchedDirectory> m_Watches;
+		Array<char> m_WatchPool;
+		// Bytes of m_WatchPool no watch refers to anymore
+		Size m_WatchPoolGarbage;
+
+		// Paths waiting to settle
+		Array<PendingPath> m_Pending;
+		Array<char> m_PendingPool;
+
+		// Seconds a path must be quiet before it's applied
+		F32 m_SettleTime;
+		// Set when events were lost, so the whole index has to be refreshed
+		bool m_NeedsRefresh;
+	};
+}
\ No newline at end of file
@@ -2,8 +2,18 @@
 
 // Used for argument packing in Fat function pointers
 #include <tuple>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "Memory.h"
 #include "Types.h"
 
+// Bytes of inline storage in a Delegate before a callable spills to the heap
+#ifndef NOBLE_DELEGATE_INLINE_SIZE
+#define NOBLE_DELEGATE_INLINE_SIZE 48
+#endif
+
 namespace Noble
 {
 	template <typename>
@@ -150,4 +160,742 @@ namespace Noble
 		Pointer m_InternalPointer;
 		std::tuple<FunctionArgs...> m_Args;
 	};
+
+	/**
+	 * Delegates are type-erased callables, similar to std::function but with a fixed
+	 * block of inline storage. Anything that fits in NOBLE_DELEGATE_INLINE_SIZE bytes
+	 * (function pointers, bound member functions, lambdas with a few captures) is stored
+	 * in place with no allocation. Larger callables fall back to Memory::Malloc.
+	 *
+	 * DelegateBase holds the shared storage/invoke logic; Delegate is copyable and
+	 * UniqueDelegate is move-only (so it can hold move-only captures).
+	 */
+	template <bool Copyable, typename ReturnType, typename... FunctionArgs>
+	class DelegateBase
+	{
+	protected:
+
+		// Operations the manager function can perform on the stored callable
+		enum class StorageOp : U8
+		{
+			Copy,
+			Move,
+			Destroy
+		};
+
+		// Raw storage, either holds the callable itself or a pointer to it on the heap
+		struct alignas(NOBLE_DEFAULT_ALIGN) Storage
+		{
+			Byte Data[NOBLE_DELEGATE_INLINE_SIZE];
+		};
+
+		typedef ReturnType(*Invoker)(Storage&, FunctionArgs&&...);
+		typedef void(*Manager)(StorageOp, Storage& dst, Storage& src);
+
+		/**
+		 * True if the callable type can live directly in the inline storage
+		 */
+		template <typename F>
+		static constexpr bool FitsInline = sizeof(F) <= sizeof(Storage)
+			&& alignof(F) <= alignof(Storage)
+			&& std::is_nothrow_move_constructible_v<F>;
+
+		/**
+		 * Per-callable type functions, instantiated once for every type bound
+		 */
+		template <typename F>
+		struct CallableOps
+		{
+			static F* Get(Storage& s)
+			{
+				if constexpr (FitsInline<F>)
+				{
+					return std::launder(reinterpret_cast<F*>(s.Data));
+				}
+				else
+				{
+					return *reinterpret_cast<F**>(s.Data);
+				}
+			}
+
+			template <typename Init>
+			static void Create(Storage& s, Init&& init)
+			{
+				if constexpr (FitsInline<F>)
+				{
+					new (s.Data) F(std::forward<Init>(init));
+				}
+				else
+				{
+					void* mem = Memory::Malloc(sizeof(F), glm::max(alignof(F), alignof(void*)));
+					*reinterpret_cast<F**>(s.Data) = new (mem) F(std::forward<Init>(init));
+				}
+			}
+
+			static ReturnType Invoke(Storage& s, FunctionArgs&&... argv)
+			{
+				return (*Get(s))(std::forward<FunctionArgs>(argv)...);
+			}
+
+			static void Manage(StorageOp op, Storage& dst, Storage& src)
+			{
+				switch (op)
+				{
+					case StorageOp::Copy:
+						if constexpr (Copyable)
+						{
+							Create(dst, *Get(src));
+						}
+						break;
+					case StorageOp::Move:
+						if constexpr (FitsInline<F>)
+						{
+							Create(dst, std::move(*Get(src)));
+							Get(src)->~F();
+						}
+						else
+						{
+							// Heap callables just hand over the pointer
+							*reinterpret_cast<F**>(dst.Data) = Get(src);
+						}
+						break;
+					case StorageOp::Destroy:
+					{
+						F* f = Get(dst);
+						f->~F();
+						if constexpr (!FitsInline<F>)
+						{
+							Memory::Free(f);
+						}
+						break;
+					}
+				}
+			}
+		};
+
+	public:
+
+		/**
+		 * Empty-initializes the delegate; invoking it is an error until something is bound
+		 */
+		DelegateBase()
+			: m_Invoke(nullptr), m_Manager(nullptr)
+		{}
+
+		DelegateBase(std::nullptr_t)
+			: DelegateBase()
+		{}
+
+		/**
+		 * Binds any callable (function pointer, functor, lambda) with a compatible signature
+		 */
+		template <typename F, typename = std::enable_if_t<
+			!std::is_base_of_v<DelegateBase, std::decay_t<F>> &&
+			std::is_invocable_r_v<ReturnType, std::decay_t<F>&, FunctionArgs...>>>
+		DelegateBase(F&& func)
+			: DelegateBase()
+		{
+			Bind(std::forward<F>(func));
+		}
+
+		/**
+		 * Frees the bound callable, if any
+		 */
+		~DelegateBase()
+		{
+			Unbind();
+		}
+
+	public:
+
+		/**
+		 * Replaces the bound callable
+		 */
+		template <typename F>
+		void Bind(F&& func)
+		{
+			typedef std::decay_t<F> Callable;
+			STATIC_CHECK(!Copyable || std::is_copy_constructible_v<Callable>,
+				"Delegate requires a copyable callable, use UniqueDelegate for move-only ones");
+
+			Unbind();
+
+			if constexpr (std::is_pointer_v<Callable>)
+			{
+				if (!func)
+				{
+					return;
+				}
+			}
+
+			CallableOps<Callable>::Create(m_Storage, std::forward<F>(func));
+			m_Invoke = &CallableOps<Callable>::Invoke;
+			m_Manager = &CallableOps<Callable>::Manage;
+		}
+
+		/**
+		 * Binds a member function to an object instance, stored inline
+		 */
+		template <typename Obj, typename Pointer>
+		void BindMember(Obj* obj, Pointer func)
+		{
+			CHECK(obj && func);
+			Bind([obj, func](FunctionArgs... argv) -> ReturnType
+			{
+				return (obj->*func)(std::forward<FunctionArgs>(argv)...);
+			});
+		}
+
+		/**
+		 * Releases the bound callable and returns to the empty state
+		 */
+		void Unbind()
+		{
+			if (m_Manager)
+			{
+				m_Manager(StorageOp::Destroy, m_Storage, m_Storage);
+			}
+			m_Invoke = nullptr;
+			m_Manager = nullptr;
+		}
+
+		/**
+		 * Returns true if a callable is bound
+		 */
+		bool IsBound() const { return m_Invoke != nullptr; }
+
+		/**
+		 * Allows quick validity checks
+		 */
+		explicit operator bool() const { return IsBound(); }
+
+		/**
+		 * Calls the bound function
+		 */
+		ReturnType operator() (FunctionArgs... argv) const
+		{
+			CHECK(m_Invoke);
+			return m_Invoke(m_Storage, std::forward<FunctionArgs>(argv)...);
+		}
+
+	protected:
+
+		/**
+		 * Copies the other delegate's callable into this one (this must be empty)
+		 */
+		void CopyFrom(const DelegateBase& other)
+		{
+			if (other.m_Manager)
+			{
+				other.m_Manager(StorageOp::Copy, m_Storage, other.m_Storage);
+				m_Invoke = other.m_Invoke;
+				m_Manager = other.m_Manager;
+			}
+		}
+
+		/**
+		 * Moves the other delegate's callable into this one (this must be empty)
+		 * Leaves the other delegate unbound
+		 */
+		void MoveFrom(DelegateBase& other)
+		{
+			if (other.m_Manager)
+			{
+				other.m_Manager(StorageOp::Move, m_Storage, other.m_Storage);
+				m_Invoke = other.m_Invoke;
+				m_Manager = other.m_Manager;
+
+				other.m_Invoke = nullptr;
+				other.m_Manager = nullptr;
+			}
+		}
+
+	private:
+
+		// Callable storage, mutable so const delegates can invoke mutable lambdas
+		mutable Storage m_Storage;
+		// Calls into the stored callable
+		Invoker m_Invoke;
+		// Copies, moves and destroys the stored callable
+		Manager m_Manager;
+	};
+
+	template <typename>
+	class Delegate;
+
+	/**
+	 * Copyable delegate - see DelegateBase
+	 */
+	template <typename ReturnType, typename... FunctionArgs>
+	class Delegate<ReturnType(FunctionArgs...)> : public DelegateBase<true, ReturnType, FunctionArgs...>
+	{
+		typedef DelegateBase<true, ReturnType, FunctionArgs...> Base;
+
+	public:
+
+		using Base::Base;
+
+		Delegate() = default;
+
+		/**
+		 * Copies the bound callable
+		 */
+		Delegate(const Delegate& other)
+			: Base()
+		{
+			this->CopyFrom(other);
+		}
+
+		/**
+		 * Takes over the other delegate's callable, leaving it unbound
+		 */
+		Delegate(Delegate&& other) noexcept
+			: Base()
+		{
+			this->MoveFrom(other);
+		}
+
+		/**
+		 * Copy assignment
+		 */
+		Delegate& operator=(const Delegate& other)
+		{
+			if (this != &other)
+			{
+				this->Unbind();
+				this->CopyFrom(other);
+			}
+			return *this;
+		}
+
+		/**
+		 * Move assignment
+		 */
+		Delegate& operator=(Delegate&& other) noexcept
+		{
+			if (this != &other)
+			{
+				this->Unbind();
+				this->MoveFrom(other);
+			}
+			return *this;
+		}
+
+		/**
+		 * Creates a delegate bound to a member function of the given object
+		 */
+		template <typename Obj, typename Pointer>
+		static Delegate FromMember(Obj* obj, Pointer func)
+		{
+			Delegate d;
+			d.BindMember(obj, func);
+			return d;
+		}
+	};
+
+	template <typename>
+	class UniqueDelegate;
+
+	/**
+	 * Move-only delegate - see DelegateBase
+	 * Can hold callables that cannot be copied (e.g. lambdas capturing owned buffers)
+	 */
+	template <typename ReturnType, typename... FunctionArgs>
+	class UniqueDelegate<ReturnType(FunctionArgs...)> : public DelegateBase<false, ReturnType, FunctionArgs...>
+	{
+		typedef DelegateBase<false, ReturnType, FunctionArgs...> Base;
+
+	public:
+
+		using Base::Base;
+
+		UniqueDelegate() = default;
+
+		NO_COPY(UniqueDelegate)
+
+		/**
+		 * Takes over the other delegate's callable, leaving it unbound
+		 */
+		UniqueDelegate(UniqueDelegate&& other) noexcept
+			: Base()
+		{
+			this->MoveFrom(other);
+		}
+
+		/**
+		 * Move assignment
+		 */
+		UniqueDelegate& operator=(UniqueDelegate&& other) noexcept
+		{
+			if (this != &other)
+			{
+				this->Unbind();
+				this->MoveFrom(other);
+			}
+			return *this;
+		}
+	};
+
+	// Handle returned by MulticastDelegate::Add, used to remove the binding later
+	typedef U32 DelegateHandle;
+	constexpr DelegateHandle InvalidDelegateHandle = 0;
+
+	template <typename>
+	class MulticastDelegate;
+
+	/**
+	 * Holds any number of Delegates and invokes them all on Broadcast()
+	 * Bindings are stored contiguously and called in the order they were added.
+	 * Bindings can be added and removed from inside a broadcast, including a nested one.
+	 * The storage being iterated never moves: additions wait in a pending list and removals
+	 * are only marked, and both are applied when the outermost broadcast returns.
+	 */
+	template <typename... FunctionArgs>
+	class MulticastDelegate<void(FunctionArgs...)>
+	{
+	public:
+
+		typedef Delegate<void(FunctionArgs...)> DelegateType;
+
+		MulticastDelegate()
+			: m_NextHandle(1), m_BroadcastDepth(0), m_RemovedCount(0)
+		{}
+
+		NO_COPY(MulticastDelegate)
+
+		/**
+		 * Moves the bindings from the other instance, leaving it empty
+		 */
+		MulticastDelegate(MulticastDelegate&& other) noexcept
+			: MulticastDelegate()
+		{
+			Swap(other);
+		}
+
+		/**
+		 * Moves the bindings from the other instance, leaving it empty
+		 */
+		MulticastDelegate& operator=(MulticastDelegate&& other) noexcept
+		{
+			if (this != &other)
+			{
+				Clear();
+				Swap(other);
+			}
+			return *this;
+		}
+
+		/**
+		 * Unbinds everything and frees the binding storage
+		 */
+		~MulticastDelegate()
+		{
+			Clear();
+			m_Bindings.Free();
+			m_Pending.Free();
+		}
+
+	public:
+
+		/**
+		 * Adds a binding and returns a handle that can be used to remove it
+		 * Bindings added during a broadcast are not called until the next one
+		 */
+		DelegateHandle Add(DelegateType&& del)
+		{
+			if (!del.IsBound())
+			{
+				return InvalidDelegateHandle;
+			}
+
+			// Growing the active list would free the storage a broadcast is iterating
+			BindingList& list = (m_BroadcastDepth > 0) ? m_Pending : m_Bindings;
+			list.Append(std::move(del), m_NextHandle);
+
+			return m_NextHandle++;
+		}
+
+		/**
+		 * Adds any callable with a matching signature
+		 */
+		template <typename F>
+		DelegateHandle Add(F&& func)
+		{
+			return Add(DelegateType(std::forward<F>(func)));
+		}
+
+		/**
+		 * Adds a member function bound to the given object
+		 */
+		template <typename Obj, typename Pointer>
+		DelegateHandle AddMember(Obj* obj, Pointer func)
+		{
+			return Add(DelegateType::FromMember(obj, func));
+		}
+
+		/**
+		 * Removes the binding with the given handle
+		 * Returns false if no such binding exists
+		 */
+		bool Remove(DelegateHandle handle)
+		{
+			if (handle == InvalidDelegateHandle)
+			{
+				return false;
+			}
+
+			// Pending bindings aren't being iterated, so they can go straight away
+			Size index = m_Pending.Find(handle);
+			if (index != SizeMaxValue)
+			{
+				m_Pending.RemoveAt(index);
+				return true;
+			}
+
+			index = m_Bindings.Find(handle);
+			if (index == SizeMaxValue)
+			{
+				return false;
+			}
+
+			if (m_BroadcastDepth > 0)
+			{
+				// Can't shift or destroy elements under the broadcast loop (the binding
+				// may be the one running), so just mark it and clean up afterwards
+				m_Bindings.Handles[index] = InvalidDelegateHandle;
+				++m_RemovedCount;
+			}
+			else
+			{
+				m_Bindings.RemoveAt(index);
+			}
+			return true;
+		}
+
+		/**
+		 * Removes all bindings
+		 */
+		void Clear()
+		{
+			CHECK(m_BroadcastDepth == 0);
+
+			m_Bindings.Clear();
+			m_Pending.Clear();
+			m_RemovedCount = 0;
+		}
+
+		/**
+		 * Calls every bound delegate with the given arguments
+		 * Bindings added during the broadcast are not called until the next one
+		 */
+		void Broadcast(FunctionArgs... argv)
+		{
+			++m_BroadcastDepth;
+
+			const Size count = m_Bindings.Count;
+			for (Size i = 0; i < count; ++i)
+			{
+				if (m_Bindings.Handles[i] != InvalidDelegateHandle)
+				{
+					m_Bindings.Bindings[i](argv...);
+				}
+			}
+
+			if (--m_BroadcastDepth == 0)
+			{
+				ApplyPendingChanges();
+			}
+		}
+
+		/**
+		 * Returns the number of bound delegates
+		 */
+		Size GetCount() const { return m_Bindings.Count + m_Pending.Count - m_RemovedCount; }
+
+		/**
+		 * Returns true if any delegates are bound
+		 */
+		bool IsBound() const { return GetCount() > 0; }
+
+	private:
+
+		/**
+		 * Contiguous bindings with a handle for each
+		 */
+		struct BindingList
+		{
+			// Contiguous array of bound delegates
+			DelegateType* Bindings = nullptr;
+			// Handle for each binding, parallel to Bindings
+			DelegateHandle* Handles = nullptr;
+			// Number of bindings
+			Size Count = 0;
+			// Number of bindings that fit in the current storage
+			Size Max = 0;
+
+			/**
+			 * Adds a binding at the end, growing the storage if it's full
+			 */
+			void Append(DelegateType&& del, DelegateHandle handle)
+			{
+				if (Count == Max)
+				{
+					Grow();
+				}
+
+				new (Bindings + Count) DelegateType(std::move(del));
+				Handles[Count++] = handle;
+			}
+
+			/**
+			 * Returns the index of the binding with the handle, or SizeMaxValue
+			 */
+			Size Find(DelegateHandle handle) const
+			{
+				for (Size i = 0; i < Count; ++i)
+				{
+					if (Handles[i] == handle)
+					{
+						return i;
+					}
+				}
+				return SizeMaxValue;
+			}
+
+			/**
+			 * Grows the storage by half again (or to 4 slots)
+			 */
+			void Grow()
+			{
+				const Size newMax = glm::max((Max * 3) / 2, Max + 4);
+
+				DelegateType* newBindings = static_cast<DelegateType*>(
+					Memory::Malloc(sizeof(DelegateType) * newMax, alignof(DelegateType)));
+				DelegateHandle* newHandles = static_cast<DelegateHandle*>(
+					Memory::Malloc(sizeof(DelegateHandle) * newMax, alignof(DelegateHandle)));
+
+				for (Size i = 0; i < Count; ++i)
+				{
+					new (newBindings + i) DelegateType(std::move(Bindings[i]));
+					Bindings[i].~DelegateType();
+					newHandles[i] = Handles[i];
+				}
+
+				Free();
+
+				Bindings = newBindings;
+				Handles = newHandles;
+				Max = newMax;
+			}
+
+			/**
+			 * Removes the binding at the index and shifts the rest down to keep call order
+			 */
+			void RemoveAt(Size index)
+			{
+				for (Size i = index + 1; i < Count; ++i)
+				{
+					Bindings[i - 1] = std::move(Bindings[i]);
+					Handles[i - 1] = Handles[i];
+				}
+
+				--Count;
+				Bindings[Count].~DelegateType();
+			}
+
+			/**
+			 * Drops any bindings whose handle was invalidated, keeping call order
+			 */
+			void Compact()
+			{
+				Size write = 0;
+				for (Size read = 0; read < Count; ++read)
+				{
+					if (Handles[read] != InvalidDelegateHandle)
+					{
+						if (write != read)
+						{
+							Bindings[write] = std::move(Bindings[read]);
+							Handles[write] = Handles[read];
+						}
+						++write;
+					}
+				}
+
+				for (Size i = write; i < Count; ++i)
+				{
+					Bindings[i].~DelegateType();
+				}
+
+				Count = write;
+			}
+
+			/**
+			 * Unbinds everything, keeping the storage
+			 */
+			void Clear()
+			{
+				for (Size i = 0; i < Count; ++i)
+				{
+					Bindings[i].~DelegateType();
+				}
+				Count = 0;
+			}
+
+			/**
+			 * Frees the storage; must be empty
+			 */
+			void Free()
+			{
+				if (Bindings)
+				{
+					Memory::Free(Bindings);
+					Memory::Free(Handles);
+				}
+			}
+		};
+
+		/**
+		 * Drops the bindings removed during a broadcast and appends the ones added during it
+		 */
+		void ApplyPendingChanges()
+		{
+			if (m_RemovedCount > 0)
+			{
+				m_Bindings.Compact();
+				m_RemovedCount = 0;
+			}
+
+			for (Size i = 0; i < m_Pending.Count; ++i)
+			{
+				m_Bindings.Append(std::move(m_Pending.Bindings[i]), m_Pending.Handles[i]);
+			}
+			m_Pending.Clear();
+		}
+
+		/**
+		 * Exchanges state with another instance
+		 */
+		void Swap(MulticastDelegate& other)
+		{
+			CHECK(m_BroadcastDepth == 0 && other.m_BroadcastDepth == 0);
+
+			std::swap(m_Bindings, other.m_Bindings);
+			std::swap(m_Pending, other.m_Pending);
+			std::swap(m_NextHandle, other.m_NextHandle);
+		}
+
+	private:
+
+		// Bindings in call order
+		BindingList m_Bindings;
+		// Bindings added during a broadcast, moved into m_Bindings once it returns
+		BindingList m_Pending;
+		// Next handle to hand out (0 is reserved as invalid)
+		DelegateHandle m_NextHandle;
+		// Number of broadcasts running, more than one when a binding broadcasts again
+		U32 m_BroadcastDepth;
+		// Number of bindings in m_Bindings marked removed during a broadcast
+		Size m_RemovedCount;
+	};
 }
\ No newline at end of file
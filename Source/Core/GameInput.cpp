@@ -379,17 +379,18 @@ namespace Noble
 			for (json::iterator it = inputCfg["Action"].begin(); it != inputCfg["Action"].end(); ++it) // for each action binding
 			{
 				RegisterActionBinding(it.key().c_str(), Action::ACTION_UNASSIGNED); // Register with a blank binding
-				U32 bindingHash = HASH(it.key().c_str()); // Hash the name for easy access
+				U32 bindingHash = HashStringN(it.key().c_str(), it.key().length()); // Hash the name for easy access
 
 				U32 bindingIndex = 0;
 				for (json::iterator binding = (*it)[0].begin(); binding != (*it)[0].end(); ++binding) // for each trigger
 				{
-					const U32 trigHash = HASH(binding->get<std::string>().c_str());
+					const std::string& trigName = binding->get_ref<const std::string&>();
+					const NIdentifier trigger(trigName.c_str(), trigName.length());
 					// Read in the bound action and set it to the corresponding index
 					SetActionBinding(
 						bindingHash, 
 						bindingIndex++, 
-						Input::GetAction(trigHash)
+						Input::GetAction(trigger)
 					);
 				}
 			}
@@ -399,7 +400,7 @@ namespace Noble
 			{
 				// Grab the name and hash it for easy access
 				const char* bindingName = it.key().c_str();
-				U32 bindingHash = HASH(it.key().c_str());
+				U32 bindingHash = HashStringN(bindingName, it.key().length());
 
 				// Register with a blank binding
 				RegisterAxisBinding(bindingName, Axis::AXIS_UNASSIGNED, 0.0F);
@@ -414,8 +415,9 @@ namespace Noble
 					if (isAction)
 					{
 						// Extract the trigger from the JSON config
-						const U32 trigHash = HASH(inputCfg["Axis"][bindingName][bindingIndex]["Binding"].get<std::string>().c_str());
-						Action act = Input::GetAction(trigHash);
+						const std::string& trigName = bindingArray[bindingIndex]["Binding"].get_ref<const std::string&>();
+						const NIdentifier trigger(trigName.c_str(), trigName.length());
+						Action act = Input::GetAction(trigger);
 
 						// Extract the scale
 						float scale = inputCfg["Axis"][bindingName][bindingIndex]["Scale"];
@@ -426,8 +428,9 @@ namespace Noble
 					else
 					{
 						// Extract the trigger from the JSON config
-						const U32 trigHash = HASH(inputCfg["Axis"][bindingName][bindingIndex]["Binding"].get<std::string>().c_str());
-						Axis ax = Input::GetAxis(trigHash);
+						const std::string& trigName = bindingArray[bindingIndex]["Binding"].get_ref<const std::string&>();
+						const NIdentifier trigger(trigName.c_str(), trigName.length());
+						Axis ax = Input::GetAxis(trigger);
 
 						// Extract the scale
 						float scale = inputCfg["Axis"][bindingName][bindingIndex]["Scale"];
@@ -9,6 +9,7 @@ namespace Noble
 	Engine* g_Engine = nullptr;
 	World* g_World = nullptr;
 	AssetManager* g_AssetManager = nullptr;
+	AsyncFileIO* g_FileIO = nullptr;
 
 	World* GetWorld()
 	{
@@ -19,4 +20,9 @@ namespace Noble
 	{
 		return g_AssetManager;
 	}
+
+	AsyncFileIO* GetFileIO()
+	{
+		return g_FileIO;
+	}
 }
\ No newline at end of file
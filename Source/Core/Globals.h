@@ -5,6 +5,7 @@ namespace Noble
 	class Engine;
 	class World;
 	class AssetManager;
+	class AsyncFileIO;
 
 	// Global pointer to the engine instance
 	extern Engine* g_Engine;
@@ -12,6 +13,8 @@ namespace Noble
 	extern World* g_World;
 	// Global pointer to the asset manager
 	extern AssetManager* g_AssetManager;
+	// Global pointer to the async file I/O system
+	extern AsyncFileIO* g_FileIO;
 
 	/**
 	 * Returns a pointer to the world instance
@@ -22,4 +25,9 @@ namespace Noble
 	 * Returns a pointer to the asset manager
 	 */
 	AssetManager* GetAssetManager();
+
+	/**
+	 * Returns a pointer to the async file I/O system, or nullptr if the engine isn't running
+	 */
+	AsyncFileIO* GetFileIO();
 }
\ No newline at end of file
@@ -177,7 +177,7 @@ namespace Noble
 		Action GetAction(const NIdentifier& id);
 
 		/**
-		 * Returns the action that corresponds to the given string, or UNKNOWN if none
+		 * Returns the action whose identifier has the given NIdentifier::GetHash, or UNKNOWN if none
 		 */
 		Action GetAction(const U32 id);
 
@@ -187,7 +187,7 @@ namespace Noble
 		Axis GetAxis(const NIdentifier& id);
 
 		/**
-		 * Returns the axis that corresponds to the given string, or UNKNOWN if none
+		 * Returns the axis whose identifier has the given NIdentifier::GetHash, or UNKNOWN if none
 		 */
 		Axis GetAxis(const U32 id);
 
@@ -1,6 +1,8 @@
 #include "Logger.h"
 
+#include "AsyncFileIO.h"
 #include "FileSystem.h"
+#include "Globals.h"
 #include "String.h"
 
 #ifdef NOBLE_DEBUG
@@ -115,7 +117,17 @@ namespace Noble
 		str.Append<U8>("%u", (++m_LogWrites));
 		str += ".txt";
 
-		PrintLogInternal(str.GetCharArray());
+		// Hand a copy of the buffer to the I/O thread so the caller doesn't stall on the disk
+		AsyncFileIO* fileIO = GetFileIO();
+		if (fileIO && fileIO->IsRunning())
+		{
+			fileIO->Write(str.GetCharArray(), BitStream(m_LogBuffer, m_LogBufferPos), FileMode::FILE_WRITE_REPLACE,
+				AsyncIOCallback(), AsyncIOPriority::Low);
+		}
+		else
+		{
+			PrintLogInternal(str.GetCharArray());
+		}
 
 		// Clear the buffer
 		memset(m_LogBuffer, 0, LOG_BUFFER_SIZE);
@@ -5,6 +5,7 @@
 #include "String.h"
 
 #include <cstring>
+#include <mutex>
 
 namespace Noble
 {
@@ -45,7 +46,9 @@ namespace Noble
 		 */
 		FORCEINLINE static void PrintLog(const char* file)
 		{
-			Get().PrintLogInternal(file);
+			Logger& log = Get();
+			std::lock_guard<std::recursive_mutex> lock(log.m_Mutex);
+			log.PrintLogInternal(file);
 		}
 
 	private:
@@ -95,6 +98,8 @@ namespace Noble
 		{
 			CHECK(fmt); // ensure the format string is valid
 
+			std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
 			WriteLevel(level);
 			I32 res = sprintf_s(GetCurrentPos(), GetRemainingSpace(), fmt, args...);
 			WriteString(GetCurrentPos(), true);
@@ -132,6 +137,9 @@ namespace Noble
 		Size m_LogBufferPos;
 		// Number of times the log has been written out this run
 		U8 m_LogWrites;
+		// Serializes logging from the main thread and I/O threads
+		// Recursive because dumping the log can itself log
+		std::recursive_mutex m_Mutex;
 	};
 }
 
@@ -0,0 +1,44 @@
+#include "MappedTable.h"
+
+#include "Checksum.h"
+#include "Logger.h"
+
+namespace Noble
+{
+	namespace MappedTable
+	{
+		bool OpenHeader(const MappedFile& mapping, const fs::path& path, const char* kind, U32 magic, U32 version,
+			BitStreamView& header)
+		{
+			if (mapping.GetMappedSize() < HeaderSize)
+			{
+				NE_LOG_WARNING("%s has no %s header", path.string().c_str(), kind);
+				return false;
+			}
+
+			header = BitStreamView(reinterpret_cast<const Byte*>(mapping.GetData()), HeaderSize);
+			header.SetByteOrder(ByteOrder::Little);
+
+			const U32 fileMagic = header.Read<U32>();
+			const U32 fileVersion = header.Read<U32>();
+			if (fileMagic != magic)
+			{
+				NE_LOG_WARNING("%s has no %s header", path.string().c_str(), kind);
+				return false;
+			}
+			if (fileVersion != version)
+			{
+				NE_LOG_WARNING("%s has %s version %u, expected %u", path.string().c_str(), kind, fileVersion, version);
+				return false;
+			}
+
+			return true;
+		}
+
+		bool ReadHeaderChecksum(BitStreamView& header)
+		{
+			const Size checkedBytes = header.GetReaderPos();
+			return header.Read<U32>() == Checksum::Crc32c(header.GetData(), checkedBytes);
+		}
+	}
+}
\ No newline at end of file
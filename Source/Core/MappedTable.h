@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+
+#include "Array.h"
+#include "BitStream.h"
+#include "FileSystem.h"
+#include "Types.h"
+
+namespace Noble
+{
+	/**
+	 * Pieces shared by the file formats that are mapped and used in place, PackFile and AssetRegistryFile
+	 *
+	 * Both start with a 64-byte little-endian header (magic, version, then format fields and a
+	 * CRC32C of the header), followed by a table of fixed-size entries sorted by hash and a block
+	 * of null-terminated strings. Readers validate every range before pointing into the mapping;
+	 * writers sort their pending entries into table order and keep the last addition of a name.
+	 */
+	namespace MappedTable
+	{
+		// Size of the header at the start of the file
+		constexpr Size HeaderSize = 64;
+
+		/**
+		 * Rounds @value up to a multiple of @alignment, a power of two
+		 */
+		constexpr Size AlignUp(Size value, Size alignment)
+		{
+			return (value + alignment - 1) & ~(alignment - 1);
+		}
+
+		/**
+		 * Checks that @mapping starts with a header of the given magic and version and points @header
+		 * at it, positioned after the version. @kind names the format in log messages
+		 * Returns false, after logging why, if the file is too small or the magic or version differ
+		 */
+		bool OpenHeader(const MappedFile& mapping, const fs::path& path, const char* kind, U32 magic, U32 version,
+			BitStreamView& header);
+
+		/**
+		 * Reads the header checksum that follows the fields read so far and returns true if it matches them
+		 */
+		bool ReadHeaderChecksum(BitStreamView& header);
+
+		/**
+		 * Returns true if @size bytes at @offset lie within @fileSize bytes, with @offset a multiple of @alignment
+		 */
+		inline bool IsRangeValid(U64 offset, U64 size, Size fileSize, Size alignment = 1)
+		{
+			return offset % alignment == 0 && offset <= fileSize && size <= fileSize - offset;
+		}
+
+		/**
+		 * Returns true if the string block lies within the file and ends in a null, so no string
+		 * in it runs past its end; a table with entries needs a non-empty block
+		 */
+		inline bool IsStringBlockValid(const Byte* base, Size fileSize, U64 offset, U64 size, U32 entryCount)
+		{
+			return IsRangeValid(offset, size, fileSize) && (entryCount == 0 || size > 0) &&
+				(size == 0 || base[offset + size - 1] == '\0');
+		}
+
+		/**
+		 * Returns the table to use in place: @entries on little-endian hosts, or a copy in
+		 * @swapped with @swapEntry applied to every entry on big-endian ones
+		 */
+		template <typename EntryType, typename SwapFunction>
+		const EntryType* ToNativeOrder(const EntryType* entries, U32 count, Array<EntryType>& swapped, SwapFunction swapEntry)
+		{
+			if constexpr (ByteOrder::Native == ByteOrder::Big)
+			{
+				if (count > 0)
+				{
+					swapped.Resize(count);
+				}
+				for (U32 i = 0; i < count; ++i)
+				{
+					EntryType entry = entries[i];
+					swapEntry(entry);
+					swapped.Add(entry);
+				}
+				return swapped.GetData();
+			}
+			else
+			{
+				return entries;
+			}
+		}
+
+		/**
+		 * Returns @entries, or a table no lookup matches if there are none, so an empty file still reads as open
+		 */
+		template <typename EntryType>
+		const EntryType* GetTable(const EntryType* entries, U32 count)
+		{
+			static const EntryType emptyTable[1] = {};
+			return count > 0 ? entries : emptyTable;
+		}
+
+		/**
+		 * Fills @sorted with the indices of @count pending entries in table order: by hash, then
+		 * name, with later additions of a name after earlier ones
+		 * @getHash and @getName return the hash and null-terminated name of the entry at an index
+		 */
+		template <typename HashFunction, typename NameFunction>
+		void SortEntries(U32 count, Array<U32>& sorted, HashFunction getHash, NameFunction getName)
+		{
+			sorted.Empty();
+			if (count > 0)
+			{
+				sorted.Resize(count);
+			}
+			for (U32 i = 0; i < count; ++i)
+			{
+				sorted.Add(i);
+			}
+
+			std::sort(sorted.GetData(), sorted.GetData() + sorted.GetCount(), [&getHash, &getName](U32 lhs, U32 rhs)
+				{
+					const auto leftHash = getHash(lhs);
+					const auto rightHash = getHash(rhs);
+					if (leftHash != rightHash)
+					{
+						return leftHash < rightHash;
+					}
+					const int order = std::strcmp(getName(lhs), getName(rhs));
+					return order != 0 ? order < 0 : lhs < rhs;
+				});
+		}
+
+		/**
+		 * Returns true if the entry at @position in the order from SortEntries is replaced by a
+		 * later addition of the same name, and shouldn't be written
+		 */
+		template <typename HashFunction, typename NameFunction>
+		bool IsReplaced(const Array<U32>& sorted, Size position, HashFunction getHash, NameFunction getName)
+		{
+			if (position + 1 >= sorted.GetCount())
+			{
+				return false;
+			}
+
+			const U32 index = sorted[position];
+			const U32 next = sorted[position + 1];
+			return getHash(next) == getHash(index) && std::strcmp(getName(next), getName(index)) == 0;
+		}
+	}
+}
\ No newline at end of file
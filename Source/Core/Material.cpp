@@ -1,5 +1,7 @@
 #include "Material.h"
 
+#include <utility>
+
 #include "AssetManager.h"
 #include "Globals.h"
 #include "Logger.h"
@@ -17,6 +19,7 @@ namespace Noble
 	Material::Material(const Material& other)
 		: Material()
 	{
+		CopyAssetRefs(other);
 		SetShader(other.GetShader());
 
 		if (m_Shader && m_UniformBuffer && other.m_UniformBuffer)
@@ -32,6 +35,8 @@ namespace Noble
 			return *this;
 		}
 
+		ReleaseAssetRefs();
+		CopyAssetRefs(other);
 		SetShader(other.GetShader());
 
 		if (m_Shader && m_UniformBuffer && other.m_UniformBuffer)
@@ -58,10 +63,24 @@ namespace Noble
 		}
 	}
 
-	void Material::CreateFromBuffer(BitStream& data)
+	bool Material::ParseBuffer(BitStreamView& data)
+	{
+		m_PendingData = data;
+		return data.GetRemainingBytes() >= sizeof(U32);
+	}
+
+	void Material::CreateResources()
 	{
+		BitStreamView data = m_PendingData;
+		m_PendingData = BitStreamView();
+
 		U32 shaderId = data.Read<U32>();
-		SetShader(GetAssetManager()->GetShader(shaderId));
+		Shader* shader = static_cast<Shader*>(GetAssetManager()->GetAssetRef(shaderId, AssetType::AT_SHADER));
+		if (shader)
+		{
+			m_AssetRefs.Add(shader);
+		}
+		SetShader(shader);
 
 		if (!m_Shader)
 		{
@@ -82,9 +101,10 @@ namespace Noble
 				{
 					// Read a 32-bit uint for the texture ID
 					U32 texId = data.Read<U32>();
-					Texture2D* tex = GetAssetManager()->GetTexture2D(texId);
+					Texture2D* tex = static_cast<Texture2D*>(GetAssetManager()->GetAssetRef(texId, AssetType::AT_TEXTURE2D));
 					if (tex)
 					{
+						m_AssetRefs.Add(tex);
 						SetUniformData(attrOffset, tex);
 					}
 					break;
@@ -114,6 +134,12 @@ namespace Noble
 		}
 	}
 
+	AssetMemoryUsage Material::GetMemoryUsage() const
+	{
+		const Size uniformBytes = (m_Shader && m_UniformBuffer) ? m_Shader->GetUniformBufferSize() : 0;
+		return AssetMemoryUsage(sizeof(Material) + uniformBytes, 0);
+	}
+
 	void Material::EnableUniforms() const
 	{
 		U32 index = 0;
@@ -145,6 +171,37 @@ namespace Noble
 		if (m_UniformBuffer)
 		{
 			Memory::Free(m_UniformBuffer);
+			m_UniformBuffer = nullptr;
+		}
+
+		m_PendingData = BitStreamView();
+		ReleaseAssetRefs();
+	}
+
+	void Material::SwapContents(Asset& other)
+	{
+		Material& material = static_cast<Material&>(other);
+		std::swap(m_Shader, material.m_Shader);
+		std::swap(m_UniformBuffer, material.m_UniformBuffer);
+		std::swap(m_PendingData, material.m_PendingData);
+		std::swap(m_AssetRefs, material.m_AssetRefs);
+	}
+
+	void Material::CopyAssetRefs(const Material& other)
+	{
+		for (Asset* asset : other.m_AssetRefs)
+		{
+			GetAssetManager()->AddAssetRef(asset);
+			m_AssetRefs.Add(asset);
+		}
+	}
+
+	void Material::ReleaseAssetRefs()
+	{
+		for (Asset* asset : m_AssetRefs)
+		{
+			GetAssetManager()->ReleaseAssetRef(asset);
 		}
+		m_AssetRefs.Empty();
 	}
 }
\ No newline at end of file
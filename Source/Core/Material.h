@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Array.h"
 #include "Asset.h"
 #include "Shader.h"
 
@@ -14,6 +15,8 @@ namespace Noble
 	{
 	public:
 
+		static constexpr AssetType StaticType = AssetType::AT_MATERIAL;
+
 		/**
 		 * Default constructor
 		 */
@@ -64,22 +67,44 @@ namespace Noble
 		/**
 		 * Returns the corresponding AssetType for Materials
 		 */
-		virtual const AssetType GetType() const override { return AssetType::AT_MATERIAL; }
+		virtual const AssetType GetType() const override { return StaticType; }
+
+		/**
+		 * Counts the uniform buffer; the shader and textures are counted on their own
+		 */
+		virtual AssetMemoryUsage GetMemoryUsage() const override;
 
 	protected:
 
 		/**
-		 * Creates the Material from the given buffer
+		 * Keeps the given buffer for CreateResources, since reading it means looking up other assets
+		 */
+		virtual bool ParseBuffer(BitStreamView& data) override;
+
+		/**
+		 * Sets up the Material from the buffer kept by ParseBuffer, loading its shader and textures
 		 */
-		virtual void CreateFromBuffer(BitStream& data) override;
+		virtual void CreateResources() override;
 
 		/**
 		 * Frees memory and releases rendering resources
 		 */
 		virtual void Destroy() override;
 
+		virtual void SwapContents(Asset& other) override;
+
 	private:
 
+		/**
+		 * Takes a reference on every asset @other references
+		 */
+		void CopyAssetRefs(const Material& other);
+
+		/**
+		 * Drops the references this Material holds
+		 */
+		void ReleaseAssetRefs();
+
 		/**
 		 * Sets the data at the offset to a new value
 		 */
@@ -95,6 +120,10 @@ namespace Noble
 		Shader* m_Shader;
 		// Uniform buffer
 		UByte* m_UniformBuffer;
+		// Buffer kept by ParseBuffer until CreateResources
+		BitStreamView m_PendingData;
+		// Shader and textures this Material keeps loaded, referenced rather than pinned
+		Array<Asset*> m_AssetRefs;
 
 	};
 }
\ No newline at end of file
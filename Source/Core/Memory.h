@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Types.h"
+#include <atomic>
 #include <type_traits>
 
 // Macro to shorten the POD type evaluation
@@ -77,8 +78,8 @@ namespace Noble
 
 	private:
 
-		// ++ for alloc, -- for free
-		inline static U32 AllocCount = 0;
+		// ++ for alloc, -- for free; atomic since worker threads allocate too
+		inline static std::atomic<U32> AllocCount = 0;
 	};
 
 	/**
@@ -286,6 +287,8 @@ namespace Noble
 			other.m_ElemCount = 0;
 			other.m_AllocSize = 0;
 			other.m_Data = nullptr;
+
+			return *this;
 		}
 
 		/**
@@ -293,14 +296,9 @@ namespace Noble
 		 */
 		const Size CalculateGrowSize(const Size& requestedCount = 0)
 		{
-			if (requestedCount > m_ElemCount)
-			{
-				return requestedCount;
-			}
-			else
-			{
-				return glm::max((m_ElemCount * 3) / 2, m_ElemCount + 4);
-			}
+			// Always grow geometrically, even when a minimum is requested, so that
+			// adding one element at a time doesn't reallocate on every add
+			return glm::max(requestedCount, glm::max((m_ElemCount * 3) / 2, m_ElemCount + 4));
 		}
 
 		/**
@@ -0,0 +1,1104 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "Array.h"
+#include "Checksum.h"
+
+namespace Noble
+{
+	namespace
+	{
+		// Marks an unassigned vertex or triangle
+		constexpr U32 Invalid = 0xFFFFFFFF;
+
+		// Tuning of Forsyth's vertex cache optimization, from the original article
+		constexpr U32 ForsythCacheSize = 32;
+		constexpr F32 CacheDecayPower = 1.5F;
+		constexpr F32 LastTriangleScore = 0.75F;
+		constexpr F32 ValenceBoostScale = 2.0F;
+		constexpr F32 ValenceBoostPower = 0.5F;
+		// Valences below this have their boost looked up rather than computed
+		constexpr U32 ValenceTableSize = 32;
+
+		// Vertex fetch is measured with 64-byte lines through a small FIFO cache of them
+		constexpr Size FetchLineSize = 64;
+		constexpr U32 FetchCacheLines = 64;
+
+		// Collapses may turn a triangle by up to about 75 degrees, the cosine below
+		constexpr F32 MinCollapseCosine = 0.25F;
+		// Marks an empty slot of the edge table
+		constexpr U64 InvalidEdge = ~0ULL;
+
+		// Clusters past their minimum size stop growing at triangles turned more than 60 degrees from their average normal
+		constexpr F32 MinClusterCosine = 0.5F;
+
+		/**
+		 * Refills @array with @count copies of @value, reusing its allocation
+		 */
+		template <typename T>
+		void Assign(Array<T>& array, Size count, const T& value)
+		{
+			array.Empty();
+			if (count > array.GetMax())
+			{
+				array.Resize(count);
+			}
+			for (Size i = 0; i < count; ++i)
+			{
+				array.Add(value);
+			}
+		}
+
+		/**
+		 * Score terms of Forsyth's algorithm, which are rescored for every cached vertex after each triangle
+		 */
+		struct ForsythScoreTables
+		{
+			ForsythScoreTables()
+			{
+				for (U32 i = 0; i < ForsythCacheSize; ++i)
+				{
+					// The last triangle's vertices all score the same, so no order among them is favored
+					const F32 scale = 1.0F / (ForsythCacheSize - 3);
+					Cache[i] = i < 3 ? LastTriangleScore : std::pow(1.0F - (i - 3) * scale, CacheDecayPower);
+				}
+				for (U32 i = 0; i < ValenceTableSize; ++i)
+				{
+					Valence[i] = ValenceBoostScale * std::pow(F32(i), -ValenceBoostPower);
+				}
+			}
+
+			F32 Cache[ForsythCacheSize];
+			F32 Valence[ValenceTableSize];
+		};
+
+		/**
+		 * Scores a vertex for Forsyth's algorithm: vertices high in the cache and with few
+		 * triangles left score higher, so triangles that use them are emitted first
+		 */
+		F32 ForsythVertexScore(I32 cachePosition, U32 remainingValence)
+		{
+			static const ForsythScoreTables tables;
+
+			// Nothing left to draw with it
+			if (remainingValence == 0)
+			{
+				return -1.0F;
+			}
+
+			// Boost vertices with few triangles left, so they're finished off rather than left as stragglers
+			const F32 score = cachePosition >= 0 ? tables.Cache[cachePosition] : 0.0F;
+			return score + (remainingValence < ValenceTableSize ? tables.Valence[remainingValence] :
+				ValenceBoostScale * std::pow(F32(remainingValence), -ValenceBoostPower));
+		}
+
+		/**
+		 * Quadric of the squared distances to a set of planes, weighted by the area of the triangles they came from
+		 * Evaluates to the weighted mean, so errors don't grow just because a region has more triangles
+		 */
+		struct Quadric
+		{
+			Quadric()
+				: A00(0), A01(0), A02(0), A11(0), A12(0), A22(0), B0(0), B1(0), B2(0), C(0), Weight(0)
+			{}
+
+			/**
+			 * Adds the plane through @point with the unit @normal
+			 */
+			void AddPlane(const Vector3f& normal, const Vector3f& point, F64 weight)
+			{
+				const F64 x = normal.x;
+				const F64 y = normal.y;
+				const F64 z = normal.z;
+				const F64 d = -(x * point.x + y * point.y + z * point.z);
+				A00 += weight * x * x;
+				A01 += weight * x * y;
+				A02 += weight * x * z;
+				A11 += weight * y * y;
+				A12 += weight * y * z;
+				A22 += weight * z * z;
+				B0 += weight * x * d;
+				B1 += weight * y * d;
+				B2 += weight * z * d;
+				C += weight * d * d;
+				Weight += weight;
+			}
+
+			void Add(const Quadric& other)
+			{
+				A00 += other.A00;
+				A01 += other.A01;
+				A02 += other.A02;
+				A11 += other.A11;
+				A12 += other.A12;
+				A22 += other.A22;
+				B0 += other.B0;
+				B1 += other.B1;
+				B2 += other.B2;
+				C += other.C;
+				Weight += other.Weight;
+			}
+
+			/**
+			 * Returns the mean squared distance from @point to the planes
+			 */
+			F64 Evaluate(const Vector3f& point) const
+			{
+				const F64 x = point.x;
+				const F64 y = point.y;
+				const F64 z = point.z;
+				const F64 error = A00 * x * x + A11 * y * y + A22 * z * z + 2.0 * (A01 * x * y + A02 * x * z + A12 * y * z) +
+					2.0 * (B0 * x + B1 * y + B2 * z) + C;
+				return Weight > 0.0 ? std::max(error, 0.0) / Weight : 0.0;
+			}
+
+			F64 A00, A01, A02, A11, A12, A22;
+			F64 B0, B1, B2;
+			F64 C;
+			F64 Weight;
+		};
+
+		/**
+		 * Moving one vertex onto another along an edge
+		 */
+		struct EdgeCollapse
+		{
+			U32 From;
+			U32 To;
+			// Mean squared distance the moved vertex ends up from its planes
+			F64 Error;
+		};
+
+		/**
+		 * Sets @positionID to the first vertex at each vertex's position, so vertices split along seams can be matched
+		 */
+		void FindSharedPositions(const StaticVertex* vertices, U32 vertexCount, Array<U32>& positionID)
+		{
+			Assign(positionID, vertexCount, Invalid);
+
+			Size tableSize = 16;
+			while (tableSize < Size(vertexCount) * 2)
+			{
+				tableSize *= 2;
+			}
+			const Size mask = tableSize - 1;
+
+			Array<U32> table;
+			Assign(table, tableSize, Invalid);
+			for (U32 v = 0; v < vertexCount; ++v)
+			{
+				Size slot = Checksum::Crc32c(&vertices[v].Position, sizeof(Vector3f)) & mask;
+				while (true)
+				{
+					const U32 existing = table[slot];
+					if (existing == Invalid)
+					{
+						table[slot] = v;
+						positionID[v] = v;
+						break;
+					}
+					if (vertices[existing].Position == vertices[v].Position)
+					{
+						positionID[v] = existing;
+						break;
+					}
+					slot = (slot + 1) & mask;
+				}
+			}
+		}
+
+		/**
+		 * Returns the slot of @key in an open-addressing edge table, inserting it if @insert is set
+		 * Returns Invalid if it's missing and not inserted
+		 */
+		U32 FindEdge(Array<U64>& table, U64 key, bool insert)
+		{
+			const Size mask = table.GetCount() - 1;
+			Size slot = Checksum::Crc32c(&key, sizeof(key)) & mask;
+			while (table[slot] != key)
+			{
+				if (table[slot] == InvalidEdge)
+				{
+					if (!insert)
+					{
+						return Invalid;
+					}
+					table[slot] = key;
+					break;
+				}
+				slot = (slot + 1) & mask;
+			}
+			return static_cast<U32>(slot);
+		}
+
+		/**
+		 * Returns true if moving @from onto @to turns any of the triangles around @from too far,
+		 * which would fold the surface over itself
+		 */
+		bool FlipsTriangles(const U32* indices, const U32* triangles, U32 triangleCount, U32 from, U32 to, const StaticVertex* vertices)
+		{
+			for (U32 i = 0; i < triangleCount; ++i)
+			{
+				const U32* triangle = indices + Size(triangles[i]) * 3;
+				if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+				{
+					// Collapses to a line and is dropped
+					continue;
+				}
+
+				Vector3f before[3];
+				Vector3f after[3];
+				for (U32 k = 0; k < 3; ++k)
+				{
+					before[k] = vertices[triangle[k]].Position;
+					after[k] = vertices[triangle[k] == from ? to : triangle[k]].Position;
+				}
+
+				const Vector3f normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+				const Vector3f normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+				const F32 lengthBefore = glm::length(normalBefore);
+				if (lengthBefore > 0.0F && glm::dot(normalBefore, normalAfter) <= MinCollapseCosine * lengthBefore * glm::length(normalAfter))
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		/**
+		 * Runs a triangle through a FIFO vertex cache emulated with timestamps: a vertex is
+		 * still cached if fewer than @cacheSize vertices were added after it
+		 * Returns the number of misses
+		 */
+		U32 UpdateCache(const U32* triangle, U32 cacheSize, U32* timestamps, U32& timestamp)
+		{
+			U32 misses = 0;
+			for (U32 k = 0; k < 3; ++k)
+			{
+				if (timestamp - timestamps[triangle[k]] > cacheSize)
+				{
+					timestamps[triangle[k]] = timestamp++;
+					++misses;
+				}
+			}
+			return misses;
+		}
+	}
+
+	U32 MeshOptimizer::Optimize(StaticVertex* vertices, U32 vertexCount, U32* indices, Size indexCount)
+	{
+		vertexCount = DeduplicateVertices(vertices, vertexCount, indices, indexCount);
+		OptimizeVertexCache(indices, indexCount, vertexCount);
+		OptimizeOverdraw(indices, indexCount, vertices, vertexCount);
+		return OptimizeVertexFetch(vertices, vertexCount, indices, indexCount);
+	}
+
+	U32 MeshOptimizer::DeduplicateVertices(StaticVertex* vertices, U32 vertexCount, U32* indices, Size indexCount)
+	{
+		// Open addressing over the compacted vertices, kept at most half full
+		Size tableSize = 16;
+		while (tableSize < Size(vertexCount) * 2)
+		{
+			tableSize *= 2;
+		}
+		const Size mask = tableSize - 1;
+
+		Array<U32> table;
+		Assign(table, tableSize, Invalid);
+		Array<U32> remap;
+		Assign(remap, vertexCount, Invalid);
+
+		// Unique vertices are compacted as they're found; the slot they move to is never past the one being read
+		U32 uniqueCount = 0;
+		for (U32 i = 0; i < vertexCount; ++i)
+		{
+			Size slot = Checksum::Crc32c(&vertices[i], sizeof(StaticVertex)) & mask;
+			while (true)
+			{
+				const U32 existing = table[slot];
+				if (existing == Invalid)
+				{
+					table[slot] = uniqueCount;
+					vertices[uniqueCount] = vertices[i];
+					remap[i] = uniqueCount++;
+					break;
+				}
+				if (std::memcmp(&vertices[existing], &vertices[i], sizeof(StaticVertex)) == 0)
+				{
+					remap[i] = existing;
+					break;
+				}
+				slot = (slot + 1) & mask;
+			}
+		}
+
+		for (Size i = 0; i < indexCount; ++i)
+		{
+			CHECK(indices[i] < vertexCount);
+			indices[i] = remap[indices[i]];
+		}
+
+		return uniqueCount;
+	}
+
+	void MeshOptimizer::OptimizeVertexCache(U32* indices, Size indexCount, U32 vertexCount)
+	{
+		CHECK(indexCount % 3 == 0);
+		const Size triangleCount = indexCount / 3;
+		if (triangleCount == 0)
+		{
+			return;
+		}
+
+		// Triangles using each vertex, as a range of one shared list
+		// The first Valence entries of a range are the triangles not emitted yet
+		Array<U32> valence;
+		Assign(valence, vertexCount, 0U);
+		for (Size i = 0; i < indexCount; ++i)
+		{
+			CHECK(indices[i] < vertexCount);
+			++valence[indices[i]];
+		}
+
+		Array<U32> firstTriangle;
+		Assign(firstTriangle, vertexCount, 0U);
+		U32 offset = 0;
+		for (U32 v = 0; v < vertexCount; ++v)
+		{
+			firstTriangle[v] = offset;
+			offset += valence[v];
+			valence[v] = 0;
+		}
+
+		Array<U32> vertexTriangles;
+		Assign(vertexTriangles, indexCount, 0U);
+		for (Size i = 0; i < indexCount; ++i)
+		{
+			const U32 v = indices[i];
+			vertexTriangles[firstTriangle[v] + valence[v]++] = static_cast<U32>(i / 3);
+		}
+
+		Array<I32> cachePosition;
+		Assign(cachePosition, vertexCount, -1);
+		Array<F32> vertexScore;
+		Assign(vertexScore, vertexCount, 0.0F);
+		for (U32 v = 0; v < vertexCount; ++v)
+		{
+			vertexScore[v] = ForsythVertexScore(-1, valence[v]);
+		}
+
+		Array<F32> triangleScore;
+		Assign(triangleScore, triangleCount, 0.0F);
+		Array<bool> emitted;
+		Assign(emitted, triangleCount, false);
+		U32 best = 0;
+		for (Size t = 0; t < triangleCount; ++t)
+		{
+			triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+			if (triangleScore[t] > triangleScore[best])
+			{
+				best = static_cast<U32>(t);
+			}
+		}
+
+		Array<U32> output;
+		output.Resize(indexCount);
+
+		// Scored cache, plus room for the vertices the next triangle pushes out of it
+		U32 cache[ForsythCacheSize + 3];
+		U32 cacheCount = 0;
+		Size nextUnemitted = 0;
+		for (Size emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+		{
+			// Dead end: nothing in the cache has triangles left, so pick up the next one in input order
+			if (best == Invalid)
+			{
+				while (emitted[nextUnemitted])
+				{
+					++nextUnemitted;
+				}
+				best = static_cast<U32>(nextUnemitted);
+			}
+
+			const U32* triangle = indices + Size(best) * 3;
+			output.AddMultiple(triangle, 3);
+			emitted[best] = true;
+
+			for (U32 k = 0; k < 3; ++k)
+			{
+				const U32 v = triangle[k];
+				U32* remaining = vertexTriangles.GetData() + firstTriangle[v];
+				const U32 count = valence[v];
+				for (U32 j = 0; j < count; ++j)
+				{
+					if (remaining[j] == best)
+					{
+						remaining[j] = remaining[count - 1];
+						remaining[count - 1] = best;
+						break;
+					}
+				}
+				--valence[v];
+			}
+
+			// The triangle's vertices move to the front, the rest keep their order behind them
+			U32 newCache[ForsythCacheSize + 3];
+			U32 newCount = 0;
+			for (U32 k = 0; k < 3; ++k)
+			{
+				if (std::find(newCache, newCache + newCount, triangle[k]) == newCache + newCount)
+				{
+					newCache[newCount++] = triangle[k];
+				}
+			}
+			for (U32 i = 0; i < cacheCount; ++i)
+			{
+				if (cache[i] != triangle[0] && cache[i] != triangle[1] && cache[i] != triangle[2])
+				{
+					newCache[newCount++] = cache[i];
+				}
+			}
+
+			// Rescore every vertex whose position changed, including the ones pushed out
+			for (U32 i = 0; i < newCount; ++i)
+			{
+				const U32 v = newCache[i];
+				cachePosition[v] = i < ForsythCacheSize ? static_cast<I32>(i) : -1;
+
+				const F32 score = ForsythVertexScore(cachePosition[v], valence[v]);
+				const F32 delta = score - vertexScore[v];
+				vertexScore[v] = score;
+
+				const U32* remaining = vertexTriangles.GetData() + firstTriangle[v];
+				for (U32 j = 0; j < valence[v]; ++j)
+				{
+					triangleScore[remaining[j]] += delta;
+				}
+			}
+
+			cacheCount = newCount < ForsythCacheSize ? newCount : ForsythCacheSize;
+			std::memcpy(cache, newCache, cacheCount * sizeof(U32));
+
+			// Only triangles touching the cache are candidates; anything else falls back to input order
+			best = Invalid;
+			F32 bestScore = -1.0F;
+			for (U32 i = 0; i < cacheCount; ++i)
+			{
+				const U32 v = cache[i];
+				const U32* remaining = vertexTriangles.GetData() + firstTriangle[v];
+				for (U32 j = 0; j < valence[v]; ++j)
+				{
+					if (triangleScore[remaining[j]] > bestScore)
+					{
+						bestScore = triangleScore[remaining[j]];
+						best = remaining[j];
+					}
+				}
+			}
+		}
+
+		std::memcpy(indices, output.GetData(), indexCount * sizeof(U32));
+	}
+
+	void MeshOptimizer::OptimizeOverdraw(U32* indices, Size indexCount, const StaticVertex* vertices, U32 vertexCount, F32 threshold)
+	{
+		CHECK(indexCount % 3 == 0);
+		const Size triangleCount = indexCount / 3;
+		if (triangleCount == 0)
+		{
+			return;
+		}
+
+		Array<U32> timestamps;
+		Assign(timestamps, vertexCount, 0U);
+		U32 timestamp = SimulatedCacheSize + 1;
+
+		// A triangle that misses on all three vertices usually starts a patch disjoint from the last one,
+		// so the mesh can be cut there without costing cache hits
+		Array<U32> hardBoundaries;
+		for (Size t = 0; t < triangleCount; ++t)
+		{
+			if (UpdateCache(indices + t * 3, SimulatedCacheSize, timestamps.GetData(), timestamp) == 3 || t == 0)
+			{
+				hardBoundaries.Add(static_cast<U32>(t));
+			}
+		}
+
+		// Patches are cut further wherever their running ACMR already meets the threshold
+		Array<U32> clusters;
+		for (Size h = 0; h < hardBoundaries.GetCount(); ++h)
+		{
+			const U32 start = hardBoundaries[h];
+			const U32 end = h + 1 < hardBoundaries.GetCount() ? hardBoundaries[h + 1] : static_cast<U32>(triangleCount);
+
+			timestamp += SimulatedCacheSize + 1;
+			U32 patchMisses = 0;
+			for (U32 t = start; t < end; ++t)
+			{
+				patchMisses += UpdateCache(indices + Size(t) * 3, SimulatedCacheSize, timestamps.GetData(), timestamp);
+			}
+			const F32 patchThreshold = threshold * F32(patchMisses) / F32(end - start);
+
+			clusters.Add(start);
+			timestamp += SimulatedCacheSize + 1;
+			U32 runningMisses = 0;
+			U32 runningTriangles = 0;
+			for (U32 t = start; t < end; ++t)
+			{
+				runningMisses += UpdateCache(indices + Size(t) * 3, SimulatedCacheSize, timestamps.GetData(), timestamp);
+				++runningTriangles;
+				if (F32(runningMisses) / F32(runningTriangles) <= patchThreshold)
+				{
+					clusters.Add(t + 1);
+					timestamp += SimulatedCacheSize + 1;
+					runningMisses = 0;
+					runningTriangles = 0;
+				}
+			}
+
+			// The last cut either ends the patch or leaves a tail short of the target; merge either way
+			if (clusters[clusters.GetCount() - 1] != start)
+			{
+				clusters.RemoveAt(clusters.GetCount() - 1);
+			}
+		}
+
+		Vector3f meshCenter(0.0F);
+		for (U32 v = 0; v < vertexCount; ++v)
+		{
+			meshCenter += vertices[v].Position;
+		}
+		meshCenter /= F32(vertexCount > 0 ? vertexCount : 1);
+
+		// Clusters facing away from the center are on the outside, so they're drawn first
+		const Size clusterCount = clusters.GetCount();
+		Array<F32> sortKeys;
+		Assign(sortKeys, clusterCount, 0.0F);
+		Array<U32> order;
+		for (Size c = 0; c < clusterCount; ++c)
+		{
+			const U32 start = clusters[c];
+			const U32 end = c + 1 < clusterCount ? clusters[c + 1] : static_cast<U32>(triangleCount);
+
+			Vector3f center(0.0F);
+			Vector3f normal(0.0F);
+			F32 area = 0.0F;
+			for (U32 t = start; t < end; ++t)
+			{
+				const Vector3f& p0 = vertices[indices[Size(t) * 3]].Position;
+				const Vector3f& p1 = vertices[indices[Size(t) * 3 + 1]].Position;
+				const Vector3f& p2 = vertices[indices[Size(t) * 3 + 2]].Position;
+				const Vector3f faceNormal = glm::cross(p1 - p0, p2 - p0);
+				const F32 faceArea = glm::length(faceNormal);
+
+				center += (p0 + p1 + p2) * (faceArea / 3.0F);
+				normal += faceNormal;
+				area += faceArea;
+			}
+
+			const F32 normalLength = glm::length(normal);
+			if (area > 0.0F && normalLength > 0.0F)
+			{
+				sortKeys[c] = glm::dot(center / area - meshCenter, normal / normalLength);
+			}
+			order.Add(static_cast<U32>(c));
+		}
+
+		std::stable_sort(order.GetData(), order.GetData() + order.GetCount(), [&sortKeys](U32 a, U32 b) { return sortKeys[a] > sortKeys[b]; });
+
+		Array<U32> output;
+		output.Resize(indexCount);
+		for (const U32 c : order)
+		{
+			const U32 start = clusters[c];
+			const U32 end = c + 1 < clusterCount ? clusters[c + 1] : static_cast<U32>(triangleCount);
+			output.AddMultiple(indices + Size(start) * 3, Size(end - start) * 3);
+		}
+
+		std::memcpy(indices, output.GetData(), indexCount * sizeof(U32));
+	}
+
+	U32 MeshOptimizer::OptimizeVertexFetch(StaticVertex* vertices, U32 vertexCount, U32* indices, Size indexCount)
+	{
+		Array<U32> remap;
+		Assign(remap, vertexCount, Invalid);
+
+		U32 usedCount = 0;
+		for (Size i = 0; i < indexCount; ++i)
+		{
+			const U32 v = indices[i];
+			CHECK(v < vertexCount);
+			if (remap[v] == Invalid)
+			{
+				remap[v] = usedCount++;
+			}
+			indices[i] = remap[v];
+		}
+
+		Array<StaticVertex> source;
+		source.Resize(vertexCount);
+		source.AddMultiple(vertices, vertexCount);
+		for (U32 v = 0; v < vertexCount; ++v)
+		{
+			if (remap[v] != Invalid)
+			{
+				vertices[remap[v]] = source[v];
+			}
+		}
+
+		return usedCount;
+	}
+
+	Size MeshOptimizer::Simplify(U32* indices, Size indexCount, const StaticVertex* vertices, U32 vertexCount,
+		Size targetIndexCount, F32 maxError, F32& resultError)
+	{
+		CHECK(indexCount % 3 == 0);
+		resultError = 0.0F;
+		if (indexCount <= targetIndexCount)
+		{
+			return indexCount;
+		}
+
+		// Vertices sharing a position sit on a seam between UV islands or hard edges; moving one would tear it,
+		// so they're locked, and edges are matched by the first vertex at each position
+		Array<U32> positionID;
+		FindSharedPositions(vertices, vertexCount, positionID);
+		Array<bool> locked;
+		Assign(locked, vertexCount, false);
+		for (U32 v = 0; v < vertexCount; ++v)
+		{
+			if (positionID[v] != v)
+			{
+				locked[v] = true;
+				locked[positionID[v]] = true;
+			}
+		}
+
+		// Edges used by only one triangle are on a border; locking their vertices keeps the outline
+		{
+			Size tableSize = 16;
+			while (tableSize < indexCount * 2)
+			{
+				tableSize *= 2;
+			}
+
+			Array<U64> edges;
+			Assign(edges, tableSize, InvalidEdge);
+			for (Size i = 0; i < indexCount; ++i)
+			{
+				const Size next = i - i % 3 + (i + 1) % 3;
+				FindEdge(edges, (U64(positionID[indices[i]]) << 32) | positionID[indices[next]], true);
+			}
+			for (Size i = 0; i < indexCount; ++i)
+			{
+				const Size next = i - i % 3 + (i + 1) % 3;
+				if (FindEdge(edges, (U64(positionID[indices[next]]) << 32) | positionID[indices[i]], false) == Invalid)
+				{
+					locked[indices[i]] = true;
+					locked[indices[next]] = true;
+				}
+			}
+		}
+
+		Array<Quadric> quadrics;
+		Assign(quadrics, vertexCount, Quadric());
+		for (Size t = 0; t < indexCount / 3; ++t)
+		{
+			const U32* triangle = indices + t * 3;
+			const Vector3f& p0 = vertices[triangle[0]].Position;
+			const Vector3f normal = glm::cross(vertices[triangle[1]].Position - p0, vertices[triangle[2]].Position - p0);
+			const F32 length = glm::length(normal);
+			if (length > 0.0F)
+			{
+				Quadric plane;
+				plane.AddPlane(normal / length, p0, length * 0.5);
+				for (U32 k = 0; k < 3; ++k)
+				{
+					quadrics[triangle[k]].Add(plane);
+				}
+			}
+		}
+
+		const F64 maxErrorSquared = F64(maxError) * F64(maxError);
+		Array<U32> valence;
+		Array<U32> firstTriangle;
+		Array<U32> vertexTriangles;
+		Array<EdgeCollapse> collapses;
+		Array<bool> touched;
+		Array<U32> remap;
+		while (indexCount > targetIndexCount)
+		{
+			// Triangles around each vertex, as a range of one shared list
+			Assign(valence, vertexCount, 0U);
+			for (Size i = 0; i < indexCount; ++i)
+			{
+				++valence[indices[i]];
+			}
+			Assign(firstTriangle, vertexCount, 0U);
+			U32 offset = 0;
+			for (U32 v = 0; v < vertexCount; ++v)
+			{
+				firstTriangle[v] = offset;
+				offset += valence[v];
+				valence[v] = 0;
+			}
+			Assign(vertexTriangles, indexCount, 0U);
+			for (Size i = 0; i < indexCount; ++i)
+			{
+				const U32 v = indices[i];
+				vertexTriangles[firstTriangle[v] + valence[v]++] = static_cast<U32>(i / 3);
+			}
+
+			// Every edge appears once in each direction, from the triangles on both sides of it
+			collapses.Empty();
+			for (Size i = 0; i < indexCount; ++i)
+			{
+				const U32 from = indices[i];
+				const U32 to = indices[i - i % 3 + (i + 1) % 3];
+				if (!locked[from] && from != to)
+				{
+					collapses.Add({ from, to, quadrics[from].Evaluate(vertices[to].Position) });
+				}
+			}
+			std::sort(collapses.GetData(), collapses.GetData() + collapses.GetCount(),
+				[] (const EdgeCollapse& a, const EdgeCollapse& b) { return a.Error < b.Error; });
+
+			// Each collapse removes about two triangles. Triangles around a moved vertex are left alone for
+			// the rest of the pass, so every flip test sees them as they'll be drawn.
+			const Size goal = (indexCount - targetIndexCount + 5) / 6;
+			Assign(touched, vertexCount, false);
+			Assign(remap, vertexCount, 0U);
+			for (U32 v = 0; v < vertexCount; ++v)
+			{
+				remap[v] = v;
+			}
+
+			Size performed = 0;
+			for (const EdgeCollapse& collapse : collapses)
+			{
+				if (performed >= goal || collapse.Error > maxErrorSquared)
+				{
+					break;
+				}
+
+				const U32* triangles = vertexTriangles.GetData() + firstTriangle[collapse.From];
+				if (touched[collapse.From] || touched[collapse.To] ||
+					FlipsTriangles(indices, triangles, valence[collapse.From], collapse.From, collapse.To, vertices))
+				{
+					continue;
+				}
+
+				remap[collapse.From] = collapse.To;
+				quadrics[collapse.To].Add(quadrics[collapse.From]);
+				resultError = std::max(resultError, static_cast<F32>(std::sqrt(collapse.Error)));
+				for (U32 j = 0; j < valence[collapse.From]; ++j)
+				{
+					const U32* triangle = indices + Size(triangles[j]) * 3;
+					touched[triangle[0]] = true;
+					touched[triangle[1]] = true;
+					touched[triangle[2]] = true;
+				}
+				touched[collapse.To] = true;
+				++performed;
+			}
+
+			if (performed == 0)
+			{
+				break;
+			}
+
+			// Triangles that lost a side are gone
+			Size kept = 0;
+			for (Size i = 0; i < indexCount; i += 3)
+			{
+				const U32 a = remap[indices[i]];
+				const U32 b = remap[indices[i + 1]];
+				const U32 c = remap[indices[i + 2]];
+				if (a != b && b != c && a != c)
+				{
+					indices[kept++] = a;
+					indices[kept++] = b;
+					indices[kept++] = c;
+				}
+			}
+			indexCount = kept;
+		}
+
+		return indexCount;
+	}
+
+	U32 MeshOptimizer::GenerateLods(Array<U32>& indices, const StaticVertex* vertices, U32 vertexCount, StaticMeshLod* lods,
+		U32 maxLodCount, F32 reduction)
+	{
+		CHECK(maxLodCount > 0 && maxLodCount <= StaticMesh::MaxLodCount);
+		CHECK(indices.GetCount() % 3 == 0 && indices.GetCount() <= 0xFFFFFFFF);
+
+		lods[0] = StaticMeshLod(0, static_cast<U32>(indices.GetCount()), 0.0F);
+		U32 lodCount = 1;
+		Array<U32> lod;
+		while (lodCount < maxLodCount)
+		{
+			// Each LOD is made from the one before, so its error adds to that one's
+			const StaticMeshLod previous = lods[lodCount - 1];
+			lod.Empty();
+			lod.AddMultiple(indices.GetData() + previous.FirstIndex, previous.IndexCount);
+
+			const Size target = Size(previous.IndexCount / 3 * reduction) * 3;
+			F32 error = 0.0F;
+			const Size count = Simplify(lod.GetData(), lod.GetCount(), vertices, vertexCount, target,
+				std::numeric_limits<F32>::max(), error);
+
+			// Stalled, e.g. on meshes that are mostly seams and borders, which stay locked
+			if (count == 0 || count * 10 > Size(previous.IndexCount) * 9 || indices.GetCount() + count > 0xFFFFFFFF)
+			{
+				break;
+			}
+
+			OptimizeVertexCache(lod.GetData(), count, vertexCount);
+			lods[lodCount++] = StaticMeshLod(static_cast<U32>(indices.GetCount()), static_cast<U32>(count), previous.Error + error);
+			indices.AddMultiple(lod.GetData(), count);
+		}
+
+		return lodCount;
+	}
+
+	void MeshOptimizer::BuildClusters(U32* indices, const StaticVertex* vertices, U32 vertexCount, StaticMeshLod* lods, U32 lodCount,
+		Array<StaticMeshCluster>& clusters)
+	{
+		// Clusters grow across seams, so neighboring triangles are found through shared positions
+		Array<U32> positionID;
+		FindSharedPositions(vertices, vertexCount, positionID);
+
+		Array<U32> valence;
+		Array<U32> firstTriangle;
+		Array<U32> vertexTriangles;
+		Array<Vector3f> normals;
+		Array<Vector3f> centroids;
+		Array<U32> clusterOf;
+		Array<U32> candidateOf;
+		Array<U32> candidates;
+		Array<U32> members;
+		Array<U32> output;
+		for (U32 l = 0; l < lodCount; ++l)
+		{
+			StaticMeshLod& lod = lods[l];
+			CHECK(lod.IndexCount % 3 == 0);
+			U32* lodIndices = indices + lod.FirstIndex;
+			const U32 triangleCount = lod.IndexCount / 3;
+
+			// Triangles around each position, as a range of one shared list
+			Assign(valence, vertexCount, 0U);
+			for (U32 i = 0; i < lod.IndexCount; ++i)
+			{
+				CHECK(lodIndices[i] < vertexCount);
+				++valence[positionID[lodIndices[i]]];
+			}
+			Assign(firstTriangle, vertexCount, 0U);
+			U32 offset = 0;
+			for (U32 v = 0; v < vertexCount; ++v)
+			{
+				firstTriangle[v] = offset;
+				offset += valence[v];
+				valence[v] = 0;
+			}
+			Assign(vertexTriangles, lod.IndexCount, 0U);
+			for (U32 i = 0; i < lod.IndexCount; ++i)
+			{
+				const U32 position = positionID[lodIndices[i]];
+				vertexTriangles[firstTriangle[position] + valence[position]++] = i / 3;
+			}
+
+			// Front faces wind clockwise, so their normals are the reverse of the usual cross product
+			Assign(normals, triangleCount, Vector3f(0.0F));
+			Assign(centroids, triangleCount, Vector3f(0.0F));
+			for (U32 t = 0; t < triangleCount; ++t)
+			{
+				const Vector3f& p0 = vertices[lodIndices[t * 3]].Position;
+				const Vector3f& p1 = vertices[lodIndices[t * 3 + 1]].Position;
+				const Vector3f& p2 = vertices[lodIndices[t * 3 + 2]].Position;
+				const Vector3f normal = glm::cross(p2 - p0, p1 - p0);
+				const F32 length = glm::length(normal);
+				if (length > 0.0F)
+				{
+					normals[t] = normal / length;
+				}
+				centroids[t] = (p0 + p1 + p2) / 3.0F;
+			}
+
+			// Seeded in draw order, so clusters keep the overdraw order and their triangles the cache order
+			Assign(clusterOf, triangleCount, Invalid);
+			Assign(candidateOf, triangleCount, Invalid);
+			output.Empty();
+			lod.FirstCluster = static_cast<U32>(clusters.GetCount());
+			U32 seed = 0;
+			while (true)
+			{
+				while (seed < triangleCount && clusterOf[seed] != Invalid)
+				{
+					++seed;
+				}
+				if (seed == triangleCount)
+				{
+					break;
+				}
+
+				const U32 cluster = static_cast<U32>(clusters.GetCount());
+				members.Empty();
+				candidates.Empty();
+				Vector3f normalSum(0.0F);
+				Vector3f min(std::numeric_limits<F32>::max());
+				Vector3f max(-std::numeric_limits<F32>::max());
+				U32 next = seed;
+				while (true)
+				{
+					clusterOf[next] = cluster;
+					members.Add(next);
+					normalSum += normals[next];
+					for (U32 k = 0; k < 3; ++k)
+					{
+						const U32 vertex = lodIndices[next * 3 + k];
+						min = glm::min(min, vertices[vertex].Position);
+						max = glm::max(max, vertices[vertex].Position);
+
+						const U32 position = positionID[vertex];
+						for (U32 j = firstTriangle[position]; j < firstTriangle[position] + valence[position]; ++j)
+						{
+							const U32 neighbor = vertexTriangles[j];
+							if (clusterOf[neighbor] == Invalid && candidateOf[neighbor] != cluster)
+							{
+								candidateOf[neighbor] = cluster;
+								candidates.Add(neighbor);
+							}
+						}
+					}
+					if (members.GetCount() == MaxClusterTriangles)
+					{
+						break;
+					}
+
+					// The nearest neighbor keeps the bounding sphere small, weighted against turning away from the normals so far
+					const Vector3f center = (min + max) * 0.5F;
+					const F32 axisLength = glm::length(normalSum);
+					const Vector3f axis = axisLength > 0.0F ? normalSum / axisLength : Vector3f(0.0F);
+					Size best = SizeMaxValue;
+					F32 bestScore = std::numeric_limits<F32>::max();
+					F32 bestCosine = 1.0F;
+					for (Size c = 0; c < candidates.GetCount(); ++c)
+					{
+						const U32 candidate = candidates[c];
+						// Degenerate triangles face nowhere, so they never widen the cone
+						const F32 cosine = normals[candidate] == Vector3f(0.0F) ? 1.0F : glm::dot(normals[candidate], axis);
+						const F32 score = glm::length(centroids[candidate] - center) * (2.0F - cosine);
+						if (score < bestScore)
+						{
+							best = c;
+							bestScore = score;
+							bestCosine = cosine;
+						}
+					}
+					if (best == SizeMaxValue || (members.GetCount() >= MinClusterTriangles && bestCosine < MinClusterCosine))
+					{
+						break;
+					}
+
+					next = candidates[best];
+					candidates[best] = candidates[candidates.GetCount() - 1];
+					candidates.RemoveAt(candidates.GetCount() - 1);
+				}
+
+				std::sort(members.GetData(), members.GetData() + members.GetCount());
+
+				StaticMeshCluster result;
+				result.FirstIndex = lod.FirstIndex + static_cast<U32>(output.GetCount());
+				result.IndexCount = static_cast<U32>(members.GetCount() * 3);
+				result.Center = (min + max) * 0.5F;
+				F32 radiusSquared = 0.0F;
+				for (const U32 member : members)
+				{
+					output.AddMultiple(lodIndices + Size(member) * 3, 3);
+					for (U32 k = 0; k < 3; ++k)
+					{
+						const Vector3f offset = vertices[lodIndices[member * 3 + k]].Position - result.Center;
+						radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+					}
+				}
+				result.Radius = std::sqrt(radiusSquared);
+
+				// The cone is as wide as the face furthest from the average normal
+				const F32 axisLength = glm::length(normalSum);
+				if (axisLength > 0.0F)
+				{
+					result.ConeAxis = normalSum / axisLength;
+					result.ConeCosine = 1.0F;
+					for (const U32 member : members)
+					{
+						if (normals[member] != Vector3f(0.0F))
+						{
+							result.ConeCosine = std::min(result.ConeCosine, glm::dot(normals[member], result.ConeAxis));
+						}
+					}
+				}
+				clusters.Add(result);
+			}
+
+			std::memcpy(lodIndices, output.GetData(), Size(lod.IndexCount) * sizeof(U32));
+			lod.ClusterCount = static_cast<U32>(clusters.GetCount()) - lod.FirstCluster;
+		}
+	}
+
+	MeshCacheStats MeshOptimizer::Analyze(const U32* indices, Size indexCount, U32 vertexCount, Size vertexSize)
+	{
+		MeshCacheStats stats;
+		if (indexCount < 3 || vertexCount == 0)
+		{
+			return stats;
+		}
+
+		Array<U32> timestamps;
+		Assign(timestamps, vertexCount, 0U);
+		U32 timestamp = SimulatedCacheSize + 1;
+
+		const Size lineCount = (Size(vertexCount) * vertexSize + FetchLineSize - 1) / FetchLineSize;
+		Array<U32> lineTimestamps;
+		Assign(lineTimestamps, lineCount, 0U);
+		U32 lineTimestamp = FetchCacheLines + 1;
+
+		Size usedCount = 0;
+		Size misses = 0;
+		Size fetchedBytes = 0;
+		for (Size i = 0; i < indexCount; ++i)
+		{
+			const U32 v = indices[i];
+			CHECK(v < vertexCount);
+			if (timestamp - timestamps[v] <= SimulatedCacheSize)
+			{
+				continue;
+			}
+
+			usedCount += timestamps[v] == 0 ? 1 : 0;
+			timestamps[v] = timestamp++;
+			++misses;
+
+			// Only vertices the shader runs on are fetched
+			const Size firstLine = Size(v) * vertexSize / FetchLineSize;
+			const Size lastLine = (Size(v) * vertexSize + vertexSize - 1) / FetchLineSize;
+			for (Size line = firstLine; line <= lastLine; ++line)
+			{
+				if (lineTimestamp - lineTimestamps[line] > FetchCacheLines)
+				{
+					lineTimestamps[line] = lineTimestamp++;
+					fetchedBytes += FetchLineSize;
+				}
+			}
+		}
+
+		stats.ACMR = F32(misses) / F32(indexCount / 3);
+		stats.ATVR = F32(misses) / F32(usedCount);
+		stats.Overfetch = F32(fetchedBytes) / F32(usedCount * vertexSize);
+		return stats;
+	}
+}
\ No newline at end of file
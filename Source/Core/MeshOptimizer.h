@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Array.h"
+#include "StaticMesh.h"
+#include "Types.h"
+
+namespace Noble
+{
+	/**
+	 * How well a triangle list uses the GPU's vertex caches
+	 */
+	struct MeshCacheStats
+	{
+		MeshCacheStats()
+			: ACMR(0), ATVR(0), Overfetch(0)
+		{}
+
+		// Average cache miss ratio: vertex shader runs per triangle, from 3 down to about 0.5
+		F32 ACMR;
+		// Average transformed vertex ratio: vertex shader runs per vertex, 1 at best
+		F32 ATVR;
+		// Bytes of vertex memory fetched over the size of the vertex data, 1 at best
+		F32 Overfetch;
+	};
+
+	/**
+	 * Cook-time processing of StaticMesh triangle lists, run before a mesh is written as a StaticMeshFile
+	 *
+	 * Every step works in place on a vertex array and a U32 index list of whole triangles. The
+	 * full pipeline merges identical vertices, orders triangles for the post-transform vertex
+	 * cache (Forsyth's linear-speed algorithm), reorders clusters of them so outward-facing parts
+	 * of the mesh draw first to cut overdraw, then orders vertices by first use so vertex fetch
+	 * streams through memory. The file writer stores 16-bit indices when the vertex count allows.
+	 *
+	 * LODs are made by quadric error simplification (Garland and Heckbert) that only collapses
+	 * vertices onto other vertices, so every LOD indexes the same vertex array and a mesh's LODs
+	 * are ranges of one index buffer. Each LOD is then split into clusters of neighboring
+	 * triangles, bounded for culling on the CPU, which are ranges of the LOD in turn.
+	 */
+	struct MeshOptimizer
+	{
+		// FIFO vertex cache size assumed by the statistics and the overdraw clustering, a common hardware size
+		static constexpr U32 SimulatedCacheSize = 16;
+		// Largest ACMR increase, as a ratio, that overdraw ordering may trade for fewer overdrawn pixels
+		static constexpr F32 DefaultOverdrawThreshold = 1.05F;
+		// LODs cooked per mesh by default, including the full mesh
+		static constexpr U32 DefaultLodCount = 4;
+		// Triangles in each LOD relative to the one before it
+		static constexpr F32 DefaultLodReduction = 0.5F;
+		// Most triangles in a cluster
+		static constexpr U32 MaxClusterTriangles = 128;
+		// Triangles a cluster grows to before it may stop where the surface turns sharply
+		static constexpr U32 MinClusterTriangles = 64;
+
+		/**
+		 * Runs every step below on the mesh
+		 * Returns the new vertex count; the vertex array is compacted to it
+		 */
+		static U32 Optimize(StaticVertex* vertices, U32 vertexCount, U32* indices, Size indexCount);
+
+		/**
+		 * Merges bitwise-identical vertices and points the indices at the remaining copy
+		 * Returns the new vertex count; unique vertices keep their relative order
+		 */
+		static U32 DeduplicateVertices(StaticVertex* vertices, U32 vertexCount, U32* indices, Size indexCount);
+
+		/**
+		 * Reorders triangles so consecutive ones share vertices still in the post-transform cache
+		 */
+		static void OptimizeVertexCache(U32* indices, Size indexCount, U32 vertexCount);
+
+		/**
+		 * Splits the cache-ordered triangles into clusters and draws the ones facing away from the
+		 * mesh's center first, so they tend to occlude the rest. Clusters are cut where the cache
+		 * would miss anyway, or where they already reach @threshold times their own ACMR.
+		 */
+		static void OptimizeOverdraw(U32* indices, Size indexCount, const StaticVertex* vertices, U32 vertexCount,
+			F32 threshold = DefaultOverdrawThreshold);
+
+		/**
+		 * Reorders vertices by their first use in the index list and drops unused ones
+		 * Returns the new vertex count
+		 */
+		static U32 OptimizeVertexFetch(StaticVertex* vertices, U32 vertexCount, U32* indices, Size indexCount);
+
+		/**
+		 * Collapses edges of the triangle list, cheapest quadric error first, until at most @targetIndexCount
+		 * indices are left or the next collapse would move the surface further than @maxError mesh units.
+		 * Vertices on borders and on seams between vertices sharing a position are kept in place.
+		 * Returns the new index count; @resultError is set to the largest error of the collapses made
+		 */
+		static Size Simplify(U32* indices, Size indexCount, const StaticVertex* vertices, U32 vertexCount,
+			Size targetIndexCount, F32 maxError, F32& resultError);
+
+		/**
+		 * Appends simplified copies of the full triangle list in @indices, each with about @reduction times the
+		 * triangles of the one before, optimized for the vertex cache. Stops early once simplification stalls.
+		 * Returns the number of LODs written to @lods, including the full mesh as the first
+		 */
+		static U32 GenerateLods(Array<U32>& indices, const StaticVertex* vertices, U32 vertexCount, StaticMeshLod* lods,
+			U32 maxLodCount = DefaultLodCount, F32 reduction = DefaultLodReduction);
+
+		/**
+		 * Splits each LOD into clusters of MinClusterTriangles to MaxClusterTriangles connected triangles, fewer
+		 * where a piece of the mesh runs out, and reorders its indices so every cluster is a range of them.
+		 * Appends the clusters with their bounding spheres and normal cones to @clusters and sets each LOD's range of them
+		 */
+		static void BuildClusters(U32* indices, const StaticVertex* vertices, U32 vertexCount, StaticMeshLod* lods, U32 lodCount,
+			Array<StaticMeshCluster>& clusters);
+
+		/**
+		 * Simulates a FIFO vertex cache and 64-byte vertex fetch lines over the index list
+		 */
+		static MeshCacheStats Analyze(const U32* indices, Size indexCount, U32 vertexCount, Size vertexSize = sizeof(StaticVertex));
+	};
+}
\ No newline at end of file
@@ -0,0 +1,219 @@
+#include "MeshQuantizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Noble
+{
+	namespace
+	{
+		// Largest magnitude of a normalized 16-bit value
+		constexpr F32 SnormScale = 32767.0F;
+
+		/**
+		 * Converts a value in -1..1 to the nearest normalized 16-bit value
+		 */
+		I16 EncodeSnorm(F32 value)
+		{
+			return static_cast<I16>(std::lround(std::clamp(value, -1.0F, 1.0F) * SnormScale));
+		}
+
+		/**
+		 * Converts a normalized 16-bit value back to -1..1 as the GPU does, with -32768 clamped to -1
+		 */
+		F32 DecodeSnorm(I16 value)
+		{
+			return std::max(value / SnormScale, -1.0F);
+		}
+
+		/**
+		 * Returns 1 for positive values and zero, -1 for negative ones
+		 */
+		F32 SignNotZero(F32 value)
+		{
+			return value >= 0.0F ? 1.0F : -1.0F;
+		}
+
+		/**
+		 * Returns the angle between two directions of any length, in degrees
+		 */
+		F32 AngleBetween(const Vector3f& a, const Vector3f& b)
+		{
+			// Small angles are lost to rounding in acos of the dot product, but not in atan2
+			return glm::degrees(std::atan2(glm::length(glm::cross(a, b)), glm::dot(a, b)));
+		}
+
+		/**
+		 * Decodes one compact vertex
+		 */
+		StaticVertex DecodeVertex(const CompactStaticVertex& vertex, const Vector3f& positionOffset, F32 positionScale)
+		{
+			StaticVertex decoded;
+			decoded.Position = positionOffset + Vector3f(DecodeSnorm(vertex.Position[0]), DecodeSnorm(vertex.Position[1]),
+				DecodeSnorm(vertex.Position[2])) * positionScale;
+			decoded.TexCoord = Vector2f(static_cast<F32>(vertex.TexCoord[0]), static_cast<F32>(vertex.TexCoord[1]));
+			decoded.Normal = MeshQuantizer::DecodeOctahedral(vertex.Normal);
+			decoded.Tangent = MeshQuantizer::DecodeOctahedral(vertex.Tangent);
+			return decoded;
+		}
+	}
+
+	void MeshQuantizer::ComputeBounds(const StaticVertex* vertices, U32 vertexCount, Vector3f& positionOffset, F32& positionScale)
+	{
+		CHECK(vertices && vertexCount > 0);
+
+		Vector3f min = vertices[0].Position;
+		Vector3f max = vertices[0].Position;
+		for (U32 i = 1; i < vertexCount; ++i)
+		{
+			min = glm::min(min, vertices[i].Position);
+			max = glm::max(max, vertices[i].Position);
+		}
+
+		// A cube rather than a box, so the position transform scales every axis the same
+		const Vector3f halfSize = (max - min) * 0.5F;
+		positionOffset = (min + max) * 0.5F;
+		positionScale = std::max(halfSize.x, std::max(halfSize.y, halfSize.z));
+		if (!(positionScale > 0.0F))
+		{
+			positionScale = 1.0F;
+		}
+	}
+
+	MeshQuantizationError MeshQuantizer::Quantize(const StaticVertex* vertices, U32 vertexCount, const Vector3f& positionOffset, F32 positionScale,
+		CompactStaticVertex* output)
+	{
+		CHECK(positionScale > 0.0F);
+
+		MeshQuantizationError error;
+		F64 positionSum = 0;
+		F64 normalSum = 0;
+		F64 tangentSum = 0;
+		F64 texCoordSum = 0;
+		U32 normalCount = 0;
+		U32 tangentCount = 0;
+		for (U32 i = 0; i < vertexCount; ++i)
+		{
+			const StaticVertex& vertex = vertices[i];
+			CompactStaticVertex& compact = output[i];
+
+			const Vector3f position = (vertex.Position - positionOffset) / positionScale;
+			compact.Position[0] = EncodeSnorm(position.x);
+			compact.Position[1] = EncodeSnorm(position.y);
+			compact.Position[2] = EncodeSnorm(position.z);
+			// Tells the vertex shader the normals and tangents are octahedral
+			compact.Position[3] = 0;
+			compact.TexCoord[0] = half_float::half_cast<F16, std::round_to_nearest>(vertex.TexCoord.x);
+			compact.TexCoord[1] = half_float::half_cast<F16, std::round_to_nearest>(vertex.TexCoord.y);
+			EncodeOctahedral(vertex.Normal, compact.Normal);
+			EncodeOctahedral(vertex.Tangent, compact.Tangent);
+
+			const StaticVertex decoded = DecodeVertex(compact, positionOffset, positionScale);
+
+			const F32 positionError = glm::length(decoded.Position - vertex.Position);
+			error.MaxPosition = std::max(error.MaxPosition, positionError);
+			positionSum += positionError;
+
+			const F32 texCoordError = std::max(std::abs(decoded.TexCoord.x - vertex.TexCoord.x), std::abs(decoded.TexCoord.y - vertex.TexCoord.y));
+			error.MaxTexCoord = std::max(error.MaxTexCoord, texCoordError);
+			texCoordSum += texCoordError;
+
+			// Directions that were never set have nothing to lose
+			if (glm::dot(vertex.Normal, vertex.Normal) > 0.0F)
+			{
+				const F32 normalError = AngleBetween(decoded.Normal, vertex.Normal);
+				error.MaxNormal = std::max(error.MaxNormal, normalError);
+				normalSum += normalError;
+				++normalCount;
+			}
+			if (glm::dot(vertex.Tangent, vertex.Tangent) > 0.0F)
+			{
+				const F32 tangentError = AngleBetween(decoded.Tangent, vertex.Tangent);
+				error.MaxTangent = std::max(error.MaxTangent, tangentError);
+				tangentSum += tangentError;
+				++tangentCount;
+			}
+		}
+
+		if (vertexCount > 0)
+		{
+			error.MeanPosition = static_cast<F32>(positionSum / vertexCount);
+			error.MeanTexCoord = static_cast<F32>(texCoordSum / vertexCount);
+		}
+		if (normalCount > 0)
+		{
+			error.MeanNormal = static_cast<F32>(normalSum / normalCount);
+		}
+		if (tangentCount > 0)
+		{
+			error.MeanTangent = static_cast<F32>(tangentSum / tangentCount);
+		}
+
+		return error;
+	}
+
+	void MeshQuantizer::Dequantize(const CompactStaticVertex* vertices, U32 vertexCount, const Vector3f& positionOffset, F32 positionScale,
+		StaticVertex* output)
+	{
+		for (U32 i = 0; i < vertexCount; ++i)
+		{
+			output[i] = DecodeVertex(vertices[i], positionOffset, positionScale);
+		}
+	}
+
+	bool MeshQuantizer::IsAcceptable(const MeshQuantizationError& error)
+	{
+		return error.MaxPosition <= DefaultMaxPositionError && error.MaxTexCoord <= DefaultMaxTexCoordError;
+	}
+
+	void MeshQuantizer::EncodeOctahedral(const Vector3f& direction, I16* encoded)
+	{
+		const F32 manhattan = std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z);
+		if (!(manhattan > 0.0F))
+		{
+			encoded[0] = 0;
+			encoded[1] = 0;
+			return;
+		}
+
+		// Project onto the octahedron, folding the lower half over the upper one
+		F32 u = direction.x / manhattan;
+		F32 v = direction.y / manhattan;
+		if (direction.z < 0.0F)
+		{
+			const F32 foldedU = (1.0F - std::abs(v)) * SignNotZero(u);
+			v = (1.0F - std::abs(u)) * SignNotZero(v);
+			u = foldedU;
+		}
+
+		// Rounding each coordinate to nearest isn't always closest once decoded, so try all four neighbors
+		const F32 floorU = std::floor(std::clamp(u, -1.0F, 1.0F) * SnormScale);
+		const F32 floorV = std::floor(std::clamp(v, -1.0F, 1.0F) * SnormScale);
+		F32 bestCosine = -2.0F;
+		for (U32 i = 0; i < 4; ++i)
+		{
+			const I16 candidate[2] = {
+				static_cast<I16>(std::min(floorU + (i & 1), SnormScale)),
+				static_cast<I16>(std::min(floorV + (i >> 1), SnormScale))
+			};
+			const F32 cosine = glm::dot(DecodeOctahedral(candidate), direction);
+			if (cosine > bestCosine)
+			{
+				bestCosine = cosine;
+				encoded[0] = candidate[0];
+				encoded[1] = candidate[1];
+			}
+		}
+	}
+
+	Vector3f MeshQuantizer::DecodeOctahedral(const I16* encoded)
+	{
+		// Matches OctahedralDecode in the vertex shaders
+		Vector3f direction(DecodeSnorm(encoded[0]), DecodeSnorm(encoded[1]), 0.0F);
+		direction.z = 1.0F - std::abs(direction.x) - std::abs(direction.y);
+		const F32 fold = std::max(-direction.z, 0.0F);
+		direction.x += direction.x >= 0.0F ? -fold : fold;
+		direction.y += direction.y >= 0.0F ? -fold : fold;
+		return glm::normalize(direction);
+	}
+}
\ No newline at end of file
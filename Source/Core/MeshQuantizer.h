@@ -0,0 +1,81 @@
+#pragma once
+
+#include "StaticMesh.h"
+#include "Types.h"
+
+namespace Noble
+{
+	/**
+	 * How far a mesh's compact vertices are from the full ones they were made from
+	 */
+	struct MeshQuantizationError
+	{
+		MeshQuantizationError()
+			: MaxPosition(0), MeanPosition(0), MaxNormal(0), MeanNormal(0), MaxTangent(0), MeanTangent(0), MaxTexCoord(0), MeanTexCoord(0)
+		{}
+
+		// Distance between a position and its decoded value, in mesh units
+		F32 MaxPosition;
+		F32 MeanPosition;
+		// Angle between a normal and its decoded direction, in degrees
+		F32 MaxNormal;
+		F32 MeanNormal;
+		// Angle between a tangent and its decoded direction, in degrees
+		F32 MaxTangent;
+		F32 MeanTangent;
+		// Largest difference of either texture coordinate
+		F32 MaxTexCoord;
+		F32 MeanTexCoord;
+	};
+
+	/**
+	 * Cook-time conversion of StaticVertex arrays to CompactStaticVertex
+	 *
+	 * Positions become normalized 16-bit values within the mesh's bounding cube, which is kept
+	 * uniform so the position transform doesn't skew normals. Normals and tangents are mapped onto
+	 * an octahedron and stored as two normalized 16-bit values, picking the rounding that decodes
+	 * closest to the original direction. Texture coordinates become half floats, so they lose
+	 * precision as they grow; meshes that tile far outside 0..1 are better left full.
+	 */
+	struct MeshQuantizer
+	{
+		// Largest position error, in mesh units, for a mesh to be cooked compact by default
+		static constexpr F32 DefaultMaxPositionError = 0.001F;
+		// Largest texture coordinate error for a mesh to be cooked compact by default, a texel of a 4096 texture
+		static constexpr F32 DefaultMaxTexCoordError = 1.0F / 4096.0F;
+
+		/**
+		 * Finds the bounding cube of the positions as its center and half size
+		 */
+		static void ComputeBounds(const StaticVertex* vertices, U32 vertexCount, Vector3f& positionOffset, F32& positionScale);
+
+		/**
+		 * Encodes the vertices in the cube at @positionOffset with half size @positionScale into @output,
+		 * and measures the error of decoding them again
+		 */
+		static MeshQuantizationError Quantize(const StaticVertex* vertices, U32 vertexCount, const Vector3f& positionOffset, F32 positionScale,
+			CompactStaticVertex* output);
+
+		/**
+		 * Decodes compact vertices back to full ones, the way the vertex shader does
+		 */
+		static void Dequantize(const CompactStaticVertex* vertices, U32 vertexCount, const Vector3f& positionOffset, F32 positionScale,
+			StaticVertex* output);
+
+		/**
+		 * Returns true if the error is within the defaults above
+		 */
+		static bool IsAcceptable(const MeshQuantizationError& error);
+
+		/**
+		 * Encodes a direction as two normalized 16-bit octahedral coordinates
+		 * Zero-length directions encode as +Z
+		 */
+		static void EncodeOctahedral(const Vector3f& direction, I16* encoded);
+
+		/**
+		 * Decodes two normalized 16-bit octahedral coordinates to a unit direction
+		 */
+		static Vector3f DecodeOctahedral(const I16* encoded);
+	};
+}
\ No newline at end of file
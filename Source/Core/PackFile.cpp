@@ -0,0 +1,612 @@
+#include "PackFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#include "Checksum.h"
+#include "Compression.h"
+#include "DirectoryIndex.h"
+#include "Logger.h"
+
+// Invalid source offset, marks entries whose data was added from memory
+#define PACK_NO_SOURCE 0xFFFFFFFFU
+
+namespace Noble
+{
+	namespace
+	{
+		/**
+		 * Byte-swaps every field of the entry, to convert between the pack's little-endian
+		 * layout and a big-endian host
+		 */
+		void SwapEntry(PackEntry& entry)
+		{
+			ByteOrderHelper::SwapUnits(&entry.NameHash, sizeof(U64), 4);
+			ByteOrderHelper::SwapUnits(&entry.NameOffset, sizeof(U32), 4);
+		}
+
+		/**
+		 * Writes @count zero bytes
+		 */
+		void WritePadding(BufferedFileWriter& writer, Size count)
+		{
+			static const Byte zeros[256] = {};
+			while (count > 0)
+			{
+				const Size chunk = count < sizeof(zeros) ? count : sizeof(zeros);
+				writer.Write(zeros, chunk);
+				count -= chunk;
+			}
+		}
+	}
+
+	PackFile::PackFile()
+		: m_Entries(nullptr), m_EntryCount(0), m_Names(nullptr), m_Alignment(0), m_VerifiedEntries(nullptr)
+	{}
+
+	PackFile::~PackFile()
+	{
+		Close();
+	}
+
+	bool PackFile::Open(const fs::path& path)
+	{
+		Close();
+
+		// Entries are read at scattered offsets, so readahead of the whole file is wasted
+		if (!m_Mapping.Open(path, 0, MappedFile::RandomAccess))
+		{
+			NE_LOG_WARNING("Failed to open pack %s", path.string().c_str());
+			return false;
+		}
+
+		BitStreamView header;
+		if (!MappedTable::OpenHeader(m_Mapping, path, "pack", Magic, Version, header))
+		{
+			Close();
+			return false;
+		}
+
+		const Byte* base = reinterpret_cast<const Byte*>(m_Mapping.GetData());
+		const Size fileSize = m_Mapping.GetMappedSize();
+
+		const U32 entryCount = header.Read<U32>();
+		const U32 alignment = header.Read<U32>();
+		const U64 tocOffset = header.Read<U64>();
+		const U64 namesOffset = header.Read<U64>();
+		const U64 namesSize = header.Read<U64>();
+		const U32 tocChecksum = header.Read<U32>();
+		const bool headerValid = MappedTable::ReadHeaderChecksum(header);
+
+		// Every range is checked against the file size before anything points into it
+		const U64 tocSize = U64(entryCount) * sizeof(PackEntry);
+		if (!headerValid || alignment == 0 || (alignment & (alignment - 1)) != 0 ||
+			!MappedTable::IsRangeValid(tocOffset, tocSize, fileSize, alignof(PackEntry)) ||
+			!MappedTable::IsStringBlockValid(base, fileSize, namesOffset, namesSize, entryCount))
+		{
+			NE_LOG_WARNING("Pack %s has a corrupt header", path.string().c_str());
+			Close();
+			return false;
+		}
+
+		U32 checksum = Checksum::Crc32c(base + tocOffset, tocSize);
+		checksum = Checksum::Crc32c(base + namesOffset, namesSize, checksum);
+		if (checksum != tocChecksum)
+		{
+			NE_LOG_WARNING("Pack %s has a corrupt table of contents", path.string().c_str());
+			Close();
+			return false;
+		}
+
+		const PackEntry* entries = MappedTable::ToNativeOrder(reinterpret_cast<const PackEntry*>(base + tocOffset),
+			entryCount, m_SwappedEntries, SwapEntry);
+
+		// Catch anything that would make a lookup or a view go out of range, or make Read allocate
+		// more than the stored data can decompress to
+		for (U32 i = 0; i < entryCount; ++i)
+		{
+			const PackEntry& entry = entries[i];
+			const bool compressed = IsCompressed(entry);
+			if (entry.NameOffset >= namesSize || entry.DataOffset > fileSize || entry.StoredSize > fileSize - entry.DataOffset ||
+				(!compressed && entry.RawSize != entry.StoredSize) || (compressed && entry.RawSize > entry.StoredSize * Compression::MaxExpansion) ||
+				(i > 0 && entries[i - 1].NameHash > entry.NameHash))
+			{
+				NE_LOG_WARNING("Pack %s has a corrupt entry", path.string().c_str());
+				Close();
+				return false;
+			}
+		}
+
+		m_Entries = MappedTable::GetTable(entries, entryCount);
+		m_EntryCount = entryCount;
+		m_Names = reinterpret_cast<const char*>(base + namesOffset);
+		m_Alignment = alignment;
+		m_VerifiedEntries = new std::atomic<U32>[(Size(entryCount) + 31) / 32]();
+
+		return true;
+	}
+
+	void PackFile::Close()
+	{
+		if (m_Mapping.IsValid())
+		{
+			m_Mapping.Close();
+		}
+		m_SwappedEntries.Empty();
+		delete[] m_VerifiedEntries;
+		m_VerifiedEntries = nullptr;
+		m_Entries = nullptr;
+		m_EntryCount = 0;
+		m_Names = nullptr;
+		m_Alignment = 0;
+	}
+
+	const PackEntry* PackFile::Find(const char* name) const
+	{
+		return Find(name, std::strlen(name));
+	}
+
+	const PackEntry* PackFile::Find(const char* name, Size length) const
+	{
+		return FindHashed(HashString64(name, length), name, length);
+	}
+
+	const PackEntry* PackFile::Find(const NIdentifier& id) const
+	{
+		if (!id.GetString())
+		{
+			return nullptr;
+		}
+
+#ifdef NOBLE_WIDE_IDENTIFIERS
+		// The identifier already carries the hash the table is keyed by
+		return FindHashed(id.GetIdentifierHash(), id.GetString(), id.GetSize());
+#else
+		return Find(id.GetString(), id.GetSize());
+#endif
+	}
+
+	const PackEntry* PackFile::FindHashed(U64 hash, const char* name, Size length) const
+	{
+		if (!IsOpen())
+		{
+			return nullptr;
+		}
+
+		const PackEntry* end = m_Entries + m_EntryCount;
+		const PackEntry* found = std::lower_bound(m_Entries, end, hash,
+			[](const PackEntry& entry, U64 value) { return entry.NameHash < value; });
+
+		for (; found != end && found->NameHash == hash; ++found)
+		{
+			const char* entryName = m_Names + found->NameOffset;
+			if (std::strncmp(entryName, name, length) == 0 && entryName[length] == '\0')
+			{
+				return found;
+			}
+		}
+		return nullptr;
+	}
+
+	bool PackFile::GetView(const PackEntry& entry, BitStreamView& view) const
+	{
+		if (!CheckEntry(entry))
+		{
+			return false;
+		}
+
+		view = GetStoredBytes(entry);
+		return true;
+	}
+
+	bool PackFile::Read(const PackEntry& entry, BitStream& output, U32 workerCount) const
+	{
+		if (entry.RawSize == 0)
+		{
+			return true;
+		}
+
+		BitStreamView stored;
+		if (!GetView(entry, stored))
+		{
+			return false;
+		}
+
+		if (output.GetStoredBytes() + entry.RawSize > output.GetMaxBytes())
+		{
+			output.Resize(output.GetStoredBytes() + entry.RawSize);
+		}
+
+		if (!IsCompressed(entry))
+		{
+			output.WriteBytes(stored.GetData(), stored.GetSize());
+			return true;
+		}
+
+		const Size startBytes = output.GetStoredBytes();
+		if (!Compression::DecompressFrame(stored, output, workerCount) || output.GetStoredBytes() - startBytes != entry.RawSize)
+		{
+			NE_LOG_WARNING("Pack entry %s failed to decompress", GetName(entry));
+			return false;
+		}
+		return true;
+	}
+
+	bool PackFile::VerifyEntry(const PackEntry& entry) const
+	{
+		const BitStreamView stored = GetStoredBytes(entry);
+		if (Checksum::Crc32c(stored.GetData(), stored.GetSize()) != entry.Checksum)
+		{
+			return false;
+		}
+
+		const Size index = &entry - m_Entries;
+		m_VerifiedEntries[index / 32].fetch_or(1U << (index % 32), std::memory_order_relaxed);
+		return true;
+	}
+
+	BitStreamView PackFile::GetStoredBytes(const PackEntry& entry) const
+	{
+		CHECK(IsOpen() && &entry >= m_Entries && &entry < m_Entries + m_EntryCount);
+
+		return BitStreamView(reinterpret_cast<const Byte*>(m_Mapping.GetData()) + entry.DataOffset, entry.StoredSize);
+	}
+
+	bool PackFile::CheckEntry(const PackEntry& entry) const
+	{
+		const Size index = &entry - m_Entries;
+		if ((m_VerifiedEntries[index / 32].load(std::memory_order_relaxed) & (1U << (index % 32))) != 0)
+		{
+			return true;
+		}
+
+		// Another thread may verify the same entry meanwhile, which costs time but gives the same answer
+		if (!VerifyEntry(entry))
+		{
+			NE_LOG_WARNING("Pack entry %s is corrupt", GetName(entry));
+			return false;
+		}
+		return true;
+	}
+
+	PackWriter::PackWriter()
+		: m_Alignment(DefaultAlignment), m_CompressionEnabled(true), m_CompressedCount(0)
+	{}
+
+	void PackWriter::SetAlignment(U32 alignment)
+	{
+		CHECK(alignment > 0 && (alignment & (alignment - 1)) == 0);
+		m_Alignment = alignment;
+	}
+
+	void PackWriter::AddFile(const char* name, const fs::path& source, bool allowCompression)
+	{
+		const std::string sourcePath = source.string();
+		const U32 sourceOffset = static_cast<U32>(m_SourcePool.GetCount());
+		m_SourcePool.AddMultiple(sourcePath.c_str(), sourcePath.size() + 1);
+
+		AddEntry(name, sourceOffset, 0, 0, allowCompression);
+	}
+
+	void PackWriter::AddData(const char* name, const void* data, Size size, bool allowCompression)
+	{
+		CHECK(data || size == 0);
+
+		const Size dataOffset = m_Data.GetStoredBytes();
+		if (size > 0)
+		{
+			m_Data.WriteBytes(static_cast<const Byte*>(data), size);
+		}
+
+		AddEntry(name, PACK_NO_SOURCE, dataOffset, size, allowCompression);
+	}
+
+	void PackWriter::AddDirectory(const DirectoryIndex& index, const char* namePrefix)
+	{
+		const Size prefixLength = std::strlen(namePrefix);
+
+		Array<char> name;
+		for (const DirectoryEntry& entry : index.GetEntries())
+		{
+			if (std::strcmp(index.GetExtension(entry), PackFile::Extension) == 0)
+			{
+				continue;
+			}
+
+			name.Empty();
+			if (prefixLength > 0)
+			{
+				name.AddMultiple(namePrefix, prefixLength);
+			}
+			name.AddMultiple(index.GetPath(entry), Size(entry.PathLength) + 1);
+
+			AddFile(name.GetData(), index.GetFullPath(entry));
+		}
+	}
+
+	void PackWriter::AddEntry(const char* name, U32 sourceOffset, Size dataOffset, Size dataSize, bool allowCompression)
+	{
+		const Size nameLength = std::strlen(name);
+		CHECK(nameLength > 0);
+
+		PendingEntry entry;
+		entry.NameHash = HashString64(name, nameLength);
+		entry.NameOffset = static_cast<U32>(m_NamePool.GetCount());
+		entry.NameLength = static_cast<U32>(nameLength);
+		entry.SourceOffset = sourceOffset;
+		entry.DataOffset = dataOffset;
+		entry.DataSize = dataSize;
+		entry.AllowCompression = allowCompression;
+
+		m_NamePool.AddMultiple(name, nameLength + 1);
+		m_Entries.Add(entry);
+	}
+
+	bool PackWriter::Write(const fs::path& path)
+	{
+		m_CompressedCount = 0;
+
+		const U32 entryCount = static_cast<U32>(m_Entries.GetCount());
+		const char* names = m_NamePool.GetData();
+
+		auto getHash = [this](U32 index) { return m_Entries[index].NameHash; };
+		auto getName = [this, names](U32 index) { return names + m_Entries[index].NameOffset; };
+		Array<U32> sorted;
+		MappedTable::SortEntries(entryCount, sorted, getHash, getName);
+
+		// Keep the last entry of each name, and lay out the name block in table order
+		Array<U32> tableOrder;
+		Array<U8> replaced;
+		Array<PackEntry> entries;
+		Array<char> nameBlock;
+		if (entryCount > 0)
+		{
+			tableOrder.Resize(entryCount);
+			replaced.Resize(entryCount);
+			entries.Resize(entryCount);
+		}
+		for (U32 i = 0; i < entryCount; ++i)
+		{
+			replaced.Add(0);
+			entries.Add(PackEntry());
+		}
+		for (U32 i = 0; i < entryCount; ++i)
+		{
+			const PendingEntry& entry = m_Entries[sorted[i]];
+			if (MappedTable::IsReplaced(sorted, i, getHash, getName))
+			{
+				NE_LOG_WARNING("%s was added to the pack more than once, keeping the last", names + entry.NameOffset);
+				replaced[sorted[i]] = 1;
+				continue;
+			}
+
+			tableOrder.Add(sorted[i]);
+			entries[sorted[i]].NameOffset = static_cast<U32>(nameBlock.GetCount());
+			nameBlock.AddMultiple(names + entry.NameOffset, Size(entry.NameLength) + 1);
+		}
+
+		fs::path tempPath = path;
+		tempPath += ".tmp";
+
+		File file(tempPath, FileMode::FILE_WRITE_REPLACE, true);
+		if (!file.IsValid())
+		{
+			NE_LOG_ERROR("Failed to create pack %s", tempPath.string().c_str());
+			return false;
+		}
+
+		bool succeeded = true;
+		Size position = 0;
+		U64 tocOffset = 0;
+		U64 namesOffset = 0;
+		U32 tocChecksum = 0;
+		{
+			BufferedFileWriter writer(file);
+
+			// The header is written last, once the offsets are known
+			WritePadding(writer, PackFile::HeaderSize);
+			position = PackFile::HeaderSize;
+
+			MappedFile source;
+			BitStream compressed;
+			for (U32 i = 0; i < entryCount && succeeded; ++i)
+			{
+				if (replaced[i])
+				{
+					continue;
+				}
+
+				const PendingEntry& pending = m_Entries[i];
+				const Byte* data = nullptr;
+				Size size = 0;
+				if (pending.SourceOffset != PACK_NO_SOURCE)
+				{
+					const char* sourcePath = m_SourcePool.GetData() + pending.SourceOffset;
+					if (source.IsValid())
+					{
+						source.Close();
+					}
+
+					if (source.Open(sourcePath, 0, MappedFile::SequentialScan))
+					{
+						data = reinterpret_cast<const Byte*>(source.GetData());
+						size = source.GetMappedSize();
+					}
+					else
+					{
+						// Empty files can't be mapped, but they're still packed
+						std::error_code error;
+						if (!fs::is_regular_file(sourcePath, error) || fs::file_size(sourcePath, error) != 0)
+						{
+							NE_LOG_ERROR("Failed to read %s into the pack", sourcePath);
+							succeeded = false;
+							break;
+						}
+					}
+				}
+				else
+				{
+					data = m_Data.GetData() + pending.DataOffset;
+					size = pending.DataSize;
+				}
+
+				PackEntry& entry = entries[i];
+				entry.NameHash = pending.NameHash;
+				entry.RawSize = size;
+				entry.StoredSize = size;
+
+				// Only worth decompressing on load if it saves a meaningful amount of I/O
+				if (m_CompressionEnabled && pending.AllowCompression && size >= MinCompressedSize)
+				{
+					compressed.Reset();
+					Compression::CompressFrame(data, size, compressed);
+					if (compressed.GetStoredBytes() <= size - size / 8)
+					{
+						data = compressed.GetData();
+						entry.StoredSize = compressed.GetStoredBytes();
+						entry.Flags |= PackEntryFlags::Compressed;
+						++m_CompressedCount;
+					}
+				}
+
+				const Size aligned = MappedTable::AlignUp(position, m_Alignment);
+				WritePadding(writer, aligned - position);
+				position = aligned;
+
+				entry.DataOffset = position;
+				entry.Checksum = Checksum::Crc32c(data, entry.StoredSize);
+				if (entry.StoredSize > 0)
+				{
+					writer.Write(data, entry.StoredSize);
+				}
+				position += entry.StoredSize;
+			}
+
+			if (succeeded)
+			{
+				const Size aligned = MappedTable::AlignUp(position, alignof(PackEntry));
+				WritePadding(writer, aligned - position);
+				position = aligned;
+
+				tocOffset = position;
+				for (const U32 index : tableOrder)
+				{
+					PackEntry entry = entries[index];
+					if constexpr (ByteOrder::Native == ByteOrder::Big)
+					{
+						SwapEntry(entry);
+					}
+					tocChecksum = Checksum::Crc32c(&entry, sizeof(entry), tocChecksum);
+					writer.Write(entry);
+				}
+				position += tableOrder.GetCount() * sizeof(PackEntry);
+
+				namesOffset = position;
+				if (nameBlock.GetCount() > 0)
+				{
+					tocChecksum = Checksum::Crc32c(nameBlock.GetData(), nameBlock.GetCount(), tocChecksum);
+					writer.Write(nameBlock.GetData(), nameBlock.GetCount());
+				}
+				position += nameBlock.GetCount();
+			}
+
+			succeeded = writer.Flush() && succeeded;
+		}
+
+		if (succeeded)
+		{
+			BitStream header(PackFile::HeaderSize);
+			header.SetByteOrder(ByteOrder::Little);
+			header.Write<U32>(PackFile::Magic);
+			header.Write<U32>(PackFile::Version);
+			header.Write<U32>(static_cast<U32>(tableOrder.GetCount()));
+			header.Write<U32>(m_Alignment);
+			header.Write<U64>(tocOffset);
+			header.Write<U64>(namesOffset);
+			header.Write<U64>(nameBlock.GetCount());
+			header.Write<U32>(tocChecksum);
+			header.Write<U32>(Checksum::Crc32c(header.GetData(), header.GetStoredBytes()));
+			while (header.GetStoredBytes() < PackFile::HeaderSize)
+			{
+				header.Write<U32>(0);
+			}
+
+			file.Seek(0);
+			succeeded = file.Write(header.GetData(), header.GetStoredBytes()) == header.GetStoredBytes();
+		}
+		file.Close();
+
+		std::error_code error;
+		if (succeeded)
+		{
+			fs::rename(tempPath, path, error);
+			if (error)
+			{
+				NE_LOG_ERROR("Failed to replace %s: %s", path.string().c_str(), error.message().c_str());
+				succeeded = false;
+			}
+		}
+		if (!succeeded)
+		{
+			fs::remove(tempPath, error);
+			NE_LOG_ERROR("Failed to write pack %s", path.string().c_str());
+		}
+
+		return succeeded;
+	}
+
+	void PackWriter::Clear()
+	{
+		m_Entries.Empty();
+		m_NamePool.Empty();
+		m_SourcePool.Empty();
+		m_Data.Reset();
+		m_CompressedCount = 0;
+	}
+
+	PackMount::PackMount(const fs::path& path)
+	{
+		m_Pack.Open(path);
+	}
+
+	void PackMount::ListFiles(Array<char>& paths) const
+	{
+		const PackEntry* entries = m_Pack.GetEntries();
+		for (U32 i = 0; i < m_Pack.GetEntryCount(); ++i)
+		{
+			const char* name = m_Pack.GetName(entries[i]);
+			paths.AddMultiple(name, std::strlen(name) + 1);
+		}
+	}
+
+	bool PackMount::Open(const char* path, VfsFile& file) const
+	{
+		const PackEntry* entry = m_Pack.Find(path);
+		if (!entry)
+		{
+			return false;
+		}
+
+		// The mapping lives as long as the mount, so stored files are handed out in place
+		if (!PackFile::IsCompressed(*entry))
+		{
+			BitStreamView view;
+			if (!m_Pack.GetView(*entry, view))
+			{
+				return false;
+			}
+			file.SetView(view.GetData(), view.GetSize());
+			return true;
+		}
+
+		// Opening blocks the caller, so large entries are decompressed on every core
+		BitStream data;
+		if (!m_Pack.Read(*entry, data, std::thread::hardware_concurrency()))
+		{
+			return false;
+		}
+		file.SetOwned(std::move(data));
+		return true;
+	}
+}
\ No newline at end of file
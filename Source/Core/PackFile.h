@@ -0,0 +1,331 @@
+#pragma once
+
+#include <atomic>
+
+#include "Array.h"
+#include "BitStream.h"
+#include "FileSystem.h"
+#include "MappedTable.h"
+#include "String.h"
+#include "Types.h"
+#include "VirtualFileSystem.h"
+
+namespace Noble
+{
+	/**
+	 * Per-entry flags of a pack
+	 */
+	namespace PackEntryFlags
+	{
+		// Stored as a compressed frame (see Compression::CompressFrame)
+		constexpr U32 Compressed = 1 << 0;
+	}
+
+	/**
+	 * Table of contents entry of a pack, read in place from the mapping
+	 * Stored little-endian
+	 */
+	struct PackEntry
+	{
+		// 64-bit hash of the name (HashString64), the key the table is sorted by
+		U64 NameHash;
+		// Offset of the stored bytes from the start of the pack
+		U64 DataOffset;
+		// Size of the stored bytes
+		U64 StoredSize;
+		// Size once decompressed, equal to StoredSize for uncompressed entries
+		U64 RawSize;
+		// Offset of the null-terminated name in the name block
+		U32 NameOffset;
+		// CRC32C of the stored bytes
+		U32 Checksum;
+		// PackEntryFlags
+		U32 Flags;
+		U32 Reserved;
+	};
+
+	static_assert(sizeof(PackEntry) == 48, "PackEntry is part of the pack format");
+
+	/**
+	 * Read-only archive of many files in one
+	 *
+	 * Layout: a 64-byte little-endian header, the entries' data (each aligned to the pack's
+	 * alignment), then the table of contents sorted by name hash and the block of names.
+	 * The whole pack is opened as a single MappedFile, the table is used in place, and
+	 * uncompressed entries are returned as views into the mapping, so opening a pack costs
+	 * one mapping plus a validation pass over the table, and reading an entry copies nothing.
+	 * Compressed entries are decompressed on read. Each entry's checksum is verified the first
+	 * time it's viewed or read, so a corrupt entry fails to load rather than being parsed.
+	 *
+	 * Lookups hash the name with HashString64, the same hash NIdentifiers compare by under
+	 * NOBLE_WIDE_IDENTIFIERS, binary search the table and compare the name on a hash match.
+	 */
+	class PackFile
+	{
+	public:
+
+		// Identifies a pack ("NPAK")
+		static constexpr U32 Magic = 0x4B41504E;
+		// Current format version
+		static constexpr U32 Version = 1;
+		// Size of the header at the start of the pack
+		static constexpr Size HeaderSize = MappedTable::HeaderSize;
+		// File extension of packs, without the leading '.'
+		static constexpr const char* Extension = "npak";
+
+		PackFile();
+
+		~PackFile();
+
+		NO_COPY(PackFile)
+
+		/**
+		 * Maps the pack and validates its header and table of contents
+		 * Returns false if the file is missing, not a pack, or corrupt
+		 */
+		bool Open(const fs::path& path);
+
+		/**
+		 * Unmaps the pack; views returned from it become invalid
+		 */
+		void Close();
+
+		/**
+		 * Returns true if a pack is open
+		 */
+		bool IsOpen() const { return m_Entries != nullptr; }
+
+		/**
+		 * Returns the entry with the name, or nullptr
+		 */
+		const PackEntry* Find(const char* name) const;
+
+		/**
+		 * Returns the entry with the name of @length characters, or nullptr
+		 */
+		const PackEntry* Find(const char* name, Size length) const;
+
+		/**
+		 * Returns the entry named by the identifier, or nullptr
+		 */
+		const PackEntry* Find(const NIdentifier& id) const;
+
+		/**
+		 * Returns the null-terminated name of the entry
+		 */
+		const char* GetName(const PackEntry& entry) const { return m_Names + entry.NameOffset; }
+
+		/**
+		 * Returns true if the entry has to be decompressed to be read
+		 */
+		static bool IsCompressed(const PackEntry& entry) { return (entry.Flags & PackEntryFlags::Compressed) != 0; }
+
+		/**
+		 * Points @view at the entry's stored bytes inside the mapping, without copying
+		 * For uncompressed entries these are the file's contents. Returns false if they don't match their checksum
+		 */
+		bool GetView(const PackEntry& entry, BitStreamView& view) const;
+
+		/**
+		 * Appends the entry's contents to @output, decompressing them if needed, on up to
+		 * @workerCount threads for large entries. Returns false if the entry is corrupt
+		 */
+		bool Read(const PackEntry& entry, BitStream& output, U32 workerCount = 1) const;
+
+		/**
+		 * Returns true if the entry's stored bytes match their checksum
+		 * Always checks the bytes, even if the entry was verified before
+		 */
+		bool VerifyEntry(const PackEntry& entry) const;
+
+		/**
+		 * Returns the entries, sorted by name hash
+		 */
+		const PackEntry* GetEntries() const { return m_Entries; }
+
+		/**
+		 * Returns the number of entries
+		 */
+		U32 GetEntryCount() const { return m_EntryCount; }
+
+		/**
+		 * Returns the alignment the entries' data was written with
+		 */
+		U32 GetAlignment() const { return m_Alignment; }
+
+	private:
+
+		/**
+		 * Returns the entry with the hash and name, or nullptr
+		 */
+		const PackEntry* FindHashed(U64 hash, const char* name, Size length) const;
+
+		/**
+		 * Returns the entry's stored bytes, unverified
+		 */
+		BitStreamView GetStoredBytes(const PackEntry& entry) const;
+
+		/**
+		 * Verifies the entry unless that was done before, logging if it's corrupt
+		 */
+		bool CheckEntry(const PackEntry& entry) const;
+
+	private:
+
+		// Mapping of the whole pack
+		MappedFile m_Mapping;
+		// Table of contents, in the mapping or in m_SwappedEntries
+		const PackEntry* m_Entries;
+		U32 m_EntryCount;
+		// Start of the name block in the mapping
+		const char* m_Names;
+		// Alignment of the entries' data
+		U32 m_Alignment;
+		// Byte-swapped copy of the table, only used on big-endian hosts
+		Array<PackEntry> m_SwappedEntries;
+		// One bit per entry, set once its checksum was verified; entries may be read from any thread
+		std::atomic<U32>* m_VerifiedEntries;
+	};
+
+	/**
+	 * Builds packs from loose files or memory
+	 *
+	 * Entries are gathered first and written in one pass through a BufferedFileWriter, in the
+	 * order they were added, so packing a DirectoryIndex keeps a directory's files together.
+	 * The pack is written next to the output under a temporary name and renamed over it once
+	 * complete, so a failed write never leaves a truncated pack behind.
+	 */
+	class PackWriter
+	{
+	public:
+
+		// Default alignment of each entry's data
+		static constexpr U32 DefaultAlignment = 16;
+		// Entries smaller than this are never compressed
+		static constexpr Size MinCompressedSize = 64;
+
+		PackWriter();
+
+		NO_COPY_NO_MOVE(PackWriter)
+
+		/**
+		 * Sets the alignment of each entry's data, a power of two
+		 * Use the page size for entries that are mapped or handed to the GPU directly
+		 */
+		void SetAlignment(U32 alignment);
+
+		/**
+		 * Enables compression of entries that shrink by at least an eighth (on by default)
+		 */
+		void SetCompressionEnabled(bool enabled) { m_CompressionEnabled = enabled; }
+
+		/**
+		 * Adds the file at @source as @name
+		 * The file is only read during Write. Adding a name twice keeps the last one.
+		 */
+		void AddFile(const char* name, const fs::path& source, bool allowCompression = true);
+
+		/**
+		 * Adds a copy of the data as @name
+		 */
+		void AddData(const char* name, const void* data, Size size, bool allowCompression = true);
+
+		/**
+		 * Adds every file of the index, named @namePrefix followed by its relative path
+		 * Other packs in the directory are skipped
+		 */
+		void AddDirectory(const DirectoryIndex& index, const char* namePrefix = "");
+
+		/**
+		 * Writes the pack to @path, replacing any existing file
+		 * Returns false if a source can't be read or the pack can't be written
+		 */
+		bool Write(const fs::path& path);
+
+		/**
+		 * Removes every entry
+		 */
+		void Clear();
+
+		/**
+		 * Returns the number of entries added
+		 */
+		Size GetEntryCount() const { return m_Entries.GetCount(); }
+
+		/**
+		 * Returns the number of entries the last Write compressed
+		 */
+		Size GetCompressedCount() const { return m_CompressedCount; }
+
+	private:
+
+		/**
+		 * An entry waiting to be written
+		 */
+		struct PendingEntry
+		{
+			U64 NameHash;
+			// Offset of the name in m_NamePool
+			U32 NameOffset;
+			// Length of the name, excluding the null terminator
+			U32 NameLength;
+			// Offset of the source path in m_SourcePool, or U32 max for data in m_Data
+			U32 SourceOffset;
+			// Offset and size of the data in m_Data
+			Size DataOffset;
+			Size DataSize;
+			bool AllowCompression;
+		};
+
+		/**
+		 * Records an entry named @name
+		 */
+		void AddEntry(const char* name, U32 sourceOffset, Size dataOffset, Size dataSize, bool allowCompression);
+
+	private:
+
+		Array<PendingEntry> m_Entries;
+		Array<char> m_NamePool;
+		Array<char> m_SourcePool;
+		// Copies of data added with AddData
+		BitStream m_Data;
+		U32 m_Alignment;
+		bool m_CompressionEnabled;
+		Size m_CompressedCount;
+	};
+
+	/**
+	 * Serves the entries of a pack through a VirtualFileSystem
+	 * Uncompressed entries are opened as views into the pack's mapping, which stays valid as
+	 * long as the mount is mounted.
+	 */
+	class PackMount : public VfsMount
+	{
+	public:
+
+		/**
+		 * Opens the pack at @path; check IsOpen before mounting
+		 */
+		explicit PackMount(const fs::path& path);
+
+		/**
+		 * Returns true if the pack opened
+		 */
+		bool IsOpen() const { return m_Pack.IsOpen(); }
+
+		/**
+		 * Returns the pack
+		 */
+		const PackFile& GetPack() const { return m_Pack; }
+
+		virtual void ListFiles(Array<char>& paths) const override;
+
+		virtual bool Open(const char* path, VfsFile& file) const override;
+
+		virtual bool Exists(const char* path) const override { return m_Pack.Find(path) != nullptr; }
+
+	private:
+
+		PackFile m_Pack;
+	};
+}
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "GameObject.h"
 #include "Globals.h"
 #include "Engine.h"
+#include "World.h"
 
 namespace Noble
 {
@@ -27,23 +28,24 @@ namespace Noble
 	{
 		if (m_Object)
 		{
-			// Forward action inputs to possessed object
+			// Queue input for the possessed object; the World delivers it in one batch
+			EventBus& events = GetWorld()->GetEventBus();
+
 			for (auto binding : Input::GetActionBindings())
 			{
 				if (binding.IsJustPressed())
 				{
-					m_Object->OnActionInput(binding.GetIdentifierHash(), true);
+					events.Send(ActionInputEvent{ m_Object, binding.GetIdentifierHash(), true });
 				}
 				else if (binding.IsJustReleased())
 				{
-					m_Object->OnActionInput(binding.GetIdentifierHash(), false);
+					events.Send(ActionInputEvent{ m_Object, binding.GetIdentifierHash(), false });
 				}
 			}
 
-			// Forward axis inputs to possessed object
 			for (auto binding : Input::GetAxisBindings())
 			{
-				m_Object->OnAnalogInput(binding.GetIdentifierHash(), binding.GetState());
+				events.Send(AnalogInputEvent{ m_Object, binding.GetIdentifierHash(), binding.GetState() });
 			}
 		}
 	}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <algorithm>
+
+#include "Array.h"
+#include "Types.h"
+
+namespace Noble
+{
+	/**
+	 * A binary heap over an Array, popping the element that orders last under Less first
+	 * Used by the work queues of AsyncFileIO and AssetLoader, which order requests by priority
+	 * and then by submission; neither is thread-safe on its own.
+	 */
+	template <typename ElementType, typename Less>
+	class PriorityQueue
+	{
+	public:
+
+		/**
+		 * Adds an element
+		 */
+		void Push(const ElementType& elem)
+		{
+			m_Heap.Add(elem);
+			std::push_heap(m_Heap.GetData(), m_Heap.GetData() + m_Heap.GetCount(), Less());
+		}
+
+		/**
+		 * Removes and returns the first element; the queue must not be empty
+		 */
+		ElementType Pop()
+		{
+			CHECK(m_Heap.GetCount() > 0);
+
+			std::pop_heap(m_Heap.GetData(), m_Heap.GetData() + m_Heap.GetCount(), Less());
+			ElementType elem = m_Heap[m_Heap.GetCount() - 1];
+			m_Heap.RemoveAt(m_Heap.GetCount() - 1);
+			return elem;
+		}
+
+		/**
+		 * Removes the element if it's queued; returns false if it isn't
+		 */
+		bool Remove(const ElementType& elem)
+		{
+			for (Size i = 0; i < m_Heap.GetCount(); ++i)
+			{
+				if (m_Heap[i] == elem)
+				{
+					m_Heap.RemoveAt(i);
+					Reorder();
+					return true;
+				}
+			}
+			return false;
+		}
+
+		/**
+		 * Restores the order after queued elements changed how they compare
+		 */
+		void Reorder()
+		{
+			std::make_heap(m_Heap.GetData(), m_Heap.GetData() + m_Heap.GetCount(), Less());
+		}
+
+		/**
+		 * Removes every element
+		 */
+		void Empty()
+		{
+			m_Heap.Empty();
+		}
+
+		/**
+		 * Returns the number of queued elements
+		 */
+		Size GetCount() const
+		{
+			return m_Heap.GetCount();
+		}
+
+		// Iteration over the queued elements, in heap order
+		ElementType* begin() { return m_Heap.GetData(); }
+		ElementType* end() { return m_Heap.GetData() + m_Heap.GetCount(); }
+
+	private:
+
+		Array<ElementType> m_Heap;
+	};
+}
\ No newline at end of file
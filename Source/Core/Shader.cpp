@@ -1,5 +1,7 @@
 #include "Shader.h"
 
+#include <utility>
+
 namespace Noble
 {
 	typedef bgfx::UniformType::Enum UniformEnum;
@@ -42,13 +44,21 @@ namespace Noble
 	}
 
 	Shader::Shader()
-		: m_Program()
+		: m_Program(BGFX_INVALID_HANDLE), m_PendingVS(nullptr), m_PendingVSSize(0), m_PendingFS(nullptr), m_PendingFSSize(0),
+		m_ProgramSize(0)
 	{}
 
-	void Shader::CreateFromBuffer(BitStream& data)
+	bool Shader::ParseBuffer(BitStreamView& data)
 	{
 		I32 attrCount = data.Read<I32>();
-		m_Uniforms.Resize(attrCount);
+		if (attrCount < 0 || Size(attrCount) > data.GetRemainingBytes())
+		{
+			return false;
+		}
+		if (attrCount > I32(m_Uniforms.GetMax()))
+		{
+			m_Uniforms.Resize(attrCount);
+		}
 		for (I32 i = 0; i < attrCount; ++i)
 		{
 			// Read name
@@ -64,28 +74,46 @@ namespace Noble
 			U32 count = data.Read<U32>();
 
 			ShaderUniform su;
-			su.UniformName = NIdentifier(str, strlen, HASH(str));
+			su.UniformName = NIdentifier(str, strlen);
 			su.UniformType = GetBGFXType(type);
 			su.UniformCount = count;
-			su.UniformHandle = bgfx::createUniform(su.UniformName.GetString(), su.UniformType, su.UniformCount);
-
-			CHECK(bgfx::isValid(su.UniformHandle));
+			su.UniformHandle = BGFX_INVALID_HANDLE;
 
 			m_Uniforms.Add(su);
 		}
 
+		// The binaries stay in the buffer until CreateResources copies them out
+		m_PendingVSSize = data.Read<U32>();
+		m_PendingVS = data.ReadSpan(m_PendingVSSize);
+
+		m_PendingFSSize = data.Read<U32>();
+		m_PendingFS = data.ReadSpan(m_PendingFSSize);
+
+		return m_PendingVS && m_PendingFS;
+	}
+
+	void Shader::CreateResources()
+	{
+		for (ShaderUniform& uniform : m_Uniforms)
+		{
+			uniform.UniformHandle = bgfx::createUniform(uniform.UniformName.GetString(), uniform.UniformType, uniform.UniformCount);
+			CHECK(bgfx::isValid(uniform.UniformHandle));
+		}
+
 		// Load VS
-		U32 vsShaderSize = data.Read<U32>();
-		const bgfx::Memory* vsMem = bgfx::alloc(U32(vsShaderSize + 1));
-		data.ReadBytes(vsMem->data, vsShaderSize);
+		const bgfx::Memory* vsMem = bgfx::alloc(m_PendingVSSize + 1);
+		Memory::Memcpy(vsMem->data, m_PendingVS, m_PendingVSSize);
 		vsMem->data[vsMem->size - 1] = '\0';
 
 		// Load FS
-		U32 fsShaderSize = data.Read<U32>();
-		const bgfx::Memory* fsMem = bgfx::alloc(U32(fsShaderSize + 1));
-		data.ReadBytes(fsMem->data, fsShaderSize);
+		const bgfx::Memory* fsMem = bgfx::alloc(m_PendingFSSize + 1);
+		Memory::Memcpy(fsMem->data, m_PendingFS, m_PendingFSSize);
 		fsMem->data[fsMem->size - 1] = '\0';
 
+		m_ProgramSize = vsMem->size + fsMem->size;
+		m_PendingVS = nullptr;
+		m_PendingFS = nullptr;
+
 		// Build shaders and create shader program
 		bgfx::ShaderHandle vs = bgfx::createShader(vsMem);
 		bgfx::ShaderHandle fs = bgfx::createShader(fsMem);
@@ -96,11 +124,67 @@ namespace Noble
 	{
 		for (auto uniform : m_Uniforms)
 		{
-			bgfx::destroy(uniform.UniformHandle);
+			if (bgfx::isValid(uniform.UniformHandle))
+			{
+				bgfx::destroy(uniform.UniformHandle);
+			}
 			// Free memory from the string alloc'd above
 			Memory::Free(const_cast<char*>(uniform.UniformName.GetString()));
 		}
-		bgfx::destroy(m_Program);
+		if (bgfx::isValid(m_Program))
+		{
+			bgfx::destroy(m_Program);
+		}
+
+		// Leave the shader ready to be created again, for reloads
+		m_Uniforms.Empty();
+		m_Program = BGFX_INVALID_HANDLE;
+		m_ProgramSize = 0;
+		m_PendingVS = nullptr;
+		m_PendingFS = nullptr;
+	}
+
+	bool Shader::CanReplaceWith(const Asset& reloaded) const
+	{
+		const Shader& shader = static_cast<const Shader&>(reloaded);
+		if (shader.m_Uniforms.GetCount() != m_Uniforms.GetCount())
+		{
+			return false;
+		}
+
+		for (Size i = 0; i < m_Uniforms.GetCount(); ++i)
+		{
+			const ShaderUniform& current = m_Uniforms[i];
+			const ShaderUniform& next = shader.m_Uniforms[i];
+			if (!(current.UniformName == next.UniformName) || current.UniformType != next.UniformType || current.UniformCount != next.UniformCount)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void Shader::SwapContents(Asset& other)
+	{
+		Shader& shader = static_cast<Shader&>(other);
+		std::swap(m_Uniforms, shader.m_Uniforms);
+		std::swap(m_Program, shader.m_Program);
+		std::swap(m_PendingVS, shader.m_PendingVS);
+		std::swap(m_PendingVSSize, shader.m_PendingVSSize);
+		std::swap(m_PendingFS, shader.m_PendingFS);
+		std::swap(m_PendingFSSize, shader.m_PendingFSSize);
+		std::swap(m_ProgramSize, shader.m_ProgramSize);
+	}
+
+	AssetMemoryUsage Shader::GetMemoryUsage() const
+	{
+		Size cpuBytes = sizeof(Shader) + m_Uniforms.GetMax() * sizeof(ShaderUniform);
+		for (const ShaderUniform& uniform : m_Uniforms)
+		{
+			cpuBytes += uniform.UniformName.GetSize() + 1;
+		}
+
+		return AssetMemoryUsage(cpuBytes, m_ProgramSize);
 	}
 
 	const U32 Shader::GetUniformBufferSize() const
@@ -32,6 +32,8 @@ namespace Noble
 		friend class Material;
 	public:
 
+		static constexpr AssetType StaticType = AssetType::AT_SHADER;
+
 		/**
 		 * Default constructor
 		 */
@@ -45,7 +47,12 @@ namespace Noble
 		/**
 		 * Returns the proper type for Shader assets
 		 */
-		virtual const AssetType GetType() const override { return AssetType::AT_SHADER; }
+		virtual const AssetType GetType() const override { return StaticType; }
+
+		/**
+		 * Counts the uniform table and the shader binaries
+		 */
+		virtual AssetMemoryUsage GetMemoryUsage() const override;
 
 		/**
 		 * Returns the required size of buffers for the given uniforms
@@ -80,15 +87,28 @@ namespace Noble
 	protected:
 
 		/**
-		 * Creates the shader instance from the stream data
+		 * Reads the uniform descriptions and locates the shader binaries in the stream data
 		 */
-		virtual void CreateFromBuffer(BitStream& data) override;
+		virtual bool ParseBuffer(BitStreamView& data) override;
+
+		/**
+		 * Creates the uniforms, shaders and program
+		 */
+		virtual void CreateResources() override;
 
 		/**
 		 * Releases shaders and uniforms
 		 */
 		virtual void Destroy() override;
 
+		/**
+		 * Materials keep uniform values at offsets into the old uniform table, so the names,
+		 * types and counts of the uniforms must not change
+		 */
+		virtual bool CanReplaceWith(const Asset& reloaded) const override;
+
+		virtual void SwapContents(Asset& other) override;
+
 		Array<ShaderUniform>& GetUniforms() { return m_Uniforms; }
 
 	private:
@@ -97,5 +117,12 @@ namespace Noble
 		Array<ShaderUniform> m_Uniforms;
 		// Program handle
 		bgfx::ProgramHandle m_Program;
+		// Shader binaries found by ParseBuffer, in the buffer being loaded, until CreateResources
+		const Byte* m_PendingVS;
+		U32 m_PendingVSSize;
+		const Byte* m_PendingFS;
+		U32 m_PendingFSSize;
+		// Size of the binaries handed to bgfx
+		Size m_ProgramSize;
 	};
 }
\ No newline at end of file
@@ -1,18 +1,62 @@
 #include "StaticMesh.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <utility>
+
 #include <bgfx/bgfx.h>
 
+#include "StaticMeshFile.h"
+#include "VirtualFileSystem.h"
+
 namespace Noble
 {
+	struct StaticMeshSource
+	{
+		StaticMeshSource(VfsFile&& file)
+			: File(std::move(file)), References(0)
+		{}
+
+		// Mapping, pack view or decoded copy the arrays point into
+		VfsFile File;
+		// Buffers that haven't released the data yet
+		std::atomic<U32> References;
+	};
+
+	namespace
+	{
+		/**
+		 * bgfx release callback for in-place arrays; frees the source once both buffers are done with it
+		 * Called from the render thread
+		 */
+		void ReleaseSource(void*, void* userData)
+		{
+			StaticMeshSource* source = static_cast<StaticMeshSource*>(userData);
+			if (source->References.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				delete source;
+			}
+		}
+	}
+
 	bgfx::VertexLayout StaticVertex::Layout;
+	bgfx::VertexLayout CompactStaticVertex::Layout;
 
 	StaticMesh::StaticMesh()
-		: m_VertexBuffer(), m_IndexBuffer()
+		: m_VertexBuffer(BGFX_INVALID_HANDLE), m_IndexBuffer(BGFX_INVALID_HANDLE), m_InPlace(false), m_Source(nullptr)
 	{
 		m_VertexCount = 0;
 		m_Vertices = nullptr;
+		m_VertexFormat = StaticVertexFormat::Full;
+		m_PositionOffset = Vector3f(0.0F);
+		m_PositionScale = 1.0F;
 		m_IndexCount = 0;
+		m_IndexSize = sizeof(Index);
 		m_Indices = nullptr;
+		m_LodCount = 0;
+		m_Clusters = nullptr;
+		m_ClusterCount = 0;
 	}
 
 	void StaticVertex::Init()
@@ -23,53 +67,317 @@ namespace Noble
 			.add(bgfx::Attrib::Normal, 3, bgfx::AttribType::Float)
 			.add(bgfx::Attrib::Tangent, 3, bgfx::AttribType::Float)
 			.end();
+
+		CompactStaticVertex::Init();
 	}
 
-	void StaticMesh::CreateFromBuffer(BitStream& data)
+	void CompactStaticVertex::Init()
 	{
+		Layout.begin()
+			.add(bgfx::Attrib::Position, 4, bgfx::AttribType::Int16, true)
+			.add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Half)
+			.add(bgfx::Attrib::Normal, 2, bgfx::AttribType::Int16, true)
+			.add(bgfx::Attrib::Tangent, 2, bgfx::AttribType::Int16, true)
+			.end();
+	}
+
+	const bgfx::VertexLayout& StaticMesh::GetVertexLayout(StaticVertexFormat format)
+	{
+		return format == StaticVertexFormat::Compact ? CompactStaticVertex::Layout : StaticVertex::Layout;
+	}
+
+	Matrix4x4f StaticMesh::GetPositionTransform() const
+	{
+		return glm::translate(m_PositionOffset) * glm::scale(Vector3f(m_PositionScale));
+	}
+
+	U32 StaticMesh::SelectLod(F32 pixelsPerUnit, F32 maxPixelError) const
+	{
+		// Errors only grow along the chain
+		U32 lod = 0;
+		while (lod + 1 < m_LodCount && m_Lods[lod + 1].Error * pixelsPerUnit <= maxPixelError)
+		{
+			++lod;
+		}
+		return lod;
+	}
+
+	U32 StaticMesh::CullClusters(U32 lod, const Matrix4x4f& meshToClip, const Vector3f& cameraPosition, bool cullBackfaces, Array<U32>& visible) const
+	{
+		// Frustum planes in mesh space, from the rows of the clip transform (Gribb and Hartmann)
+		// The near plane is the -w <= z one, which also holds everything a 0..1 depth range keeps
+		const Vector4f rowX(meshToClip[0][0], meshToClip[1][0], meshToClip[2][0], meshToClip[3][0]);
+		const Vector4f rowY(meshToClip[0][1], meshToClip[1][1], meshToClip[2][1], meshToClip[3][1]);
+		const Vector4f rowZ(meshToClip[0][2], meshToClip[1][2], meshToClip[2][2], meshToClip[3][2]);
+		const Vector4f rowW(meshToClip[0][3], meshToClip[1][3], meshToClip[2][3], meshToClip[3][3]);
+		Vector4f planes[6] = { rowW + rowX, rowW - rowX, rowW + rowY, rowW - rowY, rowW + rowZ, rowW - rowZ };
+		for (Vector4f& plane : planes)
+		{
+			// Normalized, so a sphere is tested with its radius as is
+			const F32 length = glm::length(Vector3f(plane));
+			if (length > 0.0F)
+			{
+				plane /= length;
+			}
+		}
+
+		const StaticMeshLod& range = GetLod(lod);
+		U32 indexCount = 0;
+		for (U32 c = range.FirstCluster; c < range.FirstCluster + range.ClusterCount; ++c)
+		{
+			const StaticMeshCluster& cluster = m_Clusters[c];
+
+			bool inside = true;
+			for (const Vector4f& plane : planes)
+			{
+				if (glm::dot(Vector3f(plane), cluster.Center) + plane.w < -cluster.Radius)
+				{
+					inside = false;
+					break;
+				}
+			}
+			if (!inside)
+			{
+				continue;
+			}
+
+			// A camera at distance d from the center, at angle A from the axis, sees the nearest normal of a
+			// cone of half angle B at A + B; every face in the sphere points away once d * cos(A + B) > radius
+			if (cullBackfaces && cluster.ConeCosine > 0.0F)
+			{
+				const Vector3f offset = cluster.Center - cameraPosition;
+				const F32 distance = glm::length(offset);
+				if (distance > cluster.Radius)
+				{
+					const F32 cosA = glm::dot(offset, cluster.ConeAxis) / distance;
+					const F32 sinA = std::sqrt(std::max(1.0F - cosA * cosA, 0.0F));
+					const F32 sinB = std::sqrt(std::max(1.0F - cluster.ConeCosine * cluster.ConeCosine, 0.0F));
+					if (distance * (cosA * cluster.ConeCosine - sinA * sinB) > cluster.Radius)
+					{
+						continue;
+					}
+				}
+			}
+
+			visible.Add(c);
+			indexCount += cluster.IndexCount;
+		}
+		return indexCount;
+	}
+
+	U32 StaticMesh::MergeClusterRanges(const U32* clusters, Size clusterCount, U32 maxGap, Array<StaticMeshDrawRange>& ranges) const
+	{
+		U32 indexCount = 0;
+		for (Size i = 0; i < clusterCount; ++i)
+		{
+			const StaticMeshCluster& cluster = GetCluster(clusters[i]);
+			if (i > 0)
+			{
+				StaticMeshDrawRange& last = ranges[ranges.GetCount() - 1];
+				const U32 end = last.FirstIndex + last.IndexCount;
+				CHECK(cluster.FirstIndex >= end);
+				if (cluster.FirstIndex - end <= maxGap)
+				{
+					const U32 added = cluster.FirstIndex + cluster.IndexCount - end;
+					last.IndexCount += added;
+					indexCount += added;
+					continue;
+				}
+			}
+
+			ranges.Add(StaticMeshDrawRange(cluster.FirstIndex, cluster.IndexCount));
+			indexCount += cluster.IndexCount;
+		}
+		return indexCount;
+	}
+
+	bool StaticMesh::ParseBuffer(BitStreamView& data)
+	{
+		if (StaticMeshFile::IsMeshFile(data))
+		{
+			StaticMeshFile file;
+			if (!file.Open(data))
+			{
+				return false;
+			}
+
+			m_VertexCount = file.GetVertexCount();
+			m_VertexFormat = file.GetVertexFormat();
+			m_PositionOffset = file.GetPositionOffset();
+			m_PositionScale = file.GetPositionScale();
+			m_IndexCount = file.GetIndexCount();
+			m_IndexSize = file.GetIndexSize();
+			m_LodCount = file.GetLodCount();
+			for (U32 i = 0; i < m_LodCount; ++i)
+			{
+				m_Lods[i] = file.GetLod(i);
+			}
+			m_Bounds = file.GetBounds();
+
+			m_ClusterCount = file.GetClusterCount();
+			if (m_ClusterCount > 0)
+			{
+				m_Clusters = new StaticMeshCluster[m_ClusterCount];
+				file.ReadClusters(m_Clusters);
+			}
+
+			// Point straight into the data; bgfx reads it from there, so nothing is copied or parsed
+			if (file.CanUseInPlace())
+			{
+				m_Vertices = const_cast<Byte*>(file.GetVertexData());
+				m_Indices = const_cast<Byte*>(file.GetIndexData());
+				m_InPlace = true;
+				return true;
+			}
+
+			m_Vertices = new Byte[Size(m_VertexCount) * GetVertexSize(m_VertexFormat)];
+			file.ReadVertices(m_Vertices);
+			m_Indices = new Byte[Size(m_IndexCount) * m_IndexSize];
+			file.ReadIndices(m_Indices);
+			return true;
+		}
+
+		// Older meshes: vertex count, vertices, index count, indices, all unaligned
 		// Read vertex count
 		m_VertexCount = data.Read<U32>();
-		CHECK(m_VertexCount > 0);
+		if (m_VertexCount == 0 || m_VertexCount > data.GetRemainingBytes() / sizeof(StaticVertex))
+		{
+			return false;
+		}
 
 		// Allocate vertex array
-		m_Vertices = new StaticVertex[m_VertexCount];
-		CHECK(m_Vertices);
+		m_Vertices = new Byte[Size(m_VertexCount) * sizeof(StaticVertex)];
 
-		// Read in vertices
-		for (U32 i = 0; i < m_VertexCount; ++i)
-		{
-			m_Vertices[i].Position =	data.Read<Vector3f>();
-			m_Vertices[i].TexCoord =	data.Read<Vector2f>();
-			m_Vertices[i].Normal =		data.Read<Vector3f>();
-			m_Vertices[i].Tangent =		data.Read<Vector3f>();
-		}
+		// Vertices are stored in the same layout as StaticVertex, so read them in one go
+		const Size verticesRead = data.ReadArray(reinterpret_cast<StaticVertex*>(m_Vertices), m_VertexCount);
+		CHECK(verticesRead == m_VertexCount);
 
 		// Read in number of indices
 		m_IndexCount = data.Read<U32>();
-		CHECK(m_IndexCount > 0);
+		if (m_IndexCount == 0 || m_IndexCount > data.GetRemainingBytes() / sizeof(Index))
+		{
+			Destroy();
+			return false;
+		}
 
 		// Allocate index array
-		m_Indices = new Index[m_IndexCount];
-		CHECK(m_Indices);
+		m_Indices = new Byte[Size(m_IndexCount) * sizeof(Index)];
 
 		// Read in indices
-		for (U32 i = 0; i < m_IndexCount; ++i)
+		const Size indicesRead = data.ReadArray(reinterpret_cast<Index*>(m_Indices), m_IndexCount);
+		CHECK(indicesRead == m_IndexCount);
+
+		// Older meshes have no LODs or stored bounds
+		m_LodCount = 1;
+		m_Lods[0] = StaticMeshLod(0, m_IndexCount, 0.0F);
+		m_Bounds = StaticMeshFile::ComputeBounds(reinterpret_cast<const StaticVertex*>(m_Vertices), m_VertexCount);
+
+		return true;
+	}
+
+	void StaticMesh::RetainSource(VfsFile& source)
+	{
+		if (m_InPlace)
 		{
-			m_Indices[i] = data.Read<Index>();
+			m_Source = new StaticMeshSource(std::move(source));
+		}
+	}
+
+	void StaticMesh::CreateResources()
+	{
+		if (m_InPlace)
+		{
+			CHECK(m_Source);
+
+			// One reference per buffer; the file is released once bgfx has uploaded both
+			m_Source->References = 2;
+			m_VertexBuffer = bgfx::createVertexBuffer(
+				bgfx::makeRef(m_Vertices, GetVertexSize(m_VertexFormat) * m_VertexCount, ReleaseSource, m_Source),
+				GetVertexLayout(m_VertexFormat));
+			m_IndexBuffer = bgfx::createIndexBuffer(
+				bgfx::makeRef(m_Indices, m_IndexSize * m_IndexCount, ReleaseSource, m_Source),
+				m_IndexSize == sizeof(U32) ? BGFX_BUFFER_INDEX32 : BGFX_BUFFER_NONE);
+			m_Source = nullptr;
+			return;
 		}
 
-		// Create buffers
+		// The buffers free the arrays once bgfx is done with them
 		m_VertexBuffer = bgfx::createVertexBuffer(
-			bgfx::makeRef(m_Vertices, sizeof(StaticVertex) * m_VertexCount, [] (void* data, void*) -> void { delete[] data; }),
-			StaticVertex::Layout);
+			bgfx::makeRef(m_Vertices, GetVertexSize(m_VertexFormat) * m_VertexCount, [] (void* data, void*) -> void { delete[] static_cast<Byte*>(data); }),
+			GetVertexLayout(m_VertexFormat));
 		m_IndexBuffer = bgfx::createIndexBuffer(
-			bgfx::makeRef(m_Indices, sizeof(Index) * m_IndexCount, [] (void* data, void*) -> void { delete[] data; }),
-			BGFX_BUFFER_INDEX32);
+			bgfx::makeRef(m_Indices, m_IndexSize * m_IndexCount, [] (void* data, void*) -> void { delete[] static_cast<Byte*>(data); }),
+			m_IndexSize == sizeof(U32) ? BGFX_BUFFER_INDEX32 : BGFX_BUFFER_NONE);
+	}
+
+	AssetMemoryUsage StaticMesh::GetMemoryUsage() const
+	{
+		return AssetMemoryUsage(sizeof(StaticMesh) + Size(m_ClusterCount) * sizeof(StaticMeshCluster), Size(m_VertexCount) * GetVertexSize(m_VertexFormat) + Size(m_IndexCount) * m_IndexSize);
 	}
 
 	void StaticMesh::Destroy()
 	{
-		bgfx::destroy(m_VertexBuffer);
-		bgfx::destroy(m_IndexBuffer);
+		// Arrays handed to bgfx are freed by it; only free ones that never made it into a buffer
+		if (bgfx::isValid(m_VertexBuffer))
+		{
+			bgfx::destroy(m_VertexBuffer);
+		}
+		else if (!m_InPlace)
+		{
+			delete[] m_Vertices;
+		}
+
+		if (bgfx::isValid(m_IndexBuffer))
+		{
+			bgfx::destroy(m_IndexBuffer);
+		}
+		else if (!m_InPlace)
+		{
+			delete[] m_Indices;
+		}
+
+		// Parsed in place but never uploaded
+		delete m_Source;
+
+		delete[] m_Clusters;
+
+		m_VertexBuffer = BGFX_INVALID_HANDLE;
+		m_IndexBuffer = BGFX_INVALID_HANDLE;
+		m_Vertices = nullptr;
+		m_VertexCount = 0;
+		m_VertexFormat = StaticVertexFormat::Full;
+		m_PositionOffset = Vector3f(0.0F);
+		m_PositionScale = 1.0F;
+		m_Indices = nullptr;
+		m_IndexCount = 0;
+		m_IndexSize = sizeof(Index);
+		m_LodCount = 0;
+		m_Bounds = StaticMeshBounds();
+		m_Clusters = nullptr;
+		m_ClusterCount = 0;
+		m_InPlace = false;
+		m_Source = nullptr;
+	}
+
+	void StaticMesh::SwapContents(Asset& other)
+	{
+		StaticMesh& mesh = static_cast<StaticMesh&>(other);
+		std::swap(m_Vertices, mesh.m_Vertices);
+		std::swap(m_VertexCount, mesh.m_VertexCount);
+		std::swap(m_VertexFormat, mesh.m_VertexFormat);
+		std::swap(m_PositionOffset, mesh.m_PositionOffset);
+		std::swap(m_PositionScale, mesh.m_PositionScale);
+		std::swap(m_VertexBuffer, mesh.m_VertexBuffer);
+		std::swap(m_Indices, mesh.m_Indices);
+		std::swap(m_IndexCount, mesh.m_IndexCount);
+		std::swap(m_IndexSize, mesh.m_IndexSize);
+		std::swap(m_IndexBuffer, mesh.m_IndexBuffer);
+		std::swap(m_Lods, mesh.m_Lods);
+		std::swap(m_LodCount, mesh.m_LodCount);
+		std::swap(m_Bounds, mesh.m_Bounds);
+		std::swap(m_Clusters, mesh.m_Clusters);
+		std::swap(m_ClusterCount, mesh.m_ClusterCount);
+		std::swap(m_InPlace, mesh.m_InPlace);
+		std::swap(m_Source, mesh.m_Source);
 	}
 }
\ No newline at end of file
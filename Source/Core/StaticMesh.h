@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Array.h"
 #include "Asset.h"
 
 #include <bgfx\bgfx.h>
@@ -30,19 +31,167 @@ namespace Noble
 		static void Init();
 	};
 
+	static_assert(sizeof(StaticVertex) == 44, "StaticVertex is read from mesh files as a packed array");
+
+	/**
+	 * StaticVertex is made entirely of floats, so it can be byte-swapped as an F32 array
+	 */
+	template <>
+	struct ByteSwapUnit<StaticVertex>
+	{
+		typedef F32 Type;
+	};
+
+	/**
+	 * Quantized StaticMesh vertex format, chosen per mesh at cook time when its error is small enough
+	 * Total size is 20 bytes per vertex
+	 *
+	 * Positions are normalized 16-bit values within the mesh's bounding cube and are restored by the
+	 * mesh's position transform, which the renderer folds into the model matrix. Normals and tangents
+	 * are octahedral-encoded; a position W of 0 tells the vertex shader to decode them, since full
+	 * vertices have no W and read it as 1.
+	 */
+	struct CompactStaticVertex
+	{
+		CompactStaticVertex()
+			: Position(), TexCoord(), Normal(), Tangent()
+		{}
+
+		// Position in the bounding cube as -32767..32767, then 0
+		I16 Position[4]; // (8 bytes)
+		// Half-precision texture coordinates
+		F16 TexCoord[2]; // (4 bytes)
+		// Octahedral normal
+		I16 Normal[2]; // (4 bytes)
+		// Octahedral tangent
+		I16 Tangent[2]; // (4 bytes)
+
+		// BGFX
+		static bgfx::VertexLayout Layout;
+		static void Init();
+	};
+
+	static_assert(sizeof(CompactStaticVertex) == 20, "CompactStaticVertex is read from mesh files as a packed array");
+
+	/**
+	 * CompactStaticVertex is made entirely of 16-bit values
+	 */
+	template <>
+	struct ByteSwapUnit<CompactStaticVertex>
+	{
+		typedef U16 Type;
+	};
+
+	/**
+	 * Vertex formats a StaticMesh can be stored in
+	 */
+	enum class StaticVertexFormat : U32
+	{
+		// StaticVertex
+		Full = 0,
+		// CompactStaticVertex
+		Compact = 1
+	};
+
+	/**
+	 * A level of detail of a StaticMesh: a range of its index buffer drawing the same vertices
+	 */
+	struct StaticMeshLod
+	{
+		StaticMeshLod()
+			: FirstIndex(0), IndexCount(0), Error(0), FirstCluster(0), ClusterCount(0)
+		{}
+
+		StaticMeshLod(U32 firstIndex, U32 indexCount, F32 error)
+			: FirstIndex(firstIndex), IndexCount(indexCount), Error(error), FirstCluster(0), ClusterCount(0)
+		{}
+
+		// Range of the index buffer
+		U32 FirstIndex;
+		U32 IndexCount;
+		// How far the simplified surface can be from the full mesh, in mesh units
+		F32 Error;
+		// Range of the mesh's clusters that tile the index range; a LOD without any is drawn whole
+		U32 FirstCluster;
+		U32 ClusterCount;
+	};
+
+	/**
+	 * A patch of up to about a hundred neighboring triangles in a LOD, culled on the CPU on its own
+	 *
+	 * Front faces wind clockwise, as StaticMeshComponent culls counter-clockwise triangles. Every
+	 * front face's normal lies within the cone around ConeAxis whose half angle has the cosine
+	 * ConeCosine, so a camera behind all of them sees none of the cluster.
+	 */
+	struct StaticMeshCluster
+	{
+		StaticMeshCluster()
+			: FirstIndex(0), IndexCount(0), Center(0), Radius(0), ConeAxis(0), ConeCosine(-1)
+		{}
+
+		// Range of the index buffer
+		U32 FirstIndex;
+		U32 IndexCount;
+		// Bounding sphere, in mesh units
+		Vector3f Center;
+		F32 Radius;
+		// Normal cone; a cosine of zero or less is too wide to ever cull
+		Vector3f ConeAxis;
+		F32 ConeCosine;
+	};
+
+	/**
+	 * Bounding sphere of a StaticMesh, in mesh units
+	 */
+	struct StaticMeshBounds
+	{
+		StaticMeshBounds()
+			: Center(0), Radius(0)
+		{}
+
+		Vector3f Center;
+		F32 Radius;
+	};
+
+	/**
+	 * A range of a StaticMesh's index buffer drawn in one call
+	 */
+	struct StaticMeshDrawRange
+	{
+		StaticMeshDrawRange()
+			: FirstIndex(0), IndexCount(0)
+		{}
+
+		StaticMeshDrawRange(U32 firstIndex, U32 indexCount)
+			: FirstIndex(firstIndex), IndexCount(indexCount)
+		{}
+
+		U32 FirstIndex;
+		U32 IndexCount;
+	};
+
+	// File a StaticMesh's arrays point into, kept until the renderer is done with it
+	struct StaticMeshSource;
+
 	/**
 	 * Static Meshes are non-rigged triangular meshes that can be used as input
 	 * to the rendering pipeline.
 	 *
-	 * This class handles identifying and creating StaticMesh assets
+	 * This class handles identifying and creating StaticMesh assets. Meshes in the
+	 * StaticMeshFile format are uploaded straight from the file's data, with no copy.
 	 */
 	class StaticMesh : public Asset
 	{
 	public:
 
-		// Indices are stored as unsigned 32-bit ints
+		// Indices are unsigned 32-bit ints, or 16-bit ones in cooked meshes with few enough vertices
 		typedef U32 Index;
 
+		static constexpr AssetType StaticType = AssetType::AT_STATIC_MESH;
+
+		// Most LODs a mesh can have, including the full mesh
+		static constexpr U32 MaxLodCount = 8;
+
 		/**
 		 * Default constructor
 		 */
@@ -54,9 +203,21 @@ namespace Noble
 		const U32 GetVertexCount() const { return m_VertexCount; }
 
 		/**
-		 * Returns an array of vertices for drawing this StaticMesh
+		 * Returns the format the vertices are stored in
 		 */
-		const StaticVertex* GetVertices() const { return m_Vertices; }
+		const StaticVertexFormat GetVertexFormat() const { return m_VertexFormat; }
+
+		/**
+		 * Returns an array of vertices for drawing this StaticMesh, in its vertex format
+		 * Owned by the renderer once the buffers exist, so only valid until the mesh is uploaded
+		 */
+		const void* GetVertices() const { return m_Vertices; }
+
+		/**
+		 * Returns the transform from stored positions to mesh space
+		 * Identity for full vertices; compact ones are scaled and offset out of their bounding cube
+		 */
+		Matrix4x4f GetPositionTransform() const;
 
 		/**
 		 * Returns the handle to the vertex buffer object
@@ -69,26 +230,105 @@ namespace Noble
 		const U32 GetIndexCount() const { return m_IndexCount; }
 
 		/**
-		 * Returns an array of indices for drawing this StaticMesh
+		 * Returns the size of each index, 2 or 4 bytes
 		 */
-		const Index* GetIndices() const { return m_Indices; }
+		const U32 GetIndexSize() const { return m_IndexSize; }
+
+		/**
+		 * Returns an array of indices for drawing this StaticMesh, of GetIndexSize() bytes each
+		 * Owned by the renderer once the buffers exist, so only valid until the mesh is uploaded
+		 */
+		const void* GetIndices() const { return m_Indices; }
 
 		/**
 		 * Returns the handle to the index buffer object
 		 */
 		bgfx::IndexBufferHandle& GetIndexBuffer() { return m_IndexBuffer; }
 
+		/**
+		 * Returns the number of LODs, at least 1
+		 */
+		const U32 GetLodCount() const { return m_LodCount; }
+
+		/**
+		 * Returns the LOD at the given index; 0 is the full mesh and later ones have fewer triangles
+		 */
+		const StaticMeshLod& GetLod(U32 index) const { CHECK(index < m_LodCount); return m_Lods[index]; }
+
+		/**
+		 * Returns the coarsest LOD whose error stays within @maxPixelError pixels, when one mesh unit
+		 * covers @pixelsPerUnit pixels on screen
+		 */
+		U32 SelectLod(F32 pixelsPerUnit, F32 maxPixelError) const;
+
+		/**
+		 * Returns the bounding sphere of the mesh, in mesh units
+		 */
+		const StaticMeshBounds& GetBounds() const { return m_Bounds; }
+
+		/**
+		 * Returns the number of clusters across every LOD
+		 */
+		const U32 GetClusterCount() const { return m_ClusterCount; }
+
+		/**
+		 * Returns the cluster at the given index
+		 */
+		const StaticMeshCluster& GetCluster(U32 index) const { CHECK(index < m_ClusterCount); return m_Clusters[index]; }
+
+		/**
+		 * Appends to @visible the clusters of a LOD that are inside the frustum of @meshToClip and, if
+		 * @cullBackfaces is set, have a front face towards @cameraPosition, in mesh space
+		 * Returns the number of indices they draw. Clusters are appended in index buffer order
+		 */
+		U32 CullClusters(U32 lod, const Matrix4x4f& meshToClip, const Vector3f& cameraPosition, bool cullBackfaces, Array<U32>& visible) const;
+
+		/**
+		 * Appends to @ranges the index buffer ranges that draw the given clusters, which are in index buffer order
+		 * Clusters that follow each other share a range, as do runs at most @maxGap indices apart, which
+		 * then also draw the culled clusters between them. Returns the number of indices the ranges draw
+		 */
+		U32 MergeClusterRanges(const U32* clusters, Size clusterCount, U32 maxGap, Array<StaticMeshDrawRange>& ranges) const;
+
+		/**
+		 * Returns the size of a vertex in the given format
+		 */
+		static Size GetVertexSize(StaticVertexFormat format)
+		{
+			return format == StaticVertexFormat::Compact ? sizeof(CompactStaticVertex) : sizeof(StaticVertex);
+		}
+
+		/**
+		 * Returns the bgfx layout of a vertex in the given format
+		 */
+		static const bgfx::VertexLayout& GetVertexLayout(StaticVertexFormat format);
+
 		/**
 		 * Returns the type specifier for Static Mesh
 		 */
-		virtual const AssetType GetType() const override { return AssetType::AT_STATIC_MESH; }
+		virtual const AssetType GetType() const override { return StaticType; }
+
+		/**
+		 * The arrays are handed to bgfx, so the mesh's data is counted as GPU memory
+		 */
+		virtual AssetMemoryUsage GetMemoryUsage() const override;
 
 	protected:
 
 		/**
-		 * Fills out the StaticMesh instance from the given buffer
+		 * Reads the vertex and index arrays from the given buffer
 		 */
-		virtual void CreateFromBuffer(BitStream& data) override;
+		virtual bool ParseBuffer(BitStreamView& data) override;
+
+		/**
+		 * Keeps the file alive when the arrays point into it
+		 */
+		virtual void RetainSource(VfsFile& source) override;
+
+		/**
+		 * Creates the vertex and index buffers, which take ownership of the arrays
+		 */
+		virtual void CreateResources() override;
 
 		/**
 		 * Frees the memory from the vertex and index buffers and releases
@@ -96,19 +336,40 @@ namespace Noble
 		 */
 		virtual void Destroy() override;
 
+		virtual void SwapContents(Asset& other) override;
+
 	private:
 
 		// Vertex array
-		StaticVertex* m_Vertices;
+		Byte* m_Vertices;
 		// Number of vertices
 		U32 m_VertexCount;
+		// Format of the vertex array
+		StaticVertexFormat m_VertexFormat;
+		// Mesh-space center and half size of the bounding cube compact positions are stored in
+		Vector3f m_PositionOffset;
+		F32 m_PositionScale;
 		// Vertex buffer
 		bgfx::VertexBufferHandle m_VertexBuffer;
 		// Index array
-		Index* m_Indices;
+		Byte* m_Indices;
 		// Number of indices
 		U32 m_IndexCount;
+		// Bytes per index
+		U32 m_IndexSize;
 		// Index buffer
 		bgfx::IndexBufferHandle m_IndexBuffer;
+		// Index ranges of each LOD
+		StaticMeshLod m_Lods[MaxLodCount];
+		U32 m_LodCount;
+		// Bounding sphere
+		StaticMeshBounds m_Bounds;
+		// Clusters of every LOD
+		StaticMeshCluster* m_Clusters;
+		U32 m_ClusterCount;
+		// Set when the arrays point into the source data rather than being allocated
+		bool m_InPlace;
+		// Source of in-place arrays, shared with bgfx until both buffers release it
+		StaticMeshSource* m_Source;
 	};
 }
\ No newline at end of file
@@ -1,9 +1,12 @@
 #include "StaticMeshComponent.h"
 
 #include "AssetManager.h"
+#include "CameraManager.h"
+#include "Engine.h"
 #include "FileSystem.h"
 #include "Globals.h"
 
+#include <algorithm>
 #include <string.h>
 
 namespace Noble
@@ -15,6 +18,7 @@ namespace Noble
 	{
 		m_Mesh = nullptr;
 		m_Material = nullptr;
+		m_LodPixelError = 1.0F;
 	}
 
 	void StaticMeshComponent::SetMesh(StaticMesh* mesh)
@@ -35,15 +39,82 @@ namespace Noble
 			state = BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_A | BGFX_STATE_WRITE_Z | BGFX_STATE_DEPTH_TEST_LESS | BGFX_STATE_CULL_CCW | BGFX_STATE_MSAA;
 
 			Matrix4x4f transform = GetWorldTransform();
+			const U32 lodIndex = SelectLod(transform);
+			const StaticMeshLod& lod = m_Mesh->GetLod(lodIndex);
+
+			// Only the clusters that can be seen are drawn, as ranges of the index buffer that cover runs of them
+			m_DrawRanges.Empty();
+			if (lod.ClusterCount > 0)
+			{
+				if (CullClusters(transform, lodIndex) == 0)
+				{
+					return;
+				}
+				m_Mesh->MergeClusterRanges(m_VisibleClusters.GetData(), m_VisibleClusters.GetCount(), MaxDrawRangeGap, m_DrawRanges);
+			}
+			else
+			{
+				m_DrawRanges.Add(StaticMeshDrawRange(lod.FirstIndex, lod.IndexCount));
+			}
+
+			// Compact meshes are drawn out of their bounding cube, so scale them back up to mesh space
+			if (m_Mesh->GetVertexFormat() == StaticVertexFormat::Compact)
+			{
+				transform = transform * m_Mesh->GetPositionTransform();
+			}
 
 			bgfx::setTransform(&transform);
 
 			m_Material->EnableUniforms();
 		
 			bgfx::setVertexBuffer(0, m_Mesh->GetVertexBuffer());
-			bgfx::setIndexBuffer(m_Mesh->GetIndexBuffer());
 			bgfx::setState(state);
-			bgfx::submit(0, m_Material->GetShader()->GetProgram());
+
+			// Every range keeps the rest of the draw state, which is only discarded after the last one
+			for (Size i = 0; i < m_DrawRanges.GetCount(); ++i)
+			{
+				const bool last = i + 1 == m_DrawRanges.GetCount();
+				bgfx::setIndexBuffer(m_Mesh->GetIndexBuffer(), m_DrawRanges[i].FirstIndex, m_DrawRanges[i].IndexCount);
+				bgfx::submit(0, m_Material->GetShader()->GetProgram(), 0, last ? BGFX_DISCARD_ALL : BGFX_DISCARD_INDEX_BUFFER);
+			}
+		}
+	}
+
+	U32 StaticMeshComponent::SelectLod(const Matrix4x4f& transform) const
+	{
+		if (m_Mesh->GetLodCount() <= 1)
+		{
+			return 0;
+		}
+
+		const CameraManager* cameras = g_Engine->GetCameraManager();
+		const StaticMeshBounds& bounds = m_Mesh->GetBounds();
+
+		// Distance from the camera to the nearest point of the bounding sphere, which doesn't change as the camera turns
+		const F32 scale = std::max(glm::length(Vector3f(transform[0])), std::max(glm::length(Vector3f(transform[1])), glm::length(Vector3f(transform[2]))));
+		const Vector3f center = Vector3f(cameras->GetViewMatrix() * transform * Vector4f(bounds.Center, 1.0F));
+		const F32 distance = glm::length(center) - bounds.Radius * scale;
+		if (distance <= 0.0F)
+		{
+			return 0;
 		}
+
+		// The projection scales view-space Y by the cotangent of half the field of view, which maps onto half the viewport
+		const F32 pixelsPerUnit = cameras->GetProjectionMatrix()[1][1] * 0.5F * cameras->GetViewportHeight() / distance;
+		return m_Mesh->SelectLod(pixelsPerUnit * scale, m_LodPixelError);
+	}
+
+	U32 StaticMeshComponent::CullClusters(const Matrix4x4f& transform, U32 lod)
+	{
+		const CameraManager* cameras = g_Engine->GetCameraManager();
+		const Matrix4x4f meshToView = cameras->GetViewMatrix() * transform;
+
+		// Clusters are bounded in mesh space, so the camera is brought there rather than every cluster to the world.
+		// Which side of a plane a point is on survives any transform but a mirroring one, which swaps the culled side
+		const Vector3f cameraPosition = Vector3f(glm::inverse(meshToView)[3]);
+		const bool cullBackfaces = glm::determinant(Matrix3x3f(transform)) > 0.0F;
+
+		m_VisibleClusters.Empty();
+		return m_Mesh->CullClusters(lod, cameras->GetProjectionMatrix() * meshToView, cameraPosition, cullBackfaces, m_VisibleClusters);
 	}
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Array.h"
 #include "SceneComponent.h"
 #include "StaticMesh.h"
 #include "Material.h"
@@ -31,6 +32,11 @@ namespace Noble
 		 */
 		void SetMaterial(Material* material);
 
+		/**
+		 * Sets how many pixels a LOD may be off the full mesh by on screen before a finer one is drawn
+		 */
+		void SetLodPixelError(F32 pixels) { m_LodPixelError = pixels; }
+
 	public:
 
 		/**
@@ -40,9 +46,32 @@ namespace Noble
 
 	private:
 
+		/**
+		 * Picks the mesh's LOD for the active camera from how large the mesh is projected on screen
+		 */
+		U32 SelectLod(const Matrix4x4f& transform) const;
+
+		/**
+		 * Culls the clusters of a LOD against the active camera's frustum and by their normal cones,
+		 * leaving the visible ones in m_VisibleClusters. Returns the number of indices they draw
+		 */
+		U32 CullClusters(const Matrix4x4f& transform, U32 lod);
+
+	private:
+
+		// Culled indices a gap between visible clusters may hold and still be drawn rather than split
+		// into another call; about one cluster's worth
+		static constexpr U32 MaxDrawRangeGap = 384;
+
 		// The mesh to draw
 		StaticMesh* m_Mesh;
 		// The material to draw with
 		Material* m_Material;
+		// Largest on-screen error of the LOD drawn, in pixels
+		F32 m_LodPixelError;
+		// Clusters left by the last cull, kept to reuse the allocation
+		Array<U32> m_VisibleClusters;
+		// Index ranges the visible clusters are drawn with, kept to reuse the allocation
+		Array<StaticMeshDrawRange> m_DrawRanges;
 	};
 }
\ No newline at end of file
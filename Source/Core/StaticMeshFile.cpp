@@ -0,0 +1,427 @@
+#include "StaticMeshFile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "MeshQuantizer.h"
+
+namespace Noble
+{
+	namespace
+	{
+		/**
+		 * Rounds @value up to a multiple of @alignment, a power of two
+		 */
+		constexpr Size AlignUp(Size value, Size alignment)
+		{
+			return (value + alignment - 1) & ~(alignment - 1);
+		}
+
+		/**
+		 * Appends zeros up to the next multiple of @alignment, counted from @start
+		 */
+		void WritePadding(BitStream& output, Size start, Size alignment)
+		{
+			static const Byte zeros[StaticMeshFile::BlockAlignment] = {};
+			const Size position = output.GetStoredBytes() - start;
+			const Size padding = AlignUp(position, alignment) - position;
+			if (padding > 0)
+			{
+				output.WriteBytes(zeros, padding);
+			}
+		}
+
+		/**
+		 * Returns true if every component is a finite number
+		 */
+		bool IsFinite(const Vector3f& value)
+		{
+			return std::isfinite(value.x) && std::isfinite(value.y) && std::isfinite(value.z);
+		}
+
+		/**
+		 * Returns true if two blocks of the file share any byte
+		 */
+		bool Overlaps(U64 firstOffset, U64 firstSize, U64 secondOffset, U64 secondSize)
+		{
+			return firstSize > 0 && secondSize > 0 && firstOffset < secondOffset + secondSize && secondOffset < firstOffset + firstSize;
+		}
+
+		/**
+		 * Returns the largest of @count little-endian indices of @indexSize bytes
+		 */
+		U32 FindMaxIndex(const Byte* block, U32 count, U32 indexSize)
+		{
+			const UByte* indices = reinterpret_cast<const UByte*>(block);
+			U32 maxIndex = 0;
+			if (indexSize == sizeof(U16))
+			{
+				for (U32 i = 0; i < count; ++i)
+				{
+					const UByte* index = indices + Size(i) * sizeof(U16);
+					maxIndex = std::max(maxIndex, U32(index[0]) | (U32(index[1]) << 8));
+				}
+			}
+			else
+			{
+				for (U32 i = 0; i < count; ++i)
+				{
+					const UByte* index = indices + Size(i) * sizeof(U32);
+					maxIndex = std::max(maxIndex, U32(index[0]) | (U32(index[1]) << 8) | (U32(index[2]) << 16) | (U32(index[3]) << 24));
+				}
+			}
+			return maxIndex;
+		}
+
+		/**
+		 * Reads one cluster table entry
+		 */
+		StaticMeshCluster ReadCluster(BitStreamView& table)
+		{
+			StaticMeshCluster cluster;
+			cluster.FirstIndex = table.Read<U32>();
+			cluster.IndexCount = table.Read<U32>();
+			cluster.Center = table.Read<Vector3f>();
+			cluster.Radius = table.Read<F32>();
+			cluster.ConeAxis = table.Read<Vector3f>();
+			cluster.ConeCosine = table.Read<F32>();
+			return cluster;
+		}
+	}
+
+	StaticMeshFile::StaticMeshFile()
+		: m_VertexCount(0), m_IndexCount(0), m_IndexSize(0), m_VertexFormat(StaticVertexFormat::Full), m_PositionOffset(0.0F),
+		m_PositionScale(1.0F), m_LodCount(0), m_ClusterCount(0), m_VertexData(nullptr), m_IndexData(nullptr), m_ClusterData(nullptr)
+	{}
+
+	bool StaticMeshFile::Open(const BitStreamView& data)
+	{
+		const Byte* base = data.GetData() + data.GetReaderPos();
+		const Size size = data.GetRemainingBytes();
+		if (size < HeaderSize)
+		{
+			return false;
+		}
+
+		BitStreamView header(base, HeaderSize);
+		header.SetByteOrder(ByteOrder::Little);
+
+		const U32 magic = header.Read<U32>();
+		const U32 version = header.Read<U32>();
+		const U32 vertexCount = header.Read<U32>();
+		const U32 vertexStride = header.Read<U32>();
+		const U32 indexCount = header.Read<U32>();
+		const U32 indexSize = header.Read<U32>();
+		const U32 vertexOffset = header.Read<U32>();
+		const U32 indexOffset = header.Read<U32>();
+		const U32 vertexFormat = header.Read<U32>();
+		const Vector3f positionOffset = header.Read<Vector3f>();
+		const F32 positionScale = header.Read<F32>();
+		StaticMeshBounds bounds;
+		bounds.Center = header.Read<Vector3f>();
+		bounds.Radius = header.Read<F32>();
+		const U32 lodCount = header.Read<U32>();
+		const U32 lodOffset = header.Read<U32>();
+		const U32 clusterCount = header.Read<U32>();
+		const U32 clusterOffset = header.Read<U32>();
+
+		if (magic != Magic || version != Version ||
+			(vertexFormat != U32(StaticVertexFormat::Full) && vertexFormat != U32(StaticVertexFormat::Compact)))
+		{
+			return false;
+		}
+
+		// The blocks are used as arrays, so every range is checked before pointing into them
+		const StaticVertexFormat format = static_cast<StaticVertexFormat>(vertexFormat);
+		const U64 verticesSize = U64(vertexCount) * vertexStride;
+		const U64 indicesSize = U64(indexCount) * indexSize;
+		if (vertexStride != StaticMesh::GetVertexSize(format) || (indexSize != sizeof(U16) && indexSize != sizeof(U32)) ||
+			vertexCount == 0 || indexCount == 0 || vertexOffset < HeaderSize || indexOffset < HeaderSize ||
+			vertexOffset % BlockAlignment != 0 || indexOffset % indexSize != 0 ||
+			vertexOffset > size || verticesSize > size - vertexOffset || indexOffset > size || indicesSize > size - indexOffset ||
+			!IsFinite(positionOffset) || !std::isfinite(positionScale) || positionScale <= 0.0F ||
+			!IsFinite(bounds.Center) || !std::isfinite(bounds.Radius) || bounds.Radius < 0.0F ||
+			lodCount == 0 || lodCount > StaticMesh::MaxLodCount || lodOffset < HeaderSize || lodOffset % sizeof(U32) != 0 ||
+			lodOffset > size || U64(lodCount) * LodEntrySize > size - lodOffset ||
+			clusterOffset < HeaderSize || clusterOffset % sizeof(U32) != 0 ||
+			clusterOffset > size || U64(clusterCount) * ClusterEntrySize > size - clusterOffset)
+		{
+			return false;
+		}
+
+		// Blocks sharing bytes would let one be read as another
+		const U64 lodsSize = U64(lodCount) * LodEntrySize;
+		const U64 clustersSize = U64(clusterCount) * ClusterEntrySize;
+		if (Overlaps(vertexOffset, verticesSize, indexOffset, indicesSize) || Overlaps(vertexOffset, verticesSize, lodOffset, lodsSize) ||
+			Overlaps(vertexOffset, verticesSize, clusterOffset, clustersSize) || Overlaps(indexOffset, indicesSize, lodOffset, lodsSize) ||
+			Overlaps(indexOffset, indicesSize, clusterOffset, clustersSize) || Overlaps(lodOffset, lodsSize, clusterOffset, clustersSize))
+		{
+			return false;
+		}
+
+		// The renderer and culling trust every index, and in place nothing else gets to check them
+		if (FindMaxIndex(base + indexOffset, indexCount, indexSize) >= vertexCount)
+		{
+			return false;
+		}
+
+		// Every LOD is drawn as whole triangles within the index block, and so is each of its clusters within the LOD.
+		// Clusters are in index order without overlapping, so visible neighbors can be merged into one draw
+		BitStreamView lodTable(base + lodOffset, Size(lodCount) * LodEntrySize);
+		lodTable.SetByteOrder(ByteOrder::Little);
+		for (U32 i = 0; i < lodCount; ++i)
+		{
+			StaticMeshLod& lod = m_Lods[i];
+			lod.FirstIndex = lodTable.Read<U32>();
+			lod.IndexCount = lodTable.Read<U32>();
+			lod.Error = lodTable.Read<F32>();
+			lod.FirstCluster = lodTable.Read<U32>();
+			lod.ClusterCount = lodTable.Read<U32>();
+			if (lod.IndexCount == 0 || lod.IndexCount % 3 != 0 || U64(lod.FirstIndex) + lod.IndexCount > indexCount ||
+				!std::isfinite(lod.Error) || lod.Error < 0.0F || U64(lod.FirstCluster) + lod.ClusterCount > clusterCount)
+			{
+				return false;
+			}
+
+			BitStreamView clusterTable(base + clusterOffset + Size(lod.FirstCluster) * ClusterEntrySize, Size(lod.ClusterCount) * ClusterEntrySize);
+			clusterTable.SetByteOrder(ByteOrder::Little);
+			U64 clusterEnd = lod.FirstIndex;
+			for (U32 c = 0; c < lod.ClusterCount; ++c)
+			{
+				const StaticMeshCluster cluster = ReadCluster(clusterTable);
+				if (cluster.IndexCount == 0 || cluster.IndexCount % 3 != 0 || cluster.FirstIndex < clusterEnd ||
+					U64(cluster.FirstIndex) + cluster.IndexCount > U64(lod.FirstIndex) + lod.IndexCount ||
+					!IsFinite(cluster.Center) || !std::isfinite(cluster.Radius) || cluster.Radius < 0.0F ||
+					!IsFinite(cluster.ConeAxis) || !std::isfinite(cluster.ConeCosine))
+				{
+					return false;
+				}
+				clusterEnd = U64(cluster.FirstIndex) + cluster.IndexCount;
+			}
+		}
+
+		m_VertexCount = vertexCount;
+		m_IndexCount = indexCount;
+		m_IndexSize = indexSize;
+		m_VertexFormat = format;
+		m_PositionOffset = positionOffset;
+		m_PositionScale = positionScale;
+		m_Bounds = bounds;
+		m_LodCount = lodCount;
+		m_ClusterCount = clusterCount;
+		m_VertexData = base + vertexOffset;
+		m_IndexData = base + indexOffset;
+		m_ClusterData = base + clusterOffset;
+
+		return true;
+	}
+
+	bool StaticMeshFile::CanUseInPlace() const
+	{
+		return ByteOrder::Native == ByteOrder::Little &&
+			reinterpret_cast<std::uintptr_t>(m_VertexData) % alignof(StaticVertex) == 0 &&
+			reinterpret_cast<std::uintptr_t>(m_IndexData) % m_IndexSize == 0;
+	}
+
+	void StaticMeshFile::ReadVertices(void* vertices) const
+	{
+		const Size size = Size(m_VertexCount) * StaticMesh::GetVertexSize(m_VertexFormat);
+		std::memcpy(vertices, m_VertexData, size);
+		if constexpr (ByteOrder::Native == ByteOrder::Big)
+		{
+			// Full vertices are all F32s and compact ones all 16-bit values
+			const Size unitSize = m_VertexFormat == StaticVertexFormat::Compact ? sizeof(U16) : sizeof(F32);
+			ByteOrderHelper::SwapUnits(vertices, unitSize, size / unitSize);
+		}
+	}
+
+	void StaticMeshFile::ReadIndices(void* indices) const
+	{
+		ReadIndices(indices, 0, m_IndexCount);
+	}
+
+	void StaticMeshFile::ReadIndices(void* indices, U32 firstIndex, U32 count) const
+	{
+		CHECK(U64(firstIndex) + count <= m_IndexCount);
+
+		std::memcpy(indices, m_IndexData + Size(firstIndex) * m_IndexSize, Size(count) * m_IndexSize);
+		if constexpr (ByteOrder::Native == ByteOrder::Big)
+		{
+			ByteOrderHelper::SwapUnits(indices, m_IndexSize, count);
+		}
+	}
+
+	void StaticMeshFile::ReadClusters(StaticMeshCluster* clusters) const
+	{
+		BitStreamView table(m_ClusterData, Size(m_ClusterCount) * ClusterEntrySize);
+		table.SetByteOrder(ByteOrder::Little);
+		for (U32 i = 0; i < m_ClusterCount; ++i)
+		{
+			clusters[i] = ReadCluster(table);
+		}
+	}
+
+	bool StaticMeshFile::IsMeshFile(const BitStreamView& data)
+	{
+		BitStreamView header(data.GetData() + data.GetReaderPos(), data.GetRemainingBytes());
+		header.SetByteOrder(ByteOrder::Little);
+
+		return header.GetRemainingBytes() >= HeaderSize && header.Read<U32>() == Magic;
+	}
+
+	StaticMeshBounds StaticMeshFile::ComputeBounds(const StaticVertex* vertices, U32 vertexCount)
+	{
+		StaticMeshBounds bounds;
+		if (vertexCount == 0)
+		{
+			return bounds;
+		}
+
+		// Centered on the bounding box, which is close to the smallest sphere for most meshes
+		Vector3f min = vertices[0].Position;
+		Vector3f max = vertices[0].Position;
+		for (U32 i = 1; i < vertexCount; ++i)
+		{
+			min = glm::min(min, vertices[i].Position);
+			max = glm::max(max, vertices[i].Position);
+		}
+		bounds.Center = (min + max) * 0.5F;
+
+		F32 radiusSquared = 0.0F;
+		for (U32 i = 0; i < vertexCount; ++i)
+		{
+			const Vector3f offset = vertices[i].Position - bounds.Center;
+			radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+		}
+		bounds.Radius = std::sqrt(radiusSquared);
+		return bounds;
+	}
+
+	void StaticMeshFile::Write(const StaticVertex* vertices, U32 vertexCount, const StaticMesh::Index* indices, U32 indexCount, BitStream& output)
+	{
+		Write(vertices, vertexCount, indices, indexCount, nullptr, 0, nullptr, 0, output);
+	}
+
+	void StaticMeshFile::Write(const StaticVertex* vertices, U32 vertexCount, const StaticMesh::Index* indices, U32 indexCount,
+		const StaticMeshLod* lods, U32 lodCount, const StaticMeshCluster* clusters, U32 clusterCount, BitStream& output)
+	{
+		WriteMesh(StaticVertexFormat::Full, vertices, vertexCount, Vector3f(0.0F), 1.0F, ComputeBounds(vertices, vertexCount),
+			indices, indexCount, lods, lodCount, clusters, clusterCount, output);
+	}
+
+	void StaticMeshFile::Write(const CompactStaticVertex* vertices, U32 vertexCount, const Vector3f& positionOffset, F32 positionScale,
+		const StaticMesh::Index* indices, U32 indexCount, const StaticMeshLod* lods, U32 lodCount,
+		const StaticMeshCluster* clusters, U32 clusterCount, BitStream& output)
+	{
+		// Bound the positions as they'll be decoded, so the sphere holds what's drawn
+		StaticVertex* decoded = new StaticVertex[vertexCount];
+		MeshQuantizer::Dequantize(vertices, vertexCount, positionOffset, positionScale, decoded);
+		const StaticMeshBounds bounds = ComputeBounds(decoded, vertexCount);
+		delete[] decoded;
+
+		WriteMesh(StaticVertexFormat::Compact, vertices, vertexCount, positionOffset, positionScale, bounds,
+			indices, indexCount, lods, lodCount, clusters, clusterCount, output);
+	}
+
+	void StaticMeshFile::WriteMesh(StaticVertexFormat format, const void* vertices, U32 vertexCount, const Vector3f& positionOffset, F32 positionScale,
+		const StaticMeshBounds& bounds, const StaticMesh::Index* indices, U32 indexCount, const StaticMeshLod* lods, U32 lodCount,
+		const StaticMeshCluster* clusters, U32 clusterCount, BitStream& output)
+	{
+		CHECK(vertices && vertexCount > 0);
+		CHECK(indices && indexCount > 0);
+		CHECK(positionScale > 0.0F);
+		CHECK(lodCount <= StaticMesh::MaxLodCount);
+		CHECK(clusters || clusterCount == 0);
+
+		// Without LODs the whole index list is the only one
+		const StaticMeshLod fullMesh(0, indexCount, 0.0F);
+		if (lodCount == 0)
+		{
+			lods = &fullMesh;
+			lodCount = 1;
+		}
+
+		// 16-bit indices halve the index block and its fetch bandwidth
+		const bool shortIndices = vertexCount <= 0x10000;
+		const Size indexSize = shortIndices ? sizeof(U16) : sizeof(U32);
+
+		const Size vertexSize = StaticMesh::GetVertexSize(format);
+		const Size lodOffset = HeaderSize;
+		const Size clusterOffset = lodOffset + lodCount * LodEntrySize;
+		const Size vertexOffset = AlignUp(clusterOffset + Size(clusterCount) * ClusterEntrySize, BlockAlignment);
+		const Size indexOffset = AlignUp(vertexOffset + Size(vertexCount) * vertexSize, BlockAlignment);
+		CHECK(indexOffset <= 0xFFFFFFFF);
+
+		const ByteOrder order = output.GetByteOrder();
+		output.SetByteOrder(ByteOrder::Little);
+
+		const Size start = output.GetStoredBytes();
+		output.Write<U32>(Magic);
+		output.Write<U32>(Version);
+		output.Write<U32>(vertexCount);
+		output.Write<U32>(static_cast<U32>(vertexSize));
+		output.Write<U32>(indexCount);
+		output.Write<U32>(static_cast<U32>(indexSize));
+		output.Write<U32>(static_cast<U32>(vertexOffset));
+		output.Write<U32>(static_cast<U32>(indexOffset));
+		output.Write<U32>(static_cast<U32>(format));
+		output.Write<Vector3f>(positionOffset);
+		output.Write<F32>(positionScale);
+		output.Write<Vector3f>(bounds.Center);
+		output.Write<F32>(bounds.Radius);
+		output.Write<U32>(lodCount);
+		output.Write<U32>(static_cast<U32>(lodOffset));
+		output.Write<U32>(clusterCount);
+		output.Write<U32>(static_cast<U32>(clusterOffset));
+		output.Write<U32>(0);
+
+		for (U32 i = 0; i < lodCount; ++i)
+		{
+			CHECK(lods[i].IndexCount > 0 && lods[i].IndexCount % 3 == 0 && U64(lods[i].FirstIndex) + lods[i].IndexCount <= indexCount);
+			CHECK(U64(lods[i].FirstCluster) + lods[i].ClusterCount <= clusterCount);
+			output.Write<U32>(lods[i].FirstIndex);
+			output.Write<U32>(lods[i].IndexCount);
+			output.Write<F32>(lods[i].Error);
+			output.Write<U32>(lods[i].FirstCluster);
+			output.Write<U32>(lods[i].ClusterCount);
+		}
+
+		for (U32 i = 0; i < clusterCount; ++i)
+		{
+			CHECK(clusters[i].IndexCount > 0 && clusters[i].IndexCount % 3 == 0 && U64(clusters[i].FirstIndex) + clusters[i].IndexCount <= indexCount);
+			output.Write<U32>(clusters[i].FirstIndex);
+			output.Write<U32>(clusters[i].IndexCount);
+			output.Write<Vector3f>(clusters[i].Center);
+			output.Write<F32>(clusters[i].Radius);
+			output.Write<Vector3f>(clusters[i].ConeAxis);
+			output.Write<F32>(clusters[i].ConeCosine);
+		}
+
+		WritePadding(output, start, BlockAlignment);
+		if (format == StaticVertexFormat::Compact)
+		{
+			output.WriteArray(static_cast<const CompactStaticVertex*>(vertices), vertexCount);
+		}
+		else
+		{
+			output.WriteArray(static_cast<const StaticVertex*>(vertices), vertexCount);
+		}
+		WritePadding(output, start, BlockAlignment);
+		if (shortIndices)
+		{
+			for (U32 i = 0; i < indexCount; ++i)
+			{
+				CHECK(indices[i] < vertexCount);
+				output.Write<U16>(static_cast<U16>(indices[i]));
+			}
+		}
+		else
+		{
+			output.WriteArray(indices, indexCount);
+		}
+
+		output.SetByteOrder(order);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,197 @@
+#pragma once
+
+#include "BitStream.h"
+#include "StaticMesh.h"
+#include "Types.h"
+
+namespace Noble
+{
+	/**
+	 * Cooked StaticMesh format, laid out so the vertex and index blocks can be handed to
+	 * the renderer straight from the file's mapping
+	 *
+	 * Layout: an 88-byte little-endian header (magic, version, vertex count, vertex stride,
+	 * index count, index size, vertex block offset, index block offset, vertex format, position
+	 * offset and scale, bounding sphere, LOD count, LOD table offset, cluster count, cluster table
+	 * offset, then a reserved zero), the LOD table as (first index, index count, error, first
+	 * cluster, cluster count), the cluster table as (first index, index count, bounding sphere,
+	 * cone axis and cosine), then the vertex block as packed StaticVertex or CompactStaticVertex
+	 * and the index block as U16s or U32s, holding every LOD's range one after another. Both blocks start on a 16-byte boundary relative to the
+	 * start of the mesh, so with a page-aligned mapping, a pack entry or a checksum frame
+	 * payload they stay at least 4-byte aligned in memory.
+	 */
+	class StaticMeshFile
+	{
+	public:
+
+		// Identifies a mesh file ("NMSH")
+		static constexpr U32 Magic = 0x48534D4E;
+		// Current format version
+		static constexpr U32 Version = 4;
+		// Size of the header at the start of the mesh
+		static constexpr Size HeaderSize = 88;
+		// Size of each LOD table entry
+		static constexpr Size LodEntrySize = 20;
+		// Size of each cluster table entry
+		static constexpr Size ClusterEntrySize = 40;
+		// Alignment of the vertex and index blocks, relative to the start of the mesh
+		static constexpr Size BlockAlignment = 16;
+
+		StaticMeshFile();
+
+		/**
+		 * Validates the header, block layout and indices of the mesh at the reader position of @data
+		 * The data must outlive the StaticMeshFile. Returns false if it is malformed
+		 */
+		bool Open(const BitStreamView& data);
+
+		/**
+		 * Returns the number of vertices
+		 */
+		U32 GetVertexCount() const { return m_VertexCount; }
+
+		/**
+		 * Returns the format of the vertex block
+		 */
+		StaticVertexFormat GetVertexFormat() const { return m_VertexFormat; }
+
+		/**
+		 * Returns the center of the bounding cube compact positions are stored in
+		 */
+		const Vector3f& GetPositionOffset() const { return m_PositionOffset; }
+
+		/**
+		 * Returns the half size of the bounding cube compact positions are stored in
+		 */
+		F32 GetPositionScale() const { return m_PositionScale; }
+
+		/**
+		 * Returns the number of indices, across every LOD
+		 */
+		U32 GetIndexCount() const { return m_IndexCount; }
+
+		/**
+		 * Returns the number of LODs, at least 1
+		 */
+		U32 GetLodCount() const { return m_LodCount; }
+
+		/**
+		 * Returns the LOD at the given index
+		 */
+		const StaticMeshLod& GetLod(U32 index) const { CHECK(index < m_LodCount); return m_Lods[index]; }
+
+		/**
+		 * Returns the bounding sphere of the full mesh
+		 */
+		const StaticMeshBounds& GetBounds() const { return m_Bounds; }
+
+		/**
+		 * Returns the number of clusters across every LOD, which may be none
+		 */
+		U32 GetClusterCount() const { return m_ClusterCount; }
+
+		/**
+		 * Returns the size of each index, 2 or 4 bytes
+		 */
+		U32 GetIndexSize() const { return m_IndexSize; }
+
+		/**
+		 * Returns the vertex block, which may be unaligned and stored in the wrong byte order
+		 */
+		const Byte* GetVertexData() const { return m_VertexData; }
+
+		/**
+		 * Returns the index block, which may be unaligned and stored in the wrong byte order
+		 */
+		const Byte* GetIndexData() const { return m_IndexData; }
+
+		/**
+		 * Returns true if the blocks can be used as vertex and index arrays without a copy:
+		 * the host is little-endian and both blocks are aligned for their types
+		 */
+		bool CanUseInPlace() const;
+
+		/**
+		 * Copies the vertex block into @vertices, which must hold GetVertexCount() vertices
+		 * of the file's format, swapping bytes on big-endian hosts
+		 */
+		void ReadVertices(void* vertices) const;
+
+		/**
+		 * Copies the index block into @indices, which must hold GetIndexCount() indices of
+		 * GetIndexSize() bytes, swapping bytes on big-endian hosts
+		 */
+		void ReadIndices(void* indices) const;
+
+		/**
+		 * Copies @count indices from @firstIndex on into @indices, such as the range of one LOD
+		 * The range must lie within the index block
+		 */
+		void ReadIndices(void* indices, U32 firstIndex, U32 count) const;
+
+		/**
+		 * Reads the cluster table into @clusters, which must hold GetClusterCount() clusters
+		 */
+		void ReadClusters(StaticMeshCluster* clusters) const;
+
+		/**
+		 * Returns true if the data at the reader position starts with a mesh file header
+		 * Meshes without one are the older unaligned format of counts followed by arrays
+		 */
+		static bool IsMeshFile(const BitStreamView& data);
+
+		/**
+		 * Returns a bounding sphere of the vertices' positions
+		 */
+		static StaticMeshBounds ComputeBounds(const StaticVertex* vertices, U32 vertexCount);
+
+		/**
+		 * Appends a mesh file holding the vertices and indices, drawn as a single LOD, to @output
+		 * Indices are stored as U16s when every vertex can be addressed with them
+		 */
+		static void Write(const StaticVertex* vertices, U32 vertexCount, const StaticMesh::Index* indices, U32 indexCount, BitStream& output);
+
+		/**
+		 * Appends a mesh file holding the vertices and indices to @output, with @lods as ranges of the
+		 * indices and @clusters as ranges of the LODs; no LODs writes all of them as one
+		 */
+		static void Write(const StaticVertex* vertices, U32 vertexCount, const StaticMesh::Index* indices, U32 indexCount,
+			const StaticMeshLod* lods, U32 lodCount, const StaticMeshCluster* clusters, U32 clusterCount, BitStream& output);
+
+		/**
+		 * Appends a mesh file holding compact vertices, quantized within the cube at
+		 * @positionOffset with half size @positionScale, and the indices, LODs and clusters to @output
+		 */
+		static void Write(const CompactStaticVertex* vertices, U32 vertexCount, const Vector3f& positionOffset, F32 positionScale,
+			const StaticMesh::Index* indices, U32 indexCount, const StaticMeshLod* lods, U32 lodCount,
+			const StaticMeshCluster* clusters, U32 clusterCount, BitStream& output);
+
+	private:
+
+		/**
+		 * Writes the header, the LOD and cluster tables and both blocks for either vertex format
+		 */
+		static void WriteMesh(StaticVertexFormat format, const void* vertices, U32 vertexCount, const Vector3f& positionOffset, F32 positionScale,
+			const StaticMeshBounds& bounds, const StaticMesh::Index* indices, U32 indexCount, const StaticMeshLod* lods, U32 lodCount,
+			const StaticMeshCluster* clusters, U32 clusterCount, BitStream& output);
+
+		// Counts from the header
+		U32 m_VertexCount;
+		U32 m_IndexCount;
+		U32 m_IndexSize;
+		// Vertex format and the transform restoring compact positions
+		StaticVertexFormat m_VertexFormat;
+		Vector3f m_PositionOffset;
+		F32 m_PositionScale;
+		// Bounding sphere and LODs, copied out of the header and table
+		StaticMeshBounds m_Bounds;
+		StaticMeshLod m_Lods[StaticMesh::MaxLodCount];
+		U32 m_LodCount;
+		// Cluster count from the header
+		U32 m_ClusterCount;
+		// Blocks and the cluster table, in the viewed data
+		const Byte* m_VertexData;
+		const Byte* m_IndexData;
+		const Byte* m_ClusterData;
+	};
+}
\ No newline at end of file
@@ -5,8 +5,14 @@
 #include "Types.h"
 #include "Memory.h"
 
+#include <cstring>
+#include <string>
 #include <type_traits>
 
+#ifdef NOBLE_WINDOWS
+#include <intrin.h> // _umul128
+#endif
+
 namespace Noble
 {
 	// String character typedef, in case I want to jump up to 16-bit chars eventually
@@ -450,13 +456,206 @@ namespace Noble
 	 * FNV1a C++11 Compile Time Hash Function by UnderscoreDiscovery on Github
 	 * https://gist.github.com/underscorediscovery/81308642d0325fd386237cfa3b44785c
 	 *
-	 * FNV-1a is decently collision-averse, and likely will work fine moving forward
+	 * FNV-1a is decently collision-averse, and likely will work fine moving forward.
+	 * It is the 32-bit identifier hash (HASH, GetHash, switch cases) unless wide identifiers
+	 * are enabled, and is written as a loop now so runtime calls on long dynamic strings
+	 * don't recurse once per character.
 	 */
 	constexpr U32 val32 =   0x811C9DC5;
 	constexpr U32 prime32 = 0x01000193;
 	constexpr const U32 HashString(const char* in, const U32 value = val32)
 	{
-		return (in[0] == '\0') ? value : HashString(&in[1], static_cast<U32>((value ^ U32(in[0])) * static_cast<U64>(prime32)));
+		U32 hash = value;
+		for (; *in != '\0'; ++in)
+		{
+			hash = static_cast<U32>((hash ^ U32(in[0])) * static_cast<U64>(prime32));
+		}
+
+		return hash;
+	}
+
+	/**
+	 * FNV-1a over a string of known length, skips the terminator search
+	 * Produces the same value as HashString() for the same characters
+	 */
+	constexpr const U32 HashStringN(const char* in, const Size len)
+	{
+		U32 hash = val32;
+		for (Size i = 0; i < len; ++i)
+		{
+			hash = static_cast<U32>((hash ^ U32(in[i])) * static_cast<U64>(prime32));
+		}
+
+		return hash;
+	}
+
+	namespace HashHelper
+	{
+		/**
+		 * Constants for the 64-bit hash below, taken from wyhash (final4) by Wang Yi
+		 * https://github.com/wangyi-fudan/wyhash - public domain
+		 */
+		constexpr U64 WySecret0 = 0x2d358dccaa6c78a5ULL;
+		constexpr U64 WySecret1 = 0x8bb84b93962eacc9ULL;
+		constexpr U64 WySecret2 = 0x4b33a62ed433d4a3ULL;
+		constexpr U64 WySecret3 = 0x4d5a2da51de1aa47ULL;
+
+		/**
+		 * 64x64 -> 128 bit multiply, leaves the low half in a and the high half in b
+		 */
+		constexpr void WyMum(U64& a, U64& b)
+		{
+#if defined(NOBLE_LINUX) && defined(__SIZEOF_INT128__)
+			if (!std::is_constant_evaluated())
+			{
+				unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+				a = static_cast<U64>(r);
+				b = static_cast<U64>(r >> 64);
+				return;
+			}
+#elif defined(NOBLE_WINDOWS) && defined(NOBLE_BUILD_64BIT)
+			if (!std::is_constant_evaluated())
+			{
+				a = _umul128(a, b, &b);
+				return;
+			}
+#endif
+			// Portable path, also used for compile-time evaluation
+			const U64 ha = a >> 32, hb = b >> 32, la = U32(a), lb = U32(b);
+			const U64 rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+			const U64 t = rl + (rm0 << 32);
+			U64 carry = t < rl;
+			const U64 lo = t + (rm1 << 32);
+			carry += lo < t;
+			const U64 hi = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+			a = lo;
+			b = hi;
+		}
+
+		/**
+		 * Multiplies and folds the 128-bit result back down to 64 bits
+		 */
+		constexpr U64 WyMix(U64 a, U64 b)
+		{
+			WyMum(a, b);
+			return a ^ b;
+		}
+
+		/**
+		 * Reads N (4 or 8) bytes as a little-endian integer
+		 * At runtime this is a single unaligned load, at compile time it's assembled by hand
+		 */
+		template <Size N>
+		constexpr U64 WyRead(const char* p)
+		{
+			if (!std::is_constant_evaluated())
+			{
+				if constexpr (N == 8)
+				{
+					U64 v = 0;
+					std::memcpy(&v, p, 8);
+					return v;
+				}
+				else
+				{
+					U32 v = 0;
+					std::memcpy(&v, p, 4);
+					return v;
+				}
+			}
+
+			U64 v = 0;
+			for (Size i = 0; i < N; ++i)
+			{
+				v |= U64(UByte(p[i])) << (i * 8);
+			}
+			return v;
+		}
+
+		/**
+		 * Reads 1-3 bytes into a single integer
+		 */
+		constexpr U64 WyRead3(const char* p, const Size k)
+		{
+			return (U64(UByte(p[0])) << 16) | (U64(UByte(p[k >> 1])) << 8) | U64(UByte(p[k - 1]));
+		}
+	}
+
+	/**
+	 * 64-bit hash of a string of known length, based on wyhash
+	 *
+	 * Consumes input 8 bytes per load with three independent lanes on long inputs, which
+	 * makes it many times faster than FNV-1a for runtime strings (paths, config keys).
+	 * It is constexpr as well, so literals hash to the same value at compile time.
+	 */
+	constexpr const U64 HashString64(const char* p, const Size len, U64 seed = 0)
+	{
+		using namespace HashHelper;
+
+		seed ^= WyMix(seed ^ WySecret0, WySecret1);
+		U64 a = 0, b = 0;
+
+		if (len <= 16)
+		{
+			if (len >= 4)
+			{
+				a = (WyRead<4>(p) << 32) | WyRead<4>(p + ((len >> 3) << 2));
+				b = (WyRead<4>(p + len - 4) << 32) | WyRead<4>(p + len - 4 - ((len >> 3) << 2));
+			}
+			else if (len > 0)
+			{
+				a = WyRead3(p, len);
+			}
+		}
+		else
+		{
+			Size i = len;
+			if (i >= 48)
+			{
+				U64 see1 = seed, see2 = seed;
+				do
+				{
+					seed = WyMix(WyRead<8>(p) ^ WySecret1, WyRead<8>(p + 8) ^ seed);
+					see1 = WyMix(WyRead<8>(p + 16) ^ WySecret2, WyRead<8>(p + 24) ^ see1);
+					see2 = WyMix(WyRead<8>(p + 32) ^ WySecret3, WyRead<8>(p + 40) ^ see2);
+					p += 48;
+					i -= 48;
+				} while (i >= 48);
+				seed ^= see1 ^ see2;
+			}
+
+			while (i > 16)
+			{
+				seed = WyMix(WyRead<8>(p) ^ WySecret1, WyRead<8>(p + 8) ^ seed);
+				i -= 16;
+				p += 16;
+			}
+
+			a = WyRead<8>(p + i - 16);
+			b = WyRead<8>(p + i - 8);
+		}
+
+		a ^= WySecret1;
+		b ^= seed;
+		WyMum(a, b);
+
+		return WyMix(a ^ WySecret0 ^ len, b ^ WySecret1);
+	}
+
+	/**
+	 * 64-bit hash of a null-terminated string
+	 */
+	FORCEINLINE const U64 HashString64(const char* in)
+	{
+		return HashString64(in, std::strlen(in));
+	}
+
+	/**
+	 * 64-bit hash of an arbitrary buffer, for runtime data (file contents, blobs)
+	 */
+	FORCEINLINE const U64 HashBytes64(const void* data, const Size len, const U64 seed = 0)
+	{
+		return HashString64(static_cast<const char*>(data), len, seed);
 	}
 
 	/**
@@ -467,6 +666,14 @@ namespace Noble
 		return HashString(in);
 	}
 
+	/**
+	 * Returns a 64-bit hash of a string literal, can be computed at compile time if possible
+	 */
+	constexpr const U64 operator "" _hash64(const char* in, Size len)
+	{
+		return HashString64(in, len);
+	}
+
 	/**
 	 * Returns the length of a string literal
 	 */
@@ -484,6 +691,41 @@ namespace Noble
 		static constexpr const U32 value = N;
 	};
 
+	/**
+	 * Defining NOBLE_WIDE_IDENTIFIERS makes NIdentifiers carry and compare by a 64-bit hash
+	 * (HashString64) instead of the FNV-1a hash. Large asset registries should enable it, since
+	 * 32 bits start colliding at a few tens of thousands of names. GetHash() stays 32-bit either
+	 * way, but under the define it's the low half of the 64-bit hash, so a string is only hashed
+	 * once. HASH() and HashIdentifier() follow the same switch, so they keep matching GetHash();
+	 * rebuild cooked data keyed by it after switching.
+	 */
+#ifdef NOBLE_WIDE_IDENTIFIERS
+	typedef U64 IdentifierHash;
+
+	/**
+	 * Returns the 32-bit identifier hash (NIdentifier::GetHash) for a 64-bit one
+	 */
+	constexpr const U32 NarrowIdentifierHash(const U64 wideHash)
+	{
+		return static_cast<U32>(wideHash);
+	}
+#else
+	typedef U32 IdentifierHash;
+#endif
+
+	/**
+	 * Returns the 32-bit hash NIdentifier::GetHash() has for a null-terminated string
+	 * Can be computed at compile time, so it also serves switch cases
+	 */
+	constexpr const U32 HashIdentifier(const char* in)
+	{
+#ifdef NOBLE_WIDE_IDENTIFIERS
+		return NarrowIdentifierHash(HashString64(in, std::char_traits<char>::length(in)));
+#else
+		return HashString(in);
+#endif
+	}
+
 	/**
 	 * An identifier that includes a hash of the string it represents
 	 * Comparisons of NIdentifiers are based on the hash instead of a string comparison
@@ -501,32 +743,59 @@ namespace Noble
 		 */
 		NIdentifier()
 			: m_Data(nullptr), m_Size(0), m_Hash(0)
+#ifdef NOBLE_WIDE_IDENTIFIERS
+			, m_WideHash(0)
+#endif
 		{}
 
 		/**
 		 * Constexpr constructor to allow compile-time construction of the type
+		 * @hash must be what GetIdentifierHash() returns for the string, which GetHash() is derived from
 		 */
-		constexpr NIdentifier(const char* const str, const Size len, const U32 hash)
+#ifdef NOBLE_WIDE_IDENTIFIERS
+		constexpr NIdentifier(const char* const str, const Size len, const IdentifierHash hash)
+			: m_Data(str), m_Size(len), m_Hash(NarrowIdentifierHash(hash)), m_WideHash(hash)
+		{
+		}
+#else
+		constexpr NIdentifier(const char* const str, const Size len, const IdentifierHash hash)
 			: m_Data(str), m_Size(len), m_Hash(hash)
 		{
 		}
+#endif
+
+		/**
+		 * Builds an identifier from a runtime string of known length, hashing it here
+		 */
+#ifdef NOBLE_WIDE_IDENTIFIERS
+		NIdentifier(const char* const str, const Size len)
+			: NIdentifier(str, len, HashString64(str, len))
+		{
+		}
+#else
+		NIdentifier(const char* const str, const Size len)
+			: NIdentifier(str, len, HashStringN(str, len))
+		{
+		}
+#endif
 
 		/**
 		 * Copy constructor
 		 */
 		NIdentifier(const NIdentifier& other)
 			: m_Data(other.m_Data), m_Size(other.m_Size), m_Hash(other.m_Hash)
+#ifdef NOBLE_WIDE_IDENTIFIERS
+			, m_WideHash(other.m_WideHash)
+#endif
 		{}
 
 		/**
 		 * Move constructor
 		 */
 		NIdentifier(NIdentifier&& other) noexcept
-			: m_Data(other.m_Data), m_Size(other.m_Size), m_Hash(other.m_Hash)
+			: NIdentifier(other)
 		{
-			other.m_Data = nullptr;
-			other.m_Size = 0;
-			other.m_Hash = 0;
+			other.Clear();
 		}
 
 		/**
@@ -542,6 +811,9 @@ namespace Noble
 			m_Data = other.m_Data;
 			m_Size = other.m_Size;
 			m_Hash = other.m_Hash;
+#ifdef NOBLE_WIDE_IDENTIFIERS
+			m_WideHash = other.m_WideHash;
+#endif
 
 			return *this;
 		}
@@ -551,13 +823,8 @@ namespace Noble
 		 */
 		NIdentifier& operator=(NIdentifier&& other) noexcept
 		{
-			m_Data = other.m_Data;
-			m_Size = other.m_Size;
-			m_Hash = other.m_Hash;
-
-			other.m_Data = nullptr;
-			other.m_Size = 0;
-			other.m_Hash = 0;
+			*this = static_cast<const NIdentifier&>(other);
+			other.Clear();
 
 			return *this;
 		}
@@ -573,19 +840,46 @@ namespace Noble
 		const Size GetSize() const { return m_Size; }
 
 		/**
-		 * Returns the hash of the string
+		 * Returns the 32-bit hash of the string, the same as HASH() gives for it
 		 */
 		const U32 GetHash() const { return m_Hash; }
 
+		/**
+		 * Returns the hash used for comparisons - 64-bit under NOBLE_WIDE_IDENTIFIERS
+		 */
+		const IdentifierHash GetIdentifierHash() const
+		{
+#ifdef NOBLE_WIDE_IDENTIFIERS
+			return m_WideHash;
+#else
+			return m_Hash;
+#endif
+		}
+
 		/**
 		 * Comparison operator that uses hashes for speed
 		 */
-		friend bool operator==(const NIdentifier& lhs, const NIdentifier& rhs) { return lhs.GetHash() == rhs.GetHash(); }
+		friend bool operator==(const NIdentifier& lhs, const NIdentifier& rhs) { return lhs.GetIdentifierHash() == rhs.GetIdentifierHash(); }
 
 		/**
 		 * Comparison operator that uses hashes for speed
 		 */
-		friend bool operator!=(const NIdentifier& lhs, const NIdentifier& rhs) { return lhs.GetHash() != rhs.GetHash(); }
+		friend bool operator!=(const NIdentifier& lhs, const NIdentifier& rhs) { return lhs.GetIdentifierHash() != rhs.GetIdentifierHash(); }
+
+	private:
+
+		/**
+		 * Resets to the empty state, used when moved from
+		 */
+		void Clear()
+		{
+			m_Data = nullptr;
+			m_Size = 0;
+			m_Hash = 0;
+#ifdef NOBLE_WIDE_IDENTIFIERS
+			m_WideHash = 0;
+#endif
+		}
 
 	private:
 
@@ -593,8 +887,12 @@ namespace Noble
 		const char* m_Data;
 		// Length of the original string
 		Size m_Size;
-		// Hash of the string
+		// 32-bit hash of the string, returned by GetHash()
 		U32 m_Hash;
+#ifdef NOBLE_WIDE_IDENTIFIERS
+		// 64-bit hash of the string, used for comparisons
+		U64 m_WideHash;
+#endif
 	};
 
 	/**
@@ -602,7 +900,11 @@ namespace Noble
 	 */
 	constexpr NIdentifier operator "" _ID(const char* in, Size len)
 	{
+#ifdef NOBLE_WIDE_IDENTIFIERS
+		return NIdentifier(in, len, HashString64(in, len));
+#else
 		return NIdentifier(in, len, HashString(in));
+#endif
 	}
 }
 
@@ -615,8 +917,15 @@ namespace Noble
  * hash as long as the argument to the hash is a literal or can be deduced at compile time.
  */
 
-// Returns a hash (of type U32) of the given string
-#define HASH(x) ([&] { return ::Noble::HashString(x); }())
+// Returns a hash (of type U32) of the given string, matching NIdentifier::GetHash()
+#define HASH(x) ([&] { return ::Noble::HashIdentifier(x); }())
+
+// Returns a 64-bit hash of the given string literal
+#define HASH64(x) ([] { constexpr ::Noble::U64 hash = x##_hash64; return hash; }())
 
 // Creates an NIdentifier from the given string literal
-#define ID(x) ([] { constexpr ::Noble::Size len = x##_len; constexpr ::Noble::U32 hash = x##_hash; return ::Noble::NIdentifier(x, len, hash); }())
\ No newline at end of file
+#ifdef NOBLE_WIDE_IDENTIFIERS
+#define ID(x) ([] { constexpr ::Noble::Size len = x##_len; constexpr ::Noble::U64 wide = x##_hash64; return ::Noble::NIdentifier(x, len, wide); }())
+#else
+#define ID(x) ([] { constexpr ::Noble::Size len = x##_len; constexpr ::Noble::U32 hash = x##_hash; return ::Noble::NIdentifier(x, len, hash); }())
+#endif
\ No newline at end of file
@@ -18,12 +18,22 @@ namespace Noble
 		GetAssetManager()->RegisterAsset(ID("TestTex"), "Content/TestTex.dds", AssetType::AT_TEXTURE2D);
 		GetAssetManager()->RegisterAsset(ID("TestMesh3"), "Content/TestMesh3.bin", AssetType::AT_STATIC_MESH);
 
+		// Requesting the material requests its shader and texture alongside it
+		Array<NIdentifier> materialDependencies;
+		materialDependencies.Add(ID("TestShader"));
+		materialDependencies.Add(ID("TestTex"));
+		GetAssetManager()->SetAssetDependencies(ID("TestMaterial"), materialDependencies);
+
 		m_TestObject1 = GetWorld()->SpawnGameObject<TestGameObject>();
 		m_TestObject2 = GetWorld()->SpawnGameObject<TestGameObject>();
 		m_TestObject3 = GetWorld()->SpawnGameObject<TestGameObject>();
 
 		m_TestMesh = GetAssetManager()->GetStaticMesh(ID("TestMesh3"));
 
+		// Test background loading; the cube is used for spawned objects once it's in
+		m_CubeMesh = GetAssetManager()->RequestAsset<StaticMesh>(ID("CubeMesh"), AssetLoadPriority::Normal,
+			[](Asset* asset) { NE_LOG_INFO("Background load of CubeMesh %s", asset ? "finished" : "failed"); });
+
 		// Test shader loading
 		m_TestShader = GetAssetManager()->GetShader(ID("TestShader"));
 
@@ -88,7 +98,7 @@ namespace Noble
 			BENCHMARK(ObjectCreation);
 			// spawn another object
 			auto newObj = GetWorld()->SpawnGameObject<TestPlayer>(Vector3f(0, -5, 0));
-			newObj->GetRootComponent()->IsA<StaticMeshComponent>()->SetMesh(m_TestMesh);
+			newObj->GetRootComponent()->IsA<StaticMeshComponent>()->SetMesh(m_CubeMesh.IsReady() ? m_CubeMesh.Get() : m_TestMesh);
 			newObj->GetRootComponent()->IsA<StaticMeshComponent>()->SetMaterial(m_TestMat);
 			auto newPC = GetWorld()->CreateController<PlayerController>();
 			newPC->Possess(newObj);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "AssetLoader.h"
 #include "GameInstance.h"
 #include "Material.h"
 #include "Shader.h"
@@ -33,5 +34,7 @@ namespace Noble
 		StaticMesh* m_TestMesh;
 		Shader* m_TestShader;
 		Material* m_TestMat;
+		// Loaded in the background while the scene starts
+		AssetHandle<StaticMesh> m_CubeMesh;
 	};
 }
\ No newline at end of file
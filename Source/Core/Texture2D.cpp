@@ -1,33 +1,60 @@
 #include "Texture2D.h"
 
+#include <utility>
+
 #include "Logger.h"
 
 namespace Noble
 {
 
 	Texture2D::Texture2D()
-		: m_TexHandle()
+		: m_TexHandle(BGFX_INVALID_HANDLE), m_PendingData(nullptr), m_PendingSize(0), m_StorageSize(0)
 	{}
 
-	void Texture2D::CreateFromBuffer(BitStream& data)
+	bool Texture2D::ParseBuffer(BitStreamView& data)
 	{
-		// TODO: There's certainly a way to optimize this to not require a memcpy
-		const Size bufSize = data.GetStoredBytes();
-		void* buf = Memory::Malloc(bufSize, 16);
-		Memory::Memcpy(buf, data.GetData(), bufSize);
+		m_PendingSize = data.GetRemainingBytes();
+		m_PendingData = data.ReadSpan(m_PendingSize);
+
+		return m_PendingData && m_PendingSize > 0;
+	}
 
-		const bgfx::Memory* mem = bgfx::makeRef((const void*)buf, U32(bufSize), 
-			[] (void* data, void*) -> void { Memory::Free(data); }); // lambda is for freeing the buffer allocated above
+	void Texture2D::CreateResources()
+	{
+		// The data points into the mapped file, which is unmapped once loading finishes,
+		// so this is the one copy the data needs: straight from the page cache to bgfx
+		const bgfx::Memory* mem = bgfx::copy(m_PendingData, U32(m_PendingSize));
+		m_PendingData = nullptr;
 
-		m_TexHandle = bgfx::createTexture(mem);
+		bgfx::TextureInfo info;
+		m_TexHandle = bgfx::createTexture(mem, BGFX_TEXTURE_NONE | BGFX_SAMPLER_NONE, 0, &info);
 		if (!bgfx::isValid(m_TexHandle))
 		{
 			NE_LOG_ERROR("Failed to create texture");
+			return;
 		}
+
+		m_StorageSize = info.storageSize;
 	}
 
 	void Texture2D::Destroy()
 	{
-		bgfx::destroy(m_TexHandle);
+		if (bgfx::isValid(m_TexHandle))
+		{
+			bgfx::destroy(m_TexHandle);
+		}
+
+		m_TexHandle = BGFX_INVALID_HANDLE;
+		m_StorageSize = 0;
+		m_PendingData = nullptr;
+	}
+
+	void Texture2D::SwapContents(Asset& other)
+	{
+		Texture2D& texture = static_cast<Texture2D&>(other);
+		std::swap(m_TexHandle, texture.m_TexHandle);
+		std::swap(m_PendingData, texture.m_PendingData);
+		std::swap(m_PendingSize, texture.m_PendingSize);
+		std::swap(m_StorageSize, texture.m_StorageSize);
 	}
 }
\ No newline at end of file
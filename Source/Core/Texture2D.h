@@ -14,6 +14,8 @@ namespace Noble
 	{
 	public:
 
+		static constexpr AssetType StaticType = AssetType::AT_TEXTURE2D;
+
 		/**
 		 * Default constructor
 		 */
@@ -22,7 +24,12 @@ namespace Noble
 		/**
 		 * Returns the corresponding asset type for 2D textures
 		 */
-		virtual const AssetType GetType() const override { return AssetType::AT_TEXTURE2D; }
+		virtual const AssetType GetType() const override { return StaticType; }
+
+		/**
+		 * Counts the texture's storage as reported by bgfx
+		 */
+		virtual AssetMemoryUsage GetMemoryUsage() const override { return AssetMemoryUsage(sizeof(Texture2D), m_StorageSize); }
 
 		/**
 		 * Returns the handle to the loaded texture
@@ -32,18 +39,30 @@ namespace Noble
 	protected:
 
 		/**
-		 * Creates the texture from the given data stream
+		 * Locates the texture data in the given data stream
 		 */
-		virtual void CreateFromBuffer(BitStream& data) override;
+		virtual bool ParseBuffer(BitStreamView& data) override;
+
+		/**
+		 * Creates the texture from the located data
+		 */
+		virtual void CreateResources() override;
 
 		/**
 		 * Frees memory and releases resources for the texture
 		 */
 		virtual void Destroy() override;
 
+		virtual void SwapContents(Asset& other) override;
+
 	private:
 
 		// Texture Handle
 		bgfx::TextureHandle m_TexHandle;
+		// Texture data found by ParseBuffer, in the buffer being loaded, until CreateResources
+		const Byte* m_PendingData;
+		Size m_PendingSize;
+		// Size of the texture, mips included
+		Size m_StorageSize;
 	};
 }
\ No newline at end of file
@@ -94,13 +94,14 @@ namespace Noble
 		 */
 		static U64 GetFrameRate();
 
-	private:
-
 		/**
 		 * Initializes default values and system variables
+		 * The engine calls this on startup; tools that time work without it must call it first
 		 */
 		static void Initialize();
 
+	private:
+
 		/**
 		 * Resets the loop clock and stores new delta information
 		 */
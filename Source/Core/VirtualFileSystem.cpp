@@ -0,0 +1,539 @@
+#include "VirtualFileSystem.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Logger.h"
+#include "PackFile.h"
+#include "String.h"
+
+namespace Noble
+{
+	namespace
+	{
+		/**
+		 * Returns the path in its canonical form: '/' separators, no leading "./" or '/', no trailing '/'
+		 * Paths already in that form are returned as-is, others are rewritten into @scratch
+		 */
+		const char* NormalizePath(const char* path, Array<char>& scratch, Size& length)
+		{
+			while (path[0] == '/' || path[0] == '\\' || (path[0] == '.' && (path[1] == '/' || path[1] == '\\')))
+			{
+				path += path[0] == '.' ? 2 : 1;
+			}
+
+			length = std::strlen(path);
+			const bool hasBackslash = std::memchr(path, '\\', length) != nullptr;
+			const bool hasTrailingSlash = length > 0 && (path[length - 1] == '/' || path[length - 1] == '\\');
+			if (!hasBackslash && !hasTrailingSlash)
+			{
+				return path;
+			}
+
+			scratch.Empty();
+			for (Size i = 0; i < length; ++i)
+			{
+				scratch.Add(path[i] == '\\' ? '/' : path[i]);
+			}
+			while (scratch.GetCount() > 0 && scratch[scratch.GetCount() - 1] == '/')
+			{
+				scratch.RemoveAt(scratch.GetCount() - 1);
+			}
+			length = scratch.GetCount();
+			scratch.Add('\0');
+
+			return scratch.GetData();
+		}
+
+		/**
+		 * Orders resolved files by hash, then by path
+		 */
+		int CompareResolved(U64 lhsHash, const char* lhsPath, U64 rhsHash, const char* rhsPath)
+		{
+			if (lhsHash != rhsHash)
+			{
+				return lhsHash < rhsHash ? -1 : 1;
+			}
+			return std::strcmp(lhsPath, rhsPath);
+		}
+	}
+
+	VfsFile::VfsFile()
+		: m_Data(nullptr), m_Size(0), m_Valid(false)
+	{}
+
+	VfsFile::VfsFile(VfsFile&& other) noexcept
+		: m_Data(other.m_Data), m_Size(other.m_Size), m_Valid(other.m_Valid),
+		m_Mapping(std::move(other.m_Mapping)), m_Owned(std::move(other.m_Owned))
+	{
+		other.m_Data = nullptr;
+		other.m_Size = 0;
+		other.m_Valid = false;
+	}
+
+	VfsFile& VfsFile::operator=(VfsFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Close();
+
+			m_Data = other.m_Data;
+			m_Size = other.m_Size;
+			m_Valid = other.m_Valid;
+			m_Mapping = std::move(other.m_Mapping);
+			m_Owned = std::move(other.m_Owned);
+
+			other.m_Data = nullptr;
+			other.m_Size = 0;
+			other.m_Valid = false;
+		}
+		return *this;
+	}
+
+	void VfsFile::SetView(const Byte* data, Size size)
+	{
+		Close();
+
+		m_Data = data;
+		m_Size = size;
+		m_Valid = true;
+	}
+
+	bool VfsFile::MapFile(const fs::path& path, MappedFile::CacheHint hint)
+	{
+		Close();
+
+		if (!m_Mapping.Open(path, 0, hint))
+		{
+			// Empty files can't be mapped, but they do exist
+			std::error_code error;
+			if (fs::is_regular_file(path, error) && fs::file_size(path, error) == 0)
+			{
+				m_Valid = true;
+				return true;
+			}
+			return false;
+		}
+
+		m_Data = reinterpret_cast<const Byte*>(m_Mapping.GetData());
+		m_Size = m_Mapping.GetMappedSize();
+		m_Valid = true;
+		return true;
+	}
+
+	void VfsFile::SetOwned(BitStream&& data)
+	{
+		Close();
+
+		m_Owned = std::move(data);
+		m_Data = m_Owned.GetData();
+		m_Size = m_Owned.GetStoredBytes();
+		m_Valid = true;
+	}
+
+	void VfsFile::Close()
+	{
+		if (m_Mapping.IsValid())
+		{
+			m_Mapping.Close();
+		}
+		m_Owned = BitStream();
+
+		m_Data = nullptr;
+		m_Size = 0;
+		m_Valid = false;
+	}
+
+	DirectoryMount::DirectoryMount(const fs::path& root)
+		: m_Index(&m_OwnedIndex)
+	{
+		m_OwnedIndex.Build(root);
+	}
+
+	DirectoryMount::DirectoryMount(const DirectoryIndex& index)
+		: m_Index(&index)
+	{}
+
+	void DirectoryMount::ListFiles(Array<char>& paths) const
+	{
+		for (const DirectoryEntry& entry : m_Index->GetEntries())
+		{
+			paths.AddMultiple(m_Index->GetPath(entry), Size(entry.PathLength) + 1);
+		}
+	}
+
+	bool DirectoryMount::Open(const char* path, VfsFile& file) const
+	{
+		return file.MapFile(m_Index->GetRoot() / path);
+	}
+
+	bool DirectoryMount::Exists(const char* path) const
+	{
+		return m_Index->Find(path) != nullptr;
+	}
+
+	fs::path DirectoryMount::GetNativePath(const char* path) const
+	{
+		return m_Index->GetRoot() / path;
+	}
+
+	void MemoryMount::AddFile(const char* path, const void* data, Size size, bool copy)
+	{
+		CHECK(data || size == 0);
+
+		MemoryFile file;
+		file.FileSize = size;
+		file.Data = static_cast<const Byte*>(data);
+		file.StorageOffset = SizeMaxValue;
+		if (copy && size > 0)
+		{
+			file.StorageOffset = m_Storage.GetStoredBytes();
+			m_Storage.WriteBytes(static_cast<const Byte*>(data), size);
+			file.Data = nullptr;
+		}
+
+		// Replacing keeps the old copy in storage; memory mounts are expected to be small
+		for (MemoryFile& existing : m_Files)
+		{
+			if (std::strcmp(m_Paths.GetData() + existing.PathOffset, path) == 0)
+			{
+				file.PathOffset = existing.PathOffset;
+				existing = file;
+				return;
+			}
+		}
+
+		file.PathOffset = static_cast<U32>(m_Paths.GetCount());
+		m_Paths.AddMultiple(path, std::strlen(path) + 1);
+		m_Files.Add(file);
+	}
+
+	void MemoryMount::ListFiles(Array<char>& paths) const
+	{
+		for (const MemoryFile& file : m_Files)
+		{
+			const char* path = m_Paths.GetData() + file.PathOffset;
+			paths.AddMultiple(path, std::strlen(path) + 1);
+		}
+	}
+
+	bool MemoryMount::Open(const char* path, VfsFile& file) const
+	{
+		const MemoryFile* found = FindFile(path);
+		if (!found)
+		{
+			return false;
+		}
+
+		// Copies can't be handed out by pointer, the storage moves when more files are added
+		if (found->StorageOffset != SizeMaxValue)
+		{
+			file.SetOwned(BitStream(m_Storage.GetData() + found->StorageOffset, found->FileSize));
+		}
+		else
+		{
+			file.SetView(found->Data, found->FileSize);
+		}
+		return true;
+	}
+
+	const MemoryMount::MemoryFile* MemoryMount::FindFile(const char* path) const
+	{
+		for (const MemoryFile& file : m_Files)
+		{
+			if (std::strcmp(m_Paths.GetData() + file.PathOffset, path) == 0)
+			{
+				return &file;
+			}
+		}
+		return nullptr;
+	}
+
+	VirtualFileSystem::VirtualFileSystem()
+		: m_NextHandle(1)
+	{}
+
+	VirtualFileSystem::~VirtualFileSystem()
+	{
+		for (MountPoint& mount : m_Mounts)
+		{
+			delete mount.Backend;
+		}
+	}
+
+	VfsMountHandle VirtualFileSystem::Mount(const char* virtualPrefix, VfsMount* mount, I32 priority)
+	{
+		CHECK(mount);
+
+		Array<char> scratch;
+		Size length = 0;
+		const char* prefix = NormalizePath(virtualPrefix, scratch, length);
+
+		MountPoint point;
+		point.Handle = m_NextHandle++;
+		point.Backend = mount;
+		point.Priority = priority;
+		point.PrefixOffset = static_cast<U32>(m_PrefixPool.GetCount());
+		m_PrefixPool.AddMultiple(prefix, length + 1);
+		m_Mounts.Add(point);
+
+		Rebuild();
+
+		return point.Handle;
+	}
+
+	VfsMountHandle VirtualFileSystem::MountDirectory(const char* virtualPrefix, const fs::path& root, I32 priority)
+	{
+		std::error_code error;
+		if (!fs::is_directory(root, error))
+		{
+			NE_LOG_WARNING("Can't mount %s: not a directory", root.string().c_str());
+			return 0;
+		}
+
+		return Mount(virtualPrefix, new DirectoryMount(root), priority);
+	}
+
+	VfsMountHandle VirtualFileSystem::MountPack(const char* virtualPrefix, const fs::path& path, I32 priority)
+	{
+		PackMount* mount = new PackMount(path);
+		if (!mount->IsOpen())
+		{
+			// The pack already logged why
+			delete mount;
+			return 0;
+		}
+
+		return Mount(virtualPrefix, mount, priority);
+	}
+
+	bool VirtualFileSystem::Unmount(VfsMountHandle handle)
+	{
+		for (Size i = 0; i < m_Mounts.GetCount(); ++i)
+		{
+			if (m_Mounts[i].Handle == handle)
+			{
+				delete m_Mounts[i].Backend;
+				m_Mounts.RemoveAt(i);
+
+				Rebuild();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	VfsMount* VirtualFileSystem::GetMount(VfsMountHandle handle) const
+	{
+		for (const MountPoint& mount : m_Mounts)
+		{
+			if (mount.Handle == handle)
+			{
+				return mount.Backend;
+			}
+		}
+		return nullptr;
+	}
+
+	void VirtualFileSystem::Rebuild()
+	{
+		m_Entries.Empty();
+		m_PathPool.Empty();
+
+		// Every file of every mount, including ones that will be hidden by an overlay
+		Array<ResolvedFile> candidates;
+		Array<char> listed;
+		for (Size mountIndex = 0; mountIndex < m_Mounts.GetCount(); ++mountIndex)
+		{
+			const MountPoint& mount = m_Mounts[mountIndex];
+			const char* prefix = m_PrefixPool.GetData() + mount.PrefixOffset;
+			const Size prefixLength = std::strlen(prefix);
+
+			listed.Empty();
+			mount.Backend->ListFiles(listed);
+
+			for (Size i = 0; i < listed.GetCount(); )
+			{
+				const char* relative = listed.GetData() + i;
+				const Size relativeLength = std::strlen(relative);
+				i += relativeLength + 1;
+
+				ResolvedFile file;
+				file.Mount = static_cast<U32>(mountIndex);
+				file.PathOffset = static_cast<U32>(m_PathPool.GetCount());
+				file.PrefixLength = prefixLength > 0 ? static_cast<U32>(prefixLength + 1) : 0;
+
+				if (prefixLength > 0)
+				{
+					m_PathPool.AddMultiple(prefix, prefixLength);
+					m_PathPool.Add('/');
+				}
+				m_PathPool.AddMultiple(relative, relativeLength + 1);
+
+				file.Hash = HashString64(m_PathPool.GetData() + file.PathOffset, file.PrefixLength + relativeLength);
+				candidates.Add(file);
+			}
+		}
+
+		// Group identical paths together with the winning mount first: higher priority, then later mount
+		const char* paths = m_PathPool.GetData();
+		const MountPoint* mounts = m_Mounts.GetData();
+		std::sort(candidates.GetData(), candidates.GetData() + candidates.GetCount(),
+			[paths, mounts](const ResolvedFile& lhs, const ResolvedFile& rhs)
+			{
+				const int order = CompareResolved(lhs.Hash, paths + lhs.PathOffset, rhs.Hash, paths + rhs.PathOffset);
+				if (order != 0)
+				{
+					return order < 0;
+				}
+				if (mounts[lhs.Mount].Priority != mounts[rhs.Mount].Priority)
+				{
+					return mounts[lhs.Mount].Priority > mounts[rhs.Mount].Priority;
+				}
+				return lhs.Mount > rhs.Mount;
+			});
+
+		for (const ResolvedFile& file : candidates)
+		{
+			if (m_Entries.GetCount() > 0)
+			{
+				const ResolvedFile& last = m_Entries[m_Entries.GetCount() - 1];
+				if (last.Hash == file.Hash && std::strcmp(paths + last.PathOffset, paths + file.PathOffset) == 0)
+				{
+					// Hidden by a higher priority mount
+					continue;
+				}
+			}
+			m_Entries.Add(file);
+		}
+	}
+
+	void VirtualFileSystem::UpdatePath(const char* path)
+	{
+		Array<char> scratch;
+		Size length = 0;
+		const char* normalized = NormalizePath(path, scratch, length);
+		const U64 hash = HashString64(normalized, length);
+
+		// Find the mount a Rebuild would pick: highest priority, then the latest mount
+		Size winner = SizeMaxValue;
+		U32 winnerPrefixLength = 0;
+		for (Size mountIndex = 0; mountIndex < m_Mounts.GetCount(); ++mountIndex)
+		{
+			const MountPoint& mount = m_Mounts[mountIndex];
+			if (winner != SizeMaxValue && m_Mounts[winner].Priority > mount.Priority)
+			{
+				continue;
+			}
+
+			const char* prefix = m_PrefixPool.GetData() + mount.PrefixOffset;
+			const Size prefixLength = std::strlen(prefix);
+			if (prefixLength > 0 && (length <= prefixLength || normalized[prefixLength] != '/' || std::strncmp(normalized, prefix, prefixLength) != 0))
+			{
+				continue;
+			}
+
+			const U32 relativeOffset = prefixLength > 0 ? static_cast<U32>(prefixLength + 1) : 0;
+			if (mount.Backend->Exists(normalized + relativeOffset))
+			{
+				winner = mountIndex;
+				winnerPrefixLength = relativeOffset;
+			}
+		}
+
+		const char* paths = m_PathPool.GetData();
+		ResolvedFile* entries = m_Entries.GetData();
+		ResolvedFile* end = entries + m_Entries.GetCount();
+		ResolvedFile* found = std::lower_bound(entries, end, normalized,
+			[paths, hash](const ResolvedFile& entry, const char* value)
+			{
+				return CompareResolved(entry.Hash, paths + entry.PathOffset, hash, value) < 0;
+			});
+		const Size position = found - entries;
+		const bool listed = found != end && found->Hash == hash && std::strcmp(paths + found->PathOffset, normalized) == 0;
+
+		if (winner == SizeMaxValue)
+		{
+			// The path stays in the pool until the next Rebuild
+			if (listed)
+			{
+				m_Entries.RemoveAt(position);
+			}
+			return;
+		}
+
+		if (listed)
+		{
+			found->Mount = static_cast<U32>(winner);
+			found->PrefixLength = winnerPrefixLength;
+			return;
+		}
+
+		ResolvedFile file;
+		file.Hash = hash;
+		file.Mount = static_cast<U32>(winner);
+		file.PathOffset = static_cast<U32>(m_PathPool.GetCount());
+		file.PrefixLength = winnerPrefixLength;
+		m_PathPool.AddMultiple(normalized, length + 1);
+
+		if (position < m_Entries.GetCount())
+		{
+			m_Entries.Insert(file, position);
+		}
+		else
+		{
+			m_Entries.Add(file);
+		}
+	}
+
+	bool VirtualFileSystem::Exists(const char* path) const
+	{
+		return Resolve(path) != nullptr;
+	}
+
+	bool VirtualFileSystem::Open(const char* path, VfsFile& file) const
+	{
+		const ResolvedFile* resolved = Resolve(path);
+		if (!resolved)
+		{
+			return false;
+		}
+
+		const char* relative = m_PathPool.GetData() + resolved->PathOffset + resolved->PrefixLength;
+		return m_Mounts[resolved->Mount].Backend->Open(relative, file);
+	}
+
+	fs::path VirtualFileSystem::GetNativePath(const char* path) const
+	{
+		const ResolvedFile* resolved = Resolve(path);
+		if (!resolved)
+		{
+			return fs::path();
+		}
+
+		const char* relative = m_PathPool.GetData() + resolved->PathOffset + resolved->PrefixLength;
+		return m_Mounts[resolved->Mount].Backend->GetNativePath(relative);
+	}
+
+	const VirtualFileSystem::ResolvedFile* VirtualFileSystem::Resolve(const char* path) const
+	{
+		Array<char> scratch;
+		Size length = 0;
+		const char* normalized = NormalizePath(path, scratch, length);
+		const U64 hash = HashString64(normalized, length);
+
+		const ResolvedFile* entries = m_Entries.GetData();
+		const ResolvedFile* end = entries + m_Entries.GetCount();
+		const ResolvedFile* found = std::lower_bound(entries, end, hash,
+			[](const ResolvedFile& entry, U64 value) { return entry.Hash < value; });
+
+		for (; found != end && found->Hash == hash; ++found)
+		{
+			if (std::strcmp(m_PathPool.GetData() + found->PathOffset, normalized) == 0)
+			{
+				return found;
+			}
+		}
+		return nullptr;
+	}
+}
\ No newline at end of file
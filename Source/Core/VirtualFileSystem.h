@@ -0,0 +1,313 @@
+#pragma once
+
+#include "Array.h"
+#include "BitStream.h"
+#include "DirectoryIndex.h"
+#include "FileSystem.h"
+#include "Types.h"
+
+namespace Noble
+{
+	/**
+	 * A file opened through the VirtualFileSystem
+	 * Holds whatever keeps the data alive: a mapping of a loose file, a copy, or nothing when
+	 * the data lives in memory owned by the mount. Move-only.
+	 */
+	class VfsFile
+	{
+	public:
+
+		VfsFile();
+
+		VfsFile(VfsFile&& other) noexcept;
+		VfsFile& operator=(VfsFile&& other) noexcept;
+
+		NO_COPY(VfsFile)
+
+		/**
+		 * Points the file at data that outlives it
+		 */
+		void SetView(const Byte* data, Size size);
+
+		/**
+		 * Maps the file at the native path
+		 */
+		bool MapFile(const fs::path& path, MappedFile::CacheHint hint = MappedFile::SequentialScan);
+
+		/**
+		 * Takes ownership of the stored bytes of @data
+		 */
+		void SetOwned(BitStream&& data);
+
+		/**
+		 * Releases the data
+		 */
+		void Close();
+
+		/**
+		 * Returns true if the file holds data
+		 */
+		bool IsValid() const { return m_Valid; }
+
+		/**
+		 * Returns a view over the whole file
+		 */
+		BitStreamView GetView() const { return BitStreamView(m_Data, m_Size); }
+
+		const Byte* GetData() const { return m_Data; }
+		Size GetSize() const { return m_Size; }
+
+	private:
+
+		// Start and size of the data
+		const Byte* m_Data;
+		Size m_Size;
+		// Set once the file holds data, which may be empty
+		bool m_Valid;
+		// Set for loose files
+		MappedFile m_Mapping;
+		// Set when the data had to be copied or decoded
+		BitStream m_Owned;
+	};
+
+	/**
+	 * Backend behind a mount point
+	 * Paths given to a mount are relative to its mount point, '/'-separated
+	 */
+	class VfsMount
+	{
+	public:
+
+		virtual ~VfsMount() {}
+
+		/**
+		 * Appends the null-terminated path of every file in the mount to @paths
+		 */
+		virtual void ListFiles(Array<char>& paths) const = 0;
+
+		/**
+		 * Opens the file into @file. Returns false if it doesn't exist or can't be read
+		 */
+		virtual bool Open(const char* path, VfsFile& file) const = 0;
+
+		/**
+		 * Returns true if the mount holds the file
+		 */
+		virtual bool Exists(const char* path) const = 0;
+
+		/**
+		 * Returns the path of the file on disk, or an empty path if it isn't a loose file
+		 */
+		virtual fs::path GetNativePath(const char* path) const { return fs::path(); }
+	};
+
+	/**
+	 * Loose files in a directory on disk, listed through a DirectoryIndex
+	 */
+	class DirectoryMount : public VfsMount
+	{
+	public:
+
+		/**
+		 * Indexes @root and serves files from it
+		 */
+		explicit DirectoryMount(const fs::path& root);
+
+		/**
+		 * Serves the files of an index kept by someone else, such as one updated by a FileWatcher
+		 * The index must outlive the mount
+		 */
+		explicit DirectoryMount(const DirectoryIndex& index);
+
+		virtual void ListFiles(Array<char>& paths) const override;
+
+		virtual bool Open(const char* path, VfsFile& file) const override;
+
+		virtual bool Exists(const char* path) const override;
+
+		virtual fs::path GetNativePath(const char* path) const override;
+
+	private:
+
+		// Used when the mount indexes the directory itself
+		DirectoryIndex m_OwnedIndex;
+		// The index in use, either m_OwnedIndex or a shared one
+		const DirectoryIndex* m_Index;
+	};
+
+	/**
+	 * Files held in memory, for generated content, tests and embedded defaults
+	 */
+	class MemoryMount : public VfsMount
+	{
+	public:
+
+		/**
+		 * Adds or replaces a file. With @copy false the data must outlive the mount.
+		 * Call VirtualFileSystem::Rebuild after adding files to an existing mount.
+		 */
+		void AddFile(const char* path, const void* data, Size size, bool copy = true);
+
+		virtual void ListFiles(Array<char>& paths) const override;
+
+		virtual bool Open(const char* path, VfsFile& file) const override;
+
+		virtual bool Exists(const char* path) const override { return FindFile(path) != nullptr; }
+
+	private:
+
+		struct MemoryFile
+		{
+			// Offset of the path in m_Paths
+			U32 PathOffset;
+			// Offset of copied data in m_Storage, or SizeMaxValue if @Data is external
+			Size StorageOffset;
+			const Byte* Data;
+			Size FileSize;
+		};
+
+		// Returns the file with the path, or nullptr
+		const MemoryFile* FindFile(const char* path) const;
+
+		Array<MemoryFile> m_Files;
+		Array<char> m_Paths;
+		// Copies of added data
+		BitStream m_Storage;
+	};
+
+	// Identifies a mount; 0 is never used
+	typedef U32 VfsMountHandle;
+
+	/**
+	 * Maps virtual paths onto mounted backends
+	 *
+	 * Each mount serves a virtual prefix ("Content" makes a mount's "a/b.bin" visible as
+	 * "Content/a/b.bin"). Mounts overlay each other: when several provide the same virtual path,
+	 * the highest priority wins, and the most recent mount wins a tie. So a pack can be mounted
+	 * in shipping builds and a loose directory layered on top of it during development, without
+	 * callers noticing.
+	 *
+	 * Every visible file is resolved once, into a table sorted by a 64-bit hash of the path, so a
+	 * lookup is a binary search plus one string compare regardless of the number of mounts.
+	 * The table is rebuilt when mounts change; call Rebuild if a mount's contents change, or
+	 * UpdatePath if only a few of its files were added or removed.
+	 */
+	class VirtualFileSystem
+	{
+	public:
+
+		VirtualFileSystem();
+
+		/**
+		 * Unmounts everything
+		 */
+		~VirtualFileSystem();
+
+		NO_COPY_NO_MOVE(VirtualFileSystem)
+
+		/**
+		 * Mounts @mount at @virtualPrefix, taking ownership of it
+		 */
+		VfsMountHandle Mount(const char* virtualPrefix, VfsMount* mount, I32 priority = 0);
+
+		/**
+		 * Mounts a loose directory
+		 */
+		VfsMountHandle MountDirectory(const char* virtualPrefix, const fs::path& root, I32 priority = 0);
+
+		/**
+		 * Mounts a pack (see PackFile). Returns 0 if it can't be opened
+		 */
+		VfsMountHandle MountPack(const char* virtualPrefix, const fs::path& path, I32 priority = 0);
+
+		/**
+		 * Removes and destroys a mount
+		 */
+		bool Unmount(VfsMountHandle handle);
+
+		/**
+		 * Returns the mount of the handle, or nullptr
+		 */
+		VfsMount* GetMount(VfsMountHandle handle) const;
+
+		/**
+		 * Re-lists every mount and rebuilds the lookup table
+		 */
+		void Rebuild();
+
+		/**
+		 * Resolves one virtual path again after its file was added to or removed from a mount
+		 * Only the mounts covering the path are asked, nothing is re-listed
+		 */
+		void UpdatePath(const char* path);
+
+		/**
+		 * Returns true if the virtual path resolves to a file
+		 */
+		bool Exists(const char* path) const;
+
+		/**
+		 * Opens the file the virtual path resolves to
+		 */
+		bool Open(const char* path, VfsFile& file) const;
+
+		/**
+		 * Returns the path on disk the virtual path resolves to, or an empty path if it isn't a loose file
+		 */
+		fs::path GetNativePath(const char* path) const;
+
+		/**
+		 * Returns the number of visible files
+		 */
+		Size GetFileCount() const { return m_Entries.GetCount(); }
+
+		/**
+		 * Returns true if anything is mounted
+		 */
+		bool HasMounts() const { return m_Mounts.GetCount() > 0; }
+
+	private:
+
+		/**
+		 * A mount and where it's attached
+		 */
+		struct MountPoint
+		{
+			VfsMountHandle Handle;
+			VfsMount* Backend;
+			I32 Priority;
+			// Offset of the normalized prefix in m_PrefixPool
+			U32 PrefixOffset;
+		};
+
+		/**
+		 * A resolved virtual path
+		 */
+		struct ResolvedFile
+		{
+			U64 Hash;
+			// Index into m_Mounts
+			U32 Mount;
+			// Offset of the virtual path in m_PathPool
+			U32 PathOffset;
+			// Length of the mount's prefix in the virtual path, including the '/'
+			U32 PrefixLength;
+		};
+
+		/**
+		 * Returns the resolved file for the virtual path, or nullptr
+		 */
+		const ResolvedFile* Resolve(const char* path) const;
+
+	private:
+
+		// Mounts, in the order they were added
+		Array<MountPoint> m_Mounts;
+		Array<char> m_PrefixPool;
+		// Visible files, sorted by hash
+		Array<ResolvedFile> m_Entries;
+		Array<char> m_PathPool;
+		// Source of mount handles
+		VfsMountHandle m_NextHandle;
+	};
+}
\ No newline at end of file
@@ -6,7 +6,10 @@
 namespace Noble
 {
 	World::World()
-	{}
+	{
+		m_Events.Subscribe<ActionInputEvent>(this, &World::HandleActionInput);
+		m_Events.Subscribe<AnalogInputEvent>(this, &World::HandleAnalogInput);
+	}
 
 	GameObject* World::SpawnGameObject(NClass* type, Vector3f spawnPos)
 	{
@@ -48,6 +51,9 @@ namespace Noble
 			control->Update();
 		}
 
+		// Deliver input and anything else the controllers sent before objects update
+		m_Events.Dispatch();
+
 		for (GameObject* obj : m_GameObjects)
 		{
 			obj->Update();
@@ -59,6 +65,9 @@ namespace Noble
 				}
 			}
 		}
+
+		// Deliver events sent by GameObjects and Components this frame
+		m_Events.Dispatch();
 	}
 
 	void World::FixedUpdate()
@@ -79,6 +88,24 @@ namespace Noble
 				}
 			}
 		}
+
+		m_Events.Dispatch();
+	}
+
+	void World::HandleActionInput(const EventBatch<ActionInputEvent>& batch)
+	{
+		for (const ActionInputEvent& ev : batch)
+		{
+			ev.Target->OnActionInput(ev.BindingId, ev.State);
+		}
+	}
+
+	void World::HandleAnalogInput(const EventBatch<AnalogInputEvent>& batch)
+	{
+		for (const AnalogInputEvent& ev : batch)
+		{
+			ev.Target->OnAnalogInput(ev.BindingId, ev.State);
+		}
 	}
 
 	GameObject* World::BuildGameObject(NClass* type)
@@ -3,6 +3,7 @@
 #include <type_traits>
 
 #include "Array.h"
+#include "EventBus.h"
 #include "GameObject.h"
 #include "Logger.h"
 #include "SceneComponent.h"
@@ -13,6 +14,32 @@ namespace Noble
 
 	class Controller;
 
+	/**
+	 * Sent by a PlayerController when one of its action bindings changes state
+	 */
+	struct ActionInputEvent
+	{
+		// The possessed GameObject receiving the input
+		GameObject* Target;
+		// Hashed name of the binding
+		U32 BindingId;
+		// Whether the binding was pressed or released
+		bool State;
+	};
+
+	/**
+	 * Sent by a PlayerController each frame with the state of an axis binding
+	 */
+	struct AnalogInputEvent
+	{
+		// The possessed GameObject receiving the input
+		GameObject* Target;
+		// Hashed name of the binding
+		U32 BindingId;
+		// Current axis value
+		F32 State;
+	};
+
 	/**
 	 * The World class encompasses a "map" or area of play.
 	 * Worlds hold all of the currently spawned GameObjects.
@@ -99,8 +126,25 @@ namespace Noble
 		 */
 		void FixedUpdate();
 
+		/**
+		 * Returns the event bus for this World
+		 * Events sent during a frame are dispatched in batches after the Controllers update,
+		 * and again after GameObjects and Components update
+		 */
+		EventBus& GetEventBus() { return m_Events; }
+
 	private:
 
+		/**
+		 * Forwards a batch of action inputs to their target GameObjects
+		 */
+		void HandleActionInput(const EventBatch<ActionInputEvent>& batch);
+
+		/**
+		 * Forwards a batch of analog inputs to their target GameObjects
+		 */
+		void HandleAnalogInput(const EventBatch<AnalogInputEvent>& batch);
+
 		/**
 		 * Internal code to create a game object from an NClass
 		 */
@@ -126,5 +170,7 @@ namespace Noble
 		Array<SceneComponent*> m_SceneComponents;
 		// Array of Controllers
 		Array<Controller*> m_Controllers;
+		// Batched event queues for gameplay messaging
+		EventBus m_Events;
 	};
 }
\ No newline at end of file
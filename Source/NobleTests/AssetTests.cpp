@@ -0,0 +1,454 @@
+#include <chrono>
+#include <cstring>
+#include <initializer_list>
+#include <thread>
+
+#include "AssetManager.h"
+#include "FileSystem.h"
+#include "Globals.h"
+#include "StaticMeshFile.h"
+#include "TestFramework.h"
+
+namespace Noble
+{
+	/**
+	 * Writes a cooked mesh of @triangleCount triangles over three vertices to the file
+	 * With @truncate set only the first half is written, which doesn't parse
+	 */
+	static void WriteTestMesh(const fs::path& path, U32 triangleCount, bool truncate = false)
+	{
+		StaticVertex vertices[3];
+		vertices[0].Position = Vector3f(0.0F, 0.0F, 0.0F);
+		vertices[1].Position = Vector3f(1.0F, 0.0F, 0.0F);
+		vertices[2].Position = Vector3f(0.0F, 1.0F, 0.0F);
+
+		Array<StaticMesh::Index> indices;
+		for (U32 i = 0; i < triangleCount * 3; ++i)
+		{
+			indices.Add(i % 3);
+		}
+
+		BitStream cooked;
+		StaticMeshFile::Write(vertices, 3, indices.GetData(), static_cast<U32>(indices.GetCount()), cooked);
+
+		File output(path, FileMode::FILE_WRITE_REPLACE, true);
+		output.Write(cooked.GetData(), truncate ? cooked.GetStoredBytes() / 2 : cooked.GetStoredBytes());
+	}
+
+	/**
+	 * Reloads a mesh after its file is edited, then after an edit that doesn't parse; the
+	 * asset keeps its address throughout and keeps the last good version on a failed reload
+	 */
+	TEST_CASE(AssetHotReload)
+	{
+		const fs::path path = fs::temp_directory_path() / "NobleReloadTest.mesh";
+		WriteTestMesh(path, 1);
+
+		AssetManager* assets = GetAssetManager();
+		const NIdentifier meshID = ID("ReloadTestMesh");
+		assets->RegisterAsset(meshID, path.string().c_str(), AssetType::AT_STATIC_MESH);
+
+		TEST_CHECK(!assets->ReloadAsset(meshID));
+
+		const StaticMesh* mesh = assets->GetStaticMesh(meshID);
+		TEST_CHECK(mesh && mesh->GetIndexCount() == 3);
+
+		WriteTestMesh(path, 4);
+		TEST_CHECK(assets->ReloadAsset(meshID));
+		TEST_CHECK(assets->GetStaticMesh(meshID) == mesh && mesh->GetIndexCount() == 12);
+
+		WriteTestMesh(path, 2, true);
+		TEST_CHECK(!assets->ReloadAsset(meshID));
+		TEST_CHECK(assets->GetStaticMesh(meshID) == mesh && mesh->GetIndexCount() == 12);
+
+		assets->UnloadAsset(meshID);
+		assets->UnregisterAsset(meshID);
+		std::error_code error;
+		fs::remove(path, error);
+	}
+
+	/**
+	 * Writes a shader with @uniformCount Vec4 uniforms and the given stand-in binaries
+	 */
+	static void WriteTestShader(const fs::path& path, U32 uniformCount, const char* binary)
+	{
+		const char* names[] = { "u_color", "u_tint", "u_params" };
+		CHECK(uniformCount <= 3);
+
+		BitStream shader;
+		shader.Write<I32>(uniformCount);
+		for (U32 i = 0; i < uniformCount; ++i)
+		{
+			const U8 length = static_cast<U8>(std::strlen(names[i]));
+			shader.Write<U8>(length);
+			shader.WriteBytes(names[i], length);
+			// Vec4, one element
+			shader.Write<U32>(1);
+			shader.Write<U32>(1);
+		}
+		for (U32 stage = 0; stage < 2; ++stage)
+		{
+			const U32 size = static_cast<U32>(std::strlen(binary));
+			shader.Write<U32>(size);
+			shader.WriteBytes(binary, size);
+		}
+
+		File output(path, FileMode::FILE_WRITE_REPLACE, true);
+		output.Write(shader.GetData(), shader.GetStoredBytes());
+	}
+
+	/**
+	 * Reloads a shader whose binaries changed, then refuses one whose uniforms changed, since
+	 * Materials keep their values at offsets into the loaded uniform table
+	 */
+	TEST_CASE(AssetShaderReload)
+	{
+		const fs::path path = fs::temp_directory_path() / "NobleReloadTest.shader";
+		WriteTestShader(path, 2, "first");
+
+		AssetManager* assets = GetAssetManager();
+		const NIdentifier shaderID = ID("ReloadTestShader");
+		assets->RegisterAsset(shaderID, path.string().c_str(), AssetType::AT_SHADER);
+
+		Shader* shader = assets->GetShader(shaderID);
+		TEST_CHECK(shader && shader->GetUniformCount() == 2);
+		const U32 bufferSize = shader->GetUniformBufferSize();
+
+		WriteTestShader(path, 2, "second version");
+		TEST_CHECK(assets->ReloadAsset(shaderID));
+		TEST_CHECK(assets->GetShader(shaderID) == shader && shader->GetUniformCount() == 2);
+		TEST_CHECK(shader->GetUniformOffset(ID("u_tint")) == shader->GetUniformSize(0));
+
+		WriteTestShader(path, 3, "third");
+		TEST_CHECK(!assets->ReloadAsset(shaderID));
+		TEST_CHECK(shader->GetUniformCount() == 2 && shader->GetUniformBufferSize() == bufferSize);
+
+		assets->UnloadAsset(shaderID);
+		assets->UnregisterAsset(shaderID);
+		std::error_code error;
+		fs::remove(path, error);
+	}
+
+	/**
+	 * Returns true if the asset is loaded
+	 */
+	static bool IsAssetLoaded(const NIdentifier& id)
+	{
+		const AssetRegistration* reg = GetAssetManager()->GetRegistry().Find(id);
+		return reg && reg->LoadedAsset;
+	}
+
+	/**
+	 * Loads four equal meshes over several frames and lowers the budget below them: the least
+	 * recently used ones go first, and referenced or pinned ones stay until that's dropped
+	 */
+	TEST_CASE(AssetBudgetEviction)
+	{
+		AssetManager* assets = GetAssetManager();
+		const fs::path path = fs::temp_directory_path() / "NobleEvictionTest.mesh";
+		WriteTestMesh(path, 64);
+
+		NIdentifier ids[4] = { ID("EvictionTestA"), ID("EvictionTestB"), ID("EvictionTestC"), ID("EvictionTestD") };
+		StaticMesh* meshes[4];
+		for (U32 i = 0; i < 4; ++i)
+		{
+			assets->RegisterAsset(ids[i], path.string().c_str(), AssetType::AT_STATIC_MESH);
+			meshes[i] = assets->GetStaticMesh(ids[i]);
+			TEST_CHECK(meshes[i] && meshes[i]->IsPinned());
+			assets->SetAssetPinned(ids[i], false);
+			assets->UpdateResidency();
+		}
+
+		// Using A again makes B the least recently used
+		assets->GetStaticMesh(ids[0]);
+		assets->SetAssetPinned(ids[0], false);
+
+		const Size meshBytes = meshes[0]->GetMemoryUsage().GPUBytes;
+		const Size usedBytes = assets->GetMemoryUsage().GPUBytes;
+		TEST_CHECK(meshBytes > 0);
+
+		// Room for all but two meshes: B and C go, A stays since it was used last
+		assets->SetMemoryBudget(AssetMemoryUsage(0, usedBytes - meshBytes * 2));
+		TEST_CHECK(assets->UpdateResidency() == 2);
+		TEST_CHECK(IsAssetLoaded(ids[0]) && !IsAssetLoaded(ids[1]) && !IsAssetLoaded(ids[2]) && IsAssetLoaded(ids[3]));
+		TEST_CHECK(assets->GetMemoryUsage().GPUBytes == usedBytes - meshBytes * 2);
+
+		// A referenced asset outlives the budget, and a pinned one isn't evicted at all
+		assets->AddAssetRef(meshes[3]);
+		assets->SetAssetPinned(ids[0], true);
+		assets->SetMemoryBudget(AssetMemoryUsage(0, 1));
+		TEST_CHECK(assets->UpdateResidency() == 0);
+		TEST_CHECK(IsAssetLoaded(ids[0]) && IsAssetLoaded(ids[3]));
+
+		assets->ReleaseAssetRef(meshes[3]);
+		TEST_CHECK(assets->UpdateResidency() == 1);
+		TEST_CHECK(IsAssetLoaded(ids[0]) && !IsAssetLoaded(ids[3]));
+
+		assets->SetMemoryBudget(AssetMemoryUsage());
+		for (const NIdentifier& id : ids)
+		{
+			assets->UnloadAsset(id);
+			assets->UnregisterAsset(id);
+		}
+		std::error_code error;
+		fs::remove(path, error);
+	}
+
+	/**
+	 * Starts the asset loader threads, which the other tests don't need
+	 */
+	static AssetManager* GetAsyncAssetManager()
+	{
+		static bool s_Started = false;
+
+		AssetManager* assets = GetAssetManager();
+		if (!s_Started)
+		{
+			assets->LoadAssetRegistry();
+			s_Started = true;
+		}
+		return assets;
+	}
+
+	/**
+	 * Runs ProcessAsyncLoads until no load is pending, or a second has passed
+	 * Returns the number of loads completed
+	 */
+	static U32 FinishAsyncLoads(AssetManager* assets)
+	{
+		U32 completed = 0;
+		for (U32 attempt = 0; attempt < 1000 && assets->GetPendingLoadCount() > 0; ++attempt)
+		{
+			completed += assets->ProcessAsyncLoads(1.0F);
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		// Requests answered without the loader complete here too
+		return completed + assets->ProcessAsyncLoads(1.0F);
+	}
+
+	/**
+	 * Requests a mesh twice while it loads, once more when loaded and an unregistered ID: callbacks
+	 * only run from ProcessAsyncLoads, and the asset stays referenced until every handle is gone
+	 */
+	TEST_CASE(AssetAsyncLoad)
+	{
+		AssetManager* assets = GetAsyncAssetManager();
+		const fs::path path = fs::temp_directory_path() / "NobleAsyncTest.mesh";
+		WriteTestMesh(path, 2);
+
+		const NIdentifier meshID = ID("AsyncTestMesh");
+		assets->RegisterAsset(meshID, path.string().c_str(), AssetType::AT_STATIC_MESH);
+
+		U32 calls = 0;
+		Asset* received = nullptr;
+		AssetHandle<StaticMesh> handle = assets->RequestAsset<StaticMesh>(meshID, AssetLoadPriority::Normal,
+			[&](Asset* asset) { ++calls; received = asset; });
+		AssetHandle<StaticMesh> shared = assets->RequestAsset<StaticMesh>(meshID, AssetLoadPriority::High,
+			[&](Asset* asset) { ++calls; TEST_CHECK(asset == received); });
+		TEST_CHECK(handle.IsValid() && !handle.IsReady() && !handle.Get());
+		TEST_CHECK(assets->GetPendingLoadCount() == 1);
+
+		U32 missingCalls = 0;
+		AssetHandle<StaticMesh> missing = assets->RequestAsset<StaticMesh>(ID("AsyncTestMissing"),
+			AssetLoadPriority::Normal, [&](Asset* asset) { ++missingCalls; TEST_CHECK(!asset); });
+		TEST_CHECK(missing.HasFailed() && calls == 0 && missingCalls == 0);
+
+		TEST_CHECK(FinishAsyncLoads(assets) == 2);
+		StaticMesh* mesh = handle.Get();
+		TEST_CHECK(mesh && mesh->GetIndexCount() == 6 && shared.Get() == mesh);
+		TEST_CHECK(calls == 2 && received == mesh);
+		TEST_CHECK(missing.HasFailed() && !missing.Get() && missingCalls == 1);
+		TEST_CHECK(mesh->GetRefCount() == 1 && !mesh->IsPinned());
+
+		// A loaded asset is ready at once, though its callback still waits for ProcessAsyncLoads
+		AssetHandle<StaticMesh> again = assets->RequestAsset<StaticMesh>(meshID, AssetLoadPriority::Normal,
+			[&](Asset* asset) { ++calls; TEST_CHECK(asset == mesh); });
+		TEST_CHECK(again.Get() == mesh && mesh->GetRefCount() == 2 && calls == 2);
+		TEST_CHECK(assets->ProcessAsyncLoads() == 1 && calls == 3);
+
+		// References are dropped once a request's last handle is
+		AssetHandle<StaticMesh> copy = handle;
+		handle.Reset();
+		shared.Reset();
+		assets->UpdateResidency();
+		TEST_CHECK(mesh->GetRefCount() == 2 && copy.Get() == mesh);
+
+		copy.Reset();
+		assets->UpdateResidency();
+		TEST_CHECK(mesh->GetRefCount() == 1);
+
+		again.Reset();
+		assets->UpdateResidency();
+		TEST_CHECK(mesh->GetRefCount() == 0);
+
+		assets->UnloadAsset(meshID);
+		assets->UnregisterAsset(meshID);
+		std::error_code error;
+		fs::remove(path, error);
+	}
+
+	/**
+	 * Finalizes four parsed meshes with no time to spare: one is finalized per call, highest
+	 * priority first, and the rest follow in request order on the next call
+	 */
+	TEST_CASE(AssetAsyncTimeSlice)
+	{
+		AssetManager* assets = GetAsyncAssetManager();
+		const fs::path path = fs::temp_directory_path() / "NobleTimeSliceTest.mesh";
+		WriteTestMesh(path, 16);
+
+		const NIdentifier ids[4] = { ID("TimeSliceTestA"), ID("TimeSliceTestB"), ID("TimeSliceTestC"), ID("TimeSliceTestD") };
+		const AssetLoadPriority priorities[4] = { AssetLoadPriority::Low, AssetLoadPriority::Low, AssetLoadPriority::Low,
+			AssetLoadPriority::High };
+
+		Array<U32> order;
+		AssetHandle<StaticMesh> handles[4];
+		for (U32 i = 0; i < 4; ++i)
+		{
+			assets->RegisterAsset(ids[i], path.string().c_str(), AssetType::AT_STATIC_MESH);
+			handles[i] = assets->RequestAsset<StaticMesh>(ids[i], priorities[i], [&order, i](Asset*) { order.Add(i); });
+		}
+
+		// Wait until every mesh is parsed, so they're all finalized from the same list
+		U32 parsed = 0;
+		for (U32 attempt = 0; attempt < 1000 && parsed < 4; ++attempt)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			parsed = 0;
+			for (const AssetHandle<StaticMesh>& handle : handles)
+			{
+				if (handle.GetStatus() == AssetLoadStatus::Finalizing)
+				{
+					++parsed;
+				}
+			}
+		}
+		TEST_CHECK(parsed == 4);
+
+		TEST_CHECK(assets->ProcessAsyncLoads(0.0F) == 1);
+		TEST_CHECK(handles[3].IsReady() && !handles[0].IsReady() && assets->GetPendingLoadCount() == 3);
+
+		TEST_CHECK(assets->ProcessAsyncLoads(1.0F) == 3);
+		TEST_CHECK(assets->GetPendingLoadCount() == 0);
+		TEST_CHECK(order.GetCount() == 4 && order[0] == 3 && order[1] == 0 && order[2] == 1 && order[3] == 2);
+
+		for (U32 i = 0; i < 4; ++i)
+		{
+			TEST_CHECK(handles[i].Get() && handles[i]->GetIndexCount() == 48);
+			handles[i].Reset();
+		}
+		assets->UpdateResidency();
+
+		for (const NIdentifier& id : ids)
+		{
+			assets->UnloadAsset(id);
+			assets->UnregisterAsset(id);
+		}
+		std::error_code error;
+		fs::remove(path, error);
+	}
+
+	/**
+	 * Sets the dependencies of the asset from a list of IDs
+	 */
+	static void SetTestDependencies(AssetManager* assets, const NIdentifier& id, std::initializer_list<NIdentifier> dependencies)
+	{
+		Array<NIdentifier> list;
+		for (const NIdentifier& dependency : dependencies)
+		{
+			list.Add(dependency);
+		}
+		assets->SetAssetDependencies(id, list);
+	}
+
+	/**
+	 * Requests the root of a diamond (A needs B and C, which both need D): every asset is
+	 * requested once, and none is finalized before the assets it depends on
+	 */
+	TEST_CASE(AssetDependencyGraph)
+	{
+		AssetManager* assets = GetAsyncAssetManager();
+		const fs::path smallPath = fs::temp_directory_path() / "NobleDependencyTestSmall.mesh";
+		const fs::path largePath = fs::temp_directory_path() / "NobleDependencyTestLarge.mesh";
+		WriteTestMesh(smallPath, 1);
+		// The shared leaf takes longest to parse, so its parents usually have to wait for it
+		WriteTestMesh(largePath, 20000);
+
+		const NIdentifier ids[4] = { ID("DependencyTestA"), ID("DependencyTestB"), ID("DependencyTestC"), ID("DependencyTestD") };
+		for (U32 i = 0; i < 4; ++i)
+		{
+			const fs::path& path = i == 3 ? largePath : smallPath;
+			assets->RegisterAsset(ids[i], path.string().c_str(), AssetType::AT_STATIC_MESH);
+		}
+		SetTestDependencies(assets, ids[0], { ids[1], ids[2] });
+		SetTestDependencies(assets, ids[1], { ids[3] });
+		SetTestDependencies(assets, ids[2], { ids[3] });
+
+		bool dependenciesLoaded = false;
+		AssetHandle<StaticMesh> root = assets->RequestAsset<StaticMesh>(ids[0], AssetLoadPriority::Normal,
+			[&](Asset*) { dependenciesLoaded = IsAssetLoaded(ids[1]) && IsAssetLoaded(ids[2]) && IsAssetLoaded(ids[3]); });
+		TEST_CHECK(assets->GetPendingLoadCount() == 4);
+
+		// One asset per call at most, so a parent finalized early would show up between calls
+		bool ordered = true;
+		for (U32 attempt = 0; attempt < 1000 && assets->GetPendingLoadCount() > 0; ++attempt)
+		{
+			assets->ProcessAsyncLoads(0.0F);
+			ordered &= !IsAssetLoaded(ids[1]) || IsAssetLoaded(ids[3]);
+			ordered &= !IsAssetLoaded(ids[2]) || IsAssetLoaded(ids[3]);
+			ordered &= !root.IsReady() || (IsAssetLoaded(ids[1]) && IsAssetLoaded(ids[2]));
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		TEST_CHECK(assets->GetPendingLoadCount() == 0 && ordered);
+		TEST_CHECK(root.IsReady() && dependenciesLoaded);
+
+		root.Reset();
+		assets->UpdateResidency();
+		for (const NIdentifier& id : ids)
+		{
+			assets->UnloadAsset(id);
+			assets->UnregisterAsset(id);
+		}
+		std::error_code error;
+		fs::remove(smallPath, error);
+		fs::remove(largePath, error);
+	}
+
+	/**
+	 * Requests assets that depend on each other, directly, through a third and on themselves:
+	 * the dependency closing each cycle is dropped, so every load still completes
+	 */
+	TEST_CASE(AssetDependencyCycle)
+	{
+		AssetManager* assets = GetAsyncAssetManager();
+		const fs::path path = fs::temp_directory_path() / "NobleCycleTest.mesh";
+		WriteTestMesh(path, 1);
+
+		const NIdentifier ids[3] = { ID("CycleTestA"), ID("CycleTestB"), ID("CycleTestC") };
+		for (const NIdentifier& id : ids)
+		{
+			assets->RegisterAsset(id, path.string().c_str(), AssetType::AT_STATIC_MESH);
+		}
+		SetTestDependencies(assets, ids[0], { ids[1] });
+		SetTestDependencies(assets, ids[1], { ids[0], ids[2] });
+		SetTestDependencies(assets, ids[2], { ids[0], ids[2] });
+
+		AssetHandle<StaticMesh> root = assets->RequestAsset<StaticMesh>(ids[0]);
+		TEST_CHECK(assets->GetPendingLoadCount() == 3);
+
+		FinishAsyncLoads(assets);
+		TEST_CHECK(assets->GetPendingLoadCount() == 0 && root.IsReady());
+		TEST_CHECK(IsAssetLoaded(ids[1]) && IsAssetLoaded(ids[2]));
+
+		root.Reset();
+		assets->UpdateResidency();
+		for (const NIdentifier& id : ids)
+		{
+			assets->UnloadAsset(id);
+			assets->UnregisterAsset(id);
+		}
+		std::error_code error;
+		fs::remove(path, error);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,187 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include "AsyncFileIO.h"
+#include "FileSystem.h"
+#include "TestFramework.h"
+
+namespace Noble
+{
+	/**
+	 * Starts @fileIO on the worker threads, or on io_uring where it's available
+	 * Returns false, after saying so, if the backend asked for isn't there to test
+	 */
+	static bool StartFileIO(AsyncFileIO& fileIO, bool useIoUring, U32 workerCount)
+	{
+		TEST_CHECK(fileIO.Initialize(workerCount, useIoUring));
+		if (fileIO.IsUsingIoUring() != useIoUring)
+		{
+			printf("  io_uring is unavailable, skipped\n");
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * Runs ProcessCompletions until @count requests were processed, or a second has passed
+	 */
+	static void ProcessFileIO(AsyncFileIO& fileIO, U32 count)
+	{
+		U32 processed = 0;
+		for (U32 attempt = 0; attempt < 1000 && processed < count; ++attempt)
+		{
+			processed += fileIO.ProcessCompletions();
+			if (processed < count)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		}
+		TEST_CHECK(processed == count);
+	}
+
+	/**
+	 * Writes a file and reads it back whole, at an offset and past its end, on both backends;
+	 * each callback runs once from ProcessCompletions, after which the handle is forgotten
+	 */
+	TEST_CASE(AsyncFileIOReadWrite)
+	{
+		const fs::path path = fs::temp_directory_path() / "NobleAsyncTest.bin";
+		U64 seed = 0xD6E8FEB86659FD93ULL;
+		const Size size = 300 * 1024 + 5;
+		Byte* data = new Byte[size];
+		FillTestData(data, size, 4, seed);
+
+		for (bool useIoUring : { false, true })
+		{
+			AsyncFileIO fileIO;
+			if (!StartFileIO(fileIO, useIoUring, 2))
+			{
+				continue;
+			}
+
+			BitStream written;
+			written.WriteBytes(data, size);
+			U32 calls = 0;
+			const AsyncIOHandle writeHandle = fileIO.Write(path, std::move(written), FileMode::FILE_WRITE_REPLACE,
+				[&calls, size](AsyncIOResult& result)
+				{
+					++calls;
+					TEST_CHECK(result.Status == AsyncIOStatus::Completed && result.BytesTransferred == size);
+				});
+			TEST_CHECK(writeHandle != InvalidAsyncIOHandle);
+			TEST_CHECK(fileIO.Wait(writeHandle) == AsyncIOStatus::Completed);
+			TEST_CHECK(fileIO.GetStatus(writeHandle) == AsyncIOStatus::Completed);
+			TEST_CHECK(calls == 0);
+			ProcessFileIO(fileIO, 1);
+			TEST_CHECK(calls == 1 && fileIO.GetStatus(writeHandle) == AsyncIOStatus::Unknown);
+			TEST_CHECK(fileIO.Wait(writeHandle) == AsyncIOStatus::Unknown && !fileIO.Cancel(writeHandle));
+
+			fileIO.ReadFile(path, [&calls, data, size](AsyncIOResult& result)
+				{
+					++calls;
+					TEST_CHECK(result.Status == AsyncIOStatus::Completed && result.BytesTransferred == size);
+					TEST_CHECK(result.Data.GetStoredBytes() == size && std::memcmp(result.Data.GetData(), data, size) == 0);
+				});
+
+			// The last 100 bytes asked for are past the end, which completes short rather than failing
+			Byte* part = new Byte[4096];
+			const Size offset = size - 4000;
+			fileIO.Read(path, part, 4096, offset, [&calls](AsyncIOResult& result)
+				{
+					++calls;
+					TEST_CHECK(result.Status == AsyncIOStatus::Completed && result.BytesTransferred == 4000);
+				});
+			ProcessFileIO(fileIO, 2);
+			TEST_CHECK(calls == 3 && std::memcmp(part, data + offset, 4000) == 0);
+			delete[] part;
+
+			// Appends land after what's there
+			const AsyncIOHandle appendHandle = fileIO.Write(path, data, 16, FileMode::FILE_WRITE_APPEND);
+			TEST_CHECK(fileIO.Wait(appendHandle) == AsyncIOStatus::Completed);
+			ProcessFileIO(fileIO, 1);
+			std::error_code error;
+			TEST_CHECK(fs::file_size(path, error) == size + 16);
+		}
+
+		delete[] data;
+		std::error_code error;
+		fs::remove(path, error);
+	}
+
+	/**
+	 * Missing files fail, requests made while stopped are cancelled, and a cancelled request
+	 * still gets its callback; with one worker, callbacks run in submission order
+	 */
+	TEST_CASE(AsyncFileIOErrorsAndOrder)
+	{
+		const fs::path path = fs::temp_directory_path() / "NobleAsyncOrderTest.bin";
+		const fs::path missingPath = fs::temp_directory_path() / "NobleAsyncMissing" / "missing.bin";
+		{
+			const Byte bytes[64] = {};
+			File output(path, FileMode::FILE_WRITE_REPLACE, true);
+			output.Write(bytes, sizeof(bytes));
+		}
+
+		for (bool useIoUring : { false, true })
+		{
+			AsyncFileIO fileIO;
+			TEST_CHECK(!fileIO.Cancel(InvalidAsyncIOHandle) && fileIO.GetStatus(InvalidAsyncIOHandle) == AsyncIOStatus::Unknown);
+
+			// Nothing is running yet
+			AsyncIOStatus stoppedStatus = AsyncIOStatus::Unknown;
+			fileIO.ReadFile(path, [&stoppedStatus](AsyncIOResult& result) { stoppedStatus = result.Status; });
+			ProcessFileIO(fileIO, 1);
+			TEST_CHECK(stoppedStatus == AsyncIOStatus::Cancelled);
+
+			if (!StartFileIO(fileIO, useIoUring, 1))
+			{
+				continue;
+			}
+
+			AsyncIOStatus missingStatus = AsyncIOStatus::Unknown;
+			const AsyncIOHandle missingHandle = fileIO.ReadFile(missingPath, [&missingStatus](AsyncIOResult& result) { missingStatus = result.Status; });
+			TEST_CHECK(fileIO.Wait(missingHandle) == AsyncIOStatus::Failed);
+			const AsyncIOHandle missingWrite = fileIO.Write(missingPath, path.string().c_str(), 4);
+			TEST_CHECK(fileIO.Wait(missingWrite) == AsyncIOStatus::Failed);
+			ProcessFileIO(fileIO, 2);
+			TEST_CHECK(missingStatus == AsyncIOStatus::Failed);
+
+			// Whether the last one is cancelled depends on how far the backend got, but its callback says which
+			constexpr U32 RequestCount = 16;
+			Byte buffers[RequestCount][64];
+			AsyncIOHandle handles[RequestCount];
+			Array<U32> order;
+			AsyncIOStatus lastStatus = AsyncIOStatus::Unknown;
+			for (U32 i = 0; i < RequestCount; ++i)
+			{
+				handles[i] = fileIO.Read(path, buffers[i], 64, 0, [&order, &lastStatus, i](AsyncIOResult& result)
+					{
+						order.Add(i);
+						if (i == RequestCount - 1)
+						{
+							lastStatus = result.Status;
+						}
+					});
+			}
+			const bool cancelled = fileIO.Cancel(handles[RequestCount - 1]);
+			TEST_CHECK(!fileIO.Cancel(handles[RequestCount - 1]));
+			ProcessFileIO(fileIO, RequestCount);
+			TEST_CHECK(order.GetCount() == RequestCount);
+			TEST_CHECK(lastStatus == (cancelled ? AsyncIOStatus::Cancelled : AsyncIOStatus::Completed));
+
+			// io_uring may finish transfers out of order; the single worker takes them one at a time
+			if (!useIoUring)
+			{
+				for (U32 i = 0; i + 1 < order.GetCount(); ++i)
+				{
+					TEST_CHECK(order[i] < order[i + 1] || (cancelled && order[i] == RequestCount - 1));
+				}
+			}
+		}
+
+		std::error_code error;
+		fs::remove(path, error);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,290 @@
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+
+#include "BitStream.h"
+#include "StaticMesh.h"
+#include "TestFramework.h"
+#include "Time.h"
+
+namespace Noble
+{
+	/**
+	 * Returns the next value of a xorshift sequence
+	 */
+	static U64 NextRandom(U64& seed)
+	{
+		seed ^= seed << 13;
+		seed ^= seed >> 7;
+		seed ^= seed << 17;
+		return seed;
+	}
+
+	/**
+	 * Returns a pseudo-random float in [min, max]
+	 */
+	static F32 RandomFloat(U64& seed, F32 min, F32 max)
+	{
+		return min + (max - min) * static_cast<F32>(NextRandom(seed) >> 40) / static_cast<F32>(1 << 24);
+	}
+
+	/**
+	 * Returns the angle in radians of the rotation between two unit quaternions, computed
+	 * in double precision so float rounding doesn't hide small errors
+	 */
+	static F64 GetRotationError(const Quaternion& a, const Quaternion& b)
+	{
+		// conjugate(a) * b
+		const F64 w = F64(a.w) * b.w + F64(a.x) * b.x + F64(a.y) * b.y + F64(a.z) * b.z;
+		const F64 x = F64(a.w) * b.x - F64(b.w) * a.x - (F64(a.y) * b.z - F64(a.z) * b.y);
+		const F64 y = F64(a.w) * b.y - F64(b.w) * a.y - (F64(a.z) * b.x - F64(a.x) * b.z);
+		const F64 z = F64(a.w) * b.z - F64(b.w) * a.z - (F64(a.x) * b.y - F64(a.y) * b.x);
+		return 2.0 * std::atan2(std::sqrt(x * x + y * y + z * z), std::abs(w));
+	}
+
+	/**
+	 * Packs values of every width from 1 to 64 bits, then variable length integers around
+	 * their group boundaries, and checks they read back exactly in the expected space
+	 */
+	TEST_CASE(BitPackingRoundTrip)
+	{
+		const U32 valueCount = 4096;
+		U64 values[valueCount];
+		U32 widths[valueCount];
+
+		U64 seed = 0x9E3779B97F4A7C15ULL;
+		Size totalBits = 0;
+		BitStream stream;
+		for (U32 i = 0; i < valueCount; ++i)
+		{
+			widths[i] = 1 + (i % 64);
+			values[i] = NextRandom(seed) & BitStreamHelper::BitMask(widths[i]);
+			totalBits += widths[i];
+			stream.WriteBits(values[i], widths[i]);
+		}
+		stream.WriteBool(true);
+		stream.WriteBool(false);
+		stream.AlignWrite();
+		TEST_CHECK(stream.GetStoredBytes() == (totalBits + 2 + 7) / 8);
+
+		// A view over the bytes decodes them the same way
+		BitStreamView view(stream);
+		bool viewExact = true;
+		for (U32 i = 0; i < valueCount; ++i)
+		{
+			viewExact &= view.ReadBits(widths[i]) == values[i];
+		}
+		TEST_CHECK(viewExact);
+		TEST_CHECK(view.ReadBool() && !view.ReadBool());
+
+		bool exact = true;
+		for (U32 i = 0; i < valueCount; ++i)
+		{
+			exact &= stream.ReadBits(widths[i]) == values[i];
+		}
+		TEST_CHECK(exact);
+		TEST_CHECK(stream.ReadBool());
+		TEST_CHECK(!stream.ReadBool());
+		stream.AlignRead();
+
+		// Each group holds 7 bits, so these sit on either side of a group boundary
+		const U64 unsignedValues[] = { 0, 1, 127, 128, 16383, 16384, 1ULL << 56, ~0ULL };
+		const Size unsignedSizes[] = { 1, 1, 1, 2, 2, 3, 9, 10 };
+		const I64 signedValues[] = { 0, -1, 1, -64, 64, INT64_MIN, INT64_MAX };
+		const Size signedSizes[] = { 1, 1, 1, 1, 2, 10, 10 };
+
+		for (U32 i = 0; i < sizeof(unsignedValues) / sizeof(U64); ++i)
+		{
+			const Size before = stream.GetStoredBytes();
+			stream.WriteVarUInt(unsignedValues[i]);
+			stream.AlignWrite();
+			TEST_CHECK(stream.GetStoredBytes() - before == unsignedSizes[i]);
+			TEST_CHECK(stream.ReadVarUInt() == unsignedValues[i]);
+		}
+		for (U32 i = 0; i < sizeof(signedValues) / sizeof(I64); ++i)
+		{
+			const Size before = stream.GetStoredBytes();
+			stream.WriteVarInt(signedValues[i]);
+			stream.AlignWrite();
+			TEST_CHECK(stream.GetStoredBytes() - before == signedSizes[i]);
+			TEST_CHECK(stream.ReadVarInt() == signedValues[i]);
+		}
+	}
+
+	/**
+	 * Quantizes floats over several ranges and widths and checks each one reads back within
+	 * half a step, that the ends of the range are exact and that values outside it are clamped
+	 */
+	TEST_CASE(QuantizedFloatRoundTrip)
+	{
+		const F32 ranges[][2] = { { -1.0F, 1.0F }, { 0.0F, 1000.0F }, { -0.001F, 0.5F }, { -40000.0F, 25.0F } };
+		const U32 bitCounts[] = { 1, 2, 5, 8, 12, 16, 20, 24, 32 };
+		const U32 samples = 2000;
+
+		U64 seed = 0x2545F4914F6CDD1DULL;
+		for (const F32* range : ranges)
+		{
+			const F32 min = range[0];
+			const F32 max = range[1];
+			// Past 24 bits the steps are finer than a float near the ends of the range
+			const F64 floatRounding = F64(glm::max(std::abs(min), std::abs(max))) * FLT_EPSILON;
+
+			for (const U32 bits : bitCounts)
+			{
+				const F64 bound = (F64(max) - min) / BitStreamHelper::BitMask(bits) / 2.0 + floatRounding;
+
+				BitStream stream;
+				F32 values[samples];
+				for (U32 i = 0; i < samples; ++i)
+				{
+					values[i] = RandomFloat(seed, min, max);
+					stream.WriteQuantizedFloat(values[i], min, max, bits);
+				}
+				stream.WriteQuantizedFloat(min, min, max, bits);
+				stream.WriteQuantizedFloat(max, min, max, bits);
+				stream.WriteQuantizedFloat(min - 10.0F, min, max, bits);
+				stream.WriteQuantizedFloat(max + 10.0F, min, max, bits);
+				stream.AlignWrite();
+				TEST_CHECK(stream.GetStoredBytes() == ((samples + 4) * bits + 7) / 8);
+
+				F64 worst = 0.0;
+				for (U32 i = 0; i < samples; ++i)
+				{
+					worst = glm::max(worst, std::abs(F64(stream.ReadQuantizedFloat(min, max, bits)) - values[i]));
+				}
+				TEST_CHECK(worst <= bound);
+				TEST_CHECK(stream.ReadQuantizedFloat(min, max, bits) == min);
+				TEST_CHECK(stream.ReadQuantizedFloat(min, max, bits) == max);
+				TEST_CHECK(stream.ReadQuantizedFloat(min, max, bits) == min);
+				TEST_CHECK(stream.ReadQuantizedFloat(min, max, bits) == max);
+			}
+
+			// The fewest bits whose steps are no wider than the precision
+			const F32 precision = (max - min) / 1000.0F;
+			const U32 bits = BitStream::GetQuantizationBits(min, max, precision);
+			TEST_CHECK((F64(max) - min) / BitStreamHelper::BitMask(bits) <= precision);
+			TEST_CHECK((F64(max) - min) / BitStreamHelper::BitMask(bits - 1) > precision);
+		}
+
+		// Vectors quantize each component the same way
+		BitStream stream;
+		const Vector3f vector(0.25F, -0.8F, 0.999F);
+		stream.WriteQuantizedVector(vector, -1.0F, 1.0F, 12);
+		stream.AlignWrite();
+		const Vector3f read = stream.ReadQuantizedVector<3>(-1.0F, 1.0F, 12);
+		for (U32 i = 0; i < 3; ++i)
+		{
+			TEST_CHECK(std::abs(read[i] - vector[i]) <= 1.0F / BitStreamHelper::BitMask(12));
+		}
+	}
+
+	/**
+	 * Quantizes random rotations, plus ones where the dropped component is tied or at its
+	 * smallest, and checks each reads back within the bound the encoding guarantees
+	 */
+	TEST_CASE(QuantizedQuaternionRoundTrip)
+	{
+		const U32 bitCounts[] = { 8, 10, 12, 16 };
+		const U32 samples = 20000;
+
+		const F32 half = 0.5F;
+		const F32 diagonal = 0.70710678F;
+		const Quaternion edgeCases[] = {
+			Quaternion(1.0F, 0.0F, 0.0F, 0.0F),
+			Quaternion(-1.0F, 0.0F, 0.0F, 0.0F),
+			Quaternion(diagonal, diagonal, 0.0F, 0.0F),
+			Quaternion(diagonal, 0.0F, 0.0F, -diagonal),
+			Quaternion(half, half, half, half),
+			Quaternion(-half, half, -half, half),
+		};
+		const U32 edgeCount = sizeof(edgeCases) / sizeof(Quaternion);
+
+		U64 seed = 0xD1B54A32D192ED03ULL;
+		Quaternion* rotations = new Quaternion[samples + edgeCount];
+		for (U32 i = 0; i < edgeCount; ++i)
+		{
+			rotations[i] = edgeCases[i];
+		}
+		for (U32 i = edgeCount; i < samples + edgeCount; ++i)
+		{
+			Quaternion q;
+			do
+			{
+				q = Quaternion(RandomFloat(seed, -1.0F, 1.0F), RandomFloat(seed, -1.0F, 1.0F), RandomFloat(seed, -1.0F, 1.0F), RandomFloat(seed, -1.0F, 1.0F));
+			} while (glm::length(q) < 0.1F || glm::length(q) > 1.0F);
+			rotations[i] = glm::normalize(q);
+		}
+
+		for (const U32 bits : bitCounts)
+		{
+			// Each of the three stored components is off by at most half a step of the
+			// [-1/sqrt(2), 1/sqrt(2)] range. The rebuilt largest component, at least 1/2, adds at most
+			// sqrt(3) times that, so the rotation is off by at most 2 * sqrt(6) / (2^bits - 1) radians
+			const F64 bound = 2.0 * std::sqrt(6.0) / BitStreamHelper::BitMask(bits) + 1e-5;
+
+			BitStream stream;
+			for (U32 i = 0; i < samples + edgeCount; ++i)
+			{
+				stream.WriteQuantizedQuaternion(rotations[i], bits);
+			}
+			stream.AlignWrite();
+			TEST_CHECK(stream.GetStoredBytes() == ((samples + edgeCount) * (2 + 3 * bits) + 7) / 8);
+
+			BitStreamView view(stream);
+			F64 worst = GetRotationError(rotations[0], view.ReadQuantizedQuaternion(bits));
+			for (U32 i = 0; i < samples + edgeCount; ++i)
+			{
+				worst = glm::max(worst, GetRotationError(rotations[i], stream.ReadQuantizedQuaternion(bits)));
+			}
+			TEST_CHECK(worst <= bound);
+			printf("  %u bits per component: worst error %.4f degrees\n", bits, glm::degrees(worst));
+		}
+
+		delete[] rotations;
+	}
+
+	/**
+	 * Streams a large synthetic mesh and times reading it back field by field
+	 * against reading it with a single ReadArray, as StaticMesh does
+	 */
+	BENCHMARK_CASE(MeshStreamRead)
+	{
+		const U32 vertexCount = 1 << 20;
+
+		StaticVertex* vertices = new StaticVertex[vertexCount];
+		for (U32 i = 0; i < vertexCount; ++i)
+		{
+			vertices[i].Position = Vector3f((F32)i, (F32)(i * 2), (F32)(i * 3));
+		}
+
+		// Two copies of the mesh, one for each read strategy
+		BitStream stream(2 * sizeof(StaticVertex) * vertexCount);
+		stream.WriteArray(vertices, vertexCount);
+		stream.WriteArray(vertices, vertexCount);
+
+		Timestamp start = Time::GetNowTimestamp();
+		for (U32 i = 0; i < vertexCount; ++i)
+		{
+			vertices[i].Position = stream.Read<Vector3f>();
+			vertices[i].TexCoord = stream.Read<Vector2f>();
+			vertices[i].Normal = stream.Read<Vector3f>();
+			vertices[i].Tangent = stream.Read<Vector3f>();
+		}
+		Timestamp fieldTime = Time::GetNowTimestamp();
+		fieldTime -= start;
+
+		start = Time::GetNowTimestamp();
+		stream.ReadArray(vertices, vertexCount);
+		Timestamp arrayTime = Time::GetNowTimestamp();
+		arrayTime -= start;
+
+		TEST_CHECK(vertices[vertexCount - 1].Position == Vector3f((F32)(vertexCount - 1), (F32)((vertexCount - 1) * 2), (F32)((vertexCount - 1) * 3)));
+
+		printf("  Reading %u vertices: per field %.2f ms, ReadArray %.2f ms\n",
+			vertexCount,
+			Time::GetDuration(fieldTime) * 1000.0F,
+			Time::GetDuration(arrayTime) * 1000.0F);
+
+		delete[] vertices;
+	}
+}
\ No newline at end of file
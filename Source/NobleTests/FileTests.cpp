@@ -0,0 +1,972 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "AssetRegistry.h"
+#include "AssetRegistryFile.h"
+#include "Checksum.h"
+#include "Compression.h"
+#include "DirectoryIndex.h"
+#include "FileSystem.h"
+#include "FileWatcher.h"
+#include "PackFile.h"
+#include "TestFramework.h"
+#include "Time.h"
+#include "VirtualFileSystem.h"
+
+namespace Noble
+{
+	/**
+	 * Round-trips random buffers through both compression modes and checks that corrupted
+	 * input is rejected without crashing
+	 */
+	TEST_CASE(CompressionRoundTrip)
+	{
+		U64 seed = 0x9E3779B97F4A7C15ULL;
+
+		const Size maxSize = 256 * 1024;
+		Byte* source = new Byte[maxSize];
+
+		for (U32 iteration = 0; iteration < 200; ++iteration)
+		{
+			const Size size = (seed >> 16) % maxSize;
+			FillTestData(source, size, iteration % 17, seed);
+
+			BitStream whole;
+			Compression::Compress(source, size, whole);
+			BitStream frame;
+			Compression::CompressFrame(source, size, frame, 1 + static_cast<U32>(seed % (64 * 1024)));
+
+			BitStreamView wholeView(whole);
+			BitStream wholeResult;
+			TEST_CHECK(Compression::Decompress(wholeView, wholeResult) && wholeResult.GetStoredBytes() == size);
+			TEST_CHECK(size == 0 || std::memcmp(wholeResult.GetData(), source, size) == 0);
+
+			BitStreamView frameView(frame);
+			BitStream frameResult;
+			TEST_CHECK(Compression::DecompressFrame(frameView, frameResult) && frameResult.GetStoredBytes() == size);
+			TEST_CHECK(size == 0 || std::memcmp(frameResult.GetData(), source, size) == 0);
+
+			// Flip a byte; decoding may fail but must stay in bounds
+			frame.GetData()[seed % frame.GetStoredBytes()] ^= 0x5A;
+			BitStreamView corruptView(frame);
+			BitStream corruptResult;
+			Compression::DecompressFrame(corruptView, corruptResult);
+		}
+
+		delete[] source;
+	}
+
+	/**
+	 * Decompresses a frame large enough to be split across threads and checks it matches what
+	 * one thread decodes; the redundant test data has to actually compress for this to mean anything
+	 */
+	TEST_CASE(CompressionParallelFrame)
+	{
+		U64 seed = 0x2545F4914F6CDD1DULL;
+		const Size size = 3 * CompressedFrameReader::MinBytesPerWorker + 12345;
+		Byte* source = new Byte[size];
+		FillTestData(source, size, 10, seed);
+
+		BitStream frame;
+		Compression::CompressFrame(source, size, frame);
+		TEST_CHECK(frame.GetStoredBytes() < size * 3 / 4);
+
+		for (U32 workerCount = 1; workerCount <= 4; workerCount += 3)
+		{
+			BitStreamView frameView(frame);
+			BitStream result;
+			TEST_CHECK(Compression::DecompressFrame(frameView, result, workerCount) && result.GetStoredBytes() == size);
+			TEST_CHECK(std::memcmp(result.GetData(), source, size) == 0);
+		}
+
+		delete[] source;
+	}
+
+	/**
+	 * Checks the hardware and table CRC32C paths against the reference vector and each other,
+	 * and checks that a corrupted checksum frame is rejected
+	 */
+	TEST_CASE(ChecksumVerification)
+	{
+		TEST_CHECK(Checksum::Crc32c("123456789", 9) == 0xE3069283);
+		TEST_CHECK(Checksum::Crc32cSoftware("123456789", 9) == 0xE3069283);
+
+		U64 seed = 0xC2B2AE3D27D4EB4FULL;
+		// Large enough for VerifyAll to split the payload across threads
+		const Size size = 3 * ChecksumFrameReader::MinBytesPerWorker + 13;
+		Byte* data = new Byte[size];
+		FillTestData(data, size, 0, seed);
+
+		// Odd lengths and offsets cover the unaligned head and tail of the hardware path
+		const Size crcSize = 1024 * 1024 + 13;
+		for (Size offset = 0; offset < 8; ++offset)
+		{
+			TEST_CHECK(Checksum::Crc32c(data + offset, crcSize - offset * 3) == Checksum::Crc32cSoftware(data + offset, crcSize - offset * 3));
+		}
+
+		BitStream frame;
+		ChecksumFrame::Write(data, size, frame, 64 * 1024);
+
+		BitStreamView frameView(frame);
+		ChecksumFrameReader reader;
+		TEST_CHECK(reader.Open(frameView) && reader.VerifyAll() && reader.VerifyAll(4));
+
+		// Flip a payload byte in the last worker's range; the frame must still open but fail verification
+		frame.GetData()[frame.GetStoredBytes() - 1 - seed % ChecksumFrameReader::MinBytesPerWorker] ^= 0x5A;
+		BitStreamView corruptView(frame);
+		ChecksumFrameReader corruptReader;
+		TEST_CHECK(corruptReader.Open(corruptView) && !corruptReader.VerifyAll() && !corruptReader.VerifyAll(4));
+
+		// A small payload stays on the calling thread but verifies the same way
+		BitStream smallFrame;
+		ChecksumFrame::Write(data, crcSize, smallFrame, 64 * 1024);
+		BitStreamView smallView(smallFrame);
+		TEST_CHECK(ChecksumFrame::Unwrap(smallView, 4) && smallView.GetSize() == crcSize);
+
+		delete[] data;
+	}
+
+	/**
+	 * Writes checksummed files and reads them back after what's already in the buffer, then
+	 * checks a flipped payload byte fails the read and leaves the buffer as it was
+	 */
+	TEST_CASE(FileChecksummedRoundTrip)
+	{
+		const fs::path path = fs::temp_directory_path() / "NobleChecksumTest.bin";
+		U64 seed = 0x94D049BB133111EBULL;
+		const Size size = 200 * 1024 + 7;
+		Byte* data = new Byte[size];
+		FillTestData(data, size, 4, seed);
+
+		for (Size payloadSize : { size, Size(0) })
+		{
+			{
+				File output(path, FileMode::FILE_WRITE_REPLACE, true);
+				TEST_CHECK(output.WriteChecksummed(data, payloadSize));
+			}
+
+			File input(path, FileMode::FILE_READ);
+			BitStream buffer;
+			buffer.Write<U32>(0xABCD);
+			TEST_CHECK(input.ReadChecksummed(buffer, 4) && buffer.GetStoredBytes() == sizeof(U32) + payloadSize);
+			TEST_CHECK(payloadSize == 0 || std::memcmp(buffer.GetData() + sizeof(U32), data, payloadSize) == 0);
+			TEST_CHECK(input.GetPosition() == input.GetFileSize());
+		}
+
+		{
+			BitStream frame;
+			ChecksumFrame::Write(data, size, frame);
+			frame.GetData()[frame.GetStoredBytes() - size / 2] ^= 0x5A;
+			File output(path, FileMode::FILE_WRITE_REPLACE, true);
+			output.Write(frame.GetData(), frame.GetStoredBytes());
+		}
+
+		File input(path, FileMode::FILE_READ);
+		BitStream buffer;
+		TEST_CHECK(!input.ReadChecksummed(buffer) && buffer.GetStoredBytes() == 0);
+
+		input.Close();
+		delete[] data;
+		std::error_code error;
+		fs::remove(path, error);
+	}
+
+	/**
+	 * Writes @size bytes of test data to the file, replacing it
+	 */
+	static void WriteTestFile(const fs::path& path, Size size)
+	{
+		Byte data[256];
+		U64 seed = 0x165667B19E3779F9ULL + size;
+		FillTestData(data, size, 0, seed);
+
+		File output(path, FileMode::FILE_WRITE_REPLACE, true);
+		output.Write(data, size);
+	}
+
+	/**
+	 * Polls the watcher until at least @count changes were reported, or a second has passed
+	 */
+	static void PollWatcher(FileWatcher& watcher, DirectoryChangeList& changes, Size count)
+	{
+		changes.Empty();
+		for (U32 attempt = 0; attempt < 100 && changes.GetCount() < count; ++attempt)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			watcher.Poll(changes);
+		}
+	}
+
+	/**
+	 * Returns true if the list holds a change of the type to the path
+	 */
+	static bool HasChange(const DirectoryChangeList& changes, DirectoryChangeType type, const char* path)
+	{
+		for (const DirectoryChange& change : changes)
+		{
+			if (change.Type == type && std::strcmp(changes.GetPath(change), path) == 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * Builds an index of a temporary tree and checks every query against it, then edits the
+	 * tree and keeps the index current through UpdatePath and Refresh
+	 */
+	TEST_CASE(DirectoryIndexQueries)
+	{
+		const fs::path root = fs::temp_directory_path() / "NobleIndexTest";
+		std::error_code error;
+		fs::remove_all(root, error);
+		fs::create_directories(root / "models/sub", error);
+		fs::create_directories(root / "textures", error);
+		WriteTestFile(root / "a.txt", 10);
+		WriteTestFile(root / "b.PNG", 20);
+		WriteTestFile(root / "noext", 5);
+		WriteTestFile(root / "models/m1.mesh", 30);
+		WriteTestFile(root / "models/m2.MESH", 40);
+		WriteTestFile(root / "models/sub/m3.mesh", 50);
+		WriteTestFile(root / "textures/t.png", 60);
+
+		DirectoryIndex index;
+		TEST_CHECK(index.Build(root, 2) && index.GetCount() == 7);
+
+		const char* previous = "";
+		for (const DirectoryEntry& entry : index.GetEntries())
+		{
+			TEST_CHECK(std::strcmp(previous, index.GetPath(entry)) < 0);
+			previous = index.GetPath(entry);
+		}
+
+		const DirectoryEntry* mesh = index.Find("models/m1.mesh");
+		TEST_CHECK(mesh && mesh->FileSize == 30 && std::strcmp(index.GetExtension(*mesh), "mesh") == 0);
+		TEST_CHECK(index.GetFullPath(*mesh) == root / "models/m1.mesh");
+		TEST_CHECK(!index.Find("models") && !index.Find("models/m1") && !index.Find("missing.txt"));
+
+		TEST_CHECK(index.FindByPrefix("models/").GetCount() == 3);
+		TEST_CHECK(index.FindByPrefix("models/sub/").GetCount() == 1);
+		TEST_CHECK(index.FindByPrefix("").GetCount() == 7 && index.FindByPrefix("z").IsEmpty());
+		for (const DirectoryEntry& entry : index.FindByPrefix("models/"))
+		{
+			TEST_CHECK(std::strncmp(index.GetPath(entry), "models/", 7) == 0);
+		}
+
+		TEST_CHECK(index.FindByExtension("mesh").GetCount() == 3);
+		TEST_CHECK(index.FindByExtension(".png").GetCount() == 2 && index.FindByExtension("PNG").GetCount() == 2);
+		TEST_CHECK(index.FindByExtension("wav").IsEmpty());
+		for (const DirectoryEntry& entry : index.FindByExtension("png"))
+		{
+			TEST_CHECK(entry.FileSize == 20 || entry.FileSize == 60);
+		}
+
+		// Single paths: a new file, a resized one, an unchanged one and a removed directory
+		DirectoryChangeList changes;
+		WriteTestFile(root / "models/m4.mesh", 12);
+		TEST_CHECK(index.UpdatePath("models/m4.mesh", &changes));
+		TEST_CHECK(changes.GetCount() == 1 && HasChange(changes, DirectoryChangeType::Added, "models/m4.mesh"));
+
+		changes.Empty();
+		WriteTestFile(root / "a.txt", 11);
+		TEST_CHECK(index.UpdatePath("a.txt", &changes) && HasChange(changes, DirectoryChangeType::Modified, "a.txt"));
+		TEST_CHECK(index.Find("a.txt")->FileSize == 11);
+
+		changes.Empty();
+		TEST_CHECK(!index.UpdatePath("b.PNG", &changes) && changes.GetCount() == 0);
+
+		fs::remove_all(root / "models/sub", error);
+		TEST_CHECK(index.UpdatePath("models/sub", &changes));
+		TEST_CHECK(changes.GetCount() == 1 && HasChange(changes, DirectoryChangeType::Removed, "models/sub/m3.mesh"));
+		TEST_CHECK(index.FindByPrefix("models/").GetCount() == 3 && index.FindByExtension("mesh").GetCount() == 3);
+
+		// Whole tree
+		changes.Empty();
+		WriteTestFile(root / "textures/u.png", 7);
+		WriteTestFile(root / "textures/t.png", 61);
+		fs::remove(root / "noext", error);
+		TEST_CHECK(index.Refresh(&changes, 2) && changes.GetCount() == 3);
+		TEST_CHECK(HasChange(changes, DirectoryChangeType::Added, "textures/u.png"));
+		TEST_CHECK(HasChange(changes, DirectoryChangeType::Modified, "textures/t.png"));
+		TEST_CHECK(HasChange(changes, DirectoryChangeType::Removed, "noext"));
+		TEST_CHECK(index.GetCount() == 7 && index.FindByExtension("png").GetCount() == 3 && !index.Find("noext"));
+
+		changes.Empty();
+		TEST_CHECK(!index.Refresh(&changes, 2) && changes.GetCount() == 0);
+
+		fs::remove_all(root, error);
+	}
+
+	/**
+	 * Layers a loose directory over a memory mount and adds and removes loose files, updating
+	 * one virtual path at a time: paths appear and disappear, and fall back to the lower mount
+	 */
+	TEST_CASE(VirtualFileSystemUpdatePath)
+	{
+		const fs::path root = fs::temp_directory_path() / "NobleVfsTest";
+		std::error_code error;
+		fs::remove_all(root, error);
+		fs::create_directories(root, error);
+		WriteTestFile(root / "a.bin", 16);
+
+		DirectoryIndex index;
+		TEST_CHECK(index.Build(root, 1));
+
+		VirtualFileSystem vfs;
+		MemoryMount* memory = new MemoryMount();
+		memory->AddFile("a.bin", "memory", 6);
+		memory->AddFile("b.bin", "b", 1);
+		vfs.Mount("Content", memory, -1);
+		vfs.Mount("Content", new DirectoryMount(index));
+
+		VfsFile file;
+		TEST_CHECK(vfs.GetFileCount() == 2 && vfs.Open("Content/a.bin", file) && file.GetSize() == 16);
+
+		WriteTestFile(root / "c.bin", 8);
+		index.UpdatePath("c.bin");
+		vfs.UpdatePath("Content/c.bin");
+		TEST_CHECK(vfs.GetFileCount() == 3 && vfs.Open("Content/c.bin", file) && file.GetSize() == 8);
+
+		fs::remove(root / "a.bin", error);
+		index.UpdatePath("a.bin");
+		vfs.UpdatePath("Content/a.bin");
+		TEST_CHECK(vfs.GetFileCount() == 3 && vfs.Open("Content/a.bin", file) && file.GetSize() == 6);
+
+		fs::remove(root / "c.bin", error);
+		index.UpdatePath("c.bin");
+		vfs.UpdatePath("Content\\c.bin");
+		vfs.UpdatePath("Other/b.bin");
+		TEST_CHECK(vfs.GetFileCount() == 2 && !vfs.Exists("Content/c.bin") && vfs.Exists("Content/b.bin"));
+
+		file.Close();
+		fs::remove_all(root, error);
+	}
+
+	/**
+	 * Writes a pack with stored, compressed, small and empty entries and reads it back directly
+	 * and mounted in a VirtualFileSystem
+	 */
+	TEST_CASE(PackRoundTrip)
+	{
+		const fs::path packPath = fs::temp_directory_path() / "NoblePackTest.npak";
+		U64 seed = 0x2545F4914F6CDD1DULL;
+		const Size randomSize = 3000;
+		const Size compressibleSize = 64 * 1024;
+		Byte* random = new Byte[randomSize];
+		FillTestData(random, randomSize, 0, seed);
+		Byte* compressible = new Byte[compressibleSize];
+		FillTestData(compressible, compressibleSize, 16, seed);
+
+		PackWriter writer;
+		writer.AddData("stored.bin", random, randomSize);
+		writer.AddData("data/compressed.bin", compressible, compressibleSize);
+		writer.AddData("data/small.txt", "hello", 5);
+		writer.AddData("empty.bin", nullptr, 0);
+		TEST_CHECK(writer.Write(packPath) && writer.GetCompressedCount() == 1);
+
+		{
+			PackFile pack;
+			TEST_CHECK(pack.Open(packPath) && pack.GetEntryCount() == 4);
+
+			const PackEntry* stored = pack.Find("stored.bin");
+			const PackEntry* compressed = pack.Find("data/compressed.bin");
+			TEST_CHECK(stored && compressed && !pack.Find("data") && !pack.Find("stored.bi"));
+			TEST_CHECK(!PackFile::IsCompressed(*stored) && PackFile::IsCompressed(*compressed));
+			TEST_CHECK(compressed->StoredSize < compressibleSize && std::strcmp(pack.GetName(*compressed), "data/compressed.bin") == 0);
+			TEST_CHECK(pack.Find(ID("data/small.txt")) == pack.Find("data/small.txt"));
+
+			BitStreamView view;
+			TEST_CHECK(pack.GetView(*stored, view) && view.GetSize() == randomSize && std::memcmp(view.GetData(), random, randomSize) == 0);
+
+			BitStream contents;
+			TEST_CHECK(pack.Read(*compressed, contents, 2) && contents.GetStoredBytes() == compressibleSize);
+			TEST_CHECK(std::memcmp(contents.GetData(), compressible, compressibleSize) == 0);
+		}
+
+		{
+			VirtualFileSystem vfs;
+			TEST_CHECK(vfs.MountPack("Packed", packPath) != 0 && vfs.GetFileCount() == 4);
+			TEST_CHECK(vfs.Exists("Packed/data/small.txt") && !vfs.Exists("data/small.txt"));
+
+			VfsFile file;
+			TEST_CHECK(vfs.Open("Packed/data/compressed.bin", file) && file.GetSize() == compressibleSize);
+			TEST_CHECK(std::memcmp(file.GetData(), compressible, compressibleSize) == 0);
+			TEST_CHECK(vfs.Open("Packed/stored.bin", file) && file.GetSize() == randomSize);
+			TEST_CHECK(std::memcmp(file.GetData(), random, randomSize) == 0);
+			TEST_CHECK(vfs.Open("Packed/empty.bin", file) && file.IsValid() && file.GetSize() == 0);
+		}
+
+		delete[] random;
+		delete[] compressible;
+		std::error_code error;
+		fs::remove(packPath, error);
+	}
+
+	/**
+	 * Flips a payload byte of a stored and of a compressed entry; the table of contents is intact
+	 * so the pack opens, but neither entry reads, directly or through a mount, while the rest still do
+	 */
+	TEST_CASE(PackCorruptEntry)
+	{
+		const fs::path packPath = fs::temp_directory_path() / "NoblePackCorruptTest.npak";
+		const fs::path corruptPath = fs::temp_directory_path() / "NoblePackCorruptTest2.npak";
+		U64 seed = 0x94D049BB133111EBULL;
+		const Size size = 16 * 1024;
+		Byte* random = new Byte[size];
+		FillTestData(random, size, 0, seed);
+		Byte* compressible = new Byte[size];
+		FillTestData(compressible, size, 16, seed);
+
+		PackWriter writer;
+		writer.AddData("a.bin", random, size);
+		writer.AddData("b.bin", compressible, size);
+		writer.AddData("c.bin", random, size);
+		TEST_CHECK(writer.Write(packPath) && writer.GetCompressedCount() == 1);
+
+		U64 storedOffset = 0;
+		U64 compressedOffset = 0;
+		{
+			PackFile pack;
+			TEST_CHECK(pack.Open(packPath));
+			storedOffset = pack.Find("a.bin")->DataOffset;
+			compressedOffset = pack.Find("b.bin")->DataOffset;
+		}
+
+		{
+			MappedFile mapping(packPath);
+			BitStream bytes(reinterpret_cast<const Byte*>(mapping.GetData()), mapping.GetMappedSize());
+			bytes.GetData()[storedOffset + 100] ^= 0x20;
+			bytes.GetData()[compressedOffset + 10] ^= 0x01;
+
+			File output(corruptPath, FileMode::FILE_WRITE_REPLACE, true);
+			output.Write(bytes.GetData(), bytes.GetStoredBytes());
+		}
+
+		{
+			PackFile pack;
+			TEST_CHECK(pack.Open(corruptPath));
+			const PackEntry* stored = pack.Find("a.bin");
+			const PackEntry* compressed = pack.Find("b.bin");
+			const PackEntry* intact = pack.Find("c.bin");
+			TEST_CHECK(stored && compressed && intact);
+
+			BitStreamView view;
+			BitStream contents;
+			TEST_CHECK(!pack.VerifyEntry(*stored) && !pack.GetView(*stored, view) && !pack.Read(*stored, contents));
+			TEST_CHECK(!pack.VerifyEntry(*compressed) && !pack.Read(*compressed, contents, 2));
+			TEST_CHECK(pack.Read(*intact, contents) && contents.GetStoredBytes() == size && std::memcmp(contents.GetData(), random, size) == 0);
+
+			VirtualFileSystem vfs;
+			TEST_CHECK(vfs.MountPack("", corruptPath) != 0);
+			VfsFile file;
+			TEST_CHECK(!vfs.Open("a.bin", file) && !vfs.Open("b.bin", file) && vfs.Open("c.bin", file));
+		}
+
+		delete[] random;
+		delete[] compressible;
+		std::error_code error;
+		fs::remove(packPath, error);
+		fs::remove(corruptPath, error);
+	}
+
+	/**
+	 * Edits a temporary tree while a FileWatcher keeps its index current: files are added,
+	 * modified and removed, and enough directories come and go that the watcher has to
+	 * compact its paths, after which events must still resolve to the right files
+	 */
+	TEST_CASE(FileWatcherChanges)
+	{
+		if (!FileWatcher::IsSupported())
+		{
+			return;
+		}
+
+		const fs::path root = fs::temp_directory_path() / "NobleWatcherTest";
+		std::error_code error;
+		fs::remove_all(root, error);
+		fs::create_directories(root / "keep", error);
+		WriteTestFile(root / "keep/a.bin", 16);
+
+		DirectoryIndex index;
+		FileWatcher watcher;
+		TEST_CHECK(index.Build(root) && watcher.Start(index));
+		watcher.SetSettleTime(0.0F);
+
+		DirectoryChangeList changes;
+		WriteTestFile(root / "keep/a.bin", 32);
+		WriteTestFile(root / "keep/b.bin", 8);
+		PollWatcher(watcher, changes, 2);
+		TEST_CHECK(HasChange(changes, DirectoryChangeType::Modified, "keep/a.bin"));
+		TEST_CHECK(HasChange(changes, DirectoryChangeType::Added, "keep/b.bin"));
+
+		fs::remove(root / "keep/a.bin", error);
+		PollWatcher(watcher, changes, 1);
+		TEST_CHECK(HasChange(changes, DirectoryChangeType::Removed, "keep/a.bin"));
+		TEST_CHECK(!index.Find("keep/a.bin") && index.Find("keep/b.bin"));
+
+		char name[32];
+		for (U32 i = 0; i < 64; ++i)
+		{
+			snprintf(name, sizeof(name), "churn%u", i);
+			fs::create_directories(root / name / "nested", error);
+			WriteTestFile(root / name / "nested/c.bin", 4);
+			PollWatcher(watcher, changes, 1);
+
+			fs::remove_all(root / name, error);
+			PollWatcher(watcher, changes, 1);
+		}
+		TEST_CHECK(HasChange(changes, DirectoryChangeType::Removed, "churn63/nested/c.bin"));
+		TEST_CHECK(!index.Find("churn63/nested/c.bin"));
+
+		// Reading the directory's event adds its watch, so the file after it is seen on its own
+		fs::create_directories(root / "late", error);
+		watcher.Poll(changes);
+		WriteTestFile(root / "late/d.bin", 4);
+		WriteTestFile(root / "keep/b.bin", 64);
+		PollWatcher(watcher, changes, 2);
+		TEST_CHECK(HasChange(changes, DirectoryChangeType::Added, "late/d.bin"));
+		TEST_CHECK(HasChange(changes, DirectoryChangeType::Modified, "keep/b.bin"));
+
+		watcher.Stop();
+		fs::remove_all(root, error);
+	}
+
+	/**
+	 * Writes a registry whose assets depend on each other and loads it back: dependencies keep
+	 * their full identifier hashes and resolve to the registrations they name
+	 */
+	TEST_CASE(RegistryDependencies)
+	{
+		const fs::path path = fs::temp_directory_path() / "NobleRegistryTest.nreg";
+
+		AssetRegistryWriter writer;
+		Array<NIdentifier> dependencies;
+		writer.Add("Leaf", "Content/Leaf.mesh", AssetType::AT_STATIC_MESH, 16, dependencies);
+		dependencies.Add(ID("Leaf"));
+		writer.Add("Middle", "Content/Middle.mesh", AssetType::AT_STATIC_MESH, 0, dependencies);
+		dependencies.Add(ID("Middle"));
+		writer.Add("Root", "Content/Root.mesh", AssetType::AT_STATIC_MESH, 0, dependencies);
+		TEST_CHECK(writer.Write(path));
+
+		AssetRegistry registry;
+		TEST_CHECK(registry.Load(path));
+
+		const AssetRegistration* root = registry.Find(ID("Root"));
+		TEST_CHECK(root && root->DependencyCount == 2);
+		const IdentifierHash* hashes = registry.GetDependencies(*root);
+		TEST_CHECK(hashes[0] == ID("Leaf").GetIdentifierHash() && hashes[1] == ID("Middle").GetIdentifierHash());
+
+		const AssetRegistration* middle = registry.FindByIdentifierHash(hashes[1]);
+		TEST_CHECK(middle && middle->AssetID == ID("Middle") && middle->DependencyCount == 1);
+		TEST_CHECK(registry.FindByIdentifierHash(registry.GetDependencies(*middle)[0]) == registry.Find(ID("Leaf")));
+		TEST_CHECK(!registry.FindByIdentifierHash(ID("Missing").GetIdentifierHash()));
+
+		// Set at runtime, they're stored the same way
+		AssetRegistration* leaf = registry.Find(ID("Leaf"));
+		const IdentifierHash rootHash = ID("Root").GetIdentifierHash();
+		registry.SetDependencies(*leaf, &rootHash, 1);
+		TEST_CHECK(registry.FindByIdentifierHash(registry.GetDependencies(*leaf)[0]) == registry.Find(ID("Root")));
+
+		registry.Clear();
+		std::error_code error;
+		fs::remove(path, error);
+	}
+
+	/**
+	 * Logs compression ratio and throughput over a large, moderately redundant buffer, with the
+	 * frame decompressed on one thread and on every core
+	 */
+	BENCHMARK_CASE(CompressionThroughput)
+	{
+		U64 seed = 0x9E3779B97F4A7C15ULL;
+		const Size benchSize = 32 * 1024 * 1024;
+		Byte* benchData = new Byte[benchSize];
+		FillTestData(benchData, benchSize, 12, seed);
+
+		BitStream compressed;
+		Timestamp start = Time::GetNowTimestamp();
+		Compression::CompressFrame(benchData, benchSize, compressed);
+		Timestamp compressTime = Time::GetNowTimestamp();
+		compressTime -= start;
+
+		BitStreamView compressedView(compressed);
+		BitStream decompressed(benchSize);
+		start = Time::GetNowTimestamp();
+		TEST_CHECK(Compression::DecompressFrame(compressedView, decompressed));
+		Timestamp decompressTime = Time::GetNowTimestamp();
+		decompressTime -= start;
+		TEST_CHECK(decompressed.GetStoredBytes() == benchSize && std::memcmp(decompressed.GetData(), benchData, benchSize) == 0);
+
+		const U32 workerCount = glm::max(1U, std::thread::hardware_concurrency());
+		BitStreamView parallelView(compressed);
+		BitStream parallelDecompressed(benchSize);
+		start = Time::GetNowTimestamp();
+		TEST_CHECK(Compression::DecompressFrame(parallelView, parallelDecompressed, workerCount));
+		Timestamp parallelTime = Time::GetNowTimestamp();
+		parallelTime -= start;
+		TEST_CHECK(parallelDecompressed.GetStoredBytes() == benchSize && std::memcmp(parallelDecompressed.GetData(), benchData, benchSize) == 0);
+
+		const F32 megabytes = benchSize / (1024.0F * 1024.0F);
+		printf("  Compression: ratio %.3f, compress %.1f MB/s, decompress %.1f MB/s, on %u threads %.1f MB/s\n",
+			F32(compressed.GetStoredBytes()) / benchSize,
+			megabytes / Time::GetDuration(compressTime),
+			megabytes / Time::GetDuration(decompressTime),
+			workerCount,
+			megabytes / Time::GetDuration(parallelTime));
+
+		delete[] benchData;
+	}
+
+	/**
+	 * Logs CRC32C throughput and checksum frame verification throughput on every core
+	 */
+	BENCHMARK_CASE(ChecksumThroughput)
+	{
+		U64 seed = 0xC2B2AE3D27D4EB4FULL;
+		const Size benchSize = 32 * 1024 * 1024;
+		Byte* benchData = new Byte[benchSize];
+		FillTestData(benchData, benchSize, 0, seed);
+
+		Timestamp start = Time::GetNowTimestamp();
+		const U32 crc = Checksum::Crc32c(benchData, benchSize);
+		Timestamp crcTime = Time::GetNowTimestamp();
+		crcTime -= start;
+
+		TEST_CHECK(crc == Checksum::Crc32cSoftware(benchData, benchSize));
+
+		BitStream frame;
+		ChecksumFrame::Write(benchData, benchSize, frame);
+
+		const U32 workerCount = glm::max(1U, std::thread::hardware_concurrency());
+		BitStreamView frameView(frame);
+		ChecksumFrameReader reader;
+		start = Time::GetNowTimestamp();
+		TEST_CHECK(reader.Open(frameView) && reader.VerifyAll(workerCount));
+		Timestamp verifyTime = Time::GetNowTimestamp();
+		verifyTime -= start;
+
+		const F32 megabytes = benchSize / (1024.0F * 1024.0F);
+		printf("  Checksum: %s CRC32C %.1f MB/s, frame verify on %u threads %.1f MB/s\n",
+			Checksum::HasHardwareCrc32c() ? "hardware" : "software",
+			megabytes / Time::GetDuration(crcTime),
+			workerCount,
+			megabytes / Time::GetDuration(verifyTime));
+
+		delete[] benchData;
+	}
+
+	/**
+	 * Compares reading a file through File::Read against touching the same bytes through a
+	 * MappedFile. Both passes checksum the data so each actually reads every byte; the file
+	 * was just written, so this measures the page-cache path rather than the disk.
+	 */
+	BENCHMARK_CASE(FileRead)
+	{
+		const fs::path path = fs::temp_directory_path() / "NobleFileReadBenchmark.bin";
+		const Size benchSize = 64 * 1024 * 1024;
+
+		{
+			U64 seed = 0x27D4EB2F165667C5ULL;
+			Byte* benchData = new Byte[benchSize];
+			FillTestData(benchData, benchSize, 0, seed);
+
+			File output(path, FileMode::FILE_WRITE_REPLACE, true);
+			output.Write(benchData, benchSize);
+			delete[] benchData;
+		}
+
+		Timestamp start = Time::GetNowTimestamp();
+		File input(path, FileMode::FILE_READ);
+		BitStream buffer;
+		input.Read(buffer);
+		const U32 readCrc = Checksum::Crc32c(buffer.GetData(), buffer.GetStoredBytes());
+		Timestamp readTime = Time::GetNowTimestamp();
+		readTime -= start;
+		input.Close();
+
+		start = Time::GetNowTimestamp();
+		MappedFile mapped(path, 0, MappedFile::SequentialScan);
+		const U32 mappedCrc = Checksum::Crc32c(mapped.GetData(), mapped.GetMappedSize());
+		Timestamp mappedTime = Time::GetNowTimestamp();
+		mappedTime -= start;
+		mapped.Close();
+
+		TEST_CHECK(readCrc == mappedCrc && buffer.GetStoredBytes() == benchSize);
+
+		const F32 megabytes = benchSize / (1024.0F * 1024.0F);
+		printf("  File read: File::Read %.1f MB/s, MappedFile %.1f MB/s\n",
+			megabytes / Time::GetDuration(readTime),
+			megabytes / Time::GetDuration(mappedTime));
+
+		fs::remove(path);
+	}
+
+	/**
+	 * Times many small record writes issued straight to a File against the same records
+	 * going through a BufferedFileWriter
+	 */
+	BENCHMARK_CASE(BufferedWrite)
+	{
+		const fs::path path = fs::temp_directory_path() / "NobleBufferedWriteBenchmark.bin";
+		const U32 recordCount = 200000;
+
+		struct Record
+		{
+			U32 Id;
+			F32 Position[3];
+		};
+
+		Timestamp start = Time::GetNowTimestamp();
+		{
+			File output(path, FileMode::FILE_WRITE_REPLACE, true);
+			for (U32 i = 0; i < recordCount; ++i)
+			{
+				const Record record = { i, { F32(i), 0.0F, 1.0F } };
+				output.Write(&record, sizeof(record));
+			}
+		}
+		Timestamp directTime = Time::GetNowTimestamp();
+		directTime -= start;
+
+		start = Time::GetNowTimestamp();
+		{
+			File output(path, FileMode::FILE_WRITE_REPLACE, true);
+			BufferedFileWriter writer(output);
+			for (U32 i = 0; i < recordCount; ++i)
+			{
+				const Record record = { i, { F32(i), 0.0F, 1.0F } };
+				writer.Write(record);
+			}
+		}
+		Timestamp bufferedTime = Time::GetNowTimestamp();
+		bufferedTime -= start;
+
+		TEST_CHECK(CheckFileSize(path.string().c_str()) == recordCount * sizeof(Record));
+
+		printf("  Small writes: File::Write %.2f ms, BufferedFileWriter %.2f ms\n",
+			Time::GetDuration(directTime) * 1000.0F,
+			Time::GetDuration(bufferedTime) * 1000.0F);
+
+		fs::remove(path);
+	}
+
+	/**
+	 * Times a cold DirectoryIndex build of a generated content tree against a recursive
+	 * directory walk, then a batch of lookups that no longer touch the disk
+	 */
+	BENCHMARK_CASE(DirectoryIndexBuild)
+	{
+		const fs::path root = fs::temp_directory_path() / "NobleIndexBenchmark";
+		std::error_code error;
+		fs::remove_all(root, error);
+
+		constexpr U32 DirectoryCount = 64;
+		constexpr U32 FilesPerDirectory = 64;
+		char name[64];
+		for (U32 dir = 0; dir < DirectoryCount; ++dir)
+		{
+			snprintf(name, sizeof(name), "%s/group%u", dir % 4 == 0 ? "shaders" : "models", dir);
+			fs::create_directories(root / name, error);
+			for (U32 file = 0; file < FilesPerDirectory; ++file)
+			{
+				snprintf(name, sizeof(name), "%s/group%u/asset%u.bin", dir % 4 == 0 ? "shaders" : "models", dir, file);
+				File output(root / name, FileMode::FILE_WRITE_REPLACE, true);
+				output.Write(name, 16);
+			}
+		}
+
+		Timestamp start = Time::GetNowTimestamp();
+		Directory content(root);
+		content.IterateRecursive();
+		Timestamp walkTime = Time::GetNowTimestamp();
+		walkTime -= start;
+
+		start = Time::GetNowTimestamp();
+		DirectoryIndex index;
+		index.Build(root);
+		Timestamp buildTime = Time::GetNowTimestamp();
+		buildTime -= start;
+
+		start = Time::GetNowTimestamp();
+		Size found = 0;
+		for (const DirectoryEntry& entry : index.GetEntries())
+		{
+			found += index.Find(index.GetPath(entry)) == &entry ? 1 : 0;
+		}
+		const Size shaders = index.FindByPrefix("shaders/").GetCount();
+		Timestamp queryTime = Time::GetNowTimestamp();
+		queryTime -= start;
+
+		TEST_CHECK(index.GetCount() == DirectoryCount * FilesPerDirectory && found == index.GetCount());
+		TEST_CHECK(shaders == index.GetCount() / 4);
+
+		printf("  Content index: %llu files (%llu shaders), walk %.2f ms, build %.2f ms, lookups %.3f ms\n",
+			(unsigned long long)index.GetCount(), (unsigned long long)shaders,
+			Time::GetDuration(walkTime) * 1000.0F,
+			Time::GetDuration(buildTime) * 1000.0F,
+			Time::GetDuration(queryTime) * 1000.0F);
+
+		fs::remove_all(root, error);
+	}
+
+	/**
+	 * Writes thousands of small assets as loose files and as one pack, then times opening
+	 * and reading every asset each way
+	 */
+	BENCHMARK_CASE(PackRead)
+	{
+		const fs::path root = fs::temp_directory_path() / "NoblePackBenchmark";
+		const fs::path packPath = fs::temp_directory_path() / "NoblePackBenchmark.npak";
+		const U32 assetCount = 4000;
+		const U32 directoryCount = 32;
+
+		std::error_code error;
+		fs::remove_all(root, error);
+		for (U32 i = 0; i < directoryCount; ++i)
+		{
+			fs::create_directories(root / std::to_string(i), error);
+		}
+
+		// Sizes from 256 bytes to 4 KB; every other asset repeats its first quarter, so it compresses
+		U64 seed = 0xC2B2AE3D27D4EB4FULL;
+		Byte data[4096];
+		char name[32];
+		for (U32 i = 0; i < assetCount; ++i)
+		{
+			const Size size = 256 + (seed >> 32) % (sizeof(data) - 256);
+			const Size randomSize = (i % 2) ? size / 4 : size;
+			FillTestData(data, randomSize, 0, seed);
+			for (Size j = randomSize; j < size; ++j)
+			{
+				data[j] = data[j - randomSize];
+			}
+
+			snprintf(name, sizeof(name), "%u/%u.bin", i % directoryCount, i);
+			File output(root / name, FileMode::FILE_WRITE_REPLACE, true);
+			output.Write(data, size);
+		}
+
+		DirectoryIndex index;
+		index.Build(root);
+		PackWriter writer;
+		writer.AddDirectory(index);
+		TEST_CHECK(writer.Write(packPath));
+
+		Timestamp start = Time::GetNowTimestamp();
+		U32 looseCrc = 0;
+		for (U32 i = 0; i < assetCount; ++i)
+		{
+			snprintf(name, sizeof(name), "%u/%u.bin", i % directoryCount, i);
+			MappedFile file(root / name, 0, MappedFile::SequentialScan);
+			looseCrc = Checksum::Crc32c(file.GetData(), file.GetMappedSize(), looseCrc);
+		}
+		Timestamp looseTime = Time::GetNowTimestamp();
+		looseTime -= start;
+
+		start = Time::GetNowTimestamp();
+		U32 packCrc = 0;
+		{
+			PackFile pack;
+			pack.Open(packPath);
+			BitStream decompressed;
+			for (U32 i = 0; i < assetCount; ++i)
+			{
+				snprintf(name, sizeof(name), "%u/%u.bin", i % directoryCount, i);
+				const PackEntry* entry = pack.Find(name);
+				if (!entry)
+				{
+					continue;
+				}
+
+				if (PackFile::IsCompressed(*entry))
+				{
+					decompressed.Reset();
+					pack.Read(*entry, decompressed);
+					packCrc = Checksum::Crc32c(decompressed.GetData(), decompressed.GetStoredBytes(), packCrc);
+				}
+				else
+				{
+					BitStreamView view;
+					pack.GetView(*entry, view);
+					packCrc = Checksum::Crc32c(view.GetData(), view.GetSize(), packCrc);
+				}
+			}
+		}
+		Timestamp packTime = Time::GetNowTimestamp();
+		packTime -= start;
+
+		TEST_CHECK(looseCrc == packCrc);
+
+		printf("  Reading %u small assets: loose files %.2f ms, pack %.2f ms (%llu of them compressed)\n",
+			assetCount,
+			Time::GetDuration(looseTime) * 1000.0F,
+			Time::GetDuration(packTime) * 1000.0F,
+			(unsigned long long)writer.GetCompressedCount());
+
+		fs::remove_all(root, error);
+		fs::remove(packPath, error);
+	}
+
+	/**
+	 * Registers a large synthetic asset set one Register call at a time, then times compiling
+	 * it into a registry file and loading that instead
+	 */
+	BENCHMARK_CASE(RegistryLoad)
+	{
+		const fs::path path = fs::temp_directory_path() / "NobleRegistryBenchmark.nreg";
+		const U32 assetCount = 100000;
+
+		char id[32];
+		char assetPath[64];
+		Timestamp start = Time::GetNowTimestamp();
+		{
+			AssetRegistry registry;
+			for (U32 i = 0; i < assetCount; ++i)
+			{
+				const int idLength = snprintf(id, sizeof(id), "Asset%u", i);
+				snprintf(assetPath, sizeof(assetPath), "Content/Assets/%u/Asset%u.bin", i % 64, i);
+				registry.Register(NIdentifier(id, idLength), assetPath, AssetType(i % AssetTypeCount));
+			}
+		}
+		Timestamp registerTime = Time::GetNowTimestamp();
+		registerTime -= start;
+
+		AssetRegistryWriter writer;
+		Array<NIdentifier> dependencies;
+		for (U32 i = 0; i < assetCount; ++i)
+		{
+			snprintf(id, sizeof(id), "Asset%u", i);
+			snprintf(assetPath, sizeof(assetPath), "Content/Assets/%u/Asset%u.bin", i % 64, i);
+			writer.Add(id, assetPath, AssetType(i % AssetTypeCount), 0, dependencies);
+		}
+		TEST_CHECK(writer.Write(path));
+
+		start = Time::GetNowTimestamp();
+		Size found = 0;
+		{
+			AssetRegistry registry;
+			registry.Load(path);
+			for (U32 i = 0; i < assetCount; i += 97)
+			{
+				const int idLength = snprintf(id, sizeof(id), "Asset%u", i);
+				found += registry.Find(NIdentifier(id, idLength)) ? 1 : 0;
+			}
+		}
+		Timestamp loadTime = Time::GetNowTimestamp();
+		loadTime -= start;
+
+		TEST_CHECK(found == (assetCount + 96) / 97);
+
+		printf("  Registering %u assets: one at a time %.2f ms, from a registry file %.2f ms\n",
+			assetCount,
+			Time::GetDuration(registerTime) * 1000.0F,
+			Time::GetDuration(loadTime) * 1000.0F);
+
+		std::error_code error;
+		fs::remove(path, error);
+	}
+}
\ No newline at end of file
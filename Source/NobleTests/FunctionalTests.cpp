@@ -0,0 +1,155 @@
+#include "EventBus.h"
+#include "Functional.h"
+#include "TestFramework.h"
+
+namespace Noble
+{
+	/**
+	 * Adds bindings from inside a broadcast while the storage is full, which used to free
+	 * the array the broadcast was iterating; the new bindings join on the next broadcast
+	 */
+	TEST_CASE(MulticastAddDuringBroadcast)
+	{
+		MulticastDelegate<void(int)> multicast;
+		int calls[8] = {};
+
+		// The first growth makes room for exactly four
+		for (int i = 0; i < 3; ++i)
+		{
+			multicast.Add([&calls, i](int) { ++calls[i]; });
+		}
+		multicast.Add([&](int value)
+		{
+			++calls[3];
+			if (value == 0)
+			{
+				for (int i = 4; i < 8; ++i)
+				{
+					multicast.Add([&calls, i](int) { ++calls[i]; });
+				}
+			}
+		});
+
+		multicast.Broadcast(0);
+		TEST_CHECK(multicast.GetCount() == 8);
+		for (int i = 0; i < 8; ++i)
+		{
+			TEST_CHECK(calls[i] == (i < 4 ? 1 : 0));
+		}
+
+		multicast.Broadcast(1);
+		for (int i = 0; i < 8; ++i)
+		{
+			TEST_CHECK(calls[i] == (i < 4 ? 2 : 1));
+		}
+	}
+
+	/**
+	 * Removes the running binding, a later one and one added in the same broadcast
+	 */
+	TEST_CASE(MulticastRemoveDuringBroadcast)
+	{
+		MulticastDelegate<void()> multicast;
+		int calls[4] = {};
+		DelegateHandle handles[4];
+
+		handles[0] = multicast.Add([&]()
+		{
+			++calls[0];
+			TEST_CHECK(multicast.Remove(handles[0]));
+			TEST_CHECK(multicast.Remove(handles[1]));
+
+			handles[3] = multicast.Add([&]() { ++calls[3]; });
+			TEST_CHECK(multicast.Remove(handles[3]));
+			TEST_CHECK(!multicast.Remove(handles[3]));
+		});
+		handles[1] = multicast.Add([&]() { ++calls[1]; });
+		handles[2] = multicast.Add([&]() { ++calls[2]; });
+
+		multicast.Broadcast();
+		TEST_CHECK(calls[0] == 1 && calls[1] == 0 && calls[2] == 1 && calls[3] == 0);
+		TEST_CHECK(multicast.GetCount() == 1);
+		TEST_CHECK(!multicast.Remove(InvalidDelegateHandle));
+
+		multicast.Broadcast();
+		TEST_CHECK(calls[0] == 1 && calls[1] == 0 && calls[2] == 2 && calls[3] == 0);
+	}
+
+	/**
+	 * Broadcasts again from inside a binding; changes wait for the outer broadcast to finish
+	 */
+	TEST_CASE(MulticastNestedBroadcast)
+	{
+		MulticastDelegate<void(int)> multicast;
+		int outerCalls = 0;
+		int innerCalls = 0;
+		int addedCalls = 0;
+
+		multicast.Add([&](int depth)
+		{
+			++outerCalls;
+			if (depth == 0)
+			{
+				multicast.Broadcast(1);
+				multicast.Add([&](int) { ++addedCalls; });
+			}
+		});
+		multicast.Add([&](int depth)
+		{
+			++innerCalls;
+			if (depth == 1)
+			{
+				multicast.Add([&](int) { ++addedCalls; });
+			}
+		});
+
+		multicast.Broadcast(0);
+		TEST_CHECK(outerCalls == 2 && innerCalls == 2 && addedCalls == 0);
+		TEST_CHECK(multicast.GetCount() == 4);
+
+		multicast.Broadcast(2);
+		TEST_CHECK(addedCalls == 2);
+	}
+
+	namespace
+	{
+		struct TestEvent
+		{
+			int Value;
+		};
+	}
+
+	/**
+	 * Subscribes from inside an EventBus handler, which broadcasts to the subscribers
+	 */
+	TEST_CASE(EventBusSubscribeDuringDispatch)
+	{
+		EventBus bus;
+		int sum = 0;
+		int lateSum = 0;
+
+		for (int i = 0; i < 4; ++i)
+		{
+			bus.Subscribe<TestEvent>([&](const EventBatch<TestEvent>& batch)
+			{
+				for (const TestEvent& ev : batch)
+				{
+					sum += ev.Value;
+				}
+			});
+		}
+		bus.Subscribe<TestEvent>([&](const EventBatch<TestEvent>&)
+		{
+			bus.Subscribe<TestEvent>([&](const EventBatch<TestEvent>& batch) { lateSum += (int)batch.Count; });
+		});
+
+		bus.Send(TestEvent{ 3 });
+		bus.Dispatch();
+		TEST_CHECK(sum == 12 && lateSum == 0);
+
+		bus.Send(TestEvent{ 1 });
+		bus.Send(TestEvent{ 1 });
+		bus.Dispatch();
+		TEST_CHECK(sum == 20 && lateSum == 2);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#include <cstring>
+
+#include "String.h"
+#include "TestFramework.h"
+
+namespace Noble
+{
+	/**
+	 * HASH, HashIdentifier and GetHash give the same 32-bit hash for a name whether it's a literal,
+	 * hashed at compile time, or a runtime string, which is what switches over binding hashes rely on.
+	 * Run once per identifier mode; the wide build also checks it's the low half of the 64-bit hash
+	 */
+	TEST_CASE(IdentifierHashes)
+	{
+		const char* const names[4] = { "Jump", "MoveForward", "", "A name longer than the sixteen bytes hashed in one step" };
+		for (const char* name : names)
+		{
+			const NIdentifier runtime(name, std::strlen(name));
+			TEST_CHECK(runtime.GetHash() == HASH(name));
+			TEST_CHECK(runtime.GetHash() == HashIdentifier(name));
+#ifdef NOBLE_WIDE_IDENTIFIERS
+			TEST_CHECK(runtime.GetIdentifierHash() == HashString64(name, std::strlen(name)));
+			TEST_CHECK(runtime.GetHash() == NarrowIdentifierHash(runtime.GetIdentifierHash()));
+#else
+			TEST_CHECK(runtime.GetHash() == HashString(name));
+			TEST_CHECK(runtime.GetHash() == HashStringN(name, std::strlen(name)));
+#endif
+		}
+
+		// Literals go through the compile-time paths
+		constexpr U32 jumpHash = HashIdentifier("Jump");
+		TEST_CHECK(ID("Jump").GetHash() == jumpHash);
+		TEST_CHECK(ID("Jump").GetHash() == HASH("Jump"));
+		TEST_CHECK("Jump"_ID == ID("Jump"));
+		TEST_CHECK(ID("Jump") == NIdentifier("Jump", 4, ID("Jump").GetIdentifierHash()));
+		TEST_CHECK(NIdentifier(nullptr, 0, 0) == NIdentifier());
+#ifdef NOBLE_WIDE_IDENTIFIERS
+		TEST_CHECK(ID("Jump").GetIdentifierHash() == HASH64("Jump"));
+#else
+		TEST_CHECK(ID("Jump").GetHash() == "Jump"_hash);
+#endif
+
+		U32 matched = 0;
+		switch (NIdentifier("MoveForward", 11).GetHash())
+		{
+			case HASH("Jump"):
+				break;
+			case HASH("MoveForward"):
+				++matched;
+				break;
+		}
+		TEST_CHECK(matched == 1);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,486 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+#include "AssetManager.h"
+#include "FileSystem.h"
+#include "Globals.h"
+#include "MeshOptimizer.h"
+#include "MeshQuantizer.h"
+#include "StaticMeshFile.h"
+#include "TestFramework.h"
+#include "Time.h"
+
+namespace Noble
+{
+	/**
+	 * Builds a UV sphere of radius 10, with (rings + 1) * (segments + 1) vertices and
+	 * rings * segments * 6 indices
+	 */
+	static void BuildSphereMesh(U32 rings, U32 segments, StaticVertex*& vertices, U32*& indices)
+	{
+		vertices = new StaticVertex[(rings + 1) * (segments + 1)];
+		for (U32 r = 0; r <= rings; ++r)
+		{
+			const F32 theta = glm::radians(180.0F * r / rings);
+			for (U32 s = 0; s <= segments; ++s)
+			{
+				const F32 phi = glm::radians(360.0F * s / segments);
+				StaticVertex& vertex = vertices[r * (segments + 1) + s];
+				vertex.Normal = Vector3f(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+				vertex.Tangent = Vector3f(-std::sin(phi), 0.0F, std::cos(phi));
+				vertex.Position = vertex.Normal * 10.0F + Vector3f(5.0F, 0.0F, -2.0F);
+				vertex.TexCoord = Vector2f((F32)s / segments, (F32)r / rings);
+			}
+		}
+
+		indices = new U32[rings * segments * 6];
+		for (U32 r = 0; r < rings; ++r)
+		{
+			for (U32 s = 0; s < segments; ++s)
+			{
+				const U32 corner = r * (segments + 1) + s;
+				const U32 quad[6] = { corner, corner + segments + 1, corner + 1, corner + 1, corner + segments + 1, corner + segments + 2 };
+				std::memcpy(&indices[(r * segments + s) * 6], quad, sizeof(quad));
+			}
+		}
+	}
+
+	/**
+	 * Quantizes a UV sphere to compact vertices, checks the error is within the default
+	 * limits, then checks a mesh file keeps the compact vertices and their position transform
+	 */
+	TEST_CASE(MeshQuantization)
+	{
+		// Not powers of two, so the texture coordinates aren't all exact in half precision
+		const U32 rings = 250;
+		const U32 segments = 500;
+		const U32 vertexCount = (rings + 1) * (segments + 1);
+		const U32 indexCount = rings * segments * 6;
+
+		StaticVertex* vertices;
+		U32* indices;
+		BuildSphereMesh(rings, segments, vertices, indices);
+
+		Vector3f positionOffset;
+		F32 positionScale;
+		MeshQuantizer::ComputeBounds(vertices, vertexCount, positionOffset, positionScale);
+
+		CompactStaticVertex* compact = new CompactStaticVertex[vertexCount];
+		const MeshQuantizationError error = MeshQuantizer::Quantize(vertices, vertexCount, positionOffset, positionScale, compact);
+		TEST_CHECK(MeshQuantizer::IsAcceptable(error));
+
+		BitStream cooked;
+		StaticMeshFile::Write(compact, vertexCount, positionOffset, positionScale, indices, indexCount, nullptr, 0, nullptr, 0, cooked);
+		BitStreamView view(cooked.GetData(), cooked.GetStoredBytes());
+		StaticMeshFile file;
+		TEST_CHECK(file.Open(view) && file.GetVertexFormat() == StaticVertexFormat::Compact);
+		TEST_CHECK(file.GetPositionOffset() == positionOffset && file.GetPositionScale() == positionScale);
+		TEST_CHECK(std::memcmp(file.GetVertexData(), compact, Size(vertexCount) * sizeof(CompactStaticVertex)) == 0);
+
+		delete[] vertices;
+		delete[] indices;
+		delete[] compact;
+	}
+
+	/**
+	 * Simplifies a UV sphere into LODs, checks each has fewer triangles and more error than
+	 * the one before, then checks a mesh file keeps the LOD table
+	 */
+	TEST_CASE(MeshLods)
+	{
+		const U32 rings = 100;
+		const U32 segments = 200;
+		const U32 indexCount = rings * segments * 6;
+
+		StaticVertex* vertices;
+		U32* sphereIndices;
+		BuildSphereMesh(rings, segments, vertices, sphereIndices);
+		const U32 vertexCount = MeshOptimizer::Optimize(vertices, (rings + 1) * (segments + 1), sphereIndices, indexCount);
+
+		Array<U32> indices;
+		indices.Resize(indexCount * 2);
+		indices.AddMultiple(sphereIndices, indexCount);
+		delete[] sphereIndices;
+
+		StaticMeshLod lods[StaticMesh::MaxLodCount];
+		const U32 lodCount = MeshOptimizer::GenerateLods(indices, vertices, vertexCount, lods, StaticMesh::MaxLodCount);
+		TEST_CHECK(lodCount > 1);
+		for (U32 i = 1; i < lodCount; ++i)
+		{
+			TEST_CHECK(lods[i].IndexCount < lods[i - 1].IndexCount && lods[i].Error >= lods[i - 1].Error);
+		}
+
+		BitStream cooked;
+		StaticMeshFile::Write(vertices, vertexCount, indices.GetData(), static_cast<U32>(indices.GetCount()), lods, lodCount, nullptr, 0, cooked);
+		BitStreamView view(cooked.GetData(), cooked.GetStoredBytes());
+		StaticMeshFile file;
+		TEST_CHECK(file.Open(view) && file.GetLodCount() == lodCount);
+		for (U32 i = 0; i < file.GetLodCount(); ++i)
+		{
+			TEST_CHECK(file.GetLod(i).FirstIndex == lods[i].FirstIndex && file.GetLod(i).IndexCount == lods[i].IndexCount);
+		}
+
+		delete[] vertices;
+	}
+
+	/**
+	 * Corrupts a cooked quad in ways Open has to catch before the data is used in place: an index
+	 * past the last vertex, an index block moved on top of the vertices, and clusters out of order
+	 * or overlapping within their LOD
+	 */
+	TEST_CASE(MeshFileValidation)
+	{
+		StaticVertex vertices[4];
+		const StaticMesh::Index indices[6] = { 0, 1, 2, 2, 1, 3 };
+		BitStream cooked;
+		StaticMeshFile::Write(vertices, 4, indices, 6, cooked);
+
+		StaticMeshFile file;
+		TEST_CHECK(file.Open(BitStreamView(cooked.GetData(), cooked.GetStoredBytes())));
+
+		// Block offsets follow the magic, version and vertex and index counts and sizes
+		BitStreamView header(cooked.GetData(), StaticMeshFile::HeaderSize);
+		header.SetByteOrder(ByteOrder::Little);
+		header.Skip(6 * sizeof(U32));
+		const U32 vertexOffset = header.Read<U32>();
+		const U32 indexOffset = header.Read<U32>();
+
+		BitStream badIndex;
+		badIndex.WriteBytes(cooked.GetData(), cooked.GetStoredBytes());
+		badIndex.GetData()[indexOffset + 2 * sizeof(U16)] = 4;
+		TEST_CHECK(!file.Open(BitStreamView(badIndex.GetData(), badIndex.GetStoredBytes())));
+
+		BitStream overlapping;
+		overlapping.WriteBytes(cooked.GetData(), cooked.GetStoredBytes());
+		std::memcpy(overlapping.GetData() + 7 * sizeof(U32), &vertexOffset, sizeof(U32));
+		TEST_CHECK(!file.Open(BitStreamView(overlapping.GetData(), overlapping.GetStoredBytes())));
+
+		// One cluster per triangle, in order
+		StaticMeshLod lod(0, 6, 0.0F);
+		lod.ClusterCount = 2;
+		StaticMeshCluster clusters[2];
+		clusters[0].IndexCount = 3;
+		clusters[1].FirstIndex = 3;
+		clusters[1].IndexCount = 3;
+		BitStream clustered;
+		StaticMeshFile::Write(vertices, 4, indices, 6, &lod, 1, clusters, 2, clustered);
+		TEST_CHECK(file.Open(BitStreamView(clustered.GetData(), clustered.GetStoredBytes())) && file.GetClusterCount() == 2);
+
+		std::swap(clusters[0], clusters[1]);
+		BitStream unsorted;
+		StaticMeshFile::Write(vertices, 4, indices, 6, &lod, 1, clusters, 2, unsorted);
+		TEST_CHECK(!file.Open(BitStreamView(unsorted.GetData(), unsorted.GetStoredBytes())));
+
+		clusters[0].FirstIndex = 0;
+		clusters[0].IndexCount = 6;
+		BitStream overlappingClusters;
+		StaticMeshFile::Write(vertices, 4, indices, 6, &lod, 1, clusters, 2, overlappingClusters);
+		TEST_CHECK(!file.Open(BitStreamView(overlappingClusters.GetData(), overlappingClusters.GetStoredBytes())));
+	}
+
+	/**
+	 * Writes a 1M-vertex mesh in the older format and as a StaticMeshFile, then times loading
+	 * each through the AssetManager: a copy and parse against an upload straight from the mapping
+	 */
+	BENCHMARK_CASE(MeshLoad)
+	{
+		const fs::path legacyPath = fs::temp_directory_path() / "NobleMeshBenchmark.mesh";
+		const fs::path cookedPath = fs::temp_directory_path() / "NobleMeshBenchmarkCooked.mesh";
+		const U32 vertexCount = 1 << 20;
+		const U32 indexCount = vertexCount * 3;
+
+		{
+			StaticVertex* vertices = new StaticVertex[vertexCount];
+			StaticMesh::Index* indices = new StaticMesh::Index[indexCount];
+			for (U32 i = 0; i < vertexCount; ++i)
+			{
+				vertices[i].Position = Vector3f((F32)i, (F32)(i * 2), (F32)(i * 3));
+			}
+			for (U32 i = 0; i < indexCount; ++i)
+			{
+				indices[i] = (i * 7) % vertexCount;
+			}
+
+			BitStream legacy(sizeof(U32) * 2 + sizeof(StaticVertex) * vertexCount + sizeof(StaticMesh::Index) * indexCount);
+			legacy.Write<U32>(vertexCount);
+			legacy.WriteArray(vertices, vertexCount);
+			legacy.Write<U32>(indexCount);
+			legacy.WriteArray(indices, indexCount);
+			File legacyFile(legacyPath, FileMode::FILE_WRITE_REPLACE, true);
+			legacyFile.Write(legacy.GetData(), legacy.GetStoredBytes());
+
+			BitStream cooked;
+			StaticMeshFile::Write(vertices, vertexCount, indices, indexCount, cooked);
+			File cookedFile(cookedPath, FileMode::FILE_WRITE_REPLACE, true);
+			cookedFile.Write(cooked.GetData(), cooked.GetStoredBytes());
+
+			delete[] vertices;
+			delete[] indices;
+		}
+
+		AssetManager* assets = GetAssetManager();
+		const NIdentifier legacyID = ID("MeshBenchmarkLegacy");
+		const NIdentifier cookedID = ID("MeshBenchmarkCooked");
+		assets->RegisterAsset(legacyID, legacyPath.string().c_str(), AssetType::AT_STATIC_MESH);
+		assets->RegisterAsset(cookedID, cookedPath.string().c_str(), AssetType::AT_STATIC_MESH);
+
+		Timestamp start = Time::GetNowTimestamp();
+		const StaticMesh* legacyMesh = assets->GetStaticMesh(legacyID);
+		Timestamp legacyTime = Time::GetNowTimestamp();
+		legacyTime -= start;
+
+		start = Time::GetNowTimestamp();
+		const StaticMesh* cookedMesh = assets->GetStaticMesh(cookedID);
+		Timestamp cookedTime = Time::GetNowTimestamp();
+		cookedTime -= start;
+
+		TEST_CHECK(legacyMesh && cookedMesh && legacyMesh->GetIndexCount() == cookedMesh->GetIndexCount());
+
+		printf("  Loading a %u-vertex mesh: copied %.2f ms, in place %.2f ms\n",
+			vertexCount,
+			Time::GetDuration(legacyTime) * 1000.0F,
+			Time::GetDuration(cookedTime) * 1000.0F);
+
+		// bgfx holds on to the data until it's uploaded; the cooked file stays mapped until then
+		assets->UnloadAsset(legacyID);
+		assets->UnloadAsset(cookedID);
+		assets->UnregisterAsset(legacyID);
+		assets->UnregisterAsset(cookedID);
+		std::error_code error;
+		fs::remove(legacyPath, error);
+		fs::remove(cookedPath, error);
+	}
+
+	/**
+	 * Builds a grid mesh the way an unindexed exporter would, three vertices per triangle with
+	 * the triangles shuffled, then logs its cache statistics before and after optimization.
+	 * Vertex fetch is measured on the deduplicated, cache-ordered mesh just before and after its own step
+	 */
+	BENCHMARK_CASE(MeshOptimization)
+	{
+		const U32 gridSize = 256;
+		const U32 indexCount = gridSize * gridSize * 6;
+
+		StaticVertex* vertices = new StaticVertex[indexCount];
+		U32* indices = new U32[indexCount];
+		U64 seed = 0x165667B19E3779F9ULL;
+		for (U32 quad = 0; quad < gridSize * gridSize; ++quad)
+		{
+			const U32 x = quad % gridSize;
+			const U32 y = quad / gridSize;
+			const U32 corners[6][2] = { { x, y }, { x + 1, y }, { x + 1, y + 1 }, { x, y }, { x + 1, y + 1 }, { x, y + 1 } };
+			for (U32 k = 0; k < 6; ++k)
+			{
+				StaticVertex& vertex = vertices[quad * 6 + k];
+				vertex.Position = Vector3f((F32)corners[k][0], (F32)corners[k][1], 0.0F);
+				vertex.TexCoord = Vector2f(corners[k][0] / (F32)gridSize, corners[k][1] / (F32)gridSize);
+				vertex.Normal = Vector3f(0.0F, 0.0F, 1.0F);
+				indices[quad * 6 + k] = quad * 6 + k;
+			}
+		}
+
+		// Fisher-Yates over whole triangles. The vertices move with them, as an exporter writes
+		// them in triangle order; shuffling only the indices would leave the vertex memory in
+		// scanline order, which already suits vertex fetch
+		for (U32 t = indexCount / 3 - 1; t > 0; --t)
+		{
+			seed ^= seed << 13;
+			seed ^= seed >> 7;
+			seed ^= seed << 17;
+			const U32 other = static_cast<U32>(seed % (t + 1));
+			for (U32 k = 0; k < 3; ++k)
+			{
+				std::swap(vertices[t * 3 + k], vertices[other * 3 + k]);
+			}
+		}
+
+		const MeshCacheStats soup = MeshOptimizer::Analyze(indices, indexCount, indexCount);
+
+		// The same steps as MeshOptimizer::Optimize, so fetch can be measured just before its own step
+		Timestamp start = Time::GetNowTimestamp();
+		U32 vertexCount = MeshOptimizer::DeduplicateVertices(vertices, indexCount, indices, indexCount);
+		MeshOptimizer::OptimizeVertexCache(indices, indexCount, vertexCount);
+		MeshOptimizer::OptimizeOverdraw(indices, indexCount, vertices, vertexCount);
+		Timestamp optimizeTime = Time::GetNowTimestamp();
+		optimizeTime -= start;
+
+		const MeshCacheStats cacheOrdered = MeshOptimizer::Analyze(indices, indexCount, vertexCount);
+		start = Time::GetNowTimestamp();
+		vertexCount = MeshOptimizer::OptimizeVertexFetch(vertices, vertexCount, indices, indexCount);
+		Timestamp fetchTime = Time::GetNowTimestamp();
+		fetchTime -= start;
+		optimizeTime += fetchTime;
+		const MeshCacheStats after = MeshOptimizer::Analyze(indices, indexCount, vertexCount);
+
+		// Renaming vertices leaves the post-transform cache alone, and mustn't fetch more memory
+		TEST_CHECK(vertexCount == (gridSize + 1) * (gridSize + 1) && cacheOrdered.ACMR < soup.ACMR);
+		TEST_CHECK(after.ACMR == cacheOrdered.ACMR && after.Overfetch <= cacheOrdered.Overfetch);
+
+		printf("  Mesh optimization of %u triangles in %.2f ms: vertices %u -> %u, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n",
+			indexCount / 3, Time::GetDuration(optimizeTime) * 1000.0F, indexCount, vertexCount,
+			soup.ACMR, after.ACMR, soup.ATVR, after.ATVR);
+		printf("  Vertex fetch ordering in %.2f ms: overfetch %.3f -> %.3f\n",
+			Time::GetDuration(fetchTime) * 1000.0F, cacheOrdered.Overfetch, after.Overfetch);
+
+		delete[] vertices;
+		delete[] indices;
+	}
+
+	/**
+	 * Quantizes a UV sphere to compact vertices and logs the time, the memory saved and the error report
+	 */
+	BENCHMARK_CASE(MeshQuantizationReport)
+	{
+		const U32 rings = 250;
+		const U32 segments = 500;
+		const U32 vertexCount = (rings + 1) * (segments + 1);
+
+		StaticVertex* vertices;
+		U32* indices;
+		BuildSphereMesh(rings, segments, vertices, indices);
+
+		Vector3f positionOffset;
+		F32 positionScale;
+		MeshQuantizer::ComputeBounds(vertices, vertexCount, positionOffset, positionScale);
+
+		CompactStaticVertex* compact = new CompactStaticVertex[vertexCount];
+		Timestamp start = Time::GetNowTimestamp();
+		const MeshQuantizationError error = MeshQuantizer::Quantize(vertices, vertexCount, positionOffset, positionScale, compact);
+		Timestamp quantizeTime = Time::GetNowTimestamp();
+		quantizeTime -= start;
+
+		printf("  Quantized %u vertices in %.2f ms: %llu -> %llu bytes, %s the default limits\n",
+			vertexCount, Time::GetDuration(quantizeTime) * 1000.0F,
+			(unsigned long long)(Size(vertexCount) * sizeof(StaticVertex)), (unsigned long long)(Size(vertexCount) * sizeof(CompactStaticVertex)),
+			MeshQuantizer::IsAcceptable(error) ? "within" : "over");
+		printf("  Quantization error (max / mean): position %.6f / %.6f, normal %.4f / %.4f degrees, tangent %.4f / %.4f degrees, texcoord %.6f / %.6f\n",
+			error.MaxPosition, error.MeanPosition, error.MaxNormal, error.MeanNormal, error.MaxTangent, error.MeanTangent,
+			error.MaxTexCoord, error.MeanTexCoord);
+
+		delete[] vertices;
+		delete[] indices;
+		delete[] compact;
+	}
+
+	/**
+	 * Simplifies a UV sphere into LODs and logs each one's triangles and error
+	 */
+	BENCHMARK_CASE(MeshLodGeneration)
+	{
+		const U32 rings = 200;
+		const U32 segments = 400;
+		const U32 indexCount = rings * segments * 6;
+
+		StaticVertex* vertices;
+		U32* sphereIndices;
+		BuildSphereMesh(rings, segments, vertices, sphereIndices);
+		const U32 vertexCount = MeshOptimizer::Optimize(vertices, (rings + 1) * (segments + 1), sphereIndices, indexCount);
+
+		Array<U32> indices;
+		indices.Resize(indexCount * 2);
+		indices.AddMultiple(sphereIndices, indexCount);
+		delete[] sphereIndices;
+
+		StaticMeshLod lods[StaticMesh::MaxLodCount];
+		Timestamp start = Time::GetNowTimestamp();
+		const U32 lodCount = MeshOptimizer::GenerateLods(indices, vertices, vertexCount, lods, StaticMesh::MaxLodCount);
+		Timestamp lodTime = Time::GetNowTimestamp();
+		lodTime -= start;
+
+		printf("  Generated %u LODs of %u triangles in %.2f ms\n", lodCount, indexCount / 3, Time::GetDuration(lodTime) * 1000.0F);
+		for (U32 i = 1; i < lodCount; ++i)
+		{
+			// With the default one-pixel limit, a LOD is drawn once a mesh unit covers fewer pixels than this
+			printf("  LOD %u: %u triangles, error %.5f units, used below %.1f pixels per unit\n", i, lods[i].IndexCount / 3, lods[i].Error,
+				1.0F / lods[i].Error);
+		}
+
+		delete[] vertices;
+	}
+
+	/**
+	 * Splits a UV sphere into clusters, loads it through the AssetManager and logs how many triangles
+	 * are left to draw after culling its clusters from a few camera positions, and in how many draws
+	 */
+	BENCHMARK_CASE(ClusterCulling)
+	{
+		const fs::path path = fs::temp_directory_path() / "NobleClusterBenchmark.mesh";
+		const U32 rings = 200;
+		const U32 segments = 400;
+		const U32 indexCount = rings * segments * 6;
+
+		{
+			StaticVertex* vertices;
+			U32* indices;
+			BuildSphereMesh(rings, segments, vertices, indices);
+			const U32 vertexCount = MeshOptimizer::Optimize(vertices, (rings + 1) * (segments + 1), indices, indexCount);
+
+			StaticMeshLod lod(0, indexCount, 0.0F);
+			Array<StaticMeshCluster> clusters;
+			Timestamp start = Time::GetNowTimestamp();
+			MeshOptimizer::BuildClusters(indices, vertices, vertexCount, &lod, 1, clusters);
+			Timestamp buildTime = Time::GetNowTimestamp();
+			buildTime -= start;
+
+			F32 coneAngle = 0.0F;
+			for (const StaticMeshCluster& cluster : clusters)
+			{
+				coneAngle += glm::degrees(std::acos(std::clamp(cluster.ConeCosine, -1.0F, 1.0F)));
+			}
+			printf("  Built %u clusters of %u triangles in %.2f ms: %.1f triangles and a %.1f degree normal cone each on average\n",
+				lod.ClusterCount, indexCount / 3, Time::GetDuration(buildTime) * 1000.0F, indexCount / 3.0F / lod.ClusterCount,
+				coneAngle / lod.ClusterCount);
+
+			BitStream cooked;
+			StaticMeshFile::Write(vertices, vertexCount, indices, indexCount, &lod, 1, clusters.GetData(), lod.ClusterCount, cooked);
+			File file(path, FileMode::FILE_WRITE_REPLACE, true);
+			file.Write(cooked.GetData(), cooked.GetStoredBytes());
+
+			delete[] vertices;
+			delete[] indices;
+		}
+
+		AssetManager* assets = GetAssetManager();
+		const NIdentifier meshID = ID("ClusterBenchmark");
+		assets->RegisterAsset(meshID, path.string().c_str(), AssetType::AT_STATIC_MESH);
+		const StaticMesh* mesh = assets->GetStaticMesh(meshID);
+		TEST_CHECK(mesh && mesh->GetClusterCount() > 0);
+		if (mesh)
+		{
+			// The sphere has radius 10 at the origin: whole in view, seen from just above its surface, and behind the camera
+			const Matrix4x4f projection = glm::perspective(glm::radians(60.0F), 16.0F / 9.0F, 0.1F, 1000.0F);
+			const Vector3f eyes[3] = { Vector3f(0.0F, 0.0F, 40.0F), Vector3f(0.0F, 0.0F, 10.5F), Vector3f(0.0F, 0.0F, 40.0F) };
+			const Vector3f targets[3] = { Vector3f(0.0F), Vector3f(10.0F, 0.0F, 10.5F), Vector3f(0.0F, 0.0F, 80.0F) };
+			const char* const names[3] = { "whole", "close", "behind" };
+
+			Array<U32> visible;
+			Array<StaticMeshDrawRange> ranges;
+			for (U32 i = 0; i < 3; ++i)
+			{
+				const Matrix4x4f meshToClip = projection * glm::lookAt(eyes[i], targets[i], Vector3f(0.0F, 1.0F, 0.0F));
+				visible.Empty();
+				ranges.Empty();
+				Timestamp start = Time::GetNowTimestamp();
+				const U32 visibleIndexCount = mesh->CullClusters(0, meshToClip, eyes[i], true, visible);
+
+				// The ranges StaticMeshComponent draws, merged across gaps of up to one cluster
+				const U32 drawnIndexCount = mesh->MergeClusterRanges(visible.GetData(), visible.GetCount(), 384, ranges);
+				Timestamp cullTime = Time::GetNowTimestamp();
+				cullTime -= start;
+				TEST_CHECK(drawnIndexCount >= visibleIndexCount);
+
+				printf("  Cluster culling, %s view: %llu of %u clusters and %u of %u triangles left in %.3f ms, %u triangles in %llu draws\n",
+					names[i], (unsigned long long)visible.GetCount(), mesh->GetClusterCount(), visibleIndexCount / 3, indexCount / 3,
+					Time::GetDuration(cullTime) * 1000.0F, drawnIndexCount / 3, (unsigned long long)ranges.GetCount());
+			}
+		}
+
+		assets->UnloadAsset(meshID);
+		assets->UnregisterAsset(meshID);
+		std::error_code error;
+		fs::remove(path, error);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "HelperMacros.h"
+#include "Types.h"
+
+namespace Noble
+{
+	/**
+	 * A test or benchmark known to the runner
+	 * Cases register themselves through TEST_CASE and BENCHMARK_CASE before main runs
+	 */
+	struct TestCase
+	{
+		const char* Name;
+		void (*Function)();
+		bool IsBenchmark;
+		TestCase* Next;
+
+		TestCase(const char* name, void (*function)(), bool isBenchmark);
+	};
+
+	/**
+	 * Records a failed check against the running case; the case carries on, so one run
+	 * reports every failure
+	 */
+	void OnTestFailure(const char* exprStr, const SourceInfo& si);
+
+	/**
+	 * Checks the expression and records a failure if it's false
+	 */
+	FORCEINLINE void TestCheckImpl(bool expression, const char* exprStr, const SourceInfo& si)
+	{
+		if (!expression)
+		{
+			OnTestFailure(exprStr, si);
+		}
+	}
+
+	/**
+	 * Fills a buffer with pseudo-random bytes; a higher redundancy (0 to 16) repeats runs
+	 * of earlier bytes more often, as LZ matching finds them, so the data compresses better
+	 */
+	void FillTestData(Byte* data, Size size, U32 redundancy, U64& seed);
+}
+
+#define TEST_CASE_IMPL(NAME, IS_BENCHMARK) \
+static void NAME(); \
+static ::Noble::TestCase s_##NAME##Case(#NAME, &NAME, IS_BENCHMARK); \
+static void NAME()
+
+// Defines a test, run every time the runner starts
+#define TEST_CASE(NAME) TEST_CASE_IMPL(NAME, false)
+// Defines a benchmark, only run when the runner is given -bench
+#define BENCHMARK_CASE(NAME) TEST_CASE_IMPL(NAME, true)
+
+#define TEST_CHECK(EXPR) ::Noble::TestCheckImpl(EXPR, #EXPR, SOURCE_INFO)
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include <cstdio>
+#include <cstring>
+
+#include <bgfx/bgfx.h>
+
+#include "AssetManager.h"
+#include "Globals.h"
+#include "TestFramework.h"
+#include "Time.h"
+
+namespace Noble
+{
+	// Cases in registration order, which is file by file in link order
+	static TestCase* s_FirstCase = nullptr;
+	static TestCase* s_LastCase = nullptr;
+	// Failed checks so far in this run
+	static U32 s_FailureCount = 0;
+	// Stands in for the engine's asset manager while cases run
+	static AssetManager* s_AssetManager = nullptr;
+
+	TestCase::TestCase(const char* name, void (*function)(), bool isBenchmark)
+		: Name(name), Function(function), IsBenchmark(isBenchmark), Next(nullptr)
+	{
+		if (s_LastCase)
+		{
+			s_LastCase->Next = this;
+		}
+		else
+		{
+			s_FirstCase = this;
+		}
+		s_LastCase = this;
+	}
+
+	void OnTestFailure(const char* exprStr, const SourceInfo& si)
+	{
+		++s_FailureCount;
+		printf("  %s(%i): check failed: %s\n", si.File, si.Line, exprStr);
+	}
+
+	void FillTestData(Byte* data, Size size, U32 redundancy, U64& seed)
+	{
+		for (Size i = 0; i < size;)
+		{
+			seed ^= seed << 13;
+			seed ^= seed >> 7;
+			seed ^= seed << 17;
+
+			if (i >= 64 && (seed % 16) < redundancy)
+			{
+				// A run of 4 to 35 bytes copied from up to 4 KB back
+				const Size distance = 1 + (seed >> 8) % glm::min<Size>(i, 4096);
+				const Size end = glm::min<Size>(i + 4 + (seed >> 32) % 32, size);
+				for (; i < end; ++i)
+				{
+					data[i] = data[i - distance];
+				}
+			}
+			else
+			{
+				data[i++] = static_cast<Byte>(seed >> 24);
+			}
+		}
+	}
+
+	AssetManager* GetAssetManager()
+	{
+		return s_AssetManager;
+	}
+
+	// There's no engine here, so the logger writes its file directly
+	AsyncFileIO* GetFileIO() { return nullptr; }
+}
+
+using namespace Noble;
+
+/**
+ * Prints how to run the tests
+ */
+static void PrintUsage()
+{
+	printf("Usage: NobleTests [-bench] [-filter <text>]\n");
+	printf("  -bench          Runs the benchmarks after the tests\n");
+	printf("  -filter <text>  Only runs cases whose name contains the text\n");
+}
+
+int main(int argc, char** argv)
+{
+	bool runBenchmarks = false;
+	const char* filter = nullptr;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "-bench") == 0)
+		{
+			runBenchmarks = true;
+		}
+		else if (std::strcmp(argv[i], "-filter") == 0 && i + 1 < argc)
+		{
+			filter = argv[++i];
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	Time::Initialize();
+
+	// Assets still create their GPU resources, so run bgfx on the main thread without a window
+	bgfx::renderFrame();
+	bgfx::Init initData;
+	initData.type = bgfx::RendererType::Noop;
+	if (!bgfx::init(initData))
+	{
+		fprintf(stderr, "Failed to initialize bgfx\n");
+		return 1;
+	}
+
+	U32 runCount = 0;
+	U32 failedCount = 0;
+	{
+		AssetManager assets;
+		s_AssetManager = &assets;
+
+		for (TestCase* testCase = s_FirstCase; testCase; testCase = testCase->Next)
+		{
+			if ((testCase->IsBenchmark && !runBenchmarks) || (filter && !std::strstr(testCase->Name, filter)))
+			{
+				continue;
+			}
+
+			printf("%s %s\n", testCase->IsBenchmark ? "Benchmark" : "Test", testCase->Name);
+			const U32 failuresBefore = s_FailureCount;
+			testCase->Function();
+
+			// Lets bgfx release anything the case handed it
+			bgfx::frame();
+
+			++runCount;
+			if (s_FailureCount != failuresBefore)
+			{
+				++failedCount;
+				printf("  FAILED\n");
+			}
+		}
+
+		assets.UnloadAllAssets();
+		bgfx::frame();
+		s_AssetManager = nullptr;
+	}
+
+	bgfx::shutdown();
+
+	printf("%u of %u cases passed\n", runCount - failedCount, runCount);
+	return failedCount > 0 ? 1 : 0;
+}
\ No newline at end of file
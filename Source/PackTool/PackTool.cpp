@@ -0,0 +1,493 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "AssetRegistryFile.h"
+#include "Checksum.h"
+#include "DirectoryIndex.h"
+#include "FileSystem.h"
+#include "MeshOptimizer.h"
+#include "MeshQuantizer.h"
+#include "PackFile.h"
+#include "StaticMeshFile.h"
+
+namespace Noble
+{
+	class AsyncFileIO;
+
+	// There's no engine here, so the logger writes its file directly
+	AsyncFileIO* GetFileIO() { return nullptr; }
+}
+
+using namespace Noble;
+
+/**
+ * Prints how to run the tool
+ */
+static void PrintUsage()
+{
+	printf("Usage: PackTool <input directory> <output pack> [options]\n");
+	printf("  -prefix <prefix>  Prepended to every entry's path, e.g. \"shaders/\"\n");
+	printf("  -align <bytes>    Alignment of each entry's data, a power of two (default %u)\n", PackWriter::DefaultAlignment);
+	printf("  -nocompress       Stores every entry uncompressed\n");
+	printf("  -verify           Reads the pack back and compares every entry with its source\n");
+	printf("Usage: PackTool -registry <manifest> <output registry>\n");
+	printf("  Each manifest line is \"<type> <id> <path> [dependency ids...]\", with type one of\n");
+	printf("  mesh, shader, material or texture; blank lines and lines starting with '#' are skipped\n");
+	printf("Usage: PackTool -mesh <input mesh> <output mesh> [-full | -compact] [-lods <count>]\n");
+	printf("  Optimizes a mesh for the vertex cache, overdraw and vertex fetch, and writes it in the\n");
+	printf("  aligned format StaticMesh uploads without copying. Vertices are quantized to the compact\n");
+	printf("  format when the error is within %g units of position and %g of texture coordinates,\n",
+		MeshQuantizer::DefaultMaxPositionError, MeshQuantizer::DefaultMaxTexCoordError);
+	printf("  unless -full or -compact picks the format. Up to <count> LODs are generated, including\n");
+	printf("  the full mesh, each with about half the triangles of the last (default %u, at most %u),\n",
+		MeshOptimizer::DefaultLodCount, StaticMesh::MaxLodCount);
+	printf("  and split into clusters of up to %u triangles for culling\n", MeshOptimizer::MaxClusterTriangles);
+}
+
+// How CookMesh picks the vertex format
+enum class MeshFormatChoice
+{
+	Automatic,
+	Full,
+	Compact
+};
+
+/**
+ * Converts a mesh in either format into an optimized StaticMeshFile
+ * Returns the process exit code
+ */
+static int CookMesh(const fs::path& inputPath, const fs::path& outputPath, MeshFormatChoice formatChoice, U32 maxLodCount)
+{
+	MappedFile input(inputPath, 0, MappedFile::SequentialScan);
+	if (!input.IsValid())
+	{
+		fprintf(stderr, "Failed to read %s\n", inputPath.string().c_str());
+		return 1;
+	}
+
+	BitStreamView data(reinterpret_cast<const Byte*>(input.GetData()), input.GetMappedSize());
+	if (!ChecksumFrame::Unwrap(data))
+	{
+		fprintf(stderr, "%s is corrupt\n", inputPath.string().c_str());
+		return 1;
+	}
+
+	StaticVertex* vertices = nullptr;
+	StaticMesh::Index* indices = nullptr;
+	U32 vertexCount = 0;
+	U32 indexCount = 0;
+	if (StaticMeshFile::IsMeshFile(data))
+	{
+		StaticMeshFile mesh;
+		if (mesh.Open(data))
+		{
+			// Only the full detail LOD is cooked again, and the optimizer drops the vertices only other LODs used
+			const StaticMeshLod& fullLod = mesh.GetLod(0);
+			vertexCount = mesh.GetVertexCount();
+			indexCount = fullLod.IndexCount;
+			vertices = new StaticVertex[vertexCount];
+			if (mesh.GetVertexFormat() == StaticVertexFormat::Compact)
+			{
+				// Re-cooking a compact mesh quantizes the decoded vertices again, which lands on the same values
+				CompactStaticVertex* compactVertices = new CompactStaticVertex[vertexCount];
+				mesh.ReadVertices(compactVertices);
+				MeshQuantizer::Dequantize(compactVertices, vertexCount, mesh.GetPositionOffset(), mesh.GetPositionScale(), vertices);
+				delete[] compactVertices;
+			}
+			else
+			{
+				mesh.ReadVertices(vertices);
+			}
+			indices = new StaticMesh::Index[indexCount];
+			if (mesh.GetIndexSize() == sizeof(U16))
+			{
+				U16* shortIndices = new U16[indexCount];
+				mesh.ReadIndices(shortIndices, fullLod.FirstIndex, indexCount);
+				for (U32 i = 0; i < indexCount; ++i)
+				{
+					indices[i] = shortIndices[i];
+				}
+				delete[] shortIndices;
+			}
+			else
+			{
+				mesh.ReadIndices(indices, fullLod.FirstIndex, indexCount);
+			}
+		}
+	}
+	else if (data.GetRemainingBytes() >= sizeof(U32))
+	{
+		// Older meshes: vertex count, vertices, index count, indices
+		vertexCount = data.Read<U32>();
+		if (vertexCount > 0 && vertexCount <= data.GetRemainingBytes() / sizeof(StaticVertex))
+		{
+			vertices = new StaticVertex[vertexCount];
+			data.ReadArray(vertices, vertexCount);
+			indexCount = data.GetRemainingBytes() >= sizeof(U32) ? data.Read<U32>() : 0;
+			if (indexCount > 0 && indexCount <= data.GetRemainingBytes() / sizeof(StaticMesh::Index))
+			{
+				indices = new StaticMesh::Index[indexCount];
+				data.ReadArray(indices, indexCount);
+			}
+		}
+	}
+
+	if (!vertices || !indices || indexCount % 3 != 0)
+	{
+		fprintf(stderr, "%s is not a triangle mesh\n", inputPath.string().c_str());
+		delete[] vertices;
+		delete[] indices;
+		return 1;
+	}
+	for (U32 i = 0; i < indexCount; ++i)
+	{
+		if (indices[i] >= vertexCount)
+		{
+			fprintf(stderr, "%s has an index out of range\n", inputPath.string().c_str());
+			delete[] vertices;
+			delete[] indices;
+			return 1;
+		}
+	}
+
+	const U32 inputVertexCount = vertexCount;
+	const MeshCacheStats before = MeshOptimizer::Analyze(indices, indexCount, vertexCount);
+	vertexCount = MeshOptimizer::Optimize(vertices, vertexCount, indices, indexCount);
+	const MeshCacheStats after = MeshOptimizer::Analyze(indices, indexCount, vertexCount);
+
+	printf("Vertices: %u -> %u%s\n", inputVertexCount, vertexCount, vertexCount <= 0x10000 ? ", 16-bit indices" : "");
+	printf("ACMR:      %.3f -> %.3f\n", before.ACMR, after.ACMR);
+	printf("ATVR:      %.3f -> %.3f\n", before.ATVR, after.ATVR);
+	printf("Overfetch: %.3f -> %.3f\n", before.Overfetch, after.Overfetch);
+
+	// Every LOD indexes the optimized vertices, with its range appended to the index list
+	Array<U32> lodIndices;
+	lodIndices.Resize(indexCount * 2);
+	lodIndices.AddMultiple(indices, indexCount);
+	delete[] indices;
+	StaticMeshLod lods[StaticMesh::MaxLodCount];
+	const U32 lodCount = MeshOptimizer::GenerateLods(lodIndices, vertices, vertexCount, lods, maxLodCount);
+	for (U32 i = 0; i < lodCount; ++i)
+	{
+		printf("LOD %u: %u triangles, error %.6f units\n", i, lods[i].IndexCount / 3, lods[i].Error);
+	}
+
+	// Measure the compact format's error on every mesh, so the report shows what was kept or given up
+	Vector3f positionOffset;
+	F32 positionScale;
+	MeshQuantizer::ComputeBounds(vertices, vertexCount, positionOffset, positionScale);
+	CompactStaticVertex* compactVertices = new CompactStaticVertex[vertexCount];
+	const MeshQuantizationError error = MeshQuantizer::Quantize(vertices, vertexCount, positionOffset, positionScale, compactVertices);
+	const bool compact = formatChoice == MeshFormatChoice::Compact ||
+		(formatChoice == MeshFormatChoice::Automatic && MeshQuantizer::IsAcceptable(error));
+
+	printf("Quantization error (max / mean):\n");
+	printf("  Position:  %.6f / %.6f units, in a cube of half size %.3f\n", error.MaxPosition, error.MeanPosition, positionScale);
+	printf("  Normal:    %.4f / %.4f degrees\n", error.MaxNormal, error.MeanNormal);
+	printf("  Tangent:   %.4f / %.4f degrees\n", error.MaxTangent, error.MeanTangent);
+	printf("  TexCoord:  %.6f / %.6f\n", error.MaxTexCoord, error.MeanTexCoord);
+	printf("Vertex format: %s, %llu bytes per vertex%s\n", compact ? "compact" : "full",
+		(unsigned long long)StaticMesh::GetVertexSize(compact ? StaticVertexFormat::Compact : StaticVertexFormat::Full),
+		formatChoice == MeshFormatChoice::Automatic && !compact ? " (compact error over the limit)" : "");
+
+	// Clusters are bounded by the positions that are drawn, decoded ones for compact meshes
+	Array<StaticMeshCluster> clusters;
+	if (compact)
+	{
+		StaticVertex* decoded = new StaticVertex[vertexCount];
+		MeshQuantizer::Dequantize(compactVertices, vertexCount, positionOffset, positionScale, decoded);
+		MeshOptimizer::BuildClusters(lodIndices.GetData(), decoded, vertexCount, lods, lodCount, clusters);
+		delete[] decoded;
+	}
+	else
+	{
+		MeshOptimizer::BuildClusters(lodIndices.GetData(), vertices, vertexCount, lods, lodCount, clusters);
+	}
+	const U32 clusterCount = static_cast<U32>(clusters.GetCount());
+	for (U32 i = 0; i < lodCount; ++i)
+	{
+		printf("LOD %u clusters: %u, %.1f triangles each\n", i, lods[i].ClusterCount, lods[i].IndexCount / 3.0F / lods[i].ClusterCount);
+	}
+
+	BitStream output;
+	indexCount = static_cast<U32>(lodIndices.GetCount());
+	if (compact)
+	{
+		StaticMeshFile::Write(compactVertices, vertexCount, positionOffset, positionScale, lodIndices.GetData(), indexCount, lods, lodCount,
+			clusters.GetData(), clusterCount, output);
+	}
+	else
+	{
+		StaticMeshFile::Write(vertices, vertexCount, lodIndices.GetData(), indexCount, lods, lodCount, clusters.GetData(), clusterCount, output);
+	}
+	delete[] vertices;
+	delete[] compactVertices;
+
+	File file(outputPath, FileMode::FILE_WRITE_REPLACE, true);
+	if (file.Write(output.GetData(), output.GetStoredBytes()) != output.GetStoredBytes())
+	{
+		fprintf(stderr, "Failed to write %s\n", outputPath.string().c_str());
+		return 1;
+	}
+
+	printf("Cooked %s: %u vertices, %u indices, %llu bytes\n", outputPath.string().c_str(), vertexCount, indexCount,
+		(unsigned long long)output.GetStoredBytes());
+	return 0;
+}
+
+/**
+ * Compiles a manifest into an asset registry file
+ * Returns the process exit code
+ */
+static int BuildRegistry(const char* manifestPath, const fs::path& outputPath)
+{
+	// Indexed by AssetType
+	static const char* const typeNames[AssetTypeCount] = { "mesh", "shader", "material", "texture" };
+
+	FILE* manifest = fopen(manifestPath, "r");
+	if (!manifest)
+	{
+		fprintf(stderr, "Failed to read %s\n", manifestPath);
+		return 1;
+	}
+
+	AssetRegistryWriter writer;
+	Array<NIdentifier> dependencies;
+	char line[4096];
+	U32 lineNumber = 0;
+	U32 errors = 0;
+	while (fgets(line, sizeof(line), manifest))
+	{
+		++lineNumber;
+
+		const char* separators = " \t\r\n";
+		const char* typeName = std::strtok(line, separators);
+		if (!typeName || typeName[0] == '#')
+		{
+			continue;
+		}
+
+		const char* id = std::strtok(nullptr, separators);
+		const char* path = std::strtok(nullptr, separators);
+		Size type = 0;
+		while (type < AssetTypeCount && std::strcmp(typeName, typeNames[type]) != 0)
+		{
+			++type;
+		}
+		if (!id || !path || type == AssetTypeCount)
+		{
+			fprintf(stderr, "%s(%u): expected \"<type> <id> <path> [dependency ids...]\"\n", manifestPath, lineNumber);
+			++errors;
+			continue;
+		}
+
+		dependencies.Empty();
+		while (const char* dependency = std::strtok(nullptr, separators))
+		{
+			dependencies.Add(NIdentifier(dependency, std::strlen(dependency)));
+		}
+
+		// Recorded for budgeting and progress; a missing file is only an error once it's loaded
+		std::error_code error;
+		const U64 fileSize = fs::file_size(path, error);
+		if (error)
+		{
+			printf("Warning: %s(%u): can't read %s\n", manifestPath, lineNumber, path);
+		}
+
+		writer.Add(id, path, static_cast<AssetType>(type), error ? 0 : fileSize, dependencies);
+	}
+	fclose(manifest);
+
+	if (errors > 0 || !writer.Write(outputPath))
+	{
+		fprintf(stderr, "Failed to write %s\n", outputPath.string().c_str());
+		return 1;
+	}
+
+	AssetRegistryFile registry;
+	if (!registry.Open(outputPath))
+	{
+		fprintf(stderr, "Failed to reopen %s\n", outputPath.string().c_str());
+		return 1;
+	}
+
+	printf("Registered %u assets in %s, %llu bytes\n", registry.GetEntryCount(), outputPath.string().c_str(),
+		(unsigned long long)CheckFileSize(outputPath.string().c_str()));
+	return 0;
+}
+
+/**
+ * Checks every entry of the pack against the file it was built from
+ * Returns the number of entries that don't match
+ */
+static U32 VerifyPack(const fs::path& packPath, const DirectoryIndex& index, const char* prefix)
+{
+	PackFile pack;
+	if (!pack.Open(packPath))
+	{
+		fprintf(stderr, "Failed to reopen %s\n", packPath.string().c_str());
+		return 1;
+	}
+
+	const Size prefixLength = std::strlen(prefix);
+	Array<char> name;
+	BitStream contents;
+	U32 failures = 0;
+	for (const DirectoryEntry& entry : index.GetEntries())
+	{
+		if (std::strcmp(index.GetExtension(entry), PackFile::Extension) == 0)
+		{
+			continue;
+		}
+
+		name.Empty();
+		if (prefixLength > 0)
+		{
+			name.AddMultiple(prefix, prefixLength);
+		}
+		name.AddMultiple(index.GetPath(entry), Size(entry.PathLength) + 1);
+
+		const PackEntry* packEntry = pack.Find(name.GetData());
+		contents.Reset();
+		MappedFile source(index.GetFullPath(entry));
+		if (!packEntry || !pack.VerifyEntry(*packEntry) || !pack.Read(*packEntry, contents) ||
+			contents.GetStoredBytes() != source.GetMappedSize() ||
+			(source.IsValid() && std::memcmp(contents.GetData(), source.GetData(), source.GetMappedSize()) != 0))
+		{
+			fprintf(stderr, "Mismatch: %s\n", name.GetData());
+			++failures;
+		}
+	}
+
+	return failures;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	if (std::strcmp(argv[1], "-registry") == 0)
+	{
+		if (argc != 4)
+		{
+			PrintUsage();
+			return 1;
+		}
+		return BuildRegistry(argv[2], argv[3]);
+	}
+
+	if (std::strcmp(argv[1], "-mesh") == 0)
+	{
+		MeshFormatChoice formatChoice = MeshFormatChoice::Automatic;
+		U32 maxLodCount = MeshOptimizer::DefaultLodCount;
+		for (int i = 4; i < argc; ++i)
+		{
+			if (std::strcmp(argv[i], "-full") == 0)
+			{
+				formatChoice = MeshFormatChoice::Full;
+			}
+			else if (std::strcmp(argv[i], "-compact") == 0)
+			{
+				formatChoice = MeshFormatChoice::Compact;
+			}
+			else if (std::strcmp(argv[i], "-lods") == 0 && i + 1 < argc)
+			{
+				maxLodCount = static_cast<U32>(std::strtoul(argv[++i], nullptr, 10));
+				if (maxLodCount == 0 || maxLodCount > StaticMesh::MaxLodCount)
+				{
+					fprintf(stderr, "LOD count must be between 1 and %u\n", StaticMesh::MaxLodCount);
+					return 1;
+				}
+			}
+			else
+			{
+				PrintUsage();
+				return 1;
+			}
+		}
+		if (argc < 4)
+		{
+			PrintUsage();
+			return 1;
+		}
+		return CookMesh(argv[2], argv[3], formatChoice, maxLodCount);
+	}
+
+	const fs::path inputPath = argv[1];
+	const fs::path outputPath = argv[2];
+	const char* prefix = "";
+	U32 alignment = PackWriter::DefaultAlignment;
+	bool compress = true;
+	bool verify = false;
+
+	for (int i = 3; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "-prefix") == 0 && i + 1 < argc)
+		{
+			prefix = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "-align") == 0 && i + 1 < argc)
+		{
+			alignment = static_cast<U32>(std::strtoul(argv[++i], nullptr, 10));
+			if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+			{
+				fprintf(stderr, "Alignment must be a power of two\n");
+				return 1;
+			}
+		}
+		else if (std::strcmp(argv[i], "-nocompress") == 0)
+		{
+			compress = false;
+		}
+		else if (std::strcmp(argv[i], "-verify") == 0)
+		{
+			verify = true;
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	DirectoryIndex index;
+	if (!index.Build(inputPath))
+	{
+		fprintf(stderr, "Failed to read %s\n", inputPath.string().c_str());
+		return 1;
+	}
+
+	PackWriter writer;
+	writer.SetAlignment(alignment);
+	writer.SetCompressionEnabled(compress);
+	writer.AddDirectory(index, prefix);
+
+	if (!writer.Write(outputPath))
+	{
+		fprintf(stderr, "Failed to write %s\n", outputPath.string().c_str());
+		return 1;
+	}
+
+	printf("Packed %llu files (%llu compressed) into %s, %llu bytes\n",
+		(unsigned long long)writer.GetEntryCount(), (unsigned long long)writer.GetCompressedCount(), outputPath.string().c_str(),
+		(unsigned long long)CheckFileSize(outputPath.string().c_str()));
+
+	if (verify)
+	{
+		const U32 failures = VerifyPack(outputPath, index, prefix);
+		if (failures > 0)
+		{
+			fprintf(stderr, "%u entries failed verification\n", failures);
+			return 1;
+		}
+		printf("Verified every entry\n");
+	}
+
+	return 0;
+}
\ No newline at end of file